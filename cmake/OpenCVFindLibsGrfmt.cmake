@@ -391,3 +391,8 @@ if(WITH_IMGCODEC_PFM)
 elseif(DEFINED WITH_IMGCODEC_PFM)
   set(HAVE_IMGCODEC_PFM OFF)
 endif()
+if(WITH_IMGCODEC_CVFL)
+  set(HAVE_IMGCODEC_CVFL ON)
+elseif(DEFINED WITH_IMGCODEC_CVFL)
+  set(HAVE_IMGCODEC_CVFL OFF)
+endif()
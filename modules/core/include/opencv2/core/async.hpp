@@ -9,6 +9,8 @@
 
 //#include <future>
 #include <chrono>
+#include <functional>
+#include <vector>
 
 namespace cv {
 
@@ -96,6 +98,79 @@ protected:
 };
 
 
+class ParallelLoopBody;
+
+/** @brief Non-blocking version of parallel_for_()
+
+Schedules `parallel_for_(range, body, nstripes)` on a background executor thread and returns immediately.
+The returned AsyncArray becomes ready (with empty result) when processing is completed.
+Exception raised by the loop body is re-thrown by AsyncArray::get().
+
+@note `body` must remain valid until the returned AsyncArray is ready.
+*/
+CV_EXPORTS AsyncArray parallel_for_async(const Range& range, const ParallelLoopBody& body, double nstripes = -1.);
+
+/** @overload
+The functor is copied, so it may refer temporary objects captured by value.
+*/
+CV_EXPORTS AsyncArray parallel_for_async(const Range& range, std::function<void(const Range&)> functor, double nstripes = -1.);
+
+
+/** @brief Graph of dependent tasks which is executed asynchronously
+
+Tasks are executed on background executor threads as soon as all their dependencies are completed.
+Completion of a task schedules dependent tasks directly, without involving of the calling thread.
+Tasks may use parallel_for_() internally.
+
+@code
+    AsyncTaskGraph graph;
+    int blur = graph.addTask([&]() { cv::GaussianBlur(src, blurred, Size(5, 5), 0); });
+    int dx = graph.addTask([&]() { cv::Sobel(blurred, gx, CV_32F, 1, 0); }, {blur});
+    int dy = graph.addTask([&]() { cv::Sobel(blurred, gy, CV_32F, 0, 1); }, {blur});
+    graph.addTask([&]() { cv::magnitude(gx, gy, mag); }, {dx, dy});
+    AsyncArray done = graph.run();
+    // ... do something else
+    Mat dummy;
+    done.get(dummy);  // wait for completion, re-throw exception (if any)
+@endcode
+
+If some task throws an exception, then not started tasks are skipped and the first exception is reported via AsyncArray.
+*/
+class CV_EXPORTS AsyncTaskGraph
+{
+public:
+    AsyncTaskGraph();
+    ~AsyncTaskGraph();
+
+    /** @brief Adds task into the graph
+    @param task callable object
+    @param dependencies identifiers of tasks which must be completed before. These tasks must be added before.
+    @returns identifier of the task
+    */
+    int addTask(const std::function<void()>& task, const std::vector<int>& dependencies = std::vector<int>());
+
+    /** @brief Adds task which calls `parallel_for_(range, functor, nstripes)`
+    @sa addTask
+    */
+    int addParallelTask(const Range& range, const std::function<void(const Range&)>& functor,
+            const std::vector<int>& dependencies = std::vector<int>(), double nstripes = -1.);
+
+    /** @brief Returns number of tasks in the graph */
+    size_t size() const;
+
+    /** @brief Launches execution of the graph
+
+    Returns immediately. Result AsyncArray becomes ready when all tasks are completed.
+    Graph can be executed once only, captured resources of tasks are released after execution.
+    */
+    AsyncArray run();
+
+    struct Impl;
+protected:
+    Ptr<Impl> p;
+};
+
+
 //! @}
 } // namespace
 #endif // OPENCV_CORE_ASYNC_HPP
@@ -40,6 +40,14 @@ namespace cv { namespace parallel {
  * - Configuration of compiler/linker options is responsibility of Application's scripts
  *
  *
+ * ### Work-stealing backend
+ *
+ * Builtin backend with per-thread task queues and real nested parallelism (nested `parallel_for_()` calls are not serialized).
+ * It is not used by default and should be requested explicitly:
+ * - `OPENCV_PARALLEL_BACKEND=WORK_STEALING` or `OPENCV_PARALLEL_PRIORITY_LIST=WORK_STEALING`
+ * - `cv::parallel::setParallelForBackend("WORK_STEALING")`
+ *
+ *
  * ### Plugins support
  *
  * Runtime configuration options:
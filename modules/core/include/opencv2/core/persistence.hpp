@@ -100,6 +100,8 @@ JSON.
 #include "opencv2/core/types.hpp"
 #include "opencv2/core/mat.hpp"
 
+#include <functional>
+
 namespace cv {
 
 /** @addtogroup core_xml
@@ -265,6 +267,18 @@ Here is how to read the file created by the code sample above:
     fs2.release();
 @endcode
 
+Binary file storage    {#xml_storage_binary}
+-------------------
+Files with ".cvbin" extension (or opened with FileStorage::FORMAT_BINARY flag) use compact binary
+format. It is written and read through the same API, so any data that can be stored in XML/YAML/JSON can
+be stored in the binary storage as well. Differences from the text formats:
+-   raw data (FileStorage::writeRaw(), matrix elements) is stored as is, without conversion to text.
+    Continuous matrices are stored as a single block aligned to 64 bytes, see utils::mapStorageMat() for
+    mapping of such matrices into memory without reading.
+-   the file ends with a table of contents which contains offsets of all top-level nodes.
+-   comments are not stored; appending to the existing file is not supported.
+-   ".cvbin.gz" files are compressed as a whole (table of contents is not used for such files).
+
 Format specification    {#format_spec}
 --------------------
 `([count]{u|c|w|s|i|f|d})`... where the characters correspond to fundamental C++ types:
@@ -316,6 +330,7 @@ public:
         FORMAT_XML  = (1<<3), //!< flag, XML format
         FORMAT_YAML = (2<<3), //!< flag, YAML format
         FORMAT_JSON = (3<<3), //!< flag, JSON format
+        FORMAT_BINARY = (4<<3), //!< flag, binary format (.cvbin), see @ref xml_storage_binary
 
         BASE64      = 64,     //!< flag, write rawdata in Base64 by default. (consider using WRITE_BASE64)
         WRITE_BASE64 = BASE64 | WRITE, //!< flag, enable both WRITE and BASE64
@@ -348,8 +363,8 @@ public:
      See description of parameters in FileStorage::FileStorage. The method calls FileStorage::release
      before opening the file.
      @param filename Name of the file to open or the text string to read the data from.
-     Extension of the file (.xml, .yml/.yaml or .json) determines its format (XML, YAML or JSON
-     respectively). Also you can append .gz to work with compressed files, for example myHugeMatrix.xml.gz. If both
+     Extension of the file (.xml, .yml/.yaml, .json or .cvbin) determines its format (XML, YAML, JSON or
+     binary respectively). Also you can append .gz to work with compressed files, for example myHugeMatrix.xml.gz. If both
      FileStorage::WRITE and FileStorage::MEMORY flags are specified, source is used just to specify
      the output file format (e.g. mydata.xml, .yml etc.). A file name can also contain parameters.
      You can use this format, "*?base64" (e.g. "file.json?base64" (case sensitive)), as an alternative to
@@ -454,6 +469,33 @@ public:
      */
     static String getDefaultObjectName(const String& filename);
 
+    /** @brief Reads the file node by node, without building the node tree of the whole document.
+
+    Top-level nodes (elements of the top-level mapping of each stream) are parsed one by one and passed
+    to the callback. Memory of the node is released when the callback returns, so memory usage is bounded
+    by the largest top-level node rather than by the size of the document. Parsing stops as soon as
+    the callback returns false, the rest of the file is not parsed.
+
+    @code
+        Mat descriptors;
+        FileStorage::readTopLevelNodes("features.yml.gz", [&](const FileNode& node) {
+            if (node.name() != "descriptors")
+                return true;  // skip the node
+            node >> descriptors;
+            return false;
+        });
+    @endcode
+
+    @param filename Name of the file or the text string to read the data from, see open().
+    @param callback Function which is called for each top-level node. The node and its children are
+    valid during the call only.
+    @param flags FileStorage::READ with optional FileStorage::MEMORY flag.
+    @param encoding Encoding of the file, see open().
+    @returns false if the file can't be opened.
+    */
+    static bool readTopLevelNodes(const String& filename, const std::function<bool(const FileNode&)>& callback,
+                                  int flags = READ, const String& encoding = String());
+
     /** @brief Returns the current format.
      * @returns The current format, see FileStorage::Mode
      */
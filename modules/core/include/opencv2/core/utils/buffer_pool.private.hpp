@@ -0,0 +1,159 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef OPENCV_UTILS_BUFFER_POOL_PRIVATE_HPP
+#define OPENCV_UTILS_BUFFER_POOL_PRIVATE_HPP
+
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/utils/pool_allocator.hpp>
+
+#include <limits>
+
+namespace cv { namespace utils {
+
+//! @addtogroup core_utils
+//! @{
+
+/** @brief Allocates temporary buffer from the CPU buffer pool
+
+Buffers are aligned like fastMalloc() results. Pool keeps released buffers in thread-local size-class caches,
+so repeated calls of functions with the same input sizes don't call the system allocator.
+Retention is limited by OPENCV_BUFFER_POOL_THREAD_CACHE_SIZE and OPENCV_BUFFER_POOL_MAX_RESERVED_SIZE
+(`Mat::getStdAllocator()->getBufferPoolController()`).
+
+@param size buffer size in bytes
+@sa releaseTemporaryBuffer
+*/
+CV_EXPORTS void* allocateTemporaryBuffer(size_t size);
+
+/** @brief Returns temporary buffer into the CPU buffer pool
+@param ptr buffer allocated by allocateTemporaryBuffer(), may be NULL
+@param size the same size which is passed to allocateTemporaryBuffer()
+*/
+CV_EXPORTS void releaseTemporaryBuffer(void* ptr, size_t size);
+
+/** @brief Returns MatAllocator for local Mat temporaries of OpenCV functions (backed by the CPU buffer pool)
+
+@code
+    Mat tmp;
+    tmp.allocator = utils::getTemporaryMatAllocator();
+    tmp.create(size, type);
+@endcode
+
+@note Don't use it for Mat objects which are returned to the user.
+*/
+CV_EXPORTS MatAllocator* getTemporaryMatAllocator();
+
+/** @brief Returns counters of the CPU buffer pool (allocateTemporaryBuffer() and getTemporaryMatAllocator() requests) */
+CV_EXPORTS PoolAllocatorStatistics getTemporaryBufferPoolStatistics();
+CV_EXPORTS void resetTemporaryBufferPoolStatistics();
+
+
+/** @brief AutoBuffer replacement which takes large buffers from the CPU buffer pool
+
+Small buffers (up to `fixed_size` elements) are placed on stack, like in AutoBuffer.
+
+@note Elements are not initialized: use for POD types only.
+*/
+template<typename _Tp, size_t fixed_size = 1024/sizeof(_Tp)+8>
+class PooledAutoBuffer
+{
+public:
+    typedef _Tp value_type;
+
+    PooledAutoBuffer() : ptr(buf), sz(fixed_size), capacity(0) {}
+    explicit PooledAutoBuffer(size_t _size) : ptr(buf), sz(fixed_size), capacity(0) { allocate(_size); }
+    ~PooledAutoBuffer() { deallocate(); }
+
+    /** Allocates new buffer of the specified size (content is not preserved) */
+    void allocate(size_t _size)
+    {
+        if (_size <= (ptr == buf ? fixed_size : capacity))
+        {
+            sz = _size;
+            return;
+        }
+        deallocate();
+        sz = _size;
+        if (_size > fixed_size)
+        {
+            ptr = (_Tp*)allocateTemporaryBuffer(_size * sizeof(_Tp));
+            capacity = _size;
+        }
+    }
+
+    void deallocate()
+    {
+        if (ptr != buf)
+        {
+            releaseTemporaryBuffer(ptr, capacity * sizeof(_Tp));
+            ptr = buf;
+            capacity = 0;
+        }
+        sz = fixed_size;
+    }
+
+    size_t size() const { return sz; }
+
+    inline _Tp* data() { return ptr; }
+    inline const _Tp* data() const { return ptr; }
+
+    operator _Tp* () { return ptr; }
+    operator const _Tp* () const { return ptr; }
+
+protected:
+    _Tp* ptr;
+    size_t sz;
+    size_t capacity;  // valid for pool buffers only
+    _Tp buf[(fixed_size > 0) ? fixed_size : 1];
+
+private:
+    PooledAutoBuffer(const PooledAutoBuffer&);  // = delete
+    PooledAutoBuffer& operator=(const PooledAutoBuffer&);  // = delete
+};
+
+
+/** @brief STL allocator which takes buffers from the CPU buffer pool
+
+@code
+    std::vector<uchar, utils::PooledStdAllocator<uchar> > buf;
+@endcode
+*/
+template<typename T>
+class PooledStdAllocator
+{
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+    template<typename U> struct rebind { typedef PooledStdAllocator<U> other; };
+
+    PooledStdAllocator() {}
+    PooledStdAllocator(const PooledStdAllocator&) {}
+    template<typename U> PooledStdAllocator(const PooledStdAllocator<U>&) {}
+
+    pointer address(reference r) const { return &r; }
+    const_pointer address(const_reference r) const { return &r; }
+
+    pointer allocate(size_type count, const void* = 0) { return (pointer)allocateTemporaryBuffer(count * sizeof(T)); }
+    void deallocate(pointer p, size_type count) { releaseTemporaryBuffer(p, count * sizeof(T)); }
+
+    void construct(pointer p, const T& v) { new(static_cast<void*>(p)) T(v); }
+    void destroy(pointer p) { p->~T(); }
+
+    size_type max_size() const { return std::numeric_limits<size_type>::max() / sizeof(T); }
+
+    template<typename U> bool operator==(const PooledStdAllocator<U>&) const { return true; }
+    template<typename U> bool operator!=(const PooledStdAllocator<U>&) const { return false; }
+};
+
+//! @}
+
+}} // namespace
+
+#endif // OPENCV_UTILS_BUFFER_POOL_PRIVATE_HPP
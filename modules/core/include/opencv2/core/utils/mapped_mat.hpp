@@ -0,0 +1,110 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef OPENCV_CORE_UTILS_MAPPED_MAT_HPP
+#define OPENCV_CORE_UTILS_MAPPED_MAT_HPP
+
+#include "opencv2/core/mat.hpp"
+
+namespace cv { namespace utils {
+
+//! @addtogroup core_utils
+//! @{
+
+/** @brief Access mode of memory-mapped matrices
+
+@sa mapMatFile, mapNpyFile, mapStorageMat, mapSharedMemoryMat
+*/
+enum MappedMatMode
+{
+    MAPPED_MAT_READ = 0,          //!< read-only mapping, pages are shared with page cache and other processes. Data must not be modified.
+    MAPPED_MAT_READ_WRITE = 1,    //!< modifications are written back to the file (shared memory segment) and are visible to other processes
+    MAPPED_MAT_COPY_ON_WRITE = 2  //!< modifications are private to the process: modified pages are copied on the first write
+};
+
+/** @brief Maps raw array from the file as Mat data (zero-copy)
+
+Data is not read on creation of the matrix: pages are loaded by the OS on the first access and are shared
+with the page cache, so several processes which map the same file use single copy of data in memory.
+
+The mapping is owned by the returned Mat (UMatData of the matrix): it is released together with the last
+matrix which references the data, including sub-matrices and `getUMat()` results. Copies of the matrix
+(`clone()`, `copyTo()`) are regular heap matrices.
+
+@param filename path to the file
+@param sizes array dimensions, the array is continuous. Single dimension is mapped as a column
+@param type array type
+@param offset offset of the array data in the file (in bytes), doesn't need to be aligned to the page size
+@param mode access mode, see MappedMatMode
+
+@note File size can't be changed while it is mapped.
+*/
+CV_EXPORTS Mat mapMatFile(const String& filename, const std::vector<int>& sizes, int type,
+                          size_t offset = 0, MappedMatMode mode = MAPPED_MAT_READ);
+
+/** @brief Maps array from NumPy .npy file as Mat data (zero-copy)
+
+Supported element types are bool, uint8, int8, uint16, int16, int32, float16, float32 and float64
+in C order (`fortran_order` is False) and little-endian byte order.
+Arrays with N dimensions are mapped as single-channel N-dimensional Mat. 1D arrays are mapped as a single column,
+0D arrays are mapped as 1x1 matrix. Use Mat::reshape() to interpret the last dimension as channels.
+
+@param filename path to .npy file
+@param mode access mode, see MappedMatMode
+@sa mapMatFile
+*/
+CV_EXPORTS Mat mapNpyFile(const String& filename, MappedMatMode mode = MAPPED_MAT_READ);
+
+/** @brief Maps matrix from binary file storage (.cvbin) as Mat data (zero-copy)
+
+The matrix is located by the table of contents of the storage, its elements are not read or decoded.
+Only top-level matrices written from continuous Mat can be mapped (`fs << "name" << mat`),
+compressed storages (.cvbin.gz) can't be mapped.
+
+@param filename path to .cvbin file written by FileStorage
+@param name name of the top-level node. If several streams contain the node, the first one is used
+@param mode access mode, see MappedMatMode
+@sa mapMatFile, @ref xml_storage_binary
+*/
+CV_EXPORTS Mat mapStorageMat(const String& filename, const String& name, MappedMatMode mode = MAPPED_MAT_READ);
+
+/** @brief Creates named shared memory segment and maps it as Mat data
+
+Other processes access the data through mapSharedMemoryMat() with the same name, sizes and type.
+Content of the new segment is zero-initialized.
+
+On POSIX systems the segment is created by `shm_open()` and it exists until removeSharedMemory() call
+(or system reboot). On Windows the segment exists while it is mapped by any process.
+
+@param name segment name, like "/my_tensor" (POSIX) or "Local\\my_tensor" (Windows)
+@param sizes array dimensions
+@param type array type
+
+@note Creation fails if the segment already exists.
+*/
+CV_EXPORTS Mat createSharedMemoryMat(const String& name, const std::vector<int>& sizes, int type);
+
+/** @brief Maps existing named shared memory segment as Mat data
+
+@param name segment name, see createSharedMemoryMat()
+@param sizes array dimensions, the segment must be large enough to hold the array
+@param type array type
+@param mode access mode, see MappedMatMode
+*/
+CV_EXPORTS Mat mapSharedMemoryMat(const String& name, const std::vector<int>& sizes, int type,
+                                  MappedMatMode mode = MAPPED_MAT_READ);
+
+/** @brief Removes name of shared memory segment (POSIX `shm_unlink()`)
+
+Mapped data stays valid until it is released by all processes. Function does nothing on Windows.
+
+@returns false if the segment doesn't exist
+*/
+CV_EXPORTS bool removeSharedMemory(const String& name);
+
+//! @}
+
+}} // namespace
+
+#endif // OPENCV_CORE_UTILS_MAPPED_MAT_HPP
@@ -0,0 +1,79 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef OPENCV_CORE_UTILS_POOL_ALLOCATOR_HPP
+#define OPENCV_CORE_UTILS_POOL_ALLOCATOR_HPP
+
+#include "opencv2/core/mat.hpp"
+
+namespace cv { namespace utils {
+
+//! @addtogroup core_utils
+//! @{
+
+/** @brief Counters of the pooling Mat allocator
+
+@sa getPoolMatAllocator, getPoolMatAllocatorStatistics
+*/
+struct CV_EXPORTS PoolAllocatorStatistics
+{
+    PoolAllocatorStatistics();
+
+    uint64 allocations;   //!< number of buffer allocation requests (hits + misses)
+    uint64 hits;          //!< requests served by cached buffers
+    uint64 misses;        //!< requests served by the system allocator (including bypassed requests)
+    uint64 bypassed;      //!< requests of buffers which are too large for caching (see OPENCV_POOL_ALLOCATOR_MAX_BUFFER_SIZE)
+    uint64 evictions;     //!< cached buffers which are released to the system due to retention limits
+    size_t reservedSize;  //!< memory held by cached buffers (thread caches and shared pool)
+
+    /** @brief Returns fraction of allocation requests served by cached buffers */
+    double hitRate() const { return allocations > 0 ? (double)hits / (double)allocations : 0.0; }
+};
+
+/** @brief Returns pooling Mat allocator
+
+Released buffers are not returned to the system. They are kept in size-class caches and reused by the next
+allocations of similar size (size classes are 25% apart). Pipelines which create and release matrices of the same
+sizes on each frame don't call the system allocator in steady state.
+
+Each thread has own cache, so allocations don't contend on a global lock. Thread caches are backed by the shared pool:
+buffers released by one thread are available for others (when thread cache is full or thread is terminated).
+
+Retention is bounded:
+- thread cache size is limited by OPENCV_POOL_ALLOCATOR_THREAD_CACHE_SIZE (32Mb by default)
+- shared pool size is limited by OPENCV_POOL_ALLOCATOR_MAX_RESERVED_SIZE (256Mb by default),
+  use `getBufferPoolController()->setMaxReservedSize()` to change it in runtime
+- buffers larger than OPENCV_POOL_ALLOCATOR_MAX_BUFFER_SIZE (64Mb by default) are not cached
+
+Least recently released buffers are freed first. `getBufferPoolController()->freeAllReservedBuffers()` releases all cached buffers.
+
+Allocator is used for Mat objects only, it is not enabled by default:
+@code
+    Mat::setDefaultAllocator(utils::getPoolMatAllocator());  // all threads
+    // or
+    utils::setThreadDefaultMatAllocator(utils::getPoolMatAllocator());  // current thread only
+@endcode
+*/
+CV_EXPORTS MatAllocator* getPoolMatAllocator();
+
+/** @brief Returns counters of the pooling Mat allocator (accumulated over all threads) */
+CV_EXPORTS PoolAllocatorStatistics getPoolMatAllocatorStatistics();
+
+/** @brief Resets counters of the pooling Mat allocator (cached buffers are not released) */
+CV_EXPORTS void resetPoolMatAllocatorStatistics();
+
+/** @brief Overrides default Mat allocator for the current thread
+
+@param allocator allocator for new Mat buffers of the current thread.
+       NULL restores the process-wide allocator (see Mat::setDefaultAllocator()).
+
+@note Mat keeps reference on the used allocator, so matrices can be released by any thread.
+*/
+CV_EXPORTS void setThreadDefaultMatAllocator(MatAllocator* allocator);
+
+//! @}
+
+}} // namespace
+
+#endif // OPENCV_CORE_UTILS_POOL_ALLOCATOR_HPP
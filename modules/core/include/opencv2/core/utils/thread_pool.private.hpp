@@ -0,0 +1,52 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef OPENCV_UTILS_THREAD_POOL_PRIVATE_HPP
+#define OPENCV_UTILS_THREAD_POOL_PRIVATE_HPP
+
+#include <opencv2/core/cvdef.h>
+
+#include <opencv2/core/types.hpp>
+
+#include <string>
+#include <vector>
+
+namespace cv { namespace utils {
+
+//! @addtogroup core_utils
+//! @{
+
+/** @brief Touches pages of the buffer by the workers of the builtin (pthreads) thread pool
+
+This is the NUMA first-touch step which is applied to the new large Mat buffers (OPENCV_THREAD_POOL_NUMA).
+Buffer contents are preserved. Call is no-op if NUMA mode is disabled, there is a single NUMA node,
+another parallel backend is used or the buffer is smaller than OPENCV_THREAD_POOL_NUMA_FIRST_TOUCH_THRESHOLD.
+*/
+CV_EXPORTS void threadPoolFirstTouch(void* data, size_t size);
+
+/** @brief Overrides NUMA configuration of the builtin thread pool (OPENCV_THREAD_POOL_NUMA, OPENCV_THREAD_POOL_NUMA_NODES)
+
+Worker threads are stopped and re-created with the new topology by the next parallel job.
+Must not be called in parallel with `parallel_for_()`.
+
+@param enable NUMA mode (per-node partitions of jobs and first touch of large Mat buffers)
+@param nodes CPU lists of NUMA nodes separated by ';', e.g. "0-3;4-7". Empty string: topology from sysfs
+*/
+CV_EXPORTS void setThreadPoolNUMAConfiguration(bool enable, const std::string& nodes = std::string());
+
+/** @brief Returns number of NUMA nodes of the builtin thread pool topology (1 if topology is not available) */
+CV_EXPORTS int getThreadPoolNUMANodes();
+
+/** @brief Returns per-node partitions of the range which are used by `parallel_for_()` of the builtin thread pool
+
+The partitions depend on the worker threads layout only, not on the calling thread.
+Empty result: NUMA partitioning is not applied (NUMA mode is disabled, single node or less than 2 threads).
+*/
+CV_EXPORTS std::vector<Range> getThreadPoolNUMAPartitions(const Range& range);
+
+//! @}
+
+}} // namespace cv::utils
+
+#endif // OPENCV_UTILS_THREAD_POOL_PRIVATE_HPP
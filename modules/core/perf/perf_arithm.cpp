@@ -726,13 +726,64 @@ PERF_TEST_P_(RotateTest, rotate)
 
 INSTANTIATE_TEST_CASE_P(/*nothing*/ , RotateTest,
     testing::Combine(
-        testing::Values(szVGA, sz720p, sz1080p),
+        testing::Values(szVGA, sz720p, sz1080p, sz2160p),
         testing::Values(ROTATE_180, ROTATE_90_CLOCKWISE, ROTATE_90_COUNTERCLOCKWISE),
         testing::Values(CV_8UC1, CV_8UC3, CV_8UC4, CV_8SC1, CV_16SC1, CV_16SC2, CV_16SC3, CV_16SC4, CV_32SC1, CV_32FC1)
     )
 );
 
 
+///////////// Transpose ////////////////////////
+
+typedef perf::TestBaseWithParam<std::tuple<cv::Size, perf::MatType>> TransposeTest;
+
+PERF_TEST_P_(TransposeTest, transpose)
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    cv::Mat a(sz, type), b(sz.width, sz.height, type);
+
+    declare.in(a, WARMUP_RNG).out(b);
+
+    TEST_CYCLE() cv::transpose(a, b);
+
+    SANITY_CHECK_NOTHING();
+}
+
+INSTANTIATE_TEST_CASE_P(/*nothing*/ , TransposeTest,
+    testing::Combine(
+        testing::Values(szVGA, sz1080p, sz2160p),
+        testing::Values(CV_8UC1, CV_8UC3, CV_8UC4, CV_16UC1, CV_16UC3, CV_32FC1, CV_32FC3, CV_64FC1)
+    )
+);
+
+///////////// Flip ////////////////////////
+
+typedef perf::TestBaseWithParam<std::tuple<cv::Size, int, perf::MatType>> FlipTest;
+
+PERF_TEST_P_(FlipTest, flip)
+{
+    Size sz       = get<0>(GetParam());
+    int flipCode  = get<1>(GetParam());
+    int type      = get<2>(GetParam());
+    cv::Mat a(sz, type), b(sz, type);
+
+    declare.in(a, WARMUP_RNG).out(b);
+
+    TEST_CYCLE() cv::flip(a, b, flipCode);
+
+    SANITY_CHECK_NOTHING();
+}
+
+INSTANTIATE_TEST_CASE_P(/*nothing*/ , FlipTest,
+    testing::Combine(
+        testing::Values(sz1080p, sz2160p),
+        testing::Values(0, 1, -1),
+        testing::Values(CV_8UC1, CV_8UC3, CV_16UC1, CV_32FC1)
+    )
+);
+
+
 ///////////// PatchNaNs ////////////////////////
 
 template<typename _Tp>
@@ -83,4 +83,37 @@ PERF_TEST_P(Size_Mat_StrType, DISABLED_fs_base64,
     SANITY_CHECK_NOTHING();
 }
 
+PERF_TEST_P(Size_Mat_StrType, fs_base64_read,
+            testing::Combine(testing::Values(MAT_SIZES),
+                             testing::Values(MAT_TYPES),
+                             testing::Values(FILE_EXTENSION))
+             )
+{
+    Size   size = get<0>(GetParam());
+    int    type = get<1>(GetParam());
+    String ext  = get<2>(GetParam());
+
+    Mat src(size.height, size.width, type);
+    Mat dst = src.clone();
+
+    cv::String file_name = cv::tempfile(ext.c_str());
+    cv::String key       = "test_mat";
+
+    declare.in(src, WARMUP_RNG).out(dst);
+    {
+        FileStorage fs(file_name, cv::FileStorage::WRITE_BASE64);
+        fs << key << src;
+        fs.release();
+    }
+    TEST_CYCLE()
+    {
+        FileStorage fs(file_name, cv::FileStorage::READ);
+        fs[key] >> dst;
+        fs.release();
+    }
+
+    remove(file_name.c_str());
+    SANITY_CHECK_NOTHING();
+}
+
 } // namespace
@@ -166,4 +166,23 @@ PERF_TEST_P(Size_MatType, Mat_Transform,
     SANITY_CHECK(dst, 1e-6, ERROR_RELATIVE);
 }
 
+PERF_TEST_P(Size_MatType, MatExpr_Fused,
+            testing::Combine(testing::Values(szVGA, sz1080p, sz2160p),
+                             testing::Values(CV_32FC1, CV_32FC3, CV_64FC1))
+             )
+{
+    Size size = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    Mat a(size, type), b(size, type), c(size, type), d(size, type), dst(size, type);
+
+    declare.in(a, b, c, d, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE()
+    {
+        dst = (a - b).mul(c) * 0.5 + d;
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
 } // namespace
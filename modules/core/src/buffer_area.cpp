@@ -4,6 +4,7 @@
 
 #include "opencv2/core/utils/buffer_area.private.hpp"
 #include "opencv2/core/utils/configuration.private.hpp"
+#include "opencv2/core/utils/buffer_pool.private.hpp"
 
 #ifndef OPENCV_ENABLE_MEMORY_SANITIZER
 static bool CV_BUFFER_AREA_OVERRIDE_SAFE_MODE =
@@ -146,7 +147,7 @@ void BufferArea::commit()
         CV_Assert(totalSize > 0);
         CV_Assert(oneBuf == NULL);
         CV_Assert(!blocks.empty());
-        oneBuf = fastMalloc(totalSize);
+        oneBuf = allocateTemporaryBuffer(totalSize);
         void * ptr = oneBuf;
         for(std::vector<Block>::const_iterator i = blocks.begin(); i != blocks.end(); ++i)
         {
@@ -166,7 +167,7 @@ void BufferArea::release()
 #ifndef OPENCV_ENABLE_MEMORY_SANITIZER
     if (oneBuf)
     {
-        fastFree(oneBuf);
+        releaseTemporaryBuffer(oneBuf, totalSize);
         oneBuf = 0;
     }
 #endif
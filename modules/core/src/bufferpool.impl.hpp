@@ -23,6 +23,9 @@ public:
     virtual void freeAllReservedBuffers() CV_OVERRIDE { }
 };
 
+/** Controller of the CPU buffer pool for temporary buffers (see utils::allocateTemporaryBuffer()) */
+BufferPoolController* getTemporaryBufferPoolController();
+
 } // namespace
 
 #endif // __OPENCV_CORE_BUFFER_POOL_IMPL_HPP__
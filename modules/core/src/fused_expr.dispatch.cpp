@@ -0,0 +1,260 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+
+#include "precomp.hpp"
+#include "fused_expr.hpp"
+#include <opencv2/core/utils/buffer_pool.private.hpp>
+
+#include "fused_expr.simd.hpp"
+#include "fused_expr.simd_declarations.hpp" // defines CV_CPU_DISPATCH_MODES_ALL=AVX2,...,BASELINE based on CMakeLists.txt content
+
+namespace cv {
+
+FusedExprOpFunc getFusedExprOpFunc(int op, int depth)
+{
+    CV_INSTRUMENT_REGION();
+    CV_CPU_DISPATCH(getFusedExprOpFunc, (op, depth),
+        CV_CPU_DISPATCH_MODES_ALL);
+}
+
+int FusedExprProgram::load(const Mat& m)
+{
+    CV_DbgAssert(m.type() == type);
+    for (size_t i = 0; i < code.size(); i++)
+    {
+        const FusedExprInstr& instr = code[i];
+        if (instr.op != FUSED_OP_LOAD)
+            continue;
+        const Mat& o = operands[instr.operand];
+        if (o.data && o.data == m.data && o.step == m.step)  // the same array is used several times
+            return (int)i;
+    }
+    operands.push_back(m);
+    int r = emit(FUSED_OP_LOAD, -1);
+    code[r].operand = (int)operands.size() - 1;
+    return r;
+}
+
+int FusedExprProgram::constant(const Scalar& s)
+{
+    int r = emit(FUSED_OP_CONST, -1);
+    code[r].s = s;
+    return r;
+}
+
+int FusedExprProgram::emit(int op, int src1, int src2, double p0, double p1, double p2)
+{
+    CV_DbgAssert(src1 < (int)code.size() && src2 < (int)code.size());
+    FusedExprInstr instr;
+    instr.op = op;
+    instr.src1 = src1;
+    instr.src2 = src2;
+    instr.operand = -1;
+    instr.p[0] = p0;
+    instr.p[1] = p1;
+    instr.p[2] = p2;
+    code.push_back(instr);
+    return (int)code.size() - 1;
+}
+
+int FusedExprProgram::append(const FusedExprProgram& other)
+{
+    CV_Assert(other.type == type);
+    std::vector<int> remap(other.code.size(), -1);
+    for (size_t i = 0; i < other.code.size(); i++)
+    {
+        const FusedExprInstr& instr = other.code[i];
+        if (instr.op == FUSED_OP_LOAD)
+            remap[i] = load(other.operands[instr.operand]);
+        else
+        {
+            FusedExprInstr copy = instr;
+            copy.src1 = instr.src1 >= 0 ? remap[instr.src1] : -1;
+            copy.src2 = instr.src2 >= 0 ? remap[instr.src2] : -1;
+            code.push_back(copy);
+            remap[i] = (int)code.size() - 1;
+        }
+    }
+    return remap.back();
+}
+
+
+namespace {
+
+/** Number of elements processed by a single pass of the program. Registers are kept in L1 cache */
+static const int FUSED_EXPR_BLOCK_SIZE = 1024;
+
+class FusedExprInvoker CV_FINAL : public ParallelLoopBody
+{
+public:
+    FusedExprInvoker(const FusedExprProgram& prog_, Mat& dst_, bool continuous)
+        : prog(prog_), dst(dst_)
+    {
+        const int cn = CV_MAT_CN(prog.type);
+        wdepth = CV_MAT_DEPTH(prog.type);
+        wsize = CV_ELEM_SIZE1(prog.type);
+        if (continuous)
+        {
+            rows = 1;
+            width = dst.total() * cn;
+        }
+        else
+        {
+            CV_Assert(dst.dims <= 2);
+            rows = dst.rows;
+            width = (size_t)dst.cols * cn;
+        }
+        blockLen = std::max(1, FUSED_EXPR_BLOCK_SIZE / cn) * cn;  // blocks start from the first channel
+        nblocks = (width + blockLen - 1) / blockLen;
+
+        const size_t ncode = prog.code.size();
+        const int res = prog.result();
+        directStore = dst.depth() == wdepth && prog.code[res].op != FUSED_OP_LOAD && prog.code[res].op != FUSED_OP_CONST;
+        cvtFunc = directStore ? NULL : getConvertFunc(wdepth, dst.depth());
+        CV_Assert(directStore || cvtFunc);
+
+        // assign scratch buffers to registers: buffer is reused after the last use of the register
+        std::vector<int> lastUse(ncode, -1);
+        for (size_t i = 0; i < ncode; i++)
+        {
+            const FusedExprInstr& instr = prog.code[i];
+            if (instr.src1 >= 0)
+                lastUse[instr.src1] = (int)i;
+            if (instr.src2 >= 0)
+                lastUse[instr.src2] = (int)i;
+        }
+        funcs.resize(ncode, NULL);
+        slots.resize(ncode, -1);
+        nslots = 0;
+        std::vector<int> freeSlots;
+        for (size_t i = 0; i < ncode; i++)
+        {
+            const FusedExprInstr& instr = prog.code[i];
+            if (instr.op != FUSED_OP_LOAD && instr.op != FUSED_OP_CONST)
+                funcs[i] = getFusedExprOpFunc(instr.op, wdepth);
+            if (instr.op == FUSED_OP_LOAD || ((int)i == res && directStore))
+                continue;  // result is stored into destination directly
+            if (instr.op == FUSED_OP_CONST)
+            {
+                slots[i] = nslots++;  // constants are filled once per stripe, their buffers are not shared
+                continue;
+            }
+            if (!freeSlots.empty())
+            {
+                slots[i] = freeSlots.back();
+                freeSlots.pop_back();
+            }
+            else
+                slots[i] = nslots++;
+            const int src[] = { instr.src1, instr.src2 };
+            for (int k = 0; k < 2; k++)
+            {
+                int r = src[k];
+                if (r >= 0 && lastUse[r] == (int)i && slots[r] >= 0 && prog.code[r].op != FUSED_OP_CONST &&
+                    (k == 0 || src[0] != src[1]))
+                    freeSlots.push_back(slots[r]);
+            }
+        }
+    }
+
+    size_t totalBlocks() const { return rows * nblocks; }
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        const size_t ncode = prog.code.size();
+        const int res = prog.result();
+        const size_t blockBytes = alignSize(blockLen * wsize, CV_MALLOC_ALIGN);
+        utils::PooledAutoBuffer<uchar> scratch(nslots * blockBytes + CV_MALLOC_ALIGN);
+        uchar* buf = alignPtr(scratch.data(), CV_MALLOC_ALIGN);
+        AutoBuffer<const uchar*, 64> regs(ncode);
+
+        for (size_t i = 0; i < ncode; i++)
+        {
+            const FusedExprInstr& instr = prog.code[i];
+            if (instr.op != FUSED_OP_CONST)
+                continue;
+            uchar* data = buf + slots[i] * blockBytes;
+            const int cn = CV_MAT_CN(prog.type);
+            for (int j = 0; j < blockLen; j++)
+            {
+                if (wdepth == CV_32F)
+                    ((float*)data)[j] = (float)instr.s[j % cn];
+                else
+                    ((double*)data)[j] = instr.s[j % cn];
+            }
+            regs[i] = data;
+        }
+
+        for (int item = range.start; item < range.end; item++)
+        {
+            const size_t y = item / nblocks, offset = (item - y * nblocks) * blockLen;
+            const int len = (int)std::min((size_t)blockLen, width - offset);
+            uchar* dptr = (rows == 1 ? dst.data : dst.ptr((int)y)) + offset * dst.elemSize1();
+            for (size_t i = 0; i < ncode; i++)
+            {
+                const FusedExprInstr& instr = prog.code[i];
+                if (instr.op == FUSED_OP_LOAD)
+                {
+                    const Mat& m = prog.operands[instr.operand];
+                    regs[i] = (rows == 1 ? m.data : m.ptr((int)y)) + offset * wsize;
+                }
+                else if (instr.op != FUSED_OP_CONST)
+                {
+                    uchar* out = slots[i] >= 0 ? buf + slots[i] * blockBytes : dptr;
+                    funcs[i](regs[instr.src1], instr.src2 >= 0 ? regs[instr.src2] : NULL, out, len, instr.p);
+                    regs[i] = out;
+                }
+            }
+            if (!directStore)
+                cvtFunc(regs[res], 0, 0, 0, dptr, 0, Size(len, 1), 0);
+        }
+    }
+
+protected:
+    const FusedExprProgram& prog;
+    Mat& dst;
+    int wdepth;
+    size_t wsize;
+    size_t rows, width, nblocks;
+    int blockLen;
+    bool directStore;
+    BinaryFunc cvtFunc;
+    std::vector<FusedExprOpFunc> funcs;
+    std::vector<int> slots;
+    int nslots;
+};
+
+} // namespace
+
+void FusedExprProgram::run(Mat& dst, int ddepth) const
+{
+    CV_INSTRUMENT_REGION();
+
+    CV_Assert(!operands.empty() && !code.empty());
+    const Mat& src0 = operands[0];
+    dst.create(src0.dims, src0.size.p, CV_MAKETYPE(ddepth, CV_MAT_CN(type)));
+
+    bool continuous = dst.isContinuous();
+    for (size_t i = 0; continuous && i < operands.size(); i++)
+        continuous = operands[i].isContinuous();
+    if (!continuous && dst.dims > 2)
+    {
+        // operands of n-dimensional expressions are continuous (see MatOp_Fused), the destination is a sub-array
+        Mat temp;
+        run(temp, ddepth);
+        temp.copyTo(dst);
+        return;
+    }
+
+    FusedExprInvoker invoker(*this, dst, continuous);
+    const size_t total = invoker.totalBlocks();
+    if (total == 0)
+        return;
+    CV_Assert(total <= (size_t)INT_MAX);
+    const double nstripes = (double)(total * FUSED_EXPR_BLOCK_SIZE) / (1 << 16);
+    parallel_for_(Range(0, (int)total), invoker, nstripes);
+}
+
+} // namespace
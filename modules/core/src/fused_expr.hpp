@@ -0,0 +1,77 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+#ifndef OPENCV_CORE_SRC_FUSED_EXPR_HPP
+#define OPENCV_CORE_SRC_FUSED_EXPR_HPP
+
+namespace cv {
+
+/** Operations of fused elementwise expressions (see MatOp_Fused).
+
+Registers are numbered by instructions: result of instruction `i` is register `i`.
+*/
+enum FusedExprOpcode
+{
+    FUSED_OP_LOAD = 0,   //!< r = operands[operand]
+    FUSED_OP_CONST,      //!< r = s (per-channel values)
+    FUSED_OP_ADD,        //!< r = r1 + r2
+    FUSED_OP_SUB,        //!< r = r1 - r2
+    FUSED_OP_SCALE,      //!< r = r1*p[0] + p[1]
+    FUSED_OP_ADDW,       //!< r = r1*p[0] + r2*p[1] + p[2]
+    FUSED_OP_MUL,        //!< r = r1*r2*p[0]
+    FUSED_OP_DIV,        //!< r = r1*p[0]/r2
+    FUSED_OP_RECIP,      //!< r = p[0]/r1
+    FUSED_OP_MIN,        //!< r = min(r1, r2)
+    FUSED_OP_MAX,        //!< r = max(r1, r2)
+    FUSED_OP_ABSDIFF,    //!< r = |r1 - r2|
+    FUSED_OP_COUNT
+};
+
+struct FusedExprInstr
+{
+    int op;
+    int src1, src2;
+    int operand;
+    double p[3];
+    Scalar s;
+};
+
+/** @brief Processes `len` elements: dst = op(src1, src2)
+Data type of all buffers is the working type of the expression (CV_32F or CV_64F).
+*/
+typedef void (*FusedExprOpFunc)(const uchar* src1, const uchar* src2, uchar* dst, int len, const double* p);
+
+FusedExprOpFunc getFusedExprOpFunc(int op, int depth);
+
+/** @brief Program of fused elementwise expression
+
+All operands have the same size and type (CV_32F or CV_64F with 1-4 channels), computations are performed in this type.
+Program is immutable after construction (it is shared between copies of MatExpr objects).
+*/
+class FusedExprProgram
+{
+public:
+    FusedExprProgram() : type(-1) {}
+
+    enum { MAX_INSTRUCTIONS = 64 };
+
+    int type;
+    std::vector<Mat> operands;
+    std::vector<FusedExprInstr> code;  // the last instruction computes the result
+
+    int result() const { return (int)code.size() - 1; }
+
+    int load(const Mat& m);
+    int constant(const Scalar& s);
+    int emit(int op, int src1, int src2 = -1, double p0 = 0, double p1 = 0, double p2 = 0);
+    /** Appends code of another program, returns register with its result */
+    int append(const FusedExprProgram& other);
+
+    /** Evaluates expression into `dst` with depth `ddepth` (saturated conversion of results) */
+    void run(Mat& dst, int ddepth) const;
+};
+
+} // namespace
+
+#endif // OPENCV_CORE_SRC_FUSED_EXPR_HPP
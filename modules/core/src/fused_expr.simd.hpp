@@ -0,0 +1,200 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+#include "precomp.hpp"
+#include "fused_expr.hpp"
+
+namespace cv {
+
+CV_CPU_OPTIMIZATION_NAMESPACE_BEGIN
+
+FusedExprOpFunc getFusedExprOpFunc(int op, int depth);
+
+
+#ifndef CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
+
+namespace {
+
+template<typename T> struct FusedVec { enum { enabled = 0 }; };
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+template<> struct FusedVec<float> { typedef v_float32 type; enum { enabled = 1 }; };
+#endif
+#if (CV_SIMD_64F || CV_SIMD_SCALABLE_64F)
+template<> struct FusedVec<double> { typedef v_float64 type; enum { enabled = 1 }; };
+#endif
+
+template<typename T, class Op, bool simd = FusedVec<T>::enabled>
+struct FusedLoop
+{
+    static void binary(const T* src1, const T* src2, T* dst, int len, const Op& op)
+    {
+        for (int i = 0; i < len; i++)
+            dst[i] = op(src1[i], src2[i]);
+    }
+
+    static void unary(const T* src, T* dst, int len, const Op& op)
+    {
+        for (int i = 0; i < len; i++)
+            dst[i] = op(src[i]);
+    }
+};
+
+template<typename T, class Op>
+struct FusedLoop<T, Op, true>
+{
+    typedef typename FusedVec<T>::type V;
+
+    static void binary(const T* src1, const T* src2, T* dst, int len, const Op& op)
+    {
+        const int VECSZ = VTraits<V>::vlanes();
+        int i = 0;
+        for (; i <= len - 2*VECSZ; i += 2*VECSZ)
+        {
+            V r0 = op(vx_load(src1 + i), vx_load(src2 + i));
+            V r1 = op(vx_load(src1 + i + VECSZ), vx_load(src2 + i + VECSZ));
+            v_store(dst + i, r0);
+            v_store(dst + i + VECSZ, r1);
+        }
+        for (; i <= len - VECSZ; i += VECSZ)
+            v_store(dst + i, op(vx_load(src1 + i), vx_load(src2 + i)));
+        for (; i < len; i++)
+            dst[i] = op(src1[i], src2[i]);
+    }
+
+    static void unary(const T* src, T* dst, int len, const Op& op)
+    {
+        const int VECSZ = VTraits<V>::vlanes();
+        int i = 0;
+        for (; i <= len - 2*VECSZ; i += 2*VECSZ)
+        {
+            V r0 = op(vx_load(src + i));
+            V r1 = op(vx_load(src + i + VECSZ));
+            v_store(dst + i, r0);
+            v_store(dst + i + VECSZ, r1);
+        }
+        for (; i <= len - VECSZ; i += VECSZ)
+            v_store(dst + i, op(vx_load(src + i)));
+        for (; i < len; i++)
+            dst[i] = op(src[i]);
+    }
+};
+
+template<typename T> struct FusedOpAdd
+{
+    explicit FusedOpAdd(const double*) {}
+    T operator()(T a, T b) const { return a + b; }
+    template<typename V> V operator()(const V& a, const V& b) const { return v_add(a, b); }
+};
+
+template<typename T> struct FusedOpSub
+{
+    explicit FusedOpSub(const double*) {}
+    T operator()(T a, T b) const { return a - b; }
+    template<typename V> V operator()(const V& a, const V& b) const { return v_sub(a, b); }
+};
+
+template<typename T> struct FusedOpScale
+{
+    explicit FusedOpScale(const double* p) : alpha((T)p[0]), beta((T)p[1]) {}
+    T operator()(T a) const { return a*alpha + beta; }
+    template<typename V> V operator()(const V& a) const { return v_fma(a, v_setall_<V>(alpha), v_setall_<V>(beta)); }
+    T alpha, beta;
+};
+
+template<typename T> struct FusedOpAddWeighted
+{
+    explicit FusedOpAddWeighted(const double* p) : alpha((T)p[0]), beta((T)p[1]), gamma((T)p[2]) {}
+    T operator()(T a, T b) const { return a*alpha + b*beta + gamma; }
+    template<typename V> V operator()(const V& a, const V& b) const
+    {
+        return v_fma(a, v_setall_<V>(alpha), v_fma(b, v_setall_<V>(beta), v_setall_<V>(gamma)));
+    }
+    T alpha, beta, gamma;
+};
+
+template<typename T> struct FusedOpMul
+{
+    explicit FusedOpMul(const double* p) : scale((T)p[0]) {}
+    T operator()(T a, T b) const { return a*b*scale; }
+    template<typename V> V operator()(const V& a, const V& b) const { return v_mul(v_mul(a, b), v_setall_<V>(scale)); }
+    T scale;
+};
+
+template<typename T> struct FusedOpDiv
+{
+    explicit FusedOpDiv(const double* p) : scale((T)p[0]) {}
+    T operator()(T a, T b) const { return a*scale/b; }
+    template<typename V> V operator()(const V& a, const V& b) const { return v_div(v_mul(a, v_setall_<V>(scale)), b); }
+    T scale;
+};
+
+template<typename T> struct FusedOpRecip
+{
+    explicit FusedOpRecip(const double* p) : scale((T)p[0]) {}
+    T operator()(T a) const { return scale/a; }
+    template<typename V> V operator()(const V& a) const { return v_div(v_setall_<V>(scale), a); }
+    T scale;
+};
+
+template<typename T> struct FusedOpMin
+{
+    explicit FusedOpMin(const double*) {}
+    T operator()(T a, T b) const { return std::min(a, b); }
+    template<typename V> V operator()(const V& a, const V& b) const { return v_min(a, b); }
+};
+
+template<typename T> struct FusedOpMax
+{
+    explicit FusedOpMax(const double*) {}
+    T operator()(T a, T b) const { return std::max(a, b); }
+    template<typename V> V operator()(const V& a, const V& b) const { return v_max(a, b); }
+};
+
+template<typename T> struct FusedOpAbsDiff
+{
+    explicit FusedOpAbsDiff(const double*) {}
+    T operator()(T a, T b) const { return std::abs(a - b); }
+    template<typename V> V operator()(const V& a, const V& b) const { return v_absdiff(a, b); }
+};
+
+template<typename T, template<typename> class Op>
+static void fusedBinary(const uchar* src1, const uchar* src2, uchar* dst, int len, const double* p)
+{
+    FusedLoop<T, Op<T> >::binary((const T*)src1, (const T*)src2, (T*)dst, len, Op<T>(p));
+}
+
+template<typename T, template<typename> class Op>
+static void fusedUnary(const uchar* src1, const uchar*, uchar* dst, int len, const double* p)
+{
+    FusedLoop<T, Op<T> >::unary((const T*)src1, (T*)dst, len, Op<T>(p));
+}
+
+} // namespace
+
+FusedExprOpFunc getFusedExprOpFunc(int op, int depth)
+{
+    static FusedExprOpFunc tab[FUSED_OP_COUNT][2] =
+    {
+        { 0, 0 },  // FUSED_OP_LOAD
+        { 0, 0 },  // FUSED_OP_CONST
+        { fusedBinary<float, FusedOpAdd>, fusedBinary<double, FusedOpAdd> },
+        { fusedBinary<float, FusedOpSub>, fusedBinary<double, FusedOpSub> },
+        { fusedUnary<float, FusedOpScale>, fusedUnary<double, FusedOpScale> },
+        { fusedBinary<float, FusedOpAddWeighted>, fusedBinary<double, FusedOpAddWeighted> },
+        { fusedBinary<float, FusedOpMul>, fusedBinary<double, FusedOpMul> },
+        { fusedBinary<float, FusedOpDiv>, fusedBinary<double, FusedOpDiv> },
+        { fusedUnary<float, FusedOpRecip>, fusedUnary<double, FusedOpRecip> },
+        { fusedBinary<float, FusedOpMin>, fusedBinary<double, FusedOpMin> },
+        { fusedBinary<float, FusedOpMax>, fusedBinary<double, FusedOpMax> },
+        { fusedBinary<float, FusedOpAbsDiff>, fusedBinary<double, FusedOpAbsDiff> }
+    };
+    CV_Assert(0 <= op && op < FUSED_OP_COUNT);
+    CV_Assert(depth == CV_32F || depth == CV_64F);
+    return tab[op][depth == CV_64F ? 1 : 0];
+}
+
+#endif // CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
+
+CV_CPU_OPTIMIZATION_NAMESPACE_END
+} // namespace
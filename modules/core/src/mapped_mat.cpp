@@ -0,0 +1,422 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+
+#include <opencv2/core/utils/mapped_mat.hpp>
+#include "persistence.hpp"
+
+#include <fstream>
+
+#if defined _WIN32 && !defined WINRT
+#define OPENCV_MAPPED_MAT_WIN32 1
+#define WIN32_LEAN_AND_MEAN
+#undef NOMINMAX
+#define NOMINMAX
+#include <windows.h>
+#elif defined __linux__ || defined __APPLE__ || defined __FreeBSD__ || defined __NetBSD__ || defined __OpenBSD__ || \
+      defined __DragonFly__ || defined __HAIKU__ || defined __GNU__ || defined __QNX__
+#define OPENCV_MAPPED_MAT_POSIX 1
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#if !defined __ANDROID__
+#define OPENCV_MAPPED_MAT_SHM 1
+#endif
+#endif
+
+namespace cv { namespace utils {
+
+namespace {
+
+/** Mapped view of the file or shared memory segment. It is owned by UMatData (see MappedMatAllocator) */
+struct MappedRegion
+{
+    void* addr;
+    size_t length;
+};
+
+static void unmapRegion(const MappedRegion& region)
+{
+#if defined OPENCV_MAPPED_MAT_WIN32
+    UnmapViewOfFile(region.addr);
+#elif defined OPENCV_MAPPED_MAT_POSIX
+    munmap(region.addr, region.length);
+#else
+    CV_UNUSED(region);
+#endif
+}
+
+/** Allocator of UMatData for memory-mapped arrays: the mapping is released with the last reference on the data.
+New arrays (like Mat::create() results) are not mapped, they are allocated by the standard allocator. */
+class MappedMatAllocator CV_FINAL : public MatAllocator
+{
+public:
+    UMatData* allocate(int dims, const int* sizes, int type,
+                       void* data0, size_t* step, AccessFlag flags, UMatUsageFlags usageFlags) const CV_OVERRIDE
+    {
+        return Mat::getStdAllocator()->allocate(dims, sizes, type, data0, step, flags, usageFlags);
+    }
+
+    bool allocate(UMatData* u, AccessFlag /*accessFlags*/, UMatUsageFlags /*usageFlags*/) const CV_OVERRIDE
+    {
+        return u != NULL;
+    }
+
+    void deallocate(UMatData* u) const CV_OVERRIDE
+    {
+        if (!u)
+            return;
+
+        CV_Assert(u->urefcount == 0);
+        CV_Assert(u->refcount == 0);
+        MappedRegion* region = (MappedRegion*)u->userdata;
+        if (region)
+        {
+            unmapRegion(*region);
+            delete region;
+        }
+        delete u;
+    }
+};
+
+static MatAllocator* getMappedMatAllocator()
+{
+    CV_SINGLETON_LAZY_INIT(MatAllocator, new MappedMatAllocator())
+}
+
+static size_t arraySize(const std::vector<int>& sizes, int type)
+{
+    CV_Assert(!sizes.empty() && sizes.size() <= (size_t)CV_MAX_DIM);
+    size_t total = CV_ELEM_SIZE(type);
+    for (size_t i = 0; i < sizes.size(); i++)
+    {
+        CV_CheckGE(sizes[i], 0, "Invalid array size");
+        CV_Assert(sizes[i] == 0 || total <= std::numeric_limits<size_t>::max() / (size_t)sizes[i]);
+        total *= (size_t)sizes[i];
+    }
+    return total;
+}
+
+/** Creates Mat header which owns the mapped region */
+static Mat makeMappedMat(const MappedRegion& region, size_t offset, const std::vector<int>& sizes, int type)
+{
+    MappedRegion* r = new MappedRegion(region);
+    UMatData* u = NULL;
+    try
+    {
+        uchar* data = (uchar*)region.addr + offset;
+        Mat m(sizes, type, data);
+        u = new UMatData(getMappedMatAllocator());
+        u->data = u->origdata = data;
+        u->size = m.total() * m.elemSize();
+        u->userdata = r;
+        u->refcount = 1;
+        m.u = u;
+        return m;
+    }
+    catch (...)
+    {
+        delete u;
+        unmapRegion(*r);
+        delete r;
+        throw;
+    }
+}
+
+#if defined OPENCV_MAPPED_MAT_POSIX
+
+static String errnoMessage()
+{
+    return String(strerror(errno));
+}
+
+/** Maps `length` bytes from `offset` of the file descriptor. Descriptor is closed (the mapping doesn't need it) */
+static Mat mapDescriptor(int fd, const String& name, size_t offset, const std::vector<int>& sizes, int type, MappedMatMode mode)
+{
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        String msg = errnoMessage();
+        close(fd);
+        CV_Error_(Error::StsError, ("Can't get size of '%s': %s", name.c_str(), msg.c_str()));
+    }
+    const size_t length = arraySize(sizes, type);
+    if (offset > (size_t)st.st_size || length > (size_t)st.st_size - offset)
+    {
+        close(fd);
+        CV_Error_(Error::StsOutOfRange, ("'%s' is too small: %lld bytes, required %lld bytes at offset %lld",
+                  name.c_str(), (long long)st.st_size, (long long)length, (long long)offset));
+    }
+
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    const size_t start = offset - offset % page;
+    MappedRegion region;
+    region.length = length + (offset - start);
+    region.addr = mmap(NULL, region.length, mode == MAPPED_MAT_READ ? PROT_READ : PROT_READ | PROT_WRITE,
+                       mode == MAPPED_MAT_COPY_ON_WRITE ? MAP_PRIVATE : MAP_SHARED, fd, (off_t)start);
+    String msg = region.addr == MAP_FAILED ? errnoMessage() : String();
+    close(fd);
+    if (region.addr == MAP_FAILED)
+        CV_Error_(Error::StsError, ("Can't map '%s': %s", name.c_str(), msg.c_str()));
+    return makeMappedMat(region, offset - start, sizes, type);
+}
+
+#elif defined OPENCV_MAPPED_MAT_WIN32
+
+/** Maps the view of file mapping object, the handle is closed (the view keeps the object alive) */
+static Mat mapView(HANDLE mapping, const String& name, size_t offset, const std::vector<int>& sizes, int type, MappedMatMode mode)
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    const size_t granularity = info.dwAllocationGranularity;
+    const size_t start = offset - offset % granularity;
+    MappedRegion region;
+    region.length = arraySize(sizes, type) + (offset - start);
+    DWORD access = mode == MAPPED_MAT_READ ? FILE_MAP_READ : mode == MAPPED_MAT_READ_WRITE ? FILE_MAP_WRITE : FILE_MAP_COPY;
+    region.addr = MapViewOfFile(mapping, access, (DWORD)((uint64)start >> 32), (DWORD)(start & 0xffffffff), region.length);
+    DWORD err = GetLastError();
+    CloseHandle(mapping);
+    if (!region.addr)
+        CV_Error_(Error::StsError, ("Can't map '%s': error %u", name.c_str(), (unsigned)err));
+    return makeMappedMat(region, offset - start, sizes, type);
+}
+
+#endif
+
+/** Returns OpenCV depth of NumPy type descriptor (like '<f4') or -1 if the type is not supported */
+static int npyDepth(const std::string& descr)
+{
+    if (descr.size() < 3)
+        return -1;
+    const int one = 1;
+    const bool littleEndian = *(const uchar*)&one == 1;
+    const char order = descr[0], kind = descr[1];
+    const int size = atoi(descr.c_str() + 2);
+    if (size > 1 && !(order == '=' || (order == '<' && littleEndian) || (order == '>' && !littleEndian)))
+        return -1;  // byte swapping would require a copy
+    switch (kind)
+    {
+    case 'b': return size == 1 ? CV_8U : -1;
+    case 'u': return size == 1 ? CV_8U : size == 2 ? CV_16U : -1;
+    case 'i': return size == 1 ? CV_8S : size == 2 ? CV_16S : size == 4 ? CV_32S : -1;
+    case 'f': return size == 2 ? CV_16F : size == 4 ? CV_32F : size == 8 ? CV_64F : -1;
+    default: return -1;
+    }
+}
+
+/** Returns value of the key from the header dictionary: "{'descr': '<f4', 'fortran_order': False, 'shape': (3, 4), }" */
+static std::string npyHeaderValue(const std::string& header, const char* key, const String& filename)
+{
+    size_t pos = header.find(std::string("'") + key + "'");
+    if (pos == std::string::npos)
+        pos = header.find(std::string("\"") + key + "\"");
+    if (pos != std::string::npos)
+        pos = header.find(':', pos);
+    if (pos == std::string::npos)
+        CV_Error_(Error::StsParseError, ("'%s': '%s' is not found in .npy header", filename.c_str(), key));
+    pos = header.find_first_not_of(" ", pos + 1);
+    size_t end = std::string::npos;
+    if (pos != std::string::npos)
+    {
+        char c = header[pos];
+        if (c == '\'' || c == '"')
+        {
+            end = header.find(c, pos + 1);
+            pos++;
+        }
+        else if (c == '(')
+            end = header.find(')', pos) + (header.find(')', pos) != std::string::npos ? 1 : 0);
+        else
+            end = header.find_first_of(",}", pos);
+    }
+    if (pos == std::string::npos || end == std::string::npos)
+        CV_Error_(Error::StsParseError, ("'%s': invalid value of '%s' in .npy header", filename.c_str(), key));
+    return header.substr(pos, end - pos);
+}
+
+} // namespace
+
+
+Mat mapMatFile(const String& filename, const std::vector<int>& sizes, int type, size_t offset, MappedMatMode mode)
+{
+    CV_INSTRUMENT_REGION();
+
+    if (arraySize(sizes, type) == 0)
+        return Mat(sizes, type);
+
+#if defined OPENCV_MAPPED_MAT_POSIX
+    int fd = open(filename.c_str(), mode == MAPPED_MAT_READ_WRITE ? O_RDWR : O_RDONLY);
+    if (fd < 0)
+        CV_Error_(Error::StsError, ("Can't open file '%s': %s", filename.c_str(), errnoMessage().c_str()));
+    return mapDescriptor(fd, filename, offset, sizes, type, mode);
+#elif defined OPENCV_MAPPED_MAT_WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ | (mode == MAPPED_MAT_READ_WRITE ? GENERIC_WRITE : 0),
+                              FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        CV_Error_(Error::StsError, ("Can't open file '%s': error %u", filename.c_str(), (unsigned)GetLastError()));
+    LARGE_INTEGER fileSize;
+    const size_t length = arraySize(sizes, type);
+    if (!GetFileSizeEx(file, &fileSize) || offset > (uint64)fileSize.QuadPart || length > (uint64)fileSize.QuadPart - offset)
+    {
+        CloseHandle(file);
+        CV_Error_(Error::StsOutOfRange, ("'%s' is too small: required %lld bytes at offset %lld",
+                  filename.c_str(), (long long)length, (long long)offset));
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, mode == MAPPED_MAT_READ ? PAGE_READONLY :
+                                        mode == MAPPED_MAT_READ_WRITE ? PAGE_READWRITE : PAGE_WRITECOPY, 0, 0, NULL);
+    DWORD err = GetLastError();
+    CloseHandle(file);
+    if (!mapping)
+        CV_Error_(Error::StsError, ("Can't map '%s': error %u", filename.c_str(), (unsigned)err));
+    return mapView(mapping, filename, offset, sizes, type, mode);
+#else
+    CV_UNUSED(filename); CV_UNUSED(offset); CV_UNUSED(mode);
+    CV_Error(Error::StsNotImplemented, "Memory-mapped files are not supported on this platform");
+#endif
+}
+
+Mat mapNpyFile(const String& filename, MappedMatMode mode)
+{
+    CV_INSTRUMENT_REGION();
+
+    std::ifstream f(filename.c_str(), std::ios::binary);
+    if (!f.is_open())
+        CV_Error_(Error::StsError, ("Can't open file '%s'", filename.c_str()));
+    uchar prefix[12] = {0};
+    f.read((char*)prefix, sizeof(prefix));
+    if (!f || memcmp(prefix, "\x93NUMPY", 6) != 0)
+        CV_Error_(Error::StsParseError, ("'%s' is not a .npy file", filename.c_str()));
+    const int major = prefix[6];
+    size_t headerStart = 0, headerLength = 0;
+    if (major == 1)
+    {
+        headerStart = 10;
+        headerLength = prefix[8] | (prefix[9] << 8);
+    }
+    else if (major == 2 || major == 3)
+    {
+        headerStart = 12;
+        headerLength = prefix[8] | (prefix[9] << 8) | (prefix[10] << 16) | ((size_t)prefix[11] << 24);
+    }
+    else
+        CV_Error_(Error::StsParseError, ("'%s': unsupported .npy format version %d", filename.c_str(), major));
+
+    std::string header(headerLength, ' ');
+    f.seekg((std::streamoff)headerStart);
+    f.read(&header[0], (std::streamsize)headerLength);
+    if (!f)
+        CV_Error_(Error::StsParseError, ("'%s': truncated .npy header", filename.c_str()));
+    f.close();
+
+    const std::string descr = npyHeaderValue(header, "descr", filename);
+    const int depth = npyDepth(descr);
+    if (depth < 0)
+        CV_Error_(Error::StsNotImplemented, ("'%s': unsupported .npy data type '%s'", filename.c_str(), descr.c_str()));
+    if (npyHeaderValue(header, "fortran_order", filename) != "False")
+        CV_Error_(Error::StsNotImplemented, ("'%s': arrays in Fortran order are not supported", filename.c_str()));
+
+    const std::string shape = npyHeaderValue(header, "shape", filename);
+    std::vector<int> sizes;
+    for (size_t pos = 1; pos < shape.size(); )
+    {
+        pos = shape.find_first_of("0123456789", pos);
+        if (pos == std::string::npos)
+            break;
+        const long long dim = atoll(shape.c_str() + pos);
+        if (dim > INT_MAX)
+            CV_Error_(Error::StsOutOfRange, ("'%s': array dimension %lld is too large", filename.c_str(), dim));
+        sizes.push_back((int)dim);
+        pos = shape.find_first_not_of("0123456789", pos);
+    }
+    if (sizes.empty())
+        sizes.push_back(1);  // 0D array
+
+    return mapMatFile(filename, sizes, depth, headerStart + headerLength, mode);
+}
+
+Mat mapStorageMat(const String& filename, const String& name, MappedMatMode mode)
+{
+    CV_INSTRUMENT_REGION();
+
+    std::vector<int> sizes;
+    int type = -1;
+    size_t offset = 0;
+    if (!findBinaryStorageMat(filename, name, sizes, type, offset))
+        CV_Error_(Error::StsObjectNotFound, ("'%s': top-level node '%s' is not found", filename.c_str(), name.c_str()));
+    return mapMatFile(filename, sizes, type, offset, mode);
+}
+
+Mat createSharedMemoryMat(const String& name, const std::vector<int>& sizes, int type)
+{
+    CV_INSTRUMENT_REGION();
+
+    const size_t length = arraySize(sizes, type);
+    CV_CheckGT(length, (size_t)0, "Shared memory segment can't be empty");
+#if defined OPENCV_MAPPED_MAT_SHM
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+        CV_Error_(Error::StsError, ("Can't create shared memory segment '%s': %s", name.c_str(), errnoMessage().c_str()));
+    if (ftruncate(fd, (off_t)length) != 0)
+    {
+        String msg = errnoMessage();
+        close(fd);
+        shm_unlink(name.c_str());
+        CV_Error_(Error::StsError, ("Can't resize shared memory segment '%s': %s", name.c_str(), msg.c_str()));
+    }
+    return mapDescriptor(fd, name, 0, sizes, type, MAPPED_MAT_READ_WRITE);
+#elif defined OPENCV_MAPPED_MAT_WIN32
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                        (DWORD)((uint64)length >> 32), (DWORD)(length & 0xffffffff), name.c_str());
+    DWORD err = GetLastError();
+    if (mapping && err == ERROR_ALREADY_EXISTS)
+    {
+        CloseHandle(mapping);
+        mapping = NULL;
+    }
+    if (!mapping)
+        CV_Error_(Error::StsError, ("Can't create shared memory segment '%s': error %u", name.c_str(), (unsigned)err));
+    return mapView(mapping, name, 0, sizes, type, MAPPED_MAT_READ_WRITE);
+#else
+    CV_UNUSED(name);
+    CV_Error(Error::StsNotImplemented, "Shared memory is not supported on this platform");
+#endif
+}
+
+Mat mapSharedMemoryMat(const String& name, const std::vector<int>& sizes, int type, MappedMatMode mode)
+{
+    CV_INSTRUMENT_REGION();
+
+    CV_CheckGT(arraySize(sizes, type), (size_t)0, "Shared memory segment can't be empty");
+#if defined OPENCV_MAPPED_MAT_SHM
+    int fd = shm_open(name.c_str(), mode == MAPPED_MAT_READ_WRITE ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0)
+        CV_Error_(Error::StsError, ("Can't open shared memory segment '%s': %s", name.c_str(), errnoMessage().c_str()));
+    return mapDescriptor(fd, name, 0, sizes, type, mode);
+#elif defined OPENCV_MAPPED_MAT_WIN32
+    HANDLE mapping = OpenFileMappingA(mode == MAPPED_MAT_READ ? FILE_MAP_READ :
+                                      mode == MAPPED_MAT_READ_WRITE ? FILE_MAP_WRITE : FILE_MAP_COPY, FALSE, name.c_str());
+    if (!mapping)
+        CV_Error_(Error::StsError, ("Can't open shared memory segment '%s': error %u", name.c_str(), (unsigned)GetLastError()));
+    return mapView(mapping, name, 0, sizes, type, mode);
+#else
+    CV_UNUSED(name); CV_UNUSED(mode);
+    CV_Error(Error::StsNotImplemented, "Shared memory is not supported on this platform");
+#endif
+}
+
+bool removeSharedMemory(const String& name)
+{
+#if defined OPENCV_MAPPED_MAT_SHM
+    return shm_unlink(name.c_str()) == 0;
+#else
+    CV_UNUSED(name);
+    return true;
+#endif
+}
+
+}} // namespace
@@ -4,6 +4,12 @@
 
 #include "precomp.hpp"
 #include "bufferpool.impl.hpp"
+#include "parallel_impl.hpp"
+
+#include "opencv2/core/utils/pool_allocator.hpp"
+#include "opencv2/core/utils/tls.hpp"
+
+#include <atomic>
 
 namespace cv {
 
@@ -145,6 +151,8 @@ public:
             total *= sizes[i];
         }
         uchar* data = data0 ? (uchar*)data0 : (uchar*)fastMalloc(total);
+        if (!data0)
+            parallel_pthreads_first_touch(data, total);  // NUMA locality of large buffers (OPENCV_THREAD_POOL_NUMA)
         UMatData* u = new UMatData(this);
         u->data = u->origdata = data;
         u->size = total;
@@ -174,6 +182,12 @@ public:
         }
         delete u;
     }
+
+    BufferPoolController* getBufferPoolController(const char* id) const CV_OVERRIDE
+    {
+        CV_UNUSED(id);
+        return getTemporaryBufferPoolController();  // pool of temporary buffers of OpenCV functions
+    }
 };
 
 static
@@ -183,8 +197,43 @@ MatAllocator*& getDefaultAllocatorMatRef()
     return g_matAllocator;
 }
 
+static std::atomic<int> g_numThreadMatAllocators(0);  // number of threads with own default allocator
+
+struct ThreadMatAllocator
+{
+    ThreadMatAllocator() : allocator(NULL) {}
+    ~ThreadMatAllocator()
+    {
+        if (allocator)
+            g_numThreadMatAllocators--;
+    }
+    MatAllocator* allocator;
+};
+
+static
+TLSData<ThreadMatAllocator>& getThreadMatAllocatorTLS()
+{
+    CV_SINGLETON_LAZY_INIT_REF(TLSData<ThreadMatAllocator>, new TLSData<ThreadMatAllocator>())
+}
+
+void utils::setThreadDefaultMatAllocator(MatAllocator* allocator)
+{
+    ThreadMatAllocator& data = getThreadMatAllocatorTLS().getRef();
+    if (!data.allocator && allocator)
+        g_numThreadMatAllocators++;
+    else if (data.allocator && !allocator)
+        g_numThreadMatAllocators--;
+    data.allocator = allocator;
+}
+
 MatAllocator* Mat::getDefaultAllocator()
 {
+    if (g_numThreadMatAllocators.load(std::memory_order_relaxed) > 0)
+    {
+        MatAllocator* allocator = getThreadMatAllocatorTLS().getRef().allocator;
+        if (allocator)
+            return allocator;
+    }
     return getDefaultAllocatorMatRef();
 }
 
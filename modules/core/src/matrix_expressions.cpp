@@ -10,6 +10,8 @@
 // */
 
 #include "precomp.hpp"
+#include "fused_expr.hpp"
+#include <opencv2/core/utils/configuration.private.hpp>
 #include <opencv2/core/utils/logger.hpp>
 
 namespace cv
@@ -200,6 +202,25 @@ static MatOp_Initializer* getGlobalMatOpInitializer()
     CV_SINGLETON_LAZY_INIT(MatOp_Initializer, new MatOp_Initializer())
 }
 
+/** Chain of elementwise operations which is evaluated in a single pass without temporary arrays.
+
+Expression keeps the first operand in MatExpr::a (for size() and type()) and the program in MatExpr::c (see fusedProgram()).
+*/
+class MatOp_Fused CV_FINAL : public MatOp
+{
+public:
+    MatOp_Fused() {}
+    virtual ~MatOp_Fused() {}
+
+    bool elementWise(const MatExpr& /*expr*/) const CV_OVERRIDE { return false; }
+    void assign(const MatExpr& expr, Mat& m, int type=-1) const CV_OVERRIDE;
+
+    static bool makeAddEx(MatExpr& res, const MatExpr& e1, const MatExpr* e2, double alpha, double beta, const Scalar& s=Scalar());
+    static bool makeBin(MatExpr& res, char op, const MatExpr& e1, const MatExpr* e2, double scale=1, const Scalar& s=Scalar());
+};
+
+static MatOp_Fused g_MatOp_Fused;
+
 static inline bool isIdentity(const MatExpr& e) { return e.op == &g_MatOp_Identity; }
 static inline bool isAddEx(const MatExpr& e) { return e.op == &g_MatOp_AddEx; }
 static inline bool isScaled(const MatExpr& e) { return isAddEx(e) && (!e.b.data || e.beta == 0) && e.s == Scalar(); }
@@ -212,6 +233,27 @@ static inline bool isSolve(const MatExpr& e) { return e.op == &g_MatOp_Solve; }
 //static inline bool isGEMM(const MatExpr& e) { return e.op == &g_MatOp_GEMM; }
 static inline bool isMatProd(const MatExpr& e) { return e.op == &g_MatOp_GEMM && (!e.c.data || e.beta == 0); }
 static inline bool isInitializer(const MatExpr& e) { return e.op == getGlobalMatOpInitializer(); }
+static inline bool isFused(const MatExpr& e) { return e.op == &g_MatOp_Fused; }
+// operand of add/subtract which is handled by MatOp_AddEx without temporary array
+static inline bool isLinear(const MatExpr& e) { return isIdentity(e) || (isAddEx(e) && (!e.b.data || e.beta == 0)); }
+
+// expression can be evaluated as a part of MatOp_Fused program (without temporary array)
+static bool isFusable(const MatExpr& e)
+{
+    if( isFused(e) || isAddEx(e) )
+        return true;
+    if( e.op != &g_MatOp_Bin )
+        return false;
+    switch( e.flags )
+    {
+    case '*': case '/': case 'm': case 'M': case 'a':
+        return true;
+    case 'n': case 'N':
+        return e.a.channels() == 1;
+    default:
+        return false;  // bitwise operations
+    }
+}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -269,6 +311,12 @@ void MatOp::diag(const MatExpr& expr, int d, MatExpr& e) const
 
 void MatOp::augAssignAdd(const MatExpr& expr, Mat& m) const
 {
+    MatExpr e;
+    if( isFusable(expr) && MatOp_Fused::makeAddEx(e, MatExpr(m), &expr, 1, 1) )
+    {
+        e.op->assign(e, m);
+        return;
+    }
     Mat temp;
     expr.op->assign(expr, temp);
     m += temp;
@@ -277,6 +325,12 @@ void MatOp::augAssignAdd(const MatExpr& expr, Mat& m) const
 
 void MatOp::augAssignSubtract(const MatExpr& expr, Mat& m) const
 {
+    MatExpr e;
+    if( isFusable(expr) && MatOp_Fused::makeAddEx(e, MatExpr(m), &expr, 1, -1) )
+    {
+        e.op->assign(e, m);
+        return;
+    }
     Mat temp;
     expr.op->assign(expr, temp);
     m -= temp;
@@ -293,6 +347,12 @@ void MatOp::augAssignMultiply(const MatExpr& expr, Mat& m) const
 
 void MatOp::augAssignDivide(const MatExpr& expr, Mat& m) const
 {
+    MatExpr e;
+    if( isFusable(expr) && MatOp_Fused::makeBin(e, '/', MatExpr(m), &expr) )
+    {
+        e.op->assign(e, m);
+        return;
+    }
     Mat temp;
     expr.op->assign(expr, temp);
     m /= temp;
@@ -329,6 +389,10 @@ void MatOp::add(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 
     if( this == e2.op )
     {
+        if( ((!isLinear(e1) && isFusable(e1)) || (!isLinear(e2) && isFusable(e2))) &&
+            MatOp_Fused::makeAddEx(res, e1, &e2, 1, 1) )
+            return;
+
         double alpha = 1, beta = 1;
         Scalar s;
         Mat m1, m2;
@@ -360,6 +424,9 @@ void MatOp::add(const MatExpr& expr1, const Scalar& s, MatExpr& res) const
 {
     CV_INSTRUMENT_REGION();
 
+    if( isFusable(expr1) && MatOp_Fused::makeAddEx(res, expr1, NULL, 1, 0, s) )
+        return;
+
     Mat m1;
     expr1.op->assign(expr1, m1);
     MatOp_AddEx::makeExpr(res, m1, Mat(), 1, 0, s);
@@ -372,6 +439,10 @@ void MatOp::subtract(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 
     if( this == e2.op )
     {
+        if( ((!isLinear(e1) && isFusable(e1)) || (!isLinear(e2) && isFusable(e2))) &&
+            MatOp_Fused::makeAddEx(res, e1, &e2, 1, -1) )
+            return;
+
         double alpha = 1, beta = -1;
         Scalar s;
         Mat m1, m2;
@@ -403,6 +474,9 @@ void MatOp::subtract(const Scalar& s, const MatExpr& expr, MatExpr& res) const
 {
     CV_INSTRUMENT_REGION();
 
+    if( isFusable(expr) && MatOp_Fused::makeAddEx(res, expr, NULL, -1, 0, s) )
+        return;
+
     Mat m;
     expr.op->assign(expr, m);
     MatOp_AddEx::makeExpr(res, m, Mat(), -1, 0, s);
@@ -415,6 +489,11 @@ void MatOp::multiply(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double
 
     if( this == e2.op )
     {
+        if( ((!isIdentity(e1) && !isScaled(e1) && !isReciprocal(e1) && isFusable(e1)) ||
+             (!isIdentity(e2) && !isScaled(e2) && !isReciprocal(e2) && isFusable(e2))) &&
+            MatOp_Fused::makeBin(res, '*', e1, &e2, scale) )
+            return;
+
         Mat m1, m2;
 
         if( isReciprocal(e1) )
@@ -466,6 +545,9 @@ void MatOp::multiply(const MatExpr& expr, double s, MatExpr& res) const
 {
     CV_INSTRUMENT_REGION();
 
+    if( isFusable(expr) && MatOp_Fused::makeAddEx(res, expr, NULL, s, 0) )
+        return;
+
     Mat m;
     expr.op->assign(expr, m);
     MatOp_AddEx::makeExpr(res, m, Mat(), s, 0);
@@ -480,6 +562,10 @@ void MatOp::divide(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double sc
     {
         if( isReciprocal(e1) && isReciprocal(e2) )
             MatOp_Bin::makeExpr(res, '/', e2.a, e1.a, e1.alpha/e2.alpha);
+        else if( ((!isIdentity(e1) && !isScaled(e1) && isFusable(e1)) ||
+                  (!isIdentity(e2) && !isScaled(e2) && !isReciprocal(e2) && isFusable(e2))) &&
+                 MatOp_Fused::makeBin(res, '/', e1, &e2, scale) )
+            return;
         else
         {
             Mat m1, m2;
@@ -518,6 +604,9 @@ void MatOp::divide(double s, const MatExpr& expr, MatExpr& res) const
 {
     CV_INSTRUMENT_REGION();
 
+    if( isFusable(expr) && MatOp_Fused::makeBin(res, '/', expr, NULL, s) )
+        return;
+
     Mat m;
     expr.op->assign(expr, m);
     MatOp_Bin::makeExpr(res, '/', m, Mat(), s);
@@ -528,6 +617,9 @@ void MatOp::abs(const MatExpr& expr, MatExpr& res) const
 {
     CV_INSTRUMENT_REGION();
 
+    if( isFusable(expr) && MatOp_Fused::makeBin(res, 'a', expr, NULL) )
+        return;
+
     Mat m;
     expr.op->assign(expr, m);
     MatOp_Bin::makeExpr(res, 'a', m, Mat());
@@ -1714,6 +1806,261 @@ inline void MatOp_Initializer::makeExpr(MatExpr& res, int method, int ndims, con
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/** Allocates FusedExprProgram object instead of the data buffer.
+Program is shared by copies of the expression through reference counter of the Mat header.
+*/
+class FusedExprProgramAllocator CV_FINAL : public MatAllocator
+{
+public:
+    UMatData* allocate(int dims, const int* sizes, int type, void* data0, size_t* step,
+                       AccessFlag /*flags*/, UMatUsageFlags /*usageFlags*/) const CV_OVERRIDE
+    {
+        CV_Assert(!data0);
+        size_t total = CV_ELEM_SIZE(type);
+        for( int i = dims-1; i >= 0; i-- )
+        {
+            if( step )
+                step[i] = total;
+            total *= sizes[i];
+        }
+        UMatData* u = new UMatData(this);
+        u->data = u->origdata = (uchar*)new FusedExprProgram();
+        u->size = total;
+        return u;
+    }
+
+    bool allocate(UMatData* u, AccessFlag /*accessFlags*/, UMatUsageFlags /*usageFlags*/) const CV_OVERRIDE
+    {
+        return u != NULL;
+    }
+
+    void deallocate(UMatData* u) const CV_OVERRIDE
+    {
+        if( !u )
+            return;
+        CV_Assert(u->urefcount == 0);
+        CV_Assert(u->refcount == 0);
+        delete (FusedExprProgram*)u->origdata;
+        delete u;
+    }
+};
+
+static MatAllocator* getFusedExprProgramAllocator()
+{
+    CV_SINGLETON_LAZY_INIT(MatAllocator, new FusedExprProgramAllocator())
+}
+
+static const FusedExprProgram& fusedProgram(const MatExpr& e)
+{
+    CV_DbgAssert(isFused(e) && e.c.data);
+    return *(const FusedExprProgram*)e.c.data;
+}
+
+static bool useFusedExpressions()
+{
+    static bool value = utils::getConfigurationParameterBool("OPENCV_MATEXPR_FUSION", true);
+    return value;
+}
+
+// alpha*r1 + beta*r2 + s, the same handling of scalars as in MatOp_AddEx::assign()
+static int emitAddEx(FusedExprProgram& p, int r1, int r2, double alpha, double beta, const Scalar& s)
+{
+    const int cn = CV_MAT_CN(p.type);
+    bool uniform = true;
+    for( int i = 1; i < cn; i++ )
+        uniform = uniform && s[i] == s[0];
+
+    if( r2 >= 0 )
+    {
+        // addWeighted() adds real scalar to all channels, add() is applied per channel
+        const bool perChannel = !s.isReal() && !uniform;
+        const double gamma = perChannel ? 0 : s[0];
+        int r;
+        if( alpha == 1 && beta == 1 && gamma == 0 )
+            r = p.emit(FUSED_OP_ADD, r1, r2);
+        else if( alpha == 1 && beta == -1 && gamma == 0 )
+            r = p.emit(FUSED_OP_SUB, r1, r2);
+        else if( alpha == -1 && beta == 1 && gamma == 0 )
+            r = p.emit(FUSED_OP_SUB, r2, r1);
+        else
+            r = p.emit(FUSED_OP_ADDW, r1, r2, alpha, beta, gamma);
+        if( perChannel )
+            r = p.emit(FUSED_OP_ADD, r, p.constant(s));
+        return r;
+    }
+
+    // convertTo() adds real scalar to all channels, add()/subtract() are applied per channel
+    if( uniform || (s.isReal() && fabs(alpha) != 1) )
+        return p.emit(FUSED_OP_SCALE, r1, -1, alpha, s[0]);
+    int rs = p.constant(s);
+    if( alpha == 1 )
+        return p.emit(FUSED_OP_ADD, r1, rs);
+    if( alpha == -1 )
+        return p.emit(FUSED_OP_SUB, rs, r1);
+    return p.emit(FUSED_OP_ADDW, r1, rs, alpha, 1, 0);
+}
+
+// the same operations as in MatOp_Bin::assign()
+static int emitBin(FusedExprProgram& p, char op, int r1, int r2, double scale, const Scalar& s)
+{
+    switch( op )
+    {
+    case '*':
+        return p.emit(FUSED_OP_MUL, r1, r2, scale);
+    case '/':
+        return r2 >= 0 ? p.emit(FUSED_OP_DIV, r1, r2, scale) : p.emit(FUSED_OP_RECIP, r1, -1, scale);
+    case 'm':
+        return p.emit(FUSED_OP_MIN, r1, r2);
+    case 'M':
+        return p.emit(FUSED_OP_MAX, r1, r2);
+    case 'n':
+        return p.emit(FUSED_OP_MIN, r1, p.constant(Scalar::all(s[0])));
+    case 'N':
+        return p.emit(FUSED_OP_MAX, r1, p.constant(Scalar::all(s[0])));
+    case 'a':
+        return p.emit(FUSED_OP_ABSDIFF, r1, r2 >= 0 ? r2 : p.constant(s));
+    default:
+        CV_Error(cv::Error::StsError, "Unknown operation");
+    }
+}
+
+// non-fusable subexpression which is evaluated into the operand after checks of the whole program
+struct FusedExprDeferredOperand
+{
+    FusedExprDeferredOperand(int operand_, const MatExpr& e_) : operand(operand_), e(&e_) {}
+    int operand;
+    const MatExpr* e;
+};
+
+// appends code of the expression, non-fusable expressions get placeholder operands (see FusedExprDeferredOperand)
+static int emitExpr(FusedExprProgram& p, const MatExpr& e, std::vector<FusedExprDeferredOperand>& deferred)
+{
+    if( isFused(e) )
+        return p.append(fusedProgram(e));
+    if( isAddEx(e) )
+    {
+        int r1 = p.load(e.a);
+        return e.b.data ? emitAddEx(p, r1, p.load(e.b), e.alpha, e.beta, e.s) : emitAddEx(p, r1, -1, e.alpha, 0, e.s);
+    }
+    if( isFusable(e) )  // MatOp_Bin
+    {
+        int r1 = p.load(e.a);
+        return emitBin(p, (char)e.flags, r1, e.b.data ? p.load(e.b) : -1, e.alpha, e.s);
+    }
+    p.operands.push_back(Mat());
+    deferred.push_back(FusedExprDeferredOperand((int)p.operands.size() - 1, e));
+    int r = p.emit(FUSED_OP_LOAD, -1);
+    p.code[r].operand = (int)p.operands.size() - 1;
+    return r;
+}
+
+static bool isFusedExprType(int type)
+{
+    return (CV_MAT_DEPTH(type) == CV_32F || CV_MAT_DEPTH(type) == CV_64F) && CV_MAT_CN(type) <= 4;
+}
+
+// checks operands before anything is evaluated, so the regular processing doesn't compute subexpressions twice
+static bool checkFusedExprOperands(const FusedExprProgram& p, const std::vector<FusedExprDeferredOperand>& deferred)
+{
+    const int type = p.type;
+    std::vector<const MatExpr*> exprs(p.operands.size(), (const MatExpr*)NULL);
+    for( size_t i = 0; i < deferred.size(); i++ )
+        exprs[deferred[i].operand] = deferred[i].e;
+
+    const Mat& a = p.operands[0];
+    const Size a_size = exprs[0] ? exprs[0]->size() : a.size();
+    const int a_dims = exprs[0] ? 2 : a.dims;
+    for( size_t i = 0; i < p.operands.size(); i++ )
+    {
+        if( exprs[i] )
+        {
+            if( exprs[i]->type() != type || a_dims > 2 || exprs[i]->size() != a_size )
+                return false;
+            continue;
+        }
+        const Mat& m = p.operands[i];
+        if( m.type() != type || (m.dims > 2 && !m.isContinuous()) )
+            return false;
+        if( exprs[0] ? (m.dims > 2 || m.size() != a_size) : m.size != a.size )
+            return false;
+    }
+    return true;
+}
+
+// builds program of op(e1, e2) where `op` adds the last instruction into the program
+template<typename EmitOp>
+static bool makeFusedExpr(MatExpr& res, const MatExpr& e1, const MatExpr* e2, const EmitOp& op)
+{
+    if( !useFusedExpressions() )
+        return false;
+    const int type = e1.type();
+    if( !isFusedExprType(type) || (e2 && e2->type() != type) )
+        return false;
+
+    Mat holder;
+    holder.allocator = getFusedExprProgramAllocator();
+    holder.create(1, 1, CV_8UC1);
+    FusedExprProgram& p = *(FusedExprProgram*)holder.data;
+    p.type = type;
+    std::vector<FusedExprDeferredOperand> deferred;
+    int r1 = emitExpr(p, e1, deferred);
+    int r2 = e2 ? emitExpr(p, *e2, deferred) : -1;
+    op(p, r1, r2);
+
+    if( p.code.size() > (size_t)FusedExprProgram::MAX_INSTRUCTIONS )
+        return false;  // evaluate operands separately
+    if( !checkFusedExprOperands(p, deferred) )
+        return false;  // regular processing reports errors
+
+    for( size_t i = 0; i < deferred.size(); i++ )
+    {
+        const MatExpr& e = *deferred[i].e;
+        Mat& m = p.operands[deferred[i].operand];
+        e.op->assign(e, m);
+        CV_Assert( m.type() == type && m.size() == e.size() );
+    }
+    res = MatExpr(&g_MatOp_Fused, 0, p.operands[0], Mat(), holder);
+    return true;
+}
+
+struct FusedAddExOp
+{
+    FusedAddExOp(double alpha_, double beta_, const Scalar& s_) : alpha(alpha_), beta(beta_), s(s_) {}
+    void operator()(FusedExprProgram& p, int r1, int r2) const { emitAddEx(p, r1, r2, alpha, r2 >= 0 ? beta : 0, s); }
+    double alpha, beta;
+    Scalar s;
+};
+
+struct FusedBinOp
+{
+    FusedBinOp(char op_, double scale_, const Scalar& s_) : op(op_), scale(scale_), s(s_) {}
+    void operator()(FusedExprProgram& p, int r1, int r2) const { emitBin(p, op, r1, r2, scale, s); }
+    char op;
+    double scale;
+    Scalar s;
+};
+
+bool MatOp_Fused::makeAddEx(MatExpr& res, const MatExpr& e1, const MatExpr* e2, double alpha, double beta, const Scalar& s)
+{
+    return makeFusedExpr(res, e1, e2, FusedAddExOp(alpha, beta, s));
+}
+
+bool MatOp_Fused::makeBin(MatExpr& res, char op, const MatExpr& e1, const MatExpr* e2, double scale, const Scalar& s)
+{
+    return makeFusedExpr(res, e1, e2, FusedBinOp(op, scale, s));
+}
+
+void MatOp_Fused::assign(const MatExpr& e, Mat& m, int _type) const
+{
+    CV_INSTRUMENT_REGION();
+
+    const FusedExprProgram& p = fusedProgram(e);
+    CV_Assert( _type == -1 || CV_MAT_CN(_type) == CV_MAT_CN(p.type) );
+    p.run(m, _type == -1 ? CV_MAT_DEPTH(p.type) : CV_MAT_DEPTH(_type));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 MatExpr Mat::t() const
 {
     CV_INSTRUMENT_REGION();
@@ -5,7 +5,9 @@
 #include "precomp.hpp"
 #include "opencl_kernels_core.hpp"
 #include "hal_replacement.hpp"
+#include "transpose.hpp"
 #include "opencv2/core/detail/dispatch_helper.impl.hpp"
+#include "opencv2/core/utils/buffer_pool.private.hpp"
 
 #include <algorithm> // std::swap_ranges
 #include <numeric> // std::accumulate
@@ -14,62 +16,6 @@ namespace cv {
 
 ////////////////////////////////////// transpose /////////////////////////////////////////
 
-template<typename T> static void
-transpose_( const uchar* src, size_t sstep, uchar* dst, size_t dstep, Size sz )
-{
-    int i=0, j, m = sz.width, n = sz.height;
-
-    #if CV_ENABLE_UNROLLED
-    for(; i <= m - 4; i += 4 )
-    {
-        T* d0 = (T*)(dst + dstep*i);
-        T* d1 = (T*)(dst + dstep*(i+1));
-        T* d2 = (T*)(dst + dstep*(i+2));
-        T* d3 = (T*)(dst + dstep*(i+3));
-
-        for( j = 0; j <= n - 4; j += 4 )
-        {
-            const T* s0 = (const T*)(src + i*sizeof(T) + sstep*j);
-            const T* s1 = (const T*)(src + i*sizeof(T) + sstep*(j+1));
-            const T* s2 = (const T*)(src + i*sizeof(T) + sstep*(j+2));
-            const T* s3 = (const T*)(src + i*sizeof(T) + sstep*(j+3));
-
-            d0[j] = s0[0]; d0[j+1] = s1[0]; d0[j+2] = s2[0]; d0[j+3] = s3[0];
-            d1[j] = s0[1]; d1[j+1] = s1[1]; d1[j+2] = s2[1]; d1[j+3] = s3[1];
-            d2[j] = s0[2]; d2[j+1] = s1[2]; d2[j+2] = s2[2]; d2[j+3] = s3[2];
-            d3[j] = s0[3]; d3[j+1] = s1[3]; d3[j+2] = s2[3]; d3[j+3] = s3[3];
-        }
-
-        for( ; j < n; j++ )
-        {
-            const T* s0 = (const T*)(src + i*sizeof(T) + j*sstep);
-            d0[j] = s0[0]; d1[j] = s0[1]; d2[j] = s0[2]; d3[j] = s0[3];
-        }
-    }
-    #endif
-    for( ; i < m; i++ )
-    {
-        T* d0 = (T*)(dst + dstep*i);
-        j = 0;
-        #if CV_ENABLE_UNROLLED
-        for(; j <= n - 4; j += 4 )
-        {
-            const T* s0 = (const T*)(src + i*sizeof(T) + sstep*j);
-            const T* s1 = (const T*)(src + i*sizeof(T) + sstep*(j+1));
-            const T* s2 = (const T*)(src + i*sizeof(T) + sstep*(j+2));
-            const T* s3 = (const T*)(src + i*sizeof(T) + sstep*(j+3));
-
-            d0[j] = s0[0]; d0[j+1] = s1[0]; d0[j+2] = s2[0]; d0[j+3] = s3[0];
-        }
-        #endif
-        for( ; j < n; j++ )
-        {
-            const T* s0 = (const T*)(src + i*sizeof(T) + j*sstep);
-            d0[j] = s0[0];
-        }
-    }
-}
-
 template<typename T> static void
 transposeI_( uchar* data, size_t step, int n )
 {
@@ -82,33 +28,22 @@ transposeI_( uchar* data, size_t step, int n )
     }
 }
 
-typedef void (*TransposeFunc)( const uchar* src, size_t sstep, uchar* dst, size_t dstep, Size sz );
 typedef void (*TransposeInplaceFunc)( uchar* data, size_t step, int n );
 
-#define DEF_TRANSPOSE_FUNC(suffix, type) \
-static void transpose_##suffix( const uchar* src, size_t sstep, uchar* dst, size_t dstep, Size sz ) \
-{ transpose_<type>(src, sstep, dst, dstep, sz); } \
-\
+#define DEF_TRANSPOSE_INPLACE_FUNC(suffix, type) \
 static void transposeI_##suffix( uchar* data, size_t step, int n ) \
 { transposeI_<type>(data, step, n); }
 
-DEF_TRANSPOSE_FUNC(8u, uchar)
-DEF_TRANSPOSE_FUNC(16u, ushort)
-DEF_TRANSPOSE_FUNC(8uC3, Vec3b)
-DEF_TRANSPOSE_FUNC(32s, int)
-DEF_TRANSPOSE_FUNC(16uC3, Vec3s)
-DEF_TRANSPOSE_FUNC(32sC2, Vec2i)
-DEF_TRANSPOSE_FUNC(32sC3, Vec3i)
-DEF_TRANSPOSE_FUNC(32sC4, Vec4i)
-DEF_TRANSPOSE_FUNC(32sC6, Vec6i)
-DEF_TRANSPOSE_FUNC(32sC8, Vec8i)
-
-static TransposeFunc transposeTab[] =
-{
-    0, transpose_8u, transpose_16u, transpose_8uC3, transpose_32s, 0, transpose_16uC3, 0,
-    transpose_32sC2, 0, 0, 0, transpose_32sC3, 0, 0, 0, transpose_32sC4,
-    0, 0, 0, 0, 0, 0, 0, transpose_32sC6, 0, 0, 0, 0, 0, 0, 0, transpose_32sC8
-};
+DEF_TRANSPOSE_INPLACE_FUNC(8u, uchar)
+DEF_TRANSPOSE_INPLACE_FUNC(16u, ushort)
+DEF_TRANSPOSE_INPLACE_FUNC(8uC3, Vec3b)
+DEF_TRANSPOSE_INPLACE_FUNC(32s, int)
+DEF_TRANSPOSE_INPLACE_FUNC(16uC3, Vec3s)
+DEF_TRANSPOSE_INPLACE_FUNC(32sC2, Vec2i)
+DEF_TRANSPOSE_INPLACE_FUNC(32sC3, Vec3i)
+DEF_TRANSPOSE_INPLACE_FUNC(32sC4, Vec4i)
+DEF_TRANSPOSE_INPLACE_FUNC(32sC6, Vec6i)
+DEF_TRANSPOSE_INPLACE_FUNC(32sC8, Vec8i)
 
 static TransposeInplaceFunc transposeInplaceTab[] =
 {
@@ -117,6 +52,103 @@ static TransposeInplaceFunc transposeInplaceTab[] =
     0, 0, 0, 0, 0, 0, 0, transposeI_32sC6, 0, 0, 0, 0, 0, 0, 0, transposeI_32sC8
 };
 
+/* Parallel stripes are bands of destination rows (source columns). Kernels pass through the band by groups
+   of 4-16 destination rows, so source cache lines of the band are reused from L2 cache by the next group */
+static int transposeBandWidth( size_t esz )
+{
+    return (int)alignSize(std::max((size_t)16, 128/esz), 16);
+}
+
+/* In-place transposition swaps square tiles, source and destination tiles fit into L1 cache together */
+static int transposeTileSize( size_t esz )
+{
+    return std::max(16, cvFloor(std::sqrt(16384./esz)) & -16);
+}
+
+class TransposeInvoker CV_FINAL : public ParallelLoopBody
+{
+public:
+    TransposeInvoker( const uchar* src_, ptrdiff_t sstep_, uchar* dst_, ptrdiff_t dstep_, Size sz_, size_t esz_, TransposeFunc func_ )
+        : src(src_), sstep(sstep_), dst(dst_), dstep(dstep_), sz(sz_), esz(esz_), func(func_), band(transposeBandWidth(esz_)) {}
+
+    int stripes() const { return (sz.width + band - 1)/band; }
+
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        int i = range.start*band, w = std::min(range.end*band, sz.width) - i;
+        func(src + i*esz, sstep, dst + dstep*i, dstep, Size(w, sz.height));
+    }
+
+private:
+    const uchar* src;
+    ptrdiff_t sstep;
+    uchar* dst;
+    ptrdiff_t dstep;
+    Size sz;
+    size_t esz;
+    TransposeFunc func;
+    int band;
+};
+
+class TransposeInplaceInvoker CV_FINAL : public ParallelLoopBody
+{
+public:
+    TransposeInplaceInvoker( uchar* data_, size_t step_, int n_, size_t esz_, TransposeFunc func_, TransposeInplaceFunc ifunc_ )
+        : data(data_), step(step_), n(n_), esz(esz_), func(func_), ifunc(ifunc_), tile(transposeTileSize(esz_)) {}
+
+    // stripe is a band of rows above the diagonal with its mirrored band of columns
+    int stripes() const { return (n + tile - 1)/tile; }
+
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        utils::PooledAutoBuffer<uchar> _buf(tile*tile*esz);
+        uchar* buf = _buf.data();
+        for( int t = range.start; t < range.end; t++ )
+        {
+            int i = t*tile, h = std::min(tile, n - i);
+            ifunc(data + step*i + i*esz, step, h);
+            for( int j = i + h; j < n; j += tile )
+            {
+                // swap the transposed tiles (i, j) and (j, i) through the temporary buffer
+                int w = std::min(tile, n - j);
+                uchar* a = data + step*i + j*esz;
+                uchar* b = data + step*j + i*esz;
+                func(a, (ptrdiff_t)step, buf, h*esz, Size(w, h));
+                func(b, (ptrdiff_t)step, a, (ptrdiff_t)step, Size(h, w));
+                for( int k = 0; k < w; k++ )
+                    memcpy(b + step*k, buf + k*h*esz, h*esz);
+            }
+        }
+    }
+
+private:
+    uchar* data;
+    size_t step;
+    int n;
+    size_t esz;
+    TransposeFunc func;
+    TransposeInplaceFunc ifunc;
+    int tile;
+};
+
+/* Negative steps are allowed: they are used for rotation of arrays */
+static void transposeImpl( const uchar* src, ptrdiff_t sstep, uchar* dst, ptrdiff_t dstep, Size sz, size_t esz )
+{
+    TransposeFunc func = getTransposeFunc(esz);
+    CV_Assert( func != 0 );
+    TransposeInvoker invoker(src, sstep, dst, dstep, sz, esz, func);
+    parallel_for_(Range(0, invoker.stripes()), invoker, (double)sz.area()*esz/(1 << 16));
+}
+
+static void transposeInplaceImpl( uchar* data, size_t step, int n, size_t esz )
+{
+    TransposeFunc func = getTransposeFunc(esz);
+    TransposeInplaceFunc ifunc = transposeInplaceTab[esz];
+    CV_Assert( func != 0 && ifunc != 0 );
+    TransposeInplaceInvoker invoker(data, step, n, esz, func, ifunc);
+    parallel_for_(Range(0, invoker.stripes()), invoker, (double)n*n*esz/(1 << 16));
+}
+
 #ifdef HAVE_OPENCL
 
 static bool ocl_transpose( InputArray _src, OutputArray _dst )
@@ -275,16 +307,12 @@ void transpose( InputArray _src, OutputArray _dst )
 
     if( dst.data == src.data )
     {
-        TransposeInplaceFunc func = transposeInplaceTab[esz];
-        CV_Assert( func != 0 );
         CV_Assert( dst.cols == dst.rows );
-        func( dst.ptr(), dst.step, dst.rows );
+        transposeInplaceImpl( dst.ptr(), dst.step, dst.rows, esz );
     }
     else
     {
-        TransposeFunc func = transposeTab[esz];
-        CV_Assert( func != 0 );
-        func( src.ptr(), src.step, dst.ptr(), dst.step, src.size() );
+        transposeImpl( src.ptr(), src.step, dst.ptr(), dst.step, src.size(), esz );
     }
 }
 
@@ -589,15 +617,18 @@ flipHoriz( const uchar* src, size_t sstep, uchar* dst, size_t dstep, Size size,
     }
 }
 
+// swaps the pairs of rows (y, size.height - 1 - y) for y in [y0, y1)
 static void
-flipVert( const uchar* src0, size_t sstep, uchar* dst0, size_t dstep, Size size, size_t esz )
+flipVert( const uchar* src0, size_t sstep, uchar* dst0, size_t dstep, Size size, size_t esz, int y0, int y1 )
 {
-    const uchar* src1 = src0 + (size.height - 1)*sstep;
-    uchar* dst1 = dst0 + (size.height - 1)*dstep;
+    const uchar* src1 = src0 + (size.height - 1 - y0)*sstep;
+    uchar* dst1 = dst0 + (size.height - 1 - y0)*dstep;
+    src0 += y0*sstep;
+    dst0 += y0*dstep;
     size.width *= (int)esz;
 
-    for( int y = 0; y < (size.height + 1)/2; y++, src0 += sstep, src1 -= sstep,
-                                                  dst0 += dstep, dst1 -= dstep )
+    for( int y = y0; y < y1; y++, src0 += sstep, src1 -= sstep,
+                                  dst0 += dstep, dst1 -= dstep )
     {
         int i = 0;
 #if (CV_SIMD || CV_SIMD_SCALABLE)
@@ -677,6 +708,58 @@ flipVert( const uchar* src0, size_t sstep, uchar* dst0, size_t dstep, Size size,
     }
 }
 
+class FlipInvoker CV_FINAL : public ParallelLoopBody
+{
+public:
+    FlipInvoker( const Mat& src_, Mat& dst_, int flipMode_ )
+        : src(src_), dst(dst_), flipMode(flipMode_), esz(src_.elemSize()) {}
+
+    // horizontal flip is processed by rows, other modes are processed by pairs of rows (y, rows - 1 - y)
+    int stripes() const { return flipMode > 0 ? src.rows : (src.rows + 1)/2; }
+
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        Size size = src.size();
+        if( flipMode > 0 )
+        {
+            flipHoriz( src.ptr(range.start), src.step, dst.ptr(range.start), dst.step,
+                       Size(size.width, range.end - range.start), esz );
+        }
+        else if( flipMode == 0 )
+        {
+            flipVert( src.ptr(), src.step, dst.ptr(), dst.step, size, esz, range.start, range.end );
+        }
+        else if( src.data != dst.data )
+        {
+            // both flips are done in a single pass over the source rows
+            for( int y = range.start; y < range.end; y++ )
+            {
+                int y1 = size.height - 1 - y;
+                flipHoriz( src.ptr(y), src.step, dst.ptr(y1), dst.step, Size(size.width, 1), esz );
+                if( y1 != y )
+                    flipHoriz( src.ptr(y1), src.step, dst.ptr(y), dst.step, Size(size.width, 1), esz );
+            }
+        }
+        else
+        {
+            for( int y = range.start; y < range.end; y++ )
+            {
+                int y1 = size.height - 1 - y;
+                flipVert( dst.ptr(), dst.step, dst.ptr(), dst.step, size, esz, y, y + 1 );
+                flipHoriz( dst.ptr(y), dst.step, dst.ptr(y), dst.step, Size(size.width, 1), esz );
+                if( y1 != y )
+                    flipHoriz( dst.ptr(y1), dst.step, dst.ptr(y1), dst.step, Size(size.width, 1), esz );
+            }
+        }
+    }
+
+private:
+    const Mat& src;
+    Mat& dst;
+    int flipMode;
+    size_t esz;
+};
+
 #ifdef HAVE_OPENCL
 
 enum { FLIP_COLS = 1 << 0, FLIP_ROWS = 1 << 1, FLIP_BOTH = FLIP_ROWS | FLIP_COLS };
@@ -812,13 +895,8 @@ void flip( InputArray _src, OutputArray _dst, int flip_mode )
 
     size_t esz = CV_ELEM_SIZE(type);
 
-    if( flip_mode <= 0 )
-        flipVert( src.ptr(), src.step, dst.ptr(), dst.step, src.size(), esz );
-    else
-        flipHoriz( src.ptr(), src.step, dst.ptr(), dst.step, src.size(), esz );
-
-    if( flip_mode < 0 )
-        flipHoriz( dst.ptr(), dst.step, dst.ptr(), dst.step, dst.size(), esz );
+    FlipInvoker invoker(src, dst, flip_mode);
+    parallel_for_(Range(0, invoker.stripes()), invoker, (double)src.total()*esz/(1 << 16));
 }
 
 static void
@@ -1144,6 +1222,18 @@ void rotate(InputArray _src, OutputArray _dst, int rotateMode)
     CALL_HAL(rotate90, cv_hal_rotate90, type, src.ptr(), src.step, src.cols, src.rows,
              dst.ptr(), dst.step, angle);
 
+    size_t esz = CV_ELEM_SIZE(type);
+    if( (angle == 90 || angle == 270) && dst.data != src.data && dst.size() == Size(src.rows, src.cols) &&
+        getTransposeFunc(esz) != 0 )
+    {
+        // rotation by 90 degrees is transposition with reversed order of source (clockwise) or destination rows
+        if( angle == 90 )
+            transposeImpl( src.ptr(src.rows - 1), -(ptrdiff_t)src.step, dst.ptr(), dst.step, src.size(), esz );
+        else
+            transposeImpl( src.ptr(), src.step, dst.ptr(dst.rows - 1), -(ptrdiff_t)dst.step, src.size(), esz );
+        return;
+    }
+
     // use src (Mat) since _src (InputArray) is updated by _dst.create() when in-place
     rotateImpl(src, _dst, rotateMode);
 }
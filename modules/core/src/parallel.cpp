@@ -517,6 +517,18 @@ void parallel_for_(const cv::Range& range, const cv::ParallelLoopBody& body, dou
     if (range.empty())
         return;
 
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+    {
+        std::shared_ptr<ParallelForAPI>& api = getCurrentParallelForAPI();
+        if (api && isNestedParallelForSupported(api.get()))
+        {
+            // backend schedules nested and concurrent parallel_for_() calls itself
+            parallel_for_impl(range, body, nstripes);
+            return;
+        }
+    }
+#endif
+
     static std::atomic<bool> flagNestedParallelFor(false);
     bool isNotNestedRegion = !flagNestedParallelFor.load();
     if (isNotNestedRegion)
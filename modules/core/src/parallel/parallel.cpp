@@ -39,6 +39,39 @@ std::string& getParallelBackendName()
 
 static bool g_initializedParallelForAPI = false;
 
+static
+std::shared_ptr<ParallelForAPI> tryCreateParallelForAPI(const ParallelBackendInfo& info)
+{
+    try
+    {
+        CV_LOG_DEBUG(NULL, "core(parallel): trying backend: " << info.name << " (priority=" << info.priority << ")");
+        if (!info.backendFactory)
+        {
+            CV_LOG_DEBUG(NULL, "core(parallel): factory is not available (plugins require filesystem support): " << info.name);
+            return std::shared_ptr<ParallelForAPI>();
+        }
+        std::shared_ptr<ParallelForAPI> backend = info.backendFactory->create();
+        if (!backend)
+        {
+            CV_LOG_VERBOSE(NULL, 0, "core(parallel): not available: " << info.name);
+            return std::shared_ptr<ParallelForAPI>();
+        }
+        CV_LOG_INFO(NULL, "core(parallel): using backend: " << info.name << " (priority=" << info.priority << ")");
+        g_initializedParallelForAPI = true;
+        getParallelBackendName() = info.name;
+        return backend;
+    }
+    catch (const std::exception& e)
+    {
+        CV_LOG_WARNING(NULL, "core(parallel): can't initialize " << info.name << " backend: " << e.what());
+    }
+    catch (...)
+    {
+        CV_LOG_WARNING(NULL, "core(parallel): can't initialize " << info.name << " backend: Unknown C++ exception");
+    }
+    return std::shared_ptr<ParallelForAPI>();
+}
+
 static
 std::shared_ptr<ParallelForAPI> createParallelForAPI()
 {
@@ -60,42 +93,27 @@ std::shared_ptr<ParallelForAPI> createParallelForAPI()
             }
             isKnown = true;
         }
-        try
-        {
-            CV_LOG_DEBUG(NULL, "core(parallel): trying backend: " << info.name << " (priority=" << info.priority << ")");
-            if (!info.backendFactory)
-            {
-                CV_LOG_DEBUG(NULL, "core(parallel): factory is not available (plugins require filesystem support): " << info.name);
-                continue;
-            }
-            std::shared_ptr<ParallelForAPI> backend = info.backendFactory->create();
-            if (!backend)
-            {
-                CV_LOG_VERBOSE(NULL, 0, "core(parallel): not available: " << info.name);
-                continue;
-            }
-            CV_LOG_INFO(NULL, "core(parallel): using backend: " << info.name << " (priority=" << info.priority << ")");
-            g_initializedParallelForAPI = true;
-            getParallelBackendName() = info.name;
+        std::shared_ptr<ParallelForAPI> backend = tryCreateParallelForAPI(info);
+        if (backend)
             return backend;
-        }
-        catch (const std::exception& e)
-        {
-            CV_LOG_WARNING(NULL, "core(parallel): can't initialize " << info.name << " backend: " << e.what());
-        }
-        catch (...)
-        {
-            CV_LOG_WARNING(NULL, "core(parallel): can't initialize " << info.name << " backend: Unknown C++ exception");
-        }
     }
     if (name.empty())
     {
         CV_LOG_DEBUG(NULL, "core(parallel): fallback on builtin code");
     }
-    else
+    else if (!isKnown)
     {
-        if (!isKnown)
+        const ParallelBackendInfo* info = findOnDemandParallelBackendInfo(name);
+        if (info)
+        {
+            std::shared_ptr<ParallelForAPI> backend = tryCreateParallelForAPI(*info);
+            if (backend)
+                return backend;
+        }
+        else
+        {
             CV_LOG_INFO(NULL, "core(parallel): unknown backend: " << name);
+        }
     }
     g_initializedParallelForAPI = true;
     return std::shared_ptr<ParallelForAPI>();
@@ -22,6 +22,13 @@ std::shared_ptr<cv::parallel::ParallelForAPI> createParallelBackendTBB();
 std::shared_ptr<cv::parallel::ParallelForAPI> createParallelBackendOpenMP();
 #endif
 
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+std::shared_ptr<cv::parallel::ParallelForAPI> createParallelBackendWorkStealing();
+
+/** Returns true if backend executes nested parallel_for_() calls itself (they are not serialized by the caller) */
+bool isNestedParallelForSupported(const ParallelForAPI* api);
+#endif
+
 #endif  // BUILD_PLUGIN
 
 }}  // namespace
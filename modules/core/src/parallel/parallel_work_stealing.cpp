@@ -0,0 +1,413 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+//
+// Work-stealing parallel_for backend.
+//
+// Each worker owns a deque of stripe ranges: the owner pushes/pops ranges at the back (LIFO),
+// idle threads steal from the front (FIFO). Ranges are split lazily (binary halving) by the
+// thread which executes them, so uneven stripes are redistributed between threads on demand.
+//
+// Unlike the builtin thread pool, parallel_for() calls from worker threads (nested calls)
+// and concurrent calls from different application threads are executed in parallel:
+// the calling thread pushes the job into its own deque (or into the shared queue for
+// non-worker threads) and helps to complete it instead of blocking.
+//
+
+#include "../precomp.hpp"
+
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+
+#include "parallel.hpp"
+#include "../parallel_impl.hpp"  // defaultNumberOfThreads()
+
+#include <opencv2/core/utils/configuration.private.hpp>
+#include <opencv2/core/utils/tls.hpp>
+#include <opencv2/core/utils/logger.defines.hpp>
+#ifdef NDEBUG
+#define CV_LOG_STRIP_LEVEL CV_LOG_LEVEL_DEBUG + 1
+#else
+#define CV_LOG_STRIP_LEVEL CV_LOG_LEVEL_VERBOSE + 1
+#endif
+#include <opencv2/core/utils/logger.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace cv { namespace parallel { namespace ws {
+
+static int CV_WS_ACTIVE_WAIT = (int)utils::getConfigurationParameterSizeT("OPENCV_PARALLEL_WORK_STEALING_ACTIVE_WAIT", 2000);  // iterations
+static int CV_WS_SPLIT_FACTOR = (int)utils::getConfigurationParameterSizeT("OPENCV_PARALLEL_WORK_STEALING_SPLIT_FACTOR", 4);  // ranges per thread
+
+struct Job
+{
+    Job(ParallelForAPI::FN_parallel_for_body_cb_t body_callback_, void* callback_data_, int tasks, int grain_)
+        : body_callback(body_callback_), callback_data(callback_data_), grain(grain_)
+    {
+        remaining.store(tasks, std::memory_order_relaxed);
+    }
+
+    ParallelForAPI::FN_parallel_for_body_cb_t body_callback;
+    void* callback_data;
+    const int grain;  // ranges are not split below this size
+    std::atomic<int> remaining;  // number of not completed stripes
+};
+
+struct Task
+{
+    Job* job;
+    int begin;
+    int end;
+};
+
+/** Owner works with the back of the deque, thieves take tasks from the front */
+class TaskDeque
+{
+public:
+    void push(const Task& task)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(task);
+    }
+
+    /** Takes the most recent task, optionally only if it belongs to the specified job */
+    bool pop(Task& task, const Job* job)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tasks.empty() || (job && tasks.back().job != job))
+            return false;
+        task = tasks.back();
+        tasks.pop_back();
+        return true;
+    }
+
+    /** Takes the oldest task, optionally the oldest task of the specified job */
+    bool steal(Task& task, const Job* job)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (std::deque<Task>::iterator it = tasks.begin(); it != tasks.end(); ++it)
+        {
+            if (job && it->job != job)
+                continue;
+            task = *it;
+            tasks.erase(it);
+            return true;
+        }
+        return false;
+    }
+
+protected:
+    std::mutex mutex;
+    std::deque<Task> tasks;
+};
+
+class WorkStealingPool;
+
+class Worker
+{
+public:
+    Worker(WorkStealingPool& pool_, unsigned id_)
+        : pool(pool_), id(id_)
+    {
+        // nothing
+    }
+
+    WorkStealingPool& pool;
+    const unsigned id;  // 1..N, queue index in the pool
+    TaskDeque queue;
+    std::thread thread;
+
+    void thread_body();
+};
+
+struct ThreadContext
+{
+    ThreadContext() : worker(NULL) {}
+    Worker* worker;  // NULL for non-pool threads
+};
+
+class WorkStealingPool
+{
+public:
+    WorkStealingPool()
+        : num_threads(0), active_external_jobs(0)
+    {
+        num_queued.store(0, std::memory_order_relaxed);
+        num_sleeping.store(0, std::memory_order_relaxed);
+        stop_threads.store(false, std::memory_order_relaxed);
+    }
+
+    ~WorkStealingPool()
+    {
+        std::lock_guard<std::mutex> lock(mutex_config);
+        reconfigure_(0);
+    }
+
+    void run(int tasks, ParallelForAPI::FN_parallel_for_body_cb_t body_callback, void* callback_data)
+    {
+        ThreadContext& ctx = tls_context.getRef();
+        if (ctx.worker)
+        {
+            // nested call: worker threads are already here, just extend the work
+            runJob(ctx.worker, tasks, body_callback, callback_data);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_config);
+            unsigned n = std::max(1, getNumThreads());
+            if (active_external_jobs == 0)
+                reconfigure_(n - 1);
+            active_external_jobs++;
+        }
+        try
+        {
+            if (workers.empty())
+                body_callback(0, tasks, callback_data);
+            else
+                runJob(NULL, tasks, body_callback, callback_data);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex_config);
+            active_external_jobs--;
+            throw;
+        }
+        std::lock_guard<std::mutex> lock(mutex_config);
+        active_external_jobs--;
+    }
+
+    int getThreadNum() const
+    {
+        const Worker* worker = tls_context.getRef().worker;
+        return worker ? (int)worker->id : 0;
+    }
+
+    int getNumThreads() const
+    {
+        int n = num_threads;
+        return n > 0 ? n : (int)defaultNumberOfThreads();
+    }
+
+    void setNumThreads(int n)
+    {
+        // workers are re-created lazily by the next parallel_for() call from an application thread
+        num_threads = n;
+    }
+
+protected:
+    friend class Worker;
+
+    TLSData<ThreadContext> tls_context;
+
+    std::atomic<int> num_threads;
+
+    std::mutex mutex_config;  // guards workers list
+    int active_external_jobs;
+    std::vector< Ptr<Worker> > workers;
+
+    TaskDeque shared_queue;  // jobs from non-pool threads
+
+    std::atomic<int> num_queued;  // total number of tasks in all queues (approximate)
+    std::atomic<int> num_sleeping;
+    std::atomic<bool> stop_threads;
+    std::mutex mutex_wake;
+    std::condition_variable cond_wake;
+
+    void reconfigure_(unsigned new_threads_count)
+    {
+        if (new_threads_count == workers.size())
+            return;
+        CV_LOG_DEBUG(NULL, "core(parallel): work-stealing pool: " << workers.size() << " => " << new_threads_count << " worker threads");
+        if (!workers.empty())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_wake);
+                stop_threads = true;
+            }
+            cond_wake.notify_all();
+            for (size_t i = 0; i < workers.size(); i++)
+                workers[i]->thread.join();
+            workers.clear();
+            stop_threads = false;
+        }
+        for (unsigned i = 0; i < new_threads_count; i++)
+            workers.push_back(Ptr<Worker>(new Worker(*this, i + 1)));
+        for (size_t i = 0; i < workers.size(); i++)
+            workers[i]->thread = std::thread(&Worker::thread_body, workers[i].get());
+    }
+
+    void push(Worker* self, const Task& task)
+    {
+        (self ? self->queue : shared_queue).push(task);
+        num_queued.fetch_add(1, std::memory_order_seq_cst);
+        if (num_sleeping.load(std::memory_order_seq_cst) > 0)
+        {
+            std::lock_guard<std::mutex> lock(mutex_wake);  // to avoid signal miss due pre-check
+            cond_wake.notify_one();
+        }
+    }
+
+    /** Finds a task: own queue first, then the shared queue and other workers' queues */
+    bool take(Worker* self, Task& task, const Job* job)
+    {
+        if (self && self->queue.pop(task, job))
+        {
+            num_queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        if (num_queued.load(std::memory_order_relaxed) <= 0)
+            return false;
+        if (shared_queue.steal(task, job))
+        {
+            num_queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        const size_t n = workers.size();
+        const size_t start = self ? self->id : 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            Worker* victim = workers[(start + i) % n].get();
+            if (victim == self)
+                continue;
+            if (victim->queue.steal(task, job))
+            {
+                num_queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void execute(Worker* self, Task task)
+    {
+        Job& job = *task.job;
+        while (task.end - task.begin > job.grain)
+        {
+            // keep the first half, publish the second half for other threads
+            int middle = task.begin + (task.end - task.begin) / 2;
+            Task tail = { task.job, middle, task.end };
+            push(self, tail);
+            task.end = middle;
+        }
+        job.body_callback(task.begin, task.end, job.callback_data);
+        job.remaining.fetch_sub(task.end - task.begin, std::memory_order_acq_rel);
+    }
+
+    void runJob(Worker* self, int tasks, ParallelForAPI::FN_parallel_for_body_cb_t body_callback, void* callback_data)
+    {
+        int threads = (int)workers.size() + 1;
+        int grain = std::max(1, tasks / (threads * std::max(1, CV_WS_SPLIT_FACTOR)));
+        Job job(body_callback, callback_data, tasks, grain);
+        Task task = { &job, 0, tasks };
+        execute(self, task);
+
+        // help to complete own job, don't pick unrelated work to keep latency of the caller predictable
+        int idle = 0;
+        while (job.remaining.load(std::memory_order_acquire) > 0)
+        {
+            if (take(self, task, &job))
+            {
+                execute(self, task);
+                idle = 0;
+            }
+            else if (++idle > 16)
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void wait(Worker* self)
+    {
+        CV_UNUSED(self);
+        for (int i = 0; i < CV_WS_ACTIVE_WAIT; i++)
+        {
+            if (num_queued.load(std::memory_order_relaxed) > 0 || stop_threads)
+                return;
+            if (i >= 16)
+                std::this_thread::yield();
+        }
+        std::unique_lock<std::mutex> lock(mutex_wake);
+        num_sleeping.fetch_add(1, std::memory_order_seq_cst);
+        while (num_queued.load(std::memory_order_seq_cst) <= 0 && !stop_threads)
+        {
+            CV_LOG_VERBOSE(NULL, 5, "WorkStealing: worker " << self->id << " goes to sleep");
+            cond_wake.wait(lock);
+        }
+        num_sleeping.fetch_sub(1, std::memory_order_seq_cst);
+    }
+};
+
+void Worker::thread_body()
+{
+    (void)cv::utils::getThreadID(); // notify OpenCV about new thread
+    pool.tls_context.getRef().worker = this;
+    while (!pool.stop_threads)
+    {
+        Task task;
+        if (pool.take(this, task, NULL))
+            pool.execute(this, task);
+        else
+            pool.wait(this);
+    }
+}
+
+
+class ParallelForBackend : public ParallelForAPI
+{
+public:
+    ParallelForBackend() {}
+
+    virtual ~ParallelForBackend() {}
+
+    virtual void parallel_for(int tasks, FN_parallel_for_body_cb_t body_callback, void* callback_data) CV_OVERRIDE
+    {
+        pool.run(tasks, body_callback, callback_data);
+    }
+
+    virtual int getThreadNum() const CV_OVERRIDE
+    {
+        return pool.getThreadNum();
+    }
+
+    virtual int getNumThreads() const CV_OVERRIDE
+    {
+        return pool.getNumThreads();
+    }
+
+    virtual int setNumThreads(int nThreads) CV_OVERRIDE
+    {
+        int oldNumThreads = pool.getNumThreads();
+        pool.setNumThreads(nThreads);
+        return oldNumThreads;
+    }
+
+    const char* getName() const CV_OVERRIDE
+    {
+        return "work_stealing";
+    }
+
+protected:
+    WorkStealingPool pool;
+};
+
+}  // namespace ws
+
+std::shared_ptr<cv::parallel::ParallelForAPI> createParallelBackendWorkStealing()
+{
+    return std::make_shared<cv::parallel::ws::ParallelForBackend>();
+}
+
+bool isNestedParallelForSupported(const ParallelForAPI* api)
+{
+    return dynamic_cast<const cv::parallel::ws::ParallelForBackend*>(api) != NULL;
+}
+
+}}  // namespace
+
+#endif  // OPENCV_DISABLE_THREAD_SUPPORT
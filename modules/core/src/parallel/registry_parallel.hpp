@@ -20,6 +20,12 @@ struct ParallelBackendInfo
 
 const std::vector<ParallelBackendInfo>& getParallelBackendsInfo();
 
+/** @brief Lookup builtin backend which is activated by name only (not probed by default)
+ *
+ * @return NULL if there is no such backend
+ */
+const ParallelBackendInfo* findOnDemandParallelBackendInfo(const std::string& name);
+
 }} // namespace
 
 #endif // OPENCV_CORE_PARALLEL_REGISTRY_HPP
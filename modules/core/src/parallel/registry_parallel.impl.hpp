@@ -45,6 +45,23 @@ std::vector<ParallelBackendInfo>& getBuiltinParallelBackendsInfo()
     return g_backends;
 }
 
+/** @brief Builtin backends which are not probed automatically
+ *
+ * They are activated by name: `OPENCV_PARALLEL_BACKEND=<name>`, `OPENCV_PARALLEL_PRIORITY_LIST`
+ * or cv::parallel::setParallelForBackend().
+ */
+static
+std::vector<ParallelBackendInfo>& getOnDemandParallelBackendsInfo()
+{
+    static std::vector<ParallelBackendInfo> g_backends
+    {
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+        DECLARE_STATIC_BACKEND("WORK_STEALING", createParallelBackendWorkStealing)
+#endif
+    };
+    return g_backends;
+}
+
 static
 bool sortByPriority(const ParallelBackendInfo &lhs, const ParallelBackendInfo &rhs)
 {
@@ -135,6 +152,14 @@ protected:
             }
             if (!found)
             {
+                const ParallelBackendInfo* info = findOnDemandParallelBackendInfo(name);
+                if (info)
+                {
+                    CV_LOG_INFO(NULL, "core(parallel): Adding parallel backend (builtin): '" << name << "'");
+                    enabledBackends.push_back(ParallelBackendInfo{priority, name, info->backendFactory});
+                    hasChanges = true;
+                    continue;
+                }
                 CV_LOG_INFO(NULL, "core(parallel): Adding parallel backend (plugin): '" << name << "'");
                 enabledBackends.push_back(ParallelBackendInfo{priority, name, createPluginParallelBackendFactory(name)});
                 hasChanges = true;
@@ -170,4 +195,15 @@ const std::vector<ParallelBackendInfo>& getParallelBackendsInfo()
     return cv::parallel::ParallelBackendRegistry::getInstance().getEnabledBackends();
 }
 
+const ParallelBackendInfo* findOnDemandParallelBackendInfo(const std::string& name)
+{
+    const std::vector<ParallelBackendInfo>& backends = getOnDemandParallelBackendsInfo();
+    for (size_t i = 0; i < backends.size(); i++)
+    {
+        if (backends[i].name == name)
+            return &backends[i];
+    }
+    return NULL;
+}
+
 }} // namespace
@@ -0,0 +1,418 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+#include "opencv2/core/async.hpp"
+#include "opencv2/core/detail/async_promise.hpp"
+
+#include <opencv2/core/utils/configuration.private.hpp>
+#include <opencv2/core/utils/logger.defines.hpp>
+#undef CV_LOG_STRIP_LEVEL
+#define CV_LOG_STRIP_LEVEL CV_LOG_LEVEL_DEBUG + 1
+#include <opencv2/core/utils/logger.hpp>
+
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#endif
+
+namespace cv {
+
+namespace {
+
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+
+/** @brief Executes asynchronous tasks on background threads
+
+Threads are spawned on demand (when there is no idle thread) up to OPENCV_ASYNC_EXECUTOR_THREADS_NUM.
+Tasks usually call parallel_for_() and do the heavy lifting on the parallel backend threads.
+*/
+class AsyncExecutor
+{
+public:
+    static AsyncExecutor& getInstance()
+    {
+        CV_SINGLETON_LAZY_INIT_REF(AsyncExecutor, new AsyncExecutor())
+    }
+
+    void submit(const std::function<void()>& task)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        queue.push_back(task);
+        if (idle_threads > 0)
+        {
+            cond.notify_one();
+        }
+        else if (threads.size() < max_threads)
+        {
+            CV_LOG_DEBUG(NULL, "core(async): spawn executor thread: " << threads.size() + 1);
+            threads.push_back(std::thread(&AsyncExecutor::thread_body, this));
+        }
+    }
+
+protected:
+    AsyncExecutor()
+        : idle_threads(0)
+    {
+        size_t default_threads = (size_t)std::max(2, cv::getNumberOfCPUs());
+        max_threads = std::max((size_t)1, utils::getConfigurationParameterSizeT("OPENCV_ASYNC_EXECUTOR_THREADS_NUM", default_threads));
+    }
+
+    ~AsyncExecutor()
+    {
+        // not reachable: singleton is never destroyed, threads are terminated with the process
+    }
+
+    void thread_body()
+    {
+        (void)cv::utils::getThreadID(); // notify OpenCV about new thread
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;)
+        {
+            while (queue.empty())
+            {
+                idle_threads++;
+                cond.wait(lock);
+                idle_threads--;
+            }
+            std::function<void()> task;
+            std::swap(task, queue.front());
+            queue.pop_front();
+            lock.unlock();
+            try
+            {
+                task();
+            }
+            catch (const std::exception& e)
+            {
+                CV_LOG_ERROR(NULL, "core(async): unhandled exception in asynchronous task: " << e.what());
+            }
+            catch (...)
+            {
+                CV_LOG_ERROR(NULL, "core(async): unhandled exception in asynchronous task");
+            }
+            task = std::function<void()>();  // release captured resources out of lock
+            lock.lock();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque< std::function<void()> > queue;
+    std::vector<std::thread> threads;
+    size_t max_threads;
+    int idle_threads;
+};
+
+static inline
+void submitAsyncTask(const std::function<void()>& task)
+{
+    AsyncExecutor::getInstance().submit(task);
+}
+
+#else  // OPENCV_DISABLE_THREAD_SUPPORT
+
+static inline
+void submitAsyncTask(const std::function<void()>& task)
+{
+    task();  // no threading: execute immediately
+}
+
+#endif  // OPENCV_DISABLE_THREAD_SUPPORT
+
+/** Stores result into promise. Consumer may have already dropped the AsyncArray, this is not an error here */
+static
+void setAsyncResult(AsyncPromise& promise)
+{
+    try
+    {
+        promise.setValue(Mat());
+    }
+    catch (const cv::Exception& e)
+    {
+        CV_LOG_DEBUG(NULL, "core(async): can't store result: " << e.what());
+    }
+}
+
+static
+void setAsyncException(AsyncPromise& promise,
+#if CV__EXCEPTION_PTR
+        std::exception_ptr exception
+#else
+        const cv::Exception& exception
+#endif
+)
+{
+    try
+    {
+        promise.setException(exception);
+    }
+    catch (const cv::Exception& e)
+    {
+        CV_LOG_DEBUG(NULL, "core(async): can't store exception: " << e.what());
+    }
+}
+
+#if CV__EXCEPTION_PTR
+#define CV_ASYNC_CATCH_ALL(promise) \
+    catch (...) \
+    { \
+        setAsyncException(promise, std::current_exception()); \
+    }
+#else
+#define CV_ASYNC_CATCH_ALL(promise) \
+    catch (const cv::Exception& e) \
+    { \
+        setAsyncException(promise, e); \
+    } \
+    catch (const std::exception& e) \
+    { \
+        setAsyncException(promise, cv::Exception(Error::StsError, e.what(), CV_Func, __FILE__, __LINE__)); \
+    } \
+    catch (...) \
+    { \
+        setAsyncException(promise, cv::Exception(Error::StsError, "Unknown exception", CV_Func, __FILE__, __LINE__)); \
+    }
+#endif
+
+/** Returns the exception being handled, must be called from a catch block */
+#if CV__EXCEPTION_PTR
+typedef std::exception_ptr AsyncException;
+static
+AsyncException currentAsyncException()
+{
+    return std::current_exception();
+}
+#else
+typedef cv::Exception AsyncException;
+static
+AsyncException currentAsyncException()
+{
+    try
+    {
+        throw;
+    }
+    catch (const cv::Exception& e)
+    {
+        return e;
+    }
+    catch (const std::exception& e)
+    {
+        return cv::Exception(Error::StsError, e.what(), CV_Func, __FILE__, __LINE__);
+    }
+    catch (...)
+    {
+        return cv::Exception(Error::StsError, "Unknown exception", CV_Func, __FILE__, __LINE__);
+    }
+}
+#endif
+
+static
+void runParallelForAsync(const std::shared_ptr<AsyncPromise>& promise,
+        const Range& range, const ParallelLoopBody& body, double nstripes)
+{
+    try
+    {
+        parallel_for_(range, body, nstripes);
+        setAsyncResult(*promise);
+    }
+    CV_ASYNC_CATCH_ALL(*promise)
+}
+
+}  // namespace
+
+
+AsyncArray parallel_for_async(const Range& range, const ParallelLoopBody& body, double nstripes)
+{
+    CV_INSTRUMENT_REGION();
+
+    std::shared_ptr<AsyncPromise> promise = std::make_shared<AsyncPromise>();
+    AsyncArray result = promise->getArrayResult();
+    const ParallelLoopBody* pbody = &body;
+    submitAsyncTask([promise, range, pbody, nstripes]() {
+        runParallelForAsync(promise, range, *pbody, nstripes);
+    });
+    return result;
+}
+
+AsyncArray parallel_for_async(const Range& range, std::function<void(const Range&)> functor, double nstripes)
+{
+    CV_INSTRUMENT_REGION();
+
+    std::shared_ptr<AsyncPromise> promise = std::make_shared<AsyncPromise>();
+    AsyncArray result = promise->getArrayResult();
+    std::shared_ptr<ParallelLoopBodyLambdaWrapper> body = std::make_shared<ParallelLoopBodyLambdaWrapper>(functor);
+    submitAsyncTask([promise, range, body, nstripes]() {
+        runParallelForAsync(promise, range, *body, nstripes);
+    });
+    return result;
+}
+
+
+struct AsyncTaskGraph::Impl
+{
+    struct Node
+    {
+        std::function<void()> task;
+        std::vector<int> dependents;  // tasks waiting for this one
+        int pending;  // number of not completed dependencies
+    };
+
+    std::vector<Node> nodes;  // immutable after run() except 'pending' and 'task' fields
+    bool started;
+
+    Mutex mutex;  // guards fields below (after run() call)
+    int remaining;
+    bool failed;
+    AsyncException exception;  // the first error, reported when all started tasks are completed
+    AsyncPromise promise;
+
+    Impl() : started(false), remaining(0), failed(false) {}
+
+    int addTask(const std::function<void()>& task, const std::vector<int>& dependencies)
+    {
+        CV_Assert(!started && "AsyncTaskGraph: tasks can't be added after run() call");
+        CV_Assert(task);
+        const int id = (int)nodes.size();
+        Node node;
+        node.task = task;
+        node.pending = 0;
+        for (size_t i = 0; i < dependencies.size(); i++)
+        {
+            const int dep = dependencies[i];
+            CV_CheckGE(dep, 0, "AsyncTaskGraph: invalid dependency");
+            CV_CheckLT(dep, id, "AsyncTaskGraph: dependency must be added before the dependent task");
+            nodes[dep].dependents.push_back(id);
+            node.pending++;
+        }
+        nodes.push_back(node);
+        return id;
+    }
+
+    static void submit(const Ptr<Impl>& self, int id)
+    {
+        submitAsyncTask([self, id]() { Impl::execute(self, id); });
+    }
+
+    static void execute(const Ptr<Impl>& self, int id)
+    {
+        std::vector<int> ready;
+        for (;;)
+        {
+            Node& node = self->nodes[id];
+            bool skip = false;
+            {
+                AutoLock lock(self->mutex);
+                skip = self->failed;
+            }
+            if (!skip)
+            {
+                try
+                {
+                    node.task();
+                }
+                catch (...)
+                {
+                    // dependent tasks are skipped, the first error is reported to the consumer
+                    // when the running tasks are completed, they may use the caller's state
+                    AutoLock lock(self->mutex);
+                    if (!self->failed)
+                        self->exception = currentAsyncException();
+                    self->failed = true;
+                }
+            }
+            node.task = std::function<void()>();  // release captured resources
+
+            bool completed = false, failed = false;
+            {
+                AutoLock lock(self->mutex);
+                for (size_t i = 0; i < node.dependents.size(); i++)
+                {
+                    Node& dependent = self->nodes[node.dependents[i]];
+                    if (--dependent.pending == 0)
+                        ready.push_back(node.dependents[i]);
+                }
+                completed = (--self->remaining == 0);
+                failed = self->failed;
+            }
+            if (completed)
+            {
+                if (!failed)
+                    setAsyncResult(self->promise);
+                else
+                    setAsyncException(self->promise, self->exception);
+                return;
+            }
+            if (ready.empty())
+                return;
+            // continue with the first ready task on this thread, others go to the executor
+            id = ready.back();
+            ready.pop_back();
+            for (size_t i = 0; i < ready.size(); i++)
+                submit(self, ready[i]);
+            ready.clear();
+        }
+    }
+};
+
+AsyncTaskGraph::AsyncTaskGraph()
+    : p(makePtr<Impl>())
+{
+    // nothing
+}
+
+AsyncTaskGraph::~AsyncTaskGraph()
+{
+    // nothing: running tasks keep reference on the graph state
+}
+
+int AsyncTaskGraph::addTask(const std::function<void()>& task, const std::vector<int>& dependencies)
+{
+    CV_Assert(p);
+    return p->addTask(task, dependencies);
+}
+
+int AsyncTaskGraph::addParallelTask(const Range& range, const std::function<void(const Range&)>& functor,
+        const std::vector<int>& dependencies, double nstripes)
+{
+    CV_Assert(p);
+    return p->addTask([range, functor, nstripes]() {
+        parallel_for_(range, functor, nstripes);
+    }, dependencies);
+}
+
+size_t AsyncTaskGraph::size() const
+{
+    return p ? p->nodes.size() : 0;
+}
+
+AsyncArray AsyncTaskGraph::run()
+{
+    CV_INSTRUMENT_REGION();
+
+    CV_Assert(p);
+    CV_Assert(!p->started && "AsyncTaskGraph: graph can be executed once only");
+    Ptr<Impl> self = p;
+    self->started = true;
+    AsyncArray result = self->promise.getArrayResult();
+    std::vector<int> roots;
+    for (size_t i = 0; i < self->nodes.size(); i++)
+    {
+        if (self->nodes[i].pending == 0)
+            roots.push_back((int)i);
+    }
+    self->remaining = (int)self->nodes.size();
+    if (roots.empty())
+    {
+        setAsyncResult(self->promise);  // empty graph
+        return result;
+    }
+    for (size_t i = 0; i < roots.size(); i++)
+        Impl::submit(self, roots[i]);
+    return result;
+}
+
+}  // namespace cv
@@ -9,6 +9,10 @@
 #ifdef HAVE_PTHREADS_PF
 #include <pthread.h>
 
+#include "parallel/parallel.hpp"  // getCurrentParallelForAPI()
+
+#include <opencv2/core/utils/thread_pool.private.hpp>
+
 #include <opencv2/core/utils/configuration.private.hpp>
 
 #include <opencv2/core/utils/logger.defines.hpp>
@@ -24,6 +28,13 @@
 //#define CV_USE_GLOBAL_WORKERS_COND_VAR  // not effective on many-core systems (10+)
 
 #include <atomic>
+#include <fstream>
+
+#if defined(__linux__) && defined(_GNU_SOURCE) && !defined(__ANDROID__)
+#include <sched.h>
+#include <unistd.h>
+#define CV_THREAD_POOL_HAVE_AFFINITY 1
+#endif
 
 // Spin lock's OS-level yield
 #ifdef DECLARE_CV_YIELD
@@ -79,6 +90,173 @@ static int CV_MAIN_THREAD_ACTIVE_WAIT = (int)utils::getConfigurationParameterSiz
 
 static int CV_WORKER_ACTIVE_WAIT_THREADS_LIMIT = (int)utils::getConfigurationParameterSizeT("OPENCV_THREAD_POOL_ACTIVE_WAIT_THREADS_LIMIT", 0); // number of real cores
 
+// NUMA-aware mode: pin workers (interleaved over NUMA nodes), split jobs into per-node partitions, first touch of large Mat buffers
+static bool CV_THREAD_POOL_NUMA = utils::getConfigurationParameterBool("OPENCV_THREAD_POOL_NUMA", false);
+static bool CV_THREAD_POOL_AFFINITY = utils::getConfigurationParameterBool("OPENCV_THREAD_POOL_AFFINITY", CV_THREAD_POOL_NUMA);  // pin worker threads to cores
+static size_t CV_THREAD_POOL_NUMA_FIRST_TOUCH_THRESHOLD = utils::getConfigurationParameterSizeT("OPENCV_THREAD_POOL_NUMA_FIRST_TOUCH_THRESHOLD", 4 << 20);  // bytes
+static std::string CV_THREAD_POOL_NUMA_NODES = utils::getConfigurationParameterString("OPENCV_THREAD_POOL_NUMA_NODES", "");  // forced topology: "0-3;4-7"
+
+/** CPUs available for the process, interleaved over NUMA nodes: node0.cpu0, node1.cpu0, node0.cpu1, ... */
+struct ThreadPoolTopology
+{
+    std::vector<int> cpus;
+    std::vector<int> cpu_nodes;  // NUMA node index (0..num_nodes-1) of cpus[i]
+    std::vector<int> node_of_cpu;  // system CPU id => NUMA node index, -1 for unknown CPUs
+    int num_nodes;
+
+    static const ThreadPoolTopology& get()
+    {
+        return getInstance();
+    }
+
+    /** Re-initializes topology (sysfs or forced CPU lists of nodes). Must not be called in parallel with jobs of the pool */
+    static void reset(const std::string& forced_nodes)
+    {
+        ThreadPoolTopology& topology = getInstance();
+        topology.cpus.clear();
+        topology.cpu_nodes.clear();
+        topology.node_of_cpu.clear();
+        topology.num_nodes = 1;
+        topology.init(forced_nodes);
+    }
+
+    bool isNUMA() const { return num_nodes > 1; }
+
+    /** Returns NUMA node index of the current thread (0 if unknown) */
+    int getCurrentNode() const
+    {
+#ifdef CV_THREAD_POOL_HAVE_AFFINITY
+        int cpu = sched_getcpu();
+        if (cpu >= 0 && cpu < (int)node_of_cpu.size() && node_of_cpu[cpu] >= 0)
+            return node_of_cpu[cpu];
+#endif
+        return 0;
+    }
+
+protected:
+    ThreadPoolTopology() : num_nodes(1)
+    {
+        init(CV_THREAD_POOL_NUMA_NODES);
+    }
+
+    static ThreadPoolTopology& getInstance()
+    {
+        CV_SINGLETON_LAZY_INIT_REF(ThreadPoolTopology, new ThreadPoolTopology())
+    }
+
+    void init(const std::string& forced_nodes)
+    {
+        std::vector< std::vector<int> > node_cpus;
+        if (!forced_nodes.empty())
+        {
+            // forced topology is used as is (CPUs are not checked against the process affinity mask)
+            size_t start = 0;
+            while (start <= forced_nodes.size())
+            {
+                size_t end = std::min(forced_nodes.find(';', start), forced_nodes.size());
+                std::vector<int> list = parseList(forced_nodes.substr(start, end - start));
+                if (!list.empty())
+                    node_cpus.push_back(list);
+                start = end + 1;
+            }
+            if (!node_cpus.empty())
+            {
+                setNodes(node_cpus);
+                return;
+            }
+            CV_LOG_WARNING(NULL, "ThreadPool: can't parse NUMA nodes configuration: '" << forced_nodes << "'");
+        }
+#ifdef CV_THREAD_POOL_HAVE_AFFINITY
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (0 != sched_getaffinity(0, sizeof(allowed), &allowed))
+            return;
+        std::vector<int> nodes = parseList(readFile("/sys/devices/system/node/online"));
+        for (size_t n = 0; n < nodes.size(); n++)
+        {
+            std::vector<int> list = parseList(readFile(cv::format("/sys/devices/system/node/node%d/cpulist", nodes[n]).c_str()));
+            std::vector<int> node_list;
+            for (size_t i = 0; i < list.size(); i++)
+            {
+                if (list[i] >= 0 && list[i] < CPU_SETSIZE && CPU_ISSET(list[i], &allowed))
+                    node_list.push_back(list[i]);
+            }
+            if (!node_list.empty())
+                node_cpus.push_back(node_list);
+        }
+        if (node_cpus.empty())
+        {
+            // no NUMA information (old kernels, containers): single node
+            node_cpus.resize(1);
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+            {
+                if (CPU_ISSET(cpu, &allowed))
+                    node_cpus[0].push_back(cpu);
+            }
+        }
+        setNodes(node_cpus);
+#endif
+    }
+
+    void setNodes(const std::vector< std::vector<int> >& node_cpus)
+    {
+        num_nodes = (int)node_cpus.size();
+        for (size_t i = 0; ; i++)
+        {
+            bool added = false;
+            for (int n = 0; n < num_nodes; n++)
+            {
+                if (i < node_cpus[n].size())
+                {
+                    int cpu = node_cpus[n][i];
+                    cpus.push_back(cpu);
+                    cpu_nodes.push_back(n);
+                    if (cpu >= (int)node_of_cpu.size())
+                        node_of_cpu.resize(cpu + 1, -1);
+                    node_of_cpu[cpu] = n;
+                    added = true;
+                }
+            }
+            if (!added)
+                break;
+        }
+        CV_LOG_INFO(NULL, "ThreadPool: detected " << num_nodes << " NUMA node(s), " << cpus.size() << " CPU(s)");
+    }
+
+    static std::string readFile(const char* filename)
+    {
+        std::ifstream f(filename);
+        std::string content;
+        if (f.is_open())
+            std::getline(f, content);
+        return content;
+    }
+
+    /** parses list of form "0-1,3,5-7" */
+    static std::vector<int> parseList(const std::string& str)
+    {
+        std::vector<int> result;
+        const char* pos = str.c_str();
+        while (*pos)
+        {
+            int start = 0, end = 0, n = 0;
+            if (sscanf(pos, "%d-%d%n", &start, &end, &n) == 2)
+            { /* range */ }
+            else if (sscanf(pos, "%d%n", &start, &n) == 1)
+                end = start;
+            else
+                break;
+            for (int v = start; v <= end; v++)
+                result.push_back(v);
+            pos += n;
+            if (*pos != ',')
+                break;
+            pos++;
+        }
+        return result;
+    }
+};
+
 class WorkerThread;
 class ParallelJob;
 
@@ -130,6 +308,8 @@ public:
 
     Ptr<ParallelJob> job;
 
+    std::vector<int> numa_node_workers;  // number of worker threads per NUMA node (NUMA mode only)
+
 #ifdef CV_PROFILE_THREADS
     double tickFreq;
     int64 jobSubmitTime;
@@ -200,6 +380,9 @@ public:
     pthread_t posix_thread;
     bool is_created;
 
+    int cpu;  // pinned CPU (-1 if affinity is not used)
+    int numa_node;
+
     std::atomic<bool> stop_thread;
 
     std::atomic<bool> has_wake_signal;
@@ -217,6 +400,8 @@ public:
         id(id_),
         posix_thread(0),
         is_created(false),
+        cpu(-1),
+        numa_node(0),
         stop_thread(false),
         has_wake_signal(false)
 #if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
@@ -224,6 +409,17 @@ public:
 #endif
     {
         CV_LOG_VERBOSE(NULL, 1, "MainThread: initializing new worker: " << id);
+        if (CV_THREAD_POOL_AFFINITY || CV_THREAD_POOL_NUMA)
+        {
+            const ThreadPoolTopology& topology = ThreadPoolTopology::get();
+            if (!topology.cpus.empty())
+            {
+                size_t slot = (id + 1) % topology.cpus.size();  // slot 0 is reserved for the main thread
+                if (CV_THREAD_POOL_AFFINITY)
+                    cpu = topology.cpus[slot];
+                numa_node = topology.cpu_nodes[slot];
+            }
+        }
         int res = pthread_mutex_init(&mutex, NULL);
         if (res != 0)
         {
@@ -287,11 +483,21 @@ public:
 class ParallelJob
 {
 public:
-    ParallelJob(const ThreadPool& thread_pool_, const Range& range_, const ParallelLoopBody& body_, int nstripes_) :
+    /** Part of the job range which is preferably processed by threads of the same NUMA node */
+    struct Partition
+    {
+        std::atomic<int> current_task;
+        int end;
+        int64 dummy_[8];  // avoid cache-line reusing for the same atomics
+    };
+
+    ParallelJob(const ThreadPool& thread_pool_, const Range& range_, const ParallelLoopBody& body_, int nstripes_,
+                const std::vector<int>& numa_node_threads = std::vector<int>()) :
         thread_pool(thread_pool_),
         body(body_),
         range(range_),
         nstripes((unsigned)nstripes_),
+        num_partitions(0),
         is_completed(false)
     {
         CV_LOG_VERBOSE(NULL, 5, "ParallelJob::ParallelJob(" << (void*)this << ")");
@@ -299,6 +505,7 @@ public:
         active_thread_count.store(0, std::memory_order_relaxed);
         completed_thread_count.store(0, std::memory_order_relaxed);
         dummy0_[0] = 0, dummy1_[0] = 0, dummy2_[0] = 0; // compiler warning
+        initPartitions(numa_node_threads);
     }
 
     ~ParallelJob()
@@ -306,10 +513,75 @@ public:
         CV_LOG_VERBOSE(NULL, 5, "ParallelJob::~ParallelJob(" << (void*)this << ")");
     }
 
-    unsigned execute(bool is_worker_thread)
+    /** Splits [0, task_count) proportionally to the number of worker threads on each NUMA node.
+     *  The split doesn't depend on the calling thread, so the same rows of the same-sized jobs
+     *  are processed on the same node (first-touch locality). Empty result: no partitioning.
+     */
+    static std::vector<Range> splitTasks(int task_count, const std::vector<int>& numa_node_threads)
+    {
+        std::vector<Range> result;
+        int total_threads = 0;
+        for (size_t i = 0; i < numa_node_threads.size(); i++)
+            total_threads += numa_node_threads[i];
+        if (numa_node_threads.size() <= 1 || total_threads <= 0)
+            return result;
+        int threads_before = 0;
+        for (size_t i = 0; i < numa_node_threads.size(); i++)
+        {
+            const int start = (int)((int64)task_count * threads_before / total_threads);
+            threads_before += numa_node_threads[i];
+            result.push_back(Range(start, (int)((int64)task_count * threads_before / total_threads)));
+        }
+        return result;
+    }
+
+    void initPartitions(const std::vector<int>& numa_node_threads)
     {
-        unsigned executed_tasks = 0;
         const int task_count = range.size();
+        const std::vector<Range> tasks = splitTasks(task_count, numa_node_threads);
+        if (tasks.empty())
+            return;
+        num_partitions = (int)tasks.size();
+        partitions.reset(new Partition[num_partitions]);
+        for (int i = 0; i < num_partitions; i++)
+        {
+            Partition& p = partitions[i];
+            p.current_task.store(tasks[i].start, std::memory_order_relaxed);
+            p.end = tasks[i].end;
+            p.dummy_[0] = 0;
+        }
+        current_task.store(task_count, std::memory_order_relaxed);  // not used
+    }
+
+    bool hasFreeTasks() const
+    {
+        if (num_partitions == 0)
+            return current_task < range.size();
+        for (int i = 0; i < num_partitions; i++)
+        {
+            if (partitions[i].current_task < partitions[i].end)
+                return true;
+        }
+        return false;
+    }
+
+    unsigned execute(bool is_worker_thread, int numa_node = 0)
+    {
+        if (num_partitions == 0)
+            return execute(current_task, range.size(), is_worker_thread);
+        // own node partition first, then help other nodes
+        unsigned executed_tasks = 0;
+        for (int i = 0; i < num_partitions; i++)
+        {
+            Partition& p = partitions[(numa_node + i) % num_partitions];
+            executed_tasks += execute(p.current_task, p.end, is_worker_thread);
+        }
+        return executed_tasks;
+    }
+
+    unsigned execute(std::atomic<int>& next_task, const int task_count, bool is_worker_thread)
+    {
+        unsigned executed_tasks = 0;
         const int remaining_multiplier = std::min(nstripes,
                 std::max(
                         std::min(100u, thread_pool.num_threads * 4),
@@ -317,8 +589,8 @@ public:
                 ));  // experimental value
         for (;;)
         {
-            int chunk_size = std::max(1, (task_count - current_task) / remaining_multiplier);
-            int id = current_task.fetch_add(chunk_size, std::memory_order_seq_cst);
+            int chunk_size = std::max(1, (task_count - next_task) / remaining_multiplier);
+            int id = next_task.fetch_add(chunk_size, std::memory_order_seq_cst);
             if (id >= task_count)
                 break; // no more free tasks
 
@@ -348,6 +620,9 @@ public:
     std::atomic<int> current_task;  // next free part of job
     int64 dummy0_[8];  // avoid cache-line reusing for the same atomics
 
+    int num_partitions;  // 0 - no NUMA partitioning (current_task is used)
+    std::unique_ptr<Partition[]> partitions;
+
     std::atomic<int> active_thread_count;  // number of threads worked on this job
     int64 dummy1_[8];  // avoid cache-line reusing for the same atomics
 
@@ -375,6 +650,24 @@ void WorkerThread::thread_body()
     (void)cv::utils::getThreadID(); // notify OpenCV about new thread
     CV_LOG_VERBOSE(NULL, 5, "Thread: new thread: " << id);
 
+#ifdef CV_THREAD_POOL_HAVE_AFFINITY
+    if (cpu >= 0)
+    {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(cpu, &cpu_set);
+        int res = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+        if (res != 0)
+        {
+            CV_LOG_WARNING(NULL, "Thread: " << id << ": can't set affinity (CPU=" << cpu << "): res = " << res);
+        }
+        else
+        {
+            CV_LOG_VERBOSE(NULL, 1, "Thread: " << id << ": pinned to CPU=" << cpu << " (NUMA node index=" << numa_node << ")");
+        }
+    }
+#endif
+
     bool allow_active_wait = true;
 
 #ifdef CV_PROFILE_THREADS
@@ -430,16 +723,16 @@ void WorkerThread::thread_body()
             if (j)
             {
                 CV_LOG_VERBOSE(NULL, 5, "Thread: job size=" << j->range.size() << " done=" << j->current_task);
-                if (j->current_task < j->range.size())
+                if (j->hasFreeTasks())
                 {
                     int other = j->active_thread_count.fetch_add(1, std::memory_order_seq_cst);
                     CV_LOG_VERBOSE(NULL, 5, "Thread: processing new job (with " << other << " other threads)"); CV_UNUSED(other);
 #ifdef CV_PROFILE_THREADS
                     stat.threadExecuteStart = getTickCount();
-                    stat.executedTasks = j->execute(true);
+                    stat.executedTasks = j->execute(true, numa_node);
                     stat.threadExecuteStop = getTickCount();
 #else
-                    j->execute(true);
+                    j->execute(true, numa_node);
 #endif
                     int completed = j->completed_thread_count.fetch_add(1, std::memory_order_seq_cst) + 1;
                     int active = j->active_thread_count.load(std::memory_order_acquire);
@@ -527,7 +820,6 @@ bool ThreadPool::reconfigure_(unsigned new_threads_count)
 #endif
         threads.resize(new_threads_count);
         release_threads.clear();  // calls thread_join which want to lock mutex
-        return false;
     }
     else
     {
@@ -537,6 +829,13 @@ bool ThreadPool::reconfigure_(unsigned new_threads_count)
             threads.push_back(Ptr<WorkerThread>(new WorkerThread(*this, (unsigned)i))); // spawn more threads
         }
     }
+    numa_node_workers.clear();
+    if (CV_THREAD_POOL_NUMA && ThreadPoolTopology::get().isNUMA())
+    {
+        numa_node_workers.resize(ThreadPoolTopology::get().num_nodes, 0);
+        for (size_t i = 0; i < threads.size(); ++i)
+            numa_node_workers[threads[i]->numa_node]++;
+    }
     return false;
 }
 
@@ -576,14 +875,24 @@ void ThreadPool::run(const Range& range, const ParallelLoopBody& body, double ns
 
         {
             CV_LOG_VERBOSE(NULL, 1, "MainThread: initialize parallel job: " << range.size());
-            job = Ptr<ParallelJob>(new ParallelJob(*this, range, body, nstripes));
+            int main_numa_node = 0;
+            if (!numa_node_workers.empty())
+            {
+                // partitions follow the workers only, the calling thread starts from its node partition
+                main_numa_node = ThreadPoolTopology::get().getCurrentNode();
+                job = Ptr<ParallelJob>(new ParallelJob(*this, range, body, nstripes, numa_node_workers));
+            }
+            else
+            {
+                job = Ptr<ParallelJob>(new ParallelJob(*this, range, body, nstripes));
+            }
             pthread_mutex_unlock(&mutex);
 
             CV_LOG_VERBOSE(NULL, 5, "MainThread: wake worker threads...");
             size_t num_threads_to_wake = std::min(static_cast<size_t>(range.size()), threads.size());
             for (size_t i = 0; i < num_threads_to_wake; ++i)
             {
-                if (job->current_task >= job->range.size())
+                if (!job->hasFreeTasks())
                     break;
                 WorkerThread& thread = *(threads[i].get());
                 if (
@@ -644,12 +953,12 @@ void ThreadPool::run(const Range& range, const ParallelLoopBody& body, double ns
                 ParallelJob& j = *(this->job);
 #ifdef CV_PROFILE_THREADS
                 threads_stat[0].threadExecuteStart = getTickCount();
-                threads_stat[0].executedTasks = j.execute(false);
+                threads_stat[0].executedTasks = j.execute(false, main_numa_node);
                 threads_stat[0].threadExecuteStop = getTickCount();
 #else
-                j.execute(false);
+                j.execute(false, main_numa_node);
 #endif
-                CV_Assert(j.current_task >= j.range.size());
+                CV_Assert(!j.hasFreeTasks());
                 CV_LOG_VERBOSE(NULL, 5, "MainThread: complete self-tasks: " << j.active_thread_count << " " << j.completed_thread_count);
                 if (job->is_completed || j.active_thread_count == 0)
                 {
@@ -753,6 +1062,104 @@ void parallel_for_pthreads(const Range& range, const ParallelLoopBody& body, dou
     ThreadPool::instance().run(range, body, nstripes);
 }
 
+void parallel_pthreads_first_touch(void* data, size_t size)
+{
+    if (!CV_THREAD_POOL_NUMA || size < CV_THREAD_POOL_NUMA_FIRST_TOUCH_THRESHOLD || !data)
+        return;
+    if (cv::parallel::getCurrentParallelForAPI() || !ThreadPoolTopology::get().isNUMA())
+        return;  // pool is not used or there is nothing to optimize
+#ifdef CV_THREAD_POOL_HAVE_AFFINITY
+    const size_t page_size = (size_t)std::max(4096L, sysconf(_SC_PAGESIZE));
+#else
+    const size_t page_size = 4096;
+#endif
+    volatile uchar* ptr = (volatile uchar*)data;
+    const size_t num_pages = (size + page_size - 1) / page_size;
+    if (num_pages > (size_t)INT_MAX)
+        return;
+    // pages are mapped by the first write: let the threads which will process these rows do it.
+    // The buffer may be already filled (utils::threadPoolFirstTouch()), so its bytes are written back as is.
+    parallel_for_(Range(0, (int)num_pages), [&](const Range& r)
+    {
+        for (int i = r.start; i < r.end; i++)
+            ptr[i * page_size] = ptr[i * page_size];
+    });
+}
+
+}
+
+namespace cv { namespace utils {
+
+void threadPoolFirstTouch(void* data, size_t size)
+{
+    parallel_pthreads_first_touch(data, size);
+}
+
+void setThreadPoolNUMAConfiguration(bool enable, const std::string& nodes)
+{
+    ThreadPool& pool = ThreadPool::instance();
+    pthread_mutex_lock(&pool.mutex);
+    CV_THREAD_POOL_NUMA = enable;
+    CV_THREAD_POOL_NUMA_NODES = nodes;
+    ThreadPoolTopology::reset(nodes);
+    pool.reconfigure_(0);  // workers are re-created with the new topology by the next job
+    pthread_mutex_unlock(&pool.mutex);
+}
+
+int getThreadPoolNUMANodes()
+{
+    return ThreadPoolTopology::get().num_nodes;
+}
+
+std::vector<Range> getThreadPoolNUMAPartitions(const Range& range)
+{
+    ThreadPool& pool = ThreadPool::instance();
+    pthread_mutex_lock(&pool.mutex);
+    pool.reconfigure_(pool.num_threads - 1);  // as the next job does
+    std::vector<Range> result = ParallelJob::splitTasks(range.size(), pool.numa_node_workers);
+    pthread_mutex_unlock(&pool.mutex);
+    for (size_t i = 0; i < result.size(); i++)
+        result[i] = result[i] + range.start;
+    return result;
+}
+
+}}  // namespace cv::utils
+
+#else  // HAVE_PTHREADS_PF
+
+#include <opencv2/core/utils/thread_pool.private.hpp>
+
+namespace cv {
+
+void parallel_pthreads_first_touch(void* /*data*/, size_t /*size*/)
+{
+    // nothing
+}
+
+namespace utils {
+
+void threadPoolFirstTouch(void* /*data*/, size_t /*size*/)
+{
+    // nothing
+}
+
+void setThreadPoolNUMAConfiguration(bool /*enable*/, const std::string& /*nodes*/)
+{
+    // nothing
+}
+
+int getThreadPoolNUMANodes()
+{
+    return 1;
+}
+
+std::vector<Range> getThreadPoolNUMAPartitions(const Range& /*range*/)
+{
+    return std::vector<Range>();
+}
+
+}  // namespace utils
+
 }
 
 #endif
@@ -12,6 +12,11 @@ void parallel_for_pthreads(const Range& range, const ParallelLoopBody& body, dou
 size_t parallel_pthreads_get_threads_num();
 void parallel_pthreads_set_threads_num(int num);
 
+/** Touches pages of the new buffer by the thread pool workers (NUMA first-touch policy).
+ *  No-op unless OPENCV_THREAD_POOL_NUMA is enabled on a NUMA system.
+ */
+void parallel_pthreads_first_touch(void* data, size_t size);
+
 }
 
 #endif // OPENCV_CORE_PARALLEL_IMPL_HPP
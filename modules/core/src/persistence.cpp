@@ -377,6 +377,11 @@ static inline void writeReal(uchar* p, double fval)
 
 
 
+namespace {
+//! thrown by FileStorage::Impl::emitStreamNode() to stop parsing when the callback doesn't need more nodes
+struct StreamReadingStopped {};
+}
+
 void FileStorage::Impl::init() {
     flags = 0;
     buffer.clear();
@@ -415,6 +420,10 @@ void FileStorage::Impl::init() {
     str_hash_data.resize(1);
     str_hash_data[0] = '\0';
 
+    has_stream_root = has_stream_node = false;
+    stream_root_blockIdx = stream_root_ofs = 0;
+    stream_node_blockIdx = stream_node_ofs = 0;
+
     filename.clear();
     lineno = 0;
 }
@@ -441,6 +450,8 @@ void FileStorage::Impl::release(String *out) {
                 puts("</opencv_storage>\n");
             else if (fmt == FileStorage::FORMAT_JSON)
                 puts("}\n");
+            else if (fmt == FileStorage::FORMAT_BINARY)
+                getEmitter().endWriting();
         }
         if (mem_mode && out) {
             *out = cv::String(outbuf.begin(), outbuf.end());
@@ -476,7 +487,7 @@ void FileStorage::Impl::analyze_file_name(const std::string &file_name, std::vec
     }
 }
 
-bool FileStorage::Impl::open(const char *filename_or_buf, int _flags, const char *encoding) {
+bool FileStorage::Impl::open(const char *filename_or_buf, int _flags, const char *encoding, size_t bufSize) {
     bool ok = true;
     release();
 
@@ -576,7 +587,9 @@ bool FileStorage::Impl::open(const char *filename_or_buf, int _flags, const char
                   ? FileStorage::FORMAT_XML
                   : (fs::strcasecmp(dot_pos, ".json") == 0 || fs::strcasecmp(dot_pos, ".json.gz") == 0)
                     ? FileStorage::FORMAT_JSON
-                    : FileStorage::FORMAT_YAML;
+                    : (fs::strcasecmp(dot_pos, ".cvbin") == 0 || fs::strcasecmp(dot_pos, ".cvbin.gz") == 0)
+                      ? FileStorage::FORMAT_BINARY
+                      : FileStorage::FORMAT_YAML;
         } else if (fmt == FileStorage::FORMAT_AUTO) {
             fmt = FileStorage::FORMAT_XML;
         }
@@ -597,10 +610,24 @@ bool FileStorage::Impl::open(const char *filename_or_buf, int _flags, const char
         buffer.reserve(buf_size + 1024);
         buffer.resize(buf_size);
         bufofs = 0;
-        is_using_base64 = write_base64;
+        is_using_base64 = write_base64 && fmt != FileStorage::FORMAT_BINARY;
         state_of_writing_base64 = FileStorage_API::Base64State::Uncertain;
 
-        if (fmt == FileStorage::FORMAT_XML) {
+        if (fmt == FileStorage::FORMAT_BINARY) {
+            if (append)
+                CV_Error(cv::Error::StsNotImplemented, "Appending data to binary file storage is not implemented");
+            if (file) {
+                // reopen in binary mode (matters on Windows)
+                fclose(file);
+                file = fopen(filename.c_str(), "wb");
+                if (!file)
+                {
+                    CV_LOG_ERROR(NULL, "Can't open file: '" << filename << "' in write mode");
+                    return false;
+                }
+            }
+            emitter_do_not_use_direct_dereference = createBinaryEmitter(this);
+        } else if (fmt == FileStorage::FORMAT_XML) {
             size_t file_size = file ? (size_t) ftell(file) : (size_t) 0;
             if (!append || file_size == 0) {
                 if (encoding && *encoding != '\0') {
@@ -700,26 +727,44 @@ bool FileStorage::Impl::open(const char *filename_or_buf, int _flags, const char
             strbufsize = strlen(strbuf);
         }
 
-        const char *yaml_signature = "%YAML";
-        const char *json_signature = "{";
-        const char *xml_signature = "<?xml";
-        char *buf = this->gets(16);
-        CV_Assert(buf);
-        char *bufPtr = cv_skip_BOM(buf);
-        size_t bufOffset = bufPtr - buf;
-
-        if (strncmp(bufPtr, yaml_signature, strlen(yaml_signature)) == 0)
-            fmt = FileStorage::FORMAT_YAML;
-        else if (strncmp(bufPtr, json_signature, strlen(json_signature)) == 0)
-            fmt = FileStorage::FORMAT_JSON;
-        else if (strncmp(bufPtr, xml_signature, strlen(xml_signature)) == 0)
-            fmt = FileStorage::FORMAT_XML;
-        else if (strbufsize == bufOffset)
-            CV_Error(cv::Error::StsBadArg, "Input file is invalid");
-        else
-            CV_Error(cv::Error::StsBadArg, "Unsupported file storage format");
-
+        // binary storage is detected by the signature, it may contain zero bytes
+        char binbuf[16] = {0};
+        if (checkBinaryStorageSignature(binbuf, getBytes(binbuf, sizeof(binbuf)))) {
+            fmt = FileStorage::FORMAT_BINARY;
+            if (mem_mode)
+                strbufsize = std::max(strbufsize, bufSize);
+            else if (file) {
+                // reopen in binary mode (matters on Windows)
+                fclose(file);
+                file = fopen(filename.c_str(), "rb");
+                CV_Assert(file != 0);
+            }
+        }
         rewind();
+
+        size_t bufOffset = 0;
+        if (fmt != FileStorage::FORMAT_BINARY) {
+            const char *yaml_signature = "%YAML";
+            const char *json_signature = "{";
+            const char *xml_signature = "<?xml";
+            char *buf = this->gets(16);
+            CV_Assert(buf);
+            char *bufPtr = cv_skip_BOM(buf);
+            bufOffset = bufPtr - buf;
+
+            if (strncmp(bufPtr, yaml_signature, strlen(yaml_signature)) == 0)
+                fmt = FileStorage::FORMAT_YAML;
+            else if (strncmp(bufPtr, json_signature, strlen(json_signature)) == 0)
+                fmt = FileStorage::FORMAT_JSON;
+            else if (strncmp(bufPtr, xml_signature, strlen(xml_signature)) == 0)
+                fmt = FileStorage::FORMAT_XML;
+            else if (strbufsize == bufOffset)
+                CV_Error(cv::Error::StsBadArg, "Input file is invalid");
+            else
+                CV_Error(cv::Error::StsBadArg, "Unsupported file storage format");
+
+            rewind();
+        }
         strbufpos = bufOffset;
         bufofs = 0;
 
@@ -745,6 +790,9 @@ bool FileStorage::Impl::open(const char *filename_or_buf, int _flags, const char
                 case FileStorage::FORMAT_JSON:
                     parser_do_not_use_direct_dereference = createJSONParser(this);
                     break;
+                case FileStorage::FORMAT_BINARY:
+                    parser_do_not_use_direct_dereference = createBinaryParser(this);
+                    break;
                 default:
                     parser_do_not_use_direct_dereference = Ptr<FileStorageParser>();
             }
@@ -752,7 +800,9 @@ bool FileStorage::Impl::open(const char *filename_or_buf, int _flags, const char
             if (!parser_do_not_use_direct_dereference.empty()) {
                 ok = getParser().parse(ptr);
                 if (ok) {
+                    emitStreamNode();
                     finalizeCollection(root_nodes);
+                    buildRawSeqElements(root_nodes);
 
                     CV_Assert(!fs_data_ptrs.empty());
                     FileNode roots_node(fs_ext, 0, 0);
@@ -764,6 +814,10 @@ bool FileStorage::Impl::open(const char *filename_or_buf, int _flags, const char
                 }
             }
         }
+        catch (const StreamReadingStopped&)
+        {
+            // the rest of the file is not needed (see FileStorage::readTopLevelNodes())
+        }
         catch (...)
         {
             // FIXIT log error message
@@ -796,6 +850,54 @@ void FileStorage::Impl::puts(const char *str) {
         CV_Error(cv::Error::StsError, "The storage is not opened");
 }
 
+void FileStorage::Impl::putBytes(const void *data, size_t len) {
+    CV_Assert(write_mode);
+    const char *ptr = (const char *) data;
+    if (mem_mode)
+        outbuf.insert(outbuf.end(), ptr, ptr + len);
+    else if (file) {
+        if (fwrite(ptr, 1, len, file) != len)
+            CV_Error(cv::Error::StsError, "Can't write data to the file");
+    }
+#if USE_ZLIB
+    else if (gzfile) {
+        for (size_t ofs = 0; ofs < len; ) {
+            unsigned count = (unsigned) std::min(len - ofs, (size_t) (INT_MAX / 2));
+            if (gzwrite(gzfile, ptr + ofs, count) != (int) count)
+                CV_Error(cv::Error::StsError, "Can't write data to the archive");
+            ofs += count;
+        }
+    }
+#endif
+    else
+        CV_Error(cv::Error::StsError, "The storage is not opened");
+}
+
+size_t FileStorage::Impl::getBytes(void *data, size_t len) {
+    if (strbuf) {
+        size_t count = std::min(len, strbufsize - strbufpos);
+        memcpy(data, strbuf + strbufpos, count);
+        strbufpos += count;
+        return count;
+    }
+    if (file)
+        return fread(data, 1, len, file);
+#if USE_ZLIB
+    if (gzfile) {
+        size_t ofs = 0;
+        while (ofs < len) {
+            unsigned count = (unsigned) std::min(len - ofs, (size_t) (INT_MAX / 2));
+            int n = gzread(gzfile, (char *) data + ofs, count);
+            if (n <= 0)
+                break;
+            ofs += (size_t) n;
+        }
+        return ofs;
+    }
+#endif
+    CV_Error(cv::Error::StsError, "The storage is not opened");
+}
+
 char *FileStorage::Impl::getsFromFile(char *buf, int count) {
     if (file)
         return fgets(buf, count, file);
@@ -1000,6 +1102,12 @@ void FileStorage::Impl::startWriteStruct_helper(const char *key, int struct_flag
 
 void FileStorage::Impl::startWriteStruct(const char *key, int struct_flags,
                                          const char *type_name) {
+    if (fmt == FileStorage::FORMAT_BINARY) {
+        // raw data is stored as is, Base64 is not used
+        startWriteStruct_helper(key, struct_flags, type_name);
+        return;
+    }
+
     check_if_write_struct_is_delayed(false);
     if (state_of_writing_base64 == FileStorage_API::NotUse)
         switch_to_Base64_state(FileStorage_API::Uncertain);
@@ -1069,6 +1177,11 @@ void FileStorage::Impl::write(const String &key, const String &value) {
 void FileStorage::Impl::writeRawData(const std::string &dt, const void *_data, size_t len) {
     CV_Assert(write_mode);
 
+    if (fmt == FileStorage::FORMAT_BINARY) {
+        getEmitter().writeRawData(dt.c_str(), _data, len);
+        return;
+    }
+
     if (is_using_base64 || state_of_writing_base64 == FileStorage_API::Base64State::InUse) {
         writeRawDataBase64(_data, len, dt.c_str());
         return;
@@ -1483,6 +1596,7 @@ uchar *FileStorage::Impl::reserveNodeSpace(FileNode &node, size_t sz) {
         if (ofs ==
             0)  // FileNode is a first component of this block. Resize current block instead of allocation of new one.
         {
+            fs_data[blockIdx]->reserve(sz);
             fs_data[blockIdx]->resize(sz);
             ptr = &fs_data[blockIdx]->at(0);
             fs_data_ptrs[blockIdx] = ptr;
@@ -1532,8 +1646,15 @@ unsigned FileStorage::Impl::getStringOfs(const std::string &key) const {
 FileNode FileStorage::Impl::addNode(FileNode &collection, const std::string &key,
                                     int elem_type, const void *value, int len) {
     FileStorage_API *fs = this;
+    bool streamNode = false;
+    if (stream_callback) {
+        streamNode = isStreamRoot(collection);
+        if (streamNode || (collection.blockIdx == 0 && collection.ofs == 0))
+            emitStreamNode();  // the previous top-level node is complete
+    }
     bool noname = key.empty() || (fmt == FileStorage::FORMAT_XML && strcmp(key.c_str(), "_") == 0);
     convertToCollection(noname ? FileNode::SEQ : FileNode::MAP, collection);
+    expandRawSeq(collection);
 
     bool isseq = collection.empty() ? false : collection.isSeq();
     if (noname != isseq)
@@ -1571,7 +1692,7 @@ FileNode FileStorage::Impl::addNode(FileNode &collection, const std::string &key
 
     if (elem_type == FileNode::SEQ || elem_type == FileNode::MAP) {
         writeInt(ptr, 4);
-        writeInt(ptr, 0);
+        writeInt(ptr + 4, 0);
     }
 
     if (value)
@@ -1582,10 +1703,25 @@ FileNode FileStorage::Impl::addNode(FileNode &collection, const std::string &key
     int nelems = readInt(cp + 5);
     writeInt(cp + 5, nelems + 1);
 
+    if (stream_callback) {
+        if (collection.blockIdx == 0 && collection.ofs == 0) {
+            // root of the new stream
+            has_stream_root = true;
+            stream_root_blockIdx = node.blockIdx;
+            stream_root_ofs = node.ofs;
+        } else if (streamNode) {
+            has_stream_node = true;
+            stream_node_blockIdx = node.blockIdx;
+            stream_node_ofs = node.ofs;
+        }
+    }
+
     return node;
 }
 
 void FileStorage::Impl::finalizeCollection(FileNode &collection) {
+    if (stream_callback && isStreamRoot(collection))
+        emitStreamNode();
     if (!collection.isSeq() && !collection.isMap())
         return;
     uchar *ptr0 = collection.ptr(), *ptr = ptr0 + 1;
@@ -1618,6 +1754,44 @@ void FileStorage::Impl::normalizeNodeOfs(size_t &blockIdx, size_t &ofs) const {
     }
 }
 
+// Nodes may be moved to the next block while they are parsed (see reserveNodeSpace()),
+// the saved positions of the stream root and the top-level node are normalized before use.
+bool FileStorage::Impl::isStreamRoot(const FileNode &collection) const {
+    if (!has_stream_root)
+        return false;
+    size_t blockIdx = stream_root_blockIdx, ofs = stream_root_ofs;
+    normalizeNodeOfs(blockIdx, ofs);
+    return collection.blockIdx == blockIdx && collection.ofs == ofs;
+}
+
+void FileStorage::Impl::emitStreamNode() {
+    if (!has_stream_node)
+        return;
+    has_stream_node = false;
+
+    size_t blockIdx = stream_node_blockIdx, ofs = stream_node_ofs;
+    normalizeNodeOfs(blockIdx, ofs);
+    buildRawSeqElements(FileNode(fs_ext, blockIdx, ofs));
+    bool proceed = stream_callback(FileNode(fs_ext, blockIdx, ofs));
+
+    // storage of the node is reused by the next top-level node
+    fs_data.resize(blockIdx + 1);
+    fs_data_ptrs.resize(blockIdx + 1);
+    fs_data_blksz.resize(blockIdx + 1);
+    memset(fs_data_ptrs[blockIdx] + ofs, 0, fs_data_blksz[blockIdx] - ofs);
+    freeSpaceOfs = ofs;
+
+    // the stream root contains the node being parsed only
+    size_t rootBlockIdx = stream_root_blockIdx, rootOfs = stream_root_ofs;
+    normalizeNodeOfs(rootBlockIdx, rootOfs);
+    uchar *rptr = fs_data_ptrs[rootBlockIdx] + rootOfs;
+    rptr += 1 + ((*rptr & FileNode::NAMED) ? 4 : 0);
+    writeInt(rptr + 4, 0);
+
+    if (!proceed)
+        throw StreamReadingStopped();
+}
+
 FileStorage::Impl::Base64State FileStorage::Impl::get_state_of_writing_base64() {
     return state_of_writing_base64;
 }
@@ -1696,18 +1870,20 @@ bool FileStorage::Impl::Base64Decoder::readMore(int needed) {
     }
 
     int i = 0, j, n = (int) encoded.size();
-    if (n > 0) {
+    if (n >= 4) {
         const uchar *tab = base64tab;
-        char *src = &encoded[0];
+        const char *src = &encoded[0];
+        decoded.resize(sz + (n / 4) * 3);
+        uchar *dst = &decoded[sz];
 
-        for (; i <= n - 4; i += 4) {
+        for (; i <= n - 4; i += 4, dst += 3) {
             // dddddd cccccc bbbbbb aaaaaa => ddddddcc ccccbbbb bbaaaaaa
             uchar d = tab[(int) (uchar) src[i]], c = tab[(int) (uchar) src[i + 1]];
             uchar b = tab[(int) (uchar) src[i + 2]], a = tab[(int) (uchar) src[i + 3]];
 
-            decoded.push_back((uchar) ((d << 2) | (c >> 4)));
-            decoded.push_back((uchar) ((c << 4) | (b >> 2)));
-            decoded.push_back((uchar) ((b << 6) | a));
+            dst[0] = (uchar) ((d << 2) | (c >> 4));
+            dst[1] = (uchar) ((c << 4) | (b >> 2));
+            dst[2] = (uchar) ((b << 6) | a);
         }
     }
 
@@ -1762,6 +1938,16 @@ double FileStorage::Impl::Base64Decoder::getFloat64() {
 
 bool FileStorage::Impl::Base64Decoder::endOfStream() const { return eos; }
 
+const uchar *FileStorage::Impl::Base64Decoder::peek(size_t &count) const {
+    count = decoded.size() - ofs;
+    return count > 0 ? &decoded[ofs] : 0;
+}
+
+void FileStorage::Impl::Base64Decoder::skip(size_t count) {
+    CV_Assert(ofs + count <= decoded.size());
+    ofs += count;
+}
+
 char *FileStorage::Impl::Base64Decoder::getPtr() const { return ptr; }
 
 
@@ -1783,63 +1969,314 @@ char *FileStorage::Impl::parseBase64(char *ptr, int indent, FileNode &collection
 
     int fmt_pairs[CV_FS_MAX_FMT_PAIRS * 2];
     int fmt_pair_count = fs::decodeFormat(dt, fmt_pairs, CV_FS_MAX_FMT_PAIRS);
-    int ival = 0;
-    double fval = 0;
+    for (k = 0; k < fmt_pair_count; k++) {
+        int elem_type = fmt_pairs[k * 2 + 1];
+        if (elem_type != CV_8U && elem_type != CV_8S && elem_type != CV_16U && elem_type != CV_16S &&
+            elem_type != CV_32S && elem_type != CV_32F && elem_type != CV_64F && elem_type != CV_16F)
+            CV_Error(Error::StsUnsupportedFormat, "Unsupported type");
+    }
 
+    // The decoded data is appended to the collection as is, without the element nodes (see addRawNodes()),
+    // all elements decoded from the current row at once.
+    k = i = 0;
     for (;;) {
-        for (k = 0; k < fmt_pair_count; k++) {
-            int elem_type = fmt_pairs[k * 2 + 1];
-            int count = fmt_pairs[k * 2];
+        size_t avail = 0;
+        const uchar *src = base64decoder.peek(avail);
+        if (avail > 0)
+            base64decoder.skip(addRawNodes(collection, fmt_pairs, fmt_pair_count, src, avail, k, i));
+        if (base64decoder.endOfStream())
+            break;
+        base64decoder.readMore(1);
+    }
 
-            for (i = 0; i < count; i++) {
-                int node_type = FileNode::INT;
-                switch (elem_type) {
-                    case CV_8U:
-                        ival = base64decoder.getUInt8();
-                        break;
-                    case CV_8S:
-                        ival = (char) base64decoder.getUInt8();
-                        break;
-                    case CV_16U:
-                        ival = base64decoder.getUInt16();
-                        break;
-                    case CV_16S:
-                        ival = (short) base64decoder.getUInt16();
-                        break;
-                    case CV_32S:
-                        ival = base64decoder.getInt32();
-                        break;
-                    case CV_32F: {
-                        Cv32suf v;
-                        v.i = base64decoder.getInt32();
-                        fval = v.f;
-                        node_type = FileNode::REAL;
-                    }
-                        break;
-                    case CV_64F:
-                        fval = base64decoder.getFloat64();
-                        node_type = FileNode::REAL;
-                        break;
-                    case CV_16F:
-                        fval = float(hfloatFromBits(base64decoder.getUInt16()));
-                        node_type = FileNode::REAL;
-                        break;
-                    default:
-                        CV_Error(Error::StsUnsupportedFormat, "Unsupported type");
-                }
+    finalizeCollection(collection);
+    return base64decoder.getPtr();
+}
 
-                if (base64decoder.endOfStream())
-                    break;
-                addNode(collection, std::string(), node_type,
-                        node_type == FileNode::INT ? (void *) &ival : (void *) &fval, -1);
+// Layout of the raw data sequence (CV_FS_RAW_SEQ) after the tag and the name:
+// rawSize and nelems (as in the other collections), blockIdx and ofs of the element nodes (-1 until they are built),
+// fmt_pair_count, fmt_pairs[fmt_pair_count*2] and the packed little-endian data
+enum { RAW_SEQ_HDR_SIZE = 20 };
+
+struct RawSeqInfo {
+    uchar *hdr;
+    int fmt_pairs[CV_FS_MAX_FMT_PAIRS * 2];
+    int fmt_pair_count;
+    uchar *data;
+    size_t size;
+    size_t nelems;
+};
+
+static bool getRawSeqInfo(const uchar *p0, RawSeqInfo &info) {
+    if (!(*p0 & CV_FS_RAW_SEQ))
+        return false;
+    uchar *p = (uchar *) p0 + 1 + ((*p0 & FileNode::NAMED) ? 4 : 0);
+    info.hdr = p;
+    info.nelems = (size_t) (unsigned) readInt(p + 4);
+    info.fmt_pair_count = readInt(p + 16);
+    for (int k = 0; k < info.fmt_pair_count * 2; k++)
+        info.fmt_pairs[k] = readInt(p + RAW_SEQ_HDR_SIZE + k * 4);
+    size_t hdrSize = RAW_SEQ_HDR_SIZE + (size_t) info.fmt_pair_count * 8;
+    info.data = p + hdrSize;
+    info.size = (size_t) (unsigned) readInt(p) + 4 - hdrSize;
+    return true;
+}
+
+static inline size_t rawElemSize(int elem_type, bool nodes) {
+    return nodes ? (elem_type <= CV_32S ? 5 : 9) : (size_t) CV_ELEM_SIZE1(elem_type);
+}
+
+// Returns offset of the idx-th element in the sequence of elements of the given format,
+// either in the packed data or among the element nodes. (k, i) is set to the element position in the format.
+static size_t rawElemOfs(const int *fmt_pairs, int fmt_pair_count, size_t idx, bool nodes, int &k, int &i) {
+    size_t period = 0, periodSize = 0;
+    for (k = 0; k < fmt_pair_count; k++) {
+        period += (size_t) fmt_pairs[k * 2];
+        periodSize += (size_t) fmt_pairs[k * 2] * rawElemSize(fmt_pairs[k * 2 + 1], nodes);
+    }
+    size_t ofs = idx / period * periodSize;
+    idx %= period;
+    for (k = 0;; k++) {
+        size_t count = (size_t) fmt_pairs[k * 2], esz = rawElemSize(fmt_pairs[k * 2 + 1], nodes);
+        if (idx < count) {
+            i = (int) idx;
+            return ofs + idx * esz;
+        }
+        ofs += count * esz;
+        idx -= count;
+    }
+}
+
+// Converts packed little-endian elements to INT/REAL nodes, stops at the first incomplete element.
+// Returns the number of consumed bytes.
+static size_t writeRawElementNodes(uchar *&dst, const int *fmt_pairs, int fmt_pair_count,
+                                   const uchar *src, size_t len, int &k, int &i, size_t &nelems) {
+    const uchar *src0 = src;
+    for (;;) {
+        int elem_type = fmt_pairs[k * 2 + 1];
+        size_t esz = (size_t) CV_ELEM_SIZE1(elem_type);
+        if ((size_t) (src - src0) + esz > len)
+            break;
+
+        switch (elem_type) {
+            case CV_8U:
+                *dst = FileNode::INT;
+                writeInt(dst + 1, *src);
+                break;
+            case CV_8S:
+                *dst = FileNode::INT;
+                writeInt(dst + 1, (schar) *src);
+                break;
+            case CV_16U:
+                *dst = FileNode::INT;
+                writeInt(dst + 1, (ushort) (src[0] + (src[1] << 8)));
+                break;
+            case CV_16S:
+                *dst = FileNode::INT;
+                writeInt(dst + 1, (short) (src[0] + (src[1] << 8)));
+                break;
+            case CV_32S:
+                *dst = FileNode::INT;
+                writeInt(dst + 1, readInt(src));
+                break;
+            case CV_32F: {
+                Cv32suf v;
+                v.i = readInt(src);
+                *dst = FileNode::REAL;
+                writeReal(dst + 1, v.f);
             }
+                break;
+            case CV_64F:
+                *dst = FileNode::REAL;
+                writeReal(dst + 1, readReal(src));
+                break;
+            default: // CV_16F
+                *dst = FileNode::REAL;
+                writeReal(dst + 1, float(hfloatFromBits((ushort) (src[0] + (src[1] << 8)))));
+                break;
         }
-        if (base64decoder.endOfStream())
+        dst += *dst == FileNode::INT ? 5 : 9;
+        src += esz;
+        nelems++;
+
+        if (++i >= fmt_pairs[k * 2]) {
+            i = 0;
+            if (++k >= fmt_pair_count)
+                k = 0;
+        }
+    }
+    return (size_t) (src - src0);
+}
+
+size_t FileStorage::Impl::addRawNodes(FileNode &collection, const int *fmt_pairs, int fmt_pair_count,
+                                     const uchar *src, size_t len, int &k, int &i, size_t sizeHint) {
+    // only whole elements are consumed
+    size_t period = 0, periodSize = 0;
+    for (int j = 0; j < fmt_pair_count; j++) {
+        period += (size_t) fmt_pairs[j * 2];
+        periodSize += (size_t) fmt_pairs[j * 2] * CV_ELEM_SIZE1(fmt_pairs[j * 2 + 1]);
+    }
+    size_t nbytes = 0, nelems = 0;
+    int k1 = k, i1 = i;
+    for (;;) {
+        if (k1 == 0 && i1 == 0) {
+            size_t n = (len - nbytes) / periodSize;
+            nbytes += n * periodSize;
+            nelems += n * period;
+        }
+        size_t esz = (size_t) CV_ELEM_SIZE1(fmt_pairs[k1 * 2 + 1]);
+        size_t n = std::min((size_t) (fmt_pairs[k1 * 2] - i1), (len - nbytes) / esz);
+        if (n == 0)
             break;
+        nbytes += n * esz;
+        nelems += n;
+        if ((i1 += (int) n) >= fmt_pairs[k1 * 2]) {
+            i1 = 0;
+            if (++k1 >= fmt_pair_count)
+                k1 = 0;
+        }
     }
+    if (nelems == 0)
+        return 0;
 
-    finalizeCollection(collection);
-    return base64decoder.getPtr();
+    if (collection.type() != FileNode::SEQ)
+        convertToCollection(FileNode::SEQ, collection);
+
+    RawSeqInfo info;
+    bool raw = getRawSeqInfo(collection.ptr(), info);
+    if (raw) {
+        int k0 = 0, i0 = 0;
+        rawElemOfs(info.fmt_pairs, info.fmt_pair_count, info.nelems, false, k0, i0);
+        if (info.fmt_pair_count != fmt_pair_count || k0 != k || i0 != i ||
+            memcmp(info.fmt_pairs, fmt_pairs, fmt_pair_count * 2 * sizeof(fmt_pairs[0])) != 0) {
+            expandRawSeq(collection);
+            raw = false;
+        }
+    }
+    if (!raw && (collection.size() > 0 || k != 0 || i != 0))
+        return addRawElementNodes(collection, fmt_pairs, fmt_pair_count, src, len, k, i);
+
+    // the sequence is the last node in the storage, it grows in place when possible
+    const uchar *p0 = collection.ptr();
+    size_t hdrOfs = 1 + ((*p0 & FileNode::NAMED) ? 4 : 0);
+    size_t size0 = raw ? (size_t) (info.data - p0) + info.size :
+                   hdrOfs + RAW_SEQ_HDR_SIZE + (size_t) fmt_pair_count * 8;
+    size_t size = size0 + nbytes;
+    uchar *ptr;
+    if (collection.ofs + size <= fs_data_blksz[collection.blockIdx])
+        ptr = reserveNodeSpace(collection, size);
+    else {
+        size_t capacity = size * 2;
+        if (sizeHint >= nbytes)
+            capacity = std::min(capacity, size0 + sizeHint);
+        capacity = std::max(capacity, size);
+        std::vector<uchar> saved;
+        if (raw && collection.ofs != 0)
+            saved.assign(p0, p0 + size0);
+        ptr = reserveNodeSpace(collection, capacity);
+        if (!saved.empty())
+            memcpy(ptr, saved.data(), size0);
+    }
+    freeSpaceOfs = collection.ofs + size;
+
+    uchar *p = ptr + hdrOfs;
+    if (!raw) {
+        ptr[0] |= CV_FS_RAW_SEQ;
+        writeInt(p + 4, 0);
+        writeInt(p + 8, -1);
+        writeInt(p + 12, -1);
+        writeInt(p + 16, fmt_pair_count);
+        for (int j = 0; j < fmt_pair_count * 2; j++)
+            writeInt(p + RAW_SEQ_HDR_SIZE + j * 4, fmt_pairs[j]);
+    }
+    memcpy(ptr + size0, src, nbytes);
+    writeInt(p, (int) (size - hdrOfs - 4));
+    writeInt(p + 4, readInt(p + 4) + (int) nelems);
+
+    k = k1;
+    i = i1;
+    return nbytes;
+}
+
+size_t FileStorage::Impl::addRawElementNodes(FileNode &collection, const int *fmt_pairs, int fmt_pair_count,
+                                            const uchar *src, size_t len, int &k, int &i) {
+    if (len == 0)
+        return 0;
+    if (collection.type() != FileNode::SEQ)
+        convertToCollection(FileNode::SEQ, collection);
+
+    // at most 1 element per byte, at most 9 bytes per node
+    FileNode node(fs_ext, fs_data_ptrs.size() - 1, freeSpaceOfs);
+    uchar *dst = reserveNodeSpace(node, len * 9);
+    uchar *dst0 = dst;
+    size_t nelems = 0;
+    size_t consumed = writeRawElementNodes(dst, fmt_pairs, fmt_pair_count, src, len, k, i, nelems);
+
+    freeSpaceOfs = node.ofs + (size_t) (dst - dst0);
+
+    uchar *cp = collection.ptr() + 1 + (collection.isNamed() ? 4 : 0);
+    writeInt(cp + 4, readInt(cp + 4) + (int) nelems);
+    return consumed;
+}
+
+void FileStorage::Impl::expandRawSeq(FileNode &collection) {
+    RawSeqInfo info;
+    if (!getRawSeqInfo(collection.ptr(), info))
+        return;
+    std::vector<uchar> data(info.data, info.data + info.size);
+    size_t hdrOfs = (size_t) (info.hdr - collection.ptr());
+
+    uchar *ptr = reserveNodeSpace(collection, hdrOfs + 8);
+    ptr[0] &= ~CV_FS_RAW_SEQ;
+    writeInt(ptr + hdrOfs, 4);
+    writeInt(ptr + hdrOfs + 4, 0);
+
+    int k = 0, i = 0;
+    addRawElementNodes(collection, info.fmt_pairs, info.fmt_pair_count, data.data(), data.size(), k, i);
+}
+
+static void findRawSeqs(const FileNode &node, std::vector<FileNode> &rawSeqs) {
+    if (!node.isSeq() && !node.isMap())
+        return;
+    if (*node.ptr() & CV_FS_RAW_SEQ) {
+        rawSeqs.push_back(node);
+        return;
+    }
+    for (FileNodeIterator it = node.begin(), it_end = node.end(); it != it_end; ++it)
+        findRawSeqs(*it, rawSeqs);
+}
+
+// The element nodes are appended to the storage once the node is parsed, so that reading
+// the storage never modifies it. The nodes are found first, appending doesn't move them.
+void FileStorage::Impl::buildRawSeqElements(const FileNode &node) {
+    std::vector<FileNode> rawSeqs;
+    findRawSeqs(node, rawSeqs);
+    for (size_t j = 0; j < rawSeqs.size(); j++) {
+        RawSeqInfo info;
+        getRawSeqInfo(rawSeqs[j].ptr(), info);
+        if (readInt(info.hdr + 8) >= 0)
+            continue;
+        int k = 0, i = 0;
+        FileNode nodes(fs_ext, fs_data_ptrs.size() - 1, freeSpaceOfs);
+        uchar *dst = reserveNodeSpace(nodes,
+                                      rawElemOfs(info.fmt_pairs, info.fmt_pair_count, info.nelems, true, k, i));
+        size_t nelems = 0;
+        k = i = 0;
+        writeRawElementNodes(dst, info.fmt_pairs, info.fmt_pair_count, info.data, info.size, k, i, nelems);
+        CV_Assert(nelems == info.nelems);
+        writeInt(info.hdr + 8, (int) nodes.blockIdx);
+        writeInt(info.hdr + 12, (int) nodes.ofs);
+    }
+}
+
+FileNode FileStorage::Impl::getRawSeqElement(const FileNode &seq, size_t idx) const {
+    RawSeqInfo info;
+    CV_Assert(getRawSeqInfo(seq.ptr(), info) && idx < info.nelems);
+    CV_Assert(readInt(info.hdr + 8) >= 0);  // see buildRawSeqElements()
+    int k = 0, i = 0;
+    size_t blockIdx = (size_t) readInt(info.hdr + 8);
+    size_t ofs = (size_t) readInt(info.hdr + 12) + rawElemOfs(info.fmt_pairs, info.fmt_pair_count, idx, true, k, i);
+    return FileNode(fs_ext, blockIdx, ofs);
 }
 
 void FileStorage::Impl::parseError(const char *func_name, const std::string &err_msg, const char *source_file,
@@ -1873,7 +2310,7 @@ FileStorage::FileStorage(const String& filename, int flags, const String& encodi
     : state(0)
 {
     p = makePtr<FileStorage::Impl>(this);
-    bool ok = p->open(filename.c_str(), flags, encoding.c_str());
+    bool ok = p->open(filename.c_str(), flags, encoding.c_str(), filename.size());
     if(ok)
         state = FileStorage::NAME_EXPECTED + FileStorage::INSIDE_MAP;
 }
@@ -1905,7 +2342,7 @@ bool FileStorage::open(const String& filename, int flags, const String& encoding
 {
     try
     {
-        bool ok = p->open(filename.c_str(), flags, encoding.c_str());
+        bool ok = p->open(filename.c_str(), flags, encoding.c_str(), filename.size());
         if(ok)
             state = FileStorage::NAME_EXPECTED + FileStorage::INSIDE_MAP;
         return ok;
@@ -1939,6 +2376,29 @@ FileNode FileStorage::getFirstTopLevelNode() const
     return it != r.end() ? *it : FileNode();
 }
 
+bool FileStorage::readTopLevelNodes(const String& filename, const std::function<bool(const FileNode&)>& callback,
+                                    int flags, const String& encoding)
+{
+    CV_Assert(callback);
+    CV_CheckEQ(flags & 3, (int)READ, "Only reading is supported in streaming mode");
+
+    FileStorage fs;
+    fs.p->stream_callback = callback;
+    bool ok = false;
+    try
+    {
+        ok = fs.p->open(filename.c_str(), flags, encoding.c_str(), filename.size());
+    }
+    catch (...)
+    {
+        fs.p->stream_callback = nullptr;
+        throw;
+    }
+    fs.release();
+    fs.p->stream_callback = nullptr;
+    return ok;
+}
+
 std::string FileStorage::getDefaultObjectName(const std::string& _filename)
 {
     static const char* stubname = "unnamed";
@@ -2479,6 +2939,15 @@ FileNodeIterator::FileNodeIterator( const FileNode& node, bool seekEnd )
         {
             nodeNElems = node.size();
             const uchar* p0 = node.ptr(), *p = p0 + 1;
+            if( *p0 & CV_FS_RAW_SEQ )
+            {
+                // raw data sequence: the iterator keeps the sequence position and the element index
+                // (blockSize == 0), see FileStorage::Impl::getRawSeqElement()
+                blockSize = 0;
+                if( seekEnd )
+                    idx = nodeNElems;
+                return;
+            }
             if(*p0 & FileNode::NAMED )
                 p += 4;
             if( !seekEnd )
@@ -2518,6 +2987,8 @@ FileNodeIterator& FileNodeIterator::operator=(const FileNodeIterator& it)
 
 FileNode FileNodeIterator::operator *() const
 {
+    if( blockSize == 0 && fs && idx < nodeNElems )
+        return fs->getRawSeqElement(FileNode(fs, blockIdx, ofs), idx);
     return FileNode(idx < nodeNElems ? fs : NULL, blockIdx, ofs);
 }
 
@@ -2526,6 +2997,8 @@ FileNodeIterator& FileNodeIterator::operator ++ ()
     if( idx == nodeNElems || !fs )
         return *this;
     idx++;
+    if( blockSize == 0 )
+        return *this;
     FileNode n(fs, blockIdx, ofs);
     ofs += n.rawSize();
     if( ofs >= blockSize )
@@ -2551,6 +3024,133 @@ FileNodeIterator& FileNodeIterator::operator += (int _ofs)
     return *this;
 }
 
+template<typename _Tp> static inline _Tp castRawValue(int v) { return saturate_cast<_Tp>(v); }
+template<typename _Tp> static inline _Tp castRawValue(double v) { return saturate_cast<_Tp>(v); }
+template<> inline hfloat castRawValue<hfloat>(int v) { return hfloat((float)v); }
+template<> inline hfloat castRawValue<hfloat>(double v) { return hfloat((float)v); }
+
+// Reads up to `count` numeric nodes stored in [p, end) directly into the array.
+// Returns pointer to the first node which is not read (non-numeric one or the end of the block).
+template<typename _Tp> static
+const uchar* readRawValues(const uchar* p, const uchar* end, uchar*& data, size_t& count)
+{
+    _Tp* dst = (_Tp*)data;
+    for( ; count > 0 && p < end; count--, dst++ )
+    {
+        int tag = *p;
+        const uchar* v = p + 1 + ((tag & FileNode::NAMED) ? 4 : 0);
+        tag &= FileNode::TYPE_MASK;
+        if( tag == FileNode::INT )
+        {
+            *dst = castRawValue<_Tp>(readInt(v));
+            p = v + 4;
+        }
+        else if( tag == FileNode::REAL )
+        {
+            *dst = castRawValue<_Tp>(readReal(v));
+            p = v + 8;
+        }
+        else
+            break;
+    }
+    data = (uchar*)dst;
+    return p;
+}
+
+typedef const uchar* (*ReadRawValuesFunc)(const uchar* p, const uchar* end, uchar*& data, size_t& count);
+
+template<typename _Tp> static
+uchar* storeRawValue(uchar* data, int elem_type, _Tp v)
+{
+    switch( elem_type )
+    {
+    case CV_8U: *data = castRawValue<uchar>(v); return data + 1;
+    case CV_8S: *(schar*)data = castRawValue<schar>(v); return data + 1;
+    case CV_16U: *(ushort*)data = castRawValue<ushort>(v); return data + sizeof(ushort);
+    case CV_16S: *(short*)data = castRawValue<short>(v); return data + sizeof(short);
+    case CV_32S: *(int*)data = castRawValue<int>(v); return data + sizeof(int);
+    case CV_32F: *(float*)data = castRawValue<float>(v); return data + sizeof(float);
+    case CV_64F: *(double*)data = castRawValue<double>(v); return data + sizeof(double);
+    case CV_16F: *(hfloat*)data = castRawValue<hfloat>(v); return data + sizeof(hfloat);
+    default:
+        CV_Error( Error::StsUnsupportedFormat, "Unsupported type" );
+    }
+}
+
+// converts the packed little-endian element as if it was read from the INT/REAL node
+static uchar* convertPackedValue(const uchar* src, int src_type, uchar* data, int elem_type)
+{
+    switch( src_type )
+    {
+    case CV_8U: return storeRawValue(data, elem_type, (int)src[0]);
+    case CV_8S: return storeRawValue(data, elem_type, (int)(schar)src[0]);
+    case CV_16U: return storeRawValue(data, elem_type, (int)(ushort)(src[0] + (src[1] << 8)));
+    case CV_16S: return storeRawValue(data, elem_type, (int)(short)(src[0] + (src[1] << 8)));
+    case CV_32S: return storeRawValue(data, elem_type, readInt(src));
+    case CV_32F:
+        {
+            Cv32suf v;
+            v.i = readInt(src);
+            return storeRawValue(data, elem_type, (double)v.f);
+        }
+    case CV_64F: return storeRawValue(data, elem_type, readReal(src));
+    default: // CV_16F
+        return storeRawValue(data, elem_type, (double)float(hfloatFromBits((ushort)(src[0] + (src[1] << 8)))));
+    }
+}
+
+size_t FileStorage::Impl::readRawSeq(const FileNode& seq, size_t idx, const int* fmt_pairs, int fmt_pair_count,
+                                     size_t esz, uchar* data0, size_t maxsz)
+{
+    RawSeqInfo info;
+    CV_Assert( getRawSeqInfo(seq.ptr(), info) );
+    int k = 0, i = 0;
+    const uchar* src = info.data + rawElemOfs(info.fmt_pairs, info.fmt_pair_count, idx, false, k, i);
+    size_t idx0 = idx;
+
+#if CV_LITTLE_ENDIAN_MEM_ACCESS
+    bool sameType = fmt_pair_count == 1;
+    for( int j = 0; j < info.fmt_pair_count && sameType; j++ )
+        sameType = info.fmt_pairs[j*2+1] == fmt_pairs[1];
+    if( sameType )
+    {
+        size_t count = maxsz * fmt_pairs[0];
+        if( count > info.nelems - idx )
+            CV_Error( Error::StsError, "readRawData can only be used to read plain sequences of numbers" );
+        memcpy(data0, src, count * CV_ELEM_SIZE1(fmt_pairs[1]));
+        return count;
+    }
+#endif
+
+    for( ; maxsz > 0; maxsz--, data0 += esz )
+    {
+        size_t offset = 0;
+        for( int k1 = 0; k1 < fmt_pair_count; k1++ )
+        {
+            int elem_type = fmt_pairs[k1*2+1];
+            offset = alignSize( offset, CV_ELEM_SIZE(elem_type) );
+            uchar* data = data0 + offset;
+
+            for( int i1 = 0; i1 < fmt_pairs[k1*2]; i1++, idx++ )
+            {
+                if( idx >= info.nelems )
+                    CV_Error( Error::StsError, "readRawData can only be used to read plain sequences of numbers" );
+                int src_type = info.fmt_pairs[k*2+1];
+                data = convertPackedValue(src, src_type, data, elem_type);
+                src += CV_ELEM_SIZE1(src_type);
+                if( ++i >= info.fmt_pairs[k*2] )
+                {
+                    i = 0;
+                    if( ++k >= info.fmt_pair_count )
+                        k = 0;
+                }
+            }
+            offset = (size_t)(data - data0);
+        }
+    }
+    return idx - idx0;
+}
+
 FileNodeIterator& FileNodeIterator::readRaw( const String& fmt, void* _data0, size_t maxsz)
 {
     if( fs && idx < nodeNElems )
@@ -2563,6 +3163,45 @@ FileNodeIterator& FileNodeIterator::readRaw( const String& fmt, void* _data0, si
         CV_Assert( maxsz % esz == 0 );
         maxsz /= esz;
 
+        if( blockSize == 0 )
+        {
+            // raw data sequence: the data is converted directly, without the element nodes
+            idx += fs->readRawSeq(FileNode(fs, blockIdx, ofs), idx, fmt_pairs, fmt_pair_count, esz, data0, maxsz);
+            return *this;
+        }
+
+        if( fmt_pair_count == 1 )
+        {
+            // plain sequence of numbers: element nodes are read directly from the storage blocks
+            static const ReadRawValuesFunc readTab[CV_DEPTH_MAX] =
+            {
+                readRawValues<uchar>, readRawValues<schar>, readRawValues<ushort>, readRawValues<short>,
+                readRawValues<int>, readRawValues<float>, readRawValues<double>, readRawValues<hfloat>
+            };
+            ReadRawValuesFunc func = readTab[CV_MAT_DEPTH(fmt_pairs[1])];
+            CV_Assert( func );
+            size_t count = maxsz * fmt_pairs[0];
+            while( count > 0 && idx < nodeNElems )
+            {
+                const uchar* p0 = fs->getNodePtr(blockIdx, ofs);
+                size_t n = std::min(count, nodeNElems - idx), n0 = n;
+                const uchar* p = func(p0, fs->fs_data_ptrs[blockIdx] + blockSize, data0, n);
+                if( n == n0 )
+                    break;  // non-numeric node
+                count -= n0 - n;
+                idx += n0 - n;
+                ofs += (size_t)(p - p0);
+                if( ofs >= blockSize )
+                {
+                    fs->normalizeNodeOfs(blockIdx, ofs);
+                    blockSize = fs->fs_data_blksz[blockIdx];
+                }
+            }
+            if( count > 0 )
+                CV_Error( Error::StsError, "readRawData can only be used to read plain sequences of numbers" );
+            return *this;
+        }
+
         for( ; maxsz > 0; maxsz--, data0 += esz )
         {
             size_t offset = 0;
@@ -10,6 +10,7 @@
 #include <deque>
 #include <sstream>
 #include <string>
+#include <vector>
 #include <iterator>
 
 #define USE_ZLIB 1
@@ -43,6 +44,8 @@ enum
 
 #define CV_FS_MAX_LEN 4096
 #define CV_FS_MAX_FMT_PAIRS  128
+//! flag of the sequence node tag: elements are kept as packed little-endian raw data (see FileStorage::Impl::addRawNodes())
+#define CV_FS_RAW_SEQ 64
 
 /****************************************************************************************\
 *                            Common macros and type definitions                          *
@@ -139,6 +142,8 @@ public:
 
     virtual void puts( const char* str ) = 0;
     virtual char* gets() = 0;
+    virtual void putBytes( const void* data, size_t len ) = 0;
+    virtual size_t getBytes( void* data, size_t len ) = 0;
     virtual bool eof() = 0;
     virtual void setEof() = 0;
     virtual void closeFile() = 0;
@@ -161,6 +166,12 @@ public:
     virtual double strtod(char* ptr, char** endptr) = 0;
 
     virtual char* parseBase64(char* ptr, int indent, FileNode& collection) = 0;
+    //! appends elements of packed little-endian raw data to the sequence, returns number of consumed bytes.
+    //! (pairIdx, elemIdx) is the position in the format, it is updated for the next call.
+    //! sizeHint is the expected number of bytes still to be added (including len), 0 if unknown.
+    virtual size_t addRawNodes( FileNode& collection, const int* fmt_pairs, int fmt_pair_count,
+                                const uchar* data, size_t len, int& pairIdx, int& elemIdx,
+                                size_t sizeHint = 0 ) = 0;
     CV_NORETURN
     virtual void parseError(const char* funcname, const std::string& msg,
                             const char* filename, int lineno) = 0;
@@ -198,6 +209,12 @@ public:
     virtual void writeScalar(const char* key, const char* value) = 0;
     virtual void writeComment(const char* comment, bool eol_comment) = 0;
     virtual void startNextStream() = 0;
+    virtual void writeRawData(const char* /*dt*/, const void* /*data*/, size_t /*len*/)
+    {
+        CV_Error(cv::Error::StsNotImplemented, "Raw data is written as text by this emitter");
+    }
+    //! called on release of the storage, after the last structure is closed
+    virtual void endWriting() {}
 };
 
 class FileStorageParser
@@ -216,6 +233,13 @@ Ptr<FileStorageParser> createXMLParser(FileStorage_API* fs);
 Ptr<FileStorageParser> createYAMLParser(FileStorage_API* fs);
 Ptr<FileStorageParser> createJSONParser(FileStorage_API* fs);
 
+Ptr<FileStorageEmitter> createBinaryEmitter(FileStorage_API* fs);
+Ptr<FileStorageParser> createBinaryParser(FileStorage_API* fs);
+bool checkBinaryStorageSignature(const char* buf, size_t len);
+//! locates payload of the top-level matrix in binary file storage, see utils::mapStorageMat()
+bool findBinaryStorageMat(const std::string& filename, const std::string& name,
+                          std::vector<int>& sizes, int& type, size_t& dataOffset);
+
 }
 
 #endif // SRC_PERSISTENCE_HPP
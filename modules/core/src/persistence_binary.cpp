@@ -0,0 +1,739 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+#include "precomp.hpp"
+#include "persistence.hpp"
+
+/*
+ Binary file storage layout (all numbers are little-endian):
+
+   header:  signature (8 bytes) | version (uint32) | reserved (uint32)
+   streams: one unnamed collection record per stream
+   TOC:     TAG_TOC | count (uint32) | count x { stream index (uint32) | name (uint16 length + chars) | offset (uint64) }
+   trailer: TOC offset (uint64) | signature (8 bytes)
+
+ Record:  tag (uint8, node type | TAG_NAMED) | [name (uint16 length + chars)] | value
+   FileNode::INT:    int32
+   FileNode::REAL:   float64
+   FileNode::STRING: uint32 length + chars
+   FileNode::SEQ/MAP: type name (uint16 length + chars), child records, TAG_END
+   TAG_RAW:  format (uint8 length + chars) | payload size (uint64) | padding size (uint8) + zero padding |
+             payload: packed elements of writeRaw() call.
+             Large payloads start at offset multiple of RAW_ALIGNMENT, they can be memory-mapped as is.
+
+ TOC contains top-level nodes of all streams, offsets point to the beginning of their records.
+*/
+
+namespace cv
+{
+
+static const char binarySignature[] = "\x89" "CVBIN\r\n";
+enum
+{
+    BINARY_SIGNATURE_SIZE = 8,
+    BINARY_HEADER_SIZE = 16,
+    BINARY_TRAILER_SIZE = 16,
+    BINARY_FORMAT_VERSION = 1,
+    RAW_ALIGNMENT = 64,
+
+    TAG_END = 0,
+    TAG_RAW = 6,
+    TAG_TOC = 7,
+    TAG_NAMED = FileNode::NAMED
+};
+
+static inline bool isLittleEndian()
+{
+    const ushort one = 1;
+    return *(const uchar*)&one == 1;
+}
+
+bool checkBinaryStorageSignature(const char* buf, size_t len)
+{
+    return len >= (size_t)BINARY_SIGNATURE_SIZE && memcmp(buf, binarySignature, BINARY_SIGNATURE_SIZE) == 0;
+}
+
+// returns size of the packed element (without alignment of the struct fields)
+static size_t decodeRawFormat(const char* dt, int* fmt_pairs, int& fmt_pair_count)
+{
+    fmt_pair_count = fs::decodeFormat(dt, fmt_pairs, CV_FS_MAX_FMT_PAIRS);
+    size_t packedSize = 0;
+    for (int k = 0; k < fmt_pair_count; k++)
+    {
+        int elem_type = fmt_pairs[k * 2 + 1];
+        if (elem_type != CV_8U && elem_type != CV_8S && elem_type != CV_16U && elem_type != CV_16S &&
+            elem_type != CV_32S && elem_type != CV_32F && elem_type != CV_64F && elem_type != CV_16F)
+            CV_Error(cv::Error::StsUnsupportedFormat, "Unsupported type");
+        packedSize += (size_t)fmt_pairs[k * 2] * CV_ELEM_SIZE(elem_type);
+    }
+    return packedSize;
+}
+
+class BinaryEmitter : public FileStorageEmitter
+{
+public:
+    BinaryEmitter(FileStorage_API* _fs) : fs(_fs), pos(0), depth(0), streamIdx(0), rootOpen(false)
+    {
+        putBytes(binarySignature, BINARY_SIGNATURE_SIZE);
+        putUInt32(BINARY_FORMAT_VERSION);
+        putUInt32(0);
+    }
+    virtual ~BinaryEmitter() {}
+
+    FStructData startWriteStruct( const FStructData& /*parent*/, const char* key,
+                                  int struct_flags, const char* type_name=0 )
+    {
+        struct_flags = (struct_flags & (FileNode::TYPE_MASK|FileNode::FLOW)) | FileNode::EMPTY;
+        if( !FileNode::isCollection(struct_flags))
+            CV_Error( cv::Error::StsBadArg,
+                     "Some collection type - FileNode::SEQ or FileNode::MAP, must be specified" );
+
+        startRecord(key, FileNode::isMap(struct_flags) ? FileNode::MAP : FileNode::SEQ);
+        putString16(type_name ? type_name : "");
+        depth++;
+
+        return FStructData(type_name ? type_name : "", struct_flags, 0);
+    }
+
+    void endWriteStruct(const FStructData& /*current_struct*/)
+    {
+        if (depth == 0)
+        {
+            // the stream root is closed by FileStorage::Impl::startNextStream()
+            endStream();
+            return;
+        }
+        putUInt8(TAG_END);
+        depth--;
+    }
+
+    void write(const char* key, int value)
+    {
+        startRecord(key, FileNode::INT);
+        putUInt32((unsigned)value);
+    }
+
+    void write(const char* key, double value)
+    {
+        Cv64suf v;
+        v.f = value;
+        startRecord(key, FileNode::REAL);
+        putUInt64(v.u);
+    }
+
+    void write(const char* key, const char* value, bool /*quote*/)
+    {
+        size_t len = value ? strlen(value) : 0;
+        CV_Assert(len < (size_t)INT_MAX);
+        startRecord(key, FileNode::STRING);
+        putUInt32((unsigned)len);
+        putBytes(value, len);
+    }
+
+    void writeScalar(const char* key, const char* value)
+    {
+        write(key, value, false);
+    }
+
+    void writeComment(const char* /*comment*/, bool /*eol_comment*/)
+    {
+        // comments are not stored
+    }
+
+    void startNextStream()
+    {
+        endStream();
+    }
+
+    void writeRawData(const char* dt, const void* _data, size_t len)
+    {
+        int fmt_pairs[CV_FS_MAX_FMT_PAIRS*2], fmt_pair_count = 0;
+        size_t structSize = fs::calcStructSize(dt, 0);
+        size_t packedSize = decodeRawFormat(dt, fmt_pairs, fmt_pair_count);
+        CV_Assert(structSize > 0 && len % structSize == 0);
+        if (len == 0)
+            return;
+
+        const uchar* data = (const uchar*)_data;
+        if (!data)
+            CV_Error(cv::Error::StsNullPtr, "Null data pointer");
+
+        size_t count = len / structSize, total = count * packedSize;
+        size_t dtlen = strlen(dt);
+        CV_Assert(dtlen < 256);
+
+        startRecord(0, TAG_RAW);
+        putUInt8((uchar)dtlen);
+        putBytes(dt, dtlen);
+        putUInt64((uint64)total);
+        size_t padding = 0;
+        if (total >= (size_t)RAW_ALIGNMENT)
+            padding = (RAW_ALIGNMENT - (pos + 1) % RAW_ALIGNMENT) % RAW_ALIGNMENT;
+        putUInt8((uchar)padding);
+        buf.resize(buf.size() + padding, (uchar)0);
+        pos += padding;
+
+        if (fmt_pair_count == 1 && isLittleEndian())
+        {
+            // the common case (matrices), elements are written as is
+            putBytes(data, total);
+            return;
+        }
+
+        // multi-field structures are packed, elements are converted to little-endian
+        const size_t blockSize = std::max((size_t)1, (size_t)(1 << 16) / packedSize);
+        bool le = isLittleEndian();
+        std::vector<uchar> packed;
+        for (size_t n0 = 0; n0 < count; n0 += blockSize)
+        {
+            size_t n1 = std::min(count, n0 + blockSize);
+            packed.resize((n1 - n0) * packedSize);
+            uchar* dst = packed.data();
+            for (size_t n = n0; n < n1; n++)
+            {
+                const uchar* data0 = data + n * structSize;
+                int offset = 0;
+                for (int k = 0; k < fmt_pair_count; k++)
+                {
+                    int elem_size = CV_ELEM_SIZE(fmt_pairs[k * 2 + 1]);
+                    offset = cvAlign(offset, elem_size);
+                    const uchar* src = data0 + offset;
+                    for (int i = 0; i < fmt_pairs[k * 2]; i++, src += elem_size, dst += elem_size)
+                        for (int b = 0; b < elem_size; b++)
+                            dst[b] = src[le ? b : elem_size - 1 - b];
+                    offset += fmt_pairs[k * 2] * elem_size;
+                }
+            }
+            putBytes(packed.data(), packed.size());
+        }
+    }
+
+    void endWriting()
+    {
+        endStream();
+
+        uint64 tocOfs = (uint64)pos;
+        putUInt8(TAG_TOC);
+        putUInt32((unsigned)toc.size());
+        for (size_t i = 0; i < toc.size(); i++)
+        {
+            putUInt32((unsigned)toc[i].streamIdx);
+            putString16(toc[i].name.c_str());
+            putUInt64(toc[i].ofs);
+        }
+        putUInt64(tocOfs);
+        putBytes(binarySignature, BINARY_SIGNATURE_SIZE);
+        flushBuffer();
+    }
+
+protected:
+    struct TocEntry
+    {
+        int streamIdx;
+        std::string name;
+        uint64 ofs;
+    };
+
+    void startRecord(const char* key, int tag)
+    {
+        if (key && key[0] == '\0')
+            key = 0;
+
+        int struct_flags = fs->getCurrentStruct().flags;
+        if (FileNode::isCollection(struct_flags))
+        {
+            if (FileNode::isMap(struct_flags) ^ (key != 0))
+                CV_Error( cv::Error::StsBadArg, "An attempt to add element without a key to a map, "
+                         "or add element with key to sequence" );
+        }
+        fs->setNonEmpty();
+
+        size_t keylen = key ? strlen(key) : 0;
+        if (keylen > CV_FS_MAX_LEN)
+            CV_Error( cv::Error::StsBadArg, "The key is too long" );
+
+        if (!rootOpen)
+        {
+            // the stream root type is defined by its first element
+            putUInt8((uchar)(key ? FileNode::MAP : FileNode::SEQ));
+            putString16("");
+            rootOpen = true;
+        }
+        if (depth == 0 && key)
+        {
+            TocEntry e = { streamIdx, std::string(key), (uint64)pos };
+            toc.push_back(e);
+        }
+
+        putUInt8((uchar)(tag | (key ? TAG_NAMED : 0)));
+        if (key)
+            putString16(key);
+    }
+
+    void endStream()
+    {
+        if (!rootOpen)
+            return;
+        CV_Assert(depth == 0);
+        putUInt8(TAG_END);
+        rootOpen = false;
+        streamIdx++;
+    }
+
+    void putUInt8(uchar v)
+    {
+        buf.push_back(v);
+        pos++;
+    }
+
+    void putUInt32(unsigned v)
+    {
+        uchar b[] = { (uchar)v, (uchar)(v >> 8), (uchar)(v >> 16), (uchar)(v >> 24) };
+        putBytes(b, sizeof(b));
+    }
+
+    void putUInt64(uint64 v)
+    {
+        putUInt32((unsigned)v);
+        putUInt32((unsigned)(v >> 32));
+    }
+
+    void putString16(const char* str)
+    {
+        size_t len = strlen(str);
+        CV_Assert(len <= 0xffff);
+        uchar b[] = { (uchar)len, (uchar)(len >> 8) };
+        putBytes(b, sizeof(b));
+        putBytes(str, len);
+    }
+
+    void putBytes(const void* data, size_t len)
+    {
+        const size_t bufSize = 1 << 16;
+        if (buf.size() + len > bufSize)
+        {
+            flushBuffer();
+            if (len >= bufSize)
+            {
+                fs->putBytes(data, len);
+                pos += len;
+                return;
+            }
+        }
+        buf.insert(buf.end(), (const uchar*)data, (const uchar*)data + len);
+        pos += len;
+    }
+
+    void flushBuffer()
+    {
+        if (!buf.empty())
+            fs->putBytes(buf.data(), buf.size());
+        buf.clear();
+    }
+
+    FileStorage_API* fs;
+    std::vector<uchar> buf;
+    size_t pos;  //!< position in the (uncompressed) stream
+    int depth;   //!< nesting level inside of the stream root
+    int streamIdx;
+    bool rootOpen;
+    std::vector<TocEntry> toc;
+};
+
+/* sequential reader of the records */
+class BinaryInput
+{
+public:
+    BinaryInput() : pos(0) {}
+    virtual ~BinaryInput() {}
+
+    virtual size_t read(void* data, size_t len) = 0;
+    virtual void skip(size_t len)
+    {
+        uchar tmp[1024];
+        while (len > 0)
+        {
+            size_t n = std::min(len, sizeof(tmp));
+            get(tmp, n);
+            len -= n;
+        }
+    }
+    CV_NORETURN virtual void error(const char* msg) = 0;
+
+    void get(void* data, size_t len)
+    {
+        if (read(data, len) != len)
+            error("Unexpected end of file");
+        pos += len;
+    }
+
+    uchar getUInt8() { uchar b = 0; get(&b, 1); return b; }
+    unsigned getUInt16() { uchar b[2]; get(b, 2); return b[0] | (b[1] << 8); }
+    unsigned getUInt32() { uchar b[4]; get(b, 4); return b[0] | (b[1] << 8) | (b[2] << 16) | ((unsigned)b[3] << 24); }
+    uint64 getUInt64() { uint64 lo = getUInt32(); return lo | ((uint64)getUInt32() << 32); }
+
+    std::string getString(size_t len)
+    {
+        std::string s(len, '\0');
+        if (len > 0)
+            get(&s[0], len);
+        return s;
+    }
+
+    void checkHeader()
+    {
+        char sig[BINARY_SIGNATURE_SIZE];
+        get(sig, sizeof(sig));
+        if (!checkBinaryStorageSignature(sig, sizeof(sig)))
+            error("Invalid signature of binary file storage");
+        unsigned version = getUInt32();
+        if (version != BINARY_FORMAT_VERSION)
+            error("Unsupported version of binary file storage");
+        getUInt32();
+    }
+
+    size_t pos;
+};
+
+class BinaryParser : public FileStorageParser
+{
+public:
+    BinaryParser(FileStorage_API* _fs) : fs(_fs), in(_fs) {}
+    virtual ~BinaryParser() {}
+
+    bool getBase64Row(char* /*ptr*/, int /*indent*/, char* &beg, char* &end)
+    {
+        beg = end = 0;
+        return false;
+    }
+
+    bool parse(char* /*ptr*/)
+    {
+        in.checkHeader();
+        FileNode root_collection(fs->getFS(), 0, 0);
+        for (;;)
+        {
+            int tag = in.getUInt8();
+            if (tag == TAG_TOC)
+                break;
+            if (tag != FileNode::MAP && tag != FileNode::SEQ)
+                CV_PARSE_ERROR_CPP("Collection is expected as the root of the stream");
+            in.getString(in.getUInt16());
+            FileNode root_node = fs->addNode(root_collection, std::string(), tag);
+            parseCollection(root_node);
+        }
+        return true;
+    }
+
+protected:
+    class Input : public BinaryInput
+    {
+    public:
+        Input(FileStorage_API* _fs) : fs(_fs) {}
+        size_t read(void* data, size_t len) CV_OVERRIDE { return fs->getBytes(data, len); }
+        void error(const char* msg) CV_OVERRIDE { CV_PARSE_ERROR_CPP(msg); }
+        FileStorage_API* fs;
+    };
+
+    void parseCollection(FileNode& collection)
+    {
+        for (;;)
+        {
+            int tag = in.getUInt8();
+            if (tag == TAG_END)
+                break;
+
+            std::string key;
+            if (tag & TAG_NAMED)
+                key = in.getString(in.getUInt16());
+            tag &= ~TAG_NAMED;
+
+            switch (tag)
+            {
+            case FileNode::INT:
+                {
+                    int ival = (int)in.getUInt32();
+                    fs->addNode(collection, key, FileNode::INT, &ival);
+                }
+                break;
+            case FileNode::REAL:
+                {
+                    Cv64suf v;
+                    v.u = in.getUInt64();
+                    fs->addNode(collection, key, FileNode::REAL, &v.f);
+                }
+                break;
+            case FileNode::STRING:
+                {
+                    unsigned len = in.getUInt32();
+                    if (len >= (unsigned)INT_MAX)
+                        CV_PARSE_ERROR_CPP("Too long string");
+                    std::string str = in.getString(len);
+                    fs->addNode(collection, key, FileNode::STRING, str.c_str(), (int)len);
+                }
+                break;
+            case FileNode::SEQ:
+            case FileNode::MAP:
+                {
+                    in.getString(in.getUInt16());  // type name is not used by the parsed nodes
+                    FileNode node = fs->addNode(collection, key, tag);
+                    parseCollection(node);
+                }
+                break;
+            case TAG_RAW:
+                if (!key.empty())
+                    CV_PARSE_ERROR_CPP("Raw data can't have a name");
+                parseRawData(collection);
+                break;
+            default:
+                CV_PARSE_ERROR_CPP("Invalid record type");
+            }
+        }
+        fs->finalizeCollection(collection);
+    }
+
+    void parseRawData(FileNode& collection)
+    {
+        std::string dt = in.getString(in.getUInt8());
+        uint64 total = in.getUInt64();
+        in.skip(in.getUInt8());
+
+        int fmt_pairs[CV_FS_MAX_FMT_PAIRS*2], fmt_pair_count = 0;
+        size_t packedSize = decodeRawFormat(dt.c_str(), fmt_pairs, fmt_pair_count);
+        if (packedSize == 0 || total % packedSize != 0)
+            CV_PARSE_ERROR_CPP("Invalid size of raw data");
+
+        // payload is read by blocks of whole elements, so the format position is reset after each block
+        const size_t blockSize = std::max((size_t)1, (size_t)(1 << 20) / packedSize) * packedSize;
+        rawbuf.resize((size_t)std::min((uint64)blockSize, total));
+        while (total > 0)
+        {
+            size_t n = (size_t)std::min((uint64)blockSize, total);
+            in.get(rawbuf.data(), n);
+            int k = 0, i = 0;
+            fs->addRawNodes(collection, fmt_pairs, fmt_pair_count, rawbuf.data(), n, k, i,
+                            (size_t)std::min(total, (uint64)SIZE_MAX));
+            total -= n;
+        }
+    }
+
+    FileStorage_API* fs;
+    Input in;
+    std::vector<uchar> rawbuf;
+};
+
+Ptr<FileStorageEmitter> createBinaryEmitter(FileStorage_API* fs)
+{
+    return makePtr<BinaryEmitter>(fs);
+}
+
+Ptr<FileStorageParser> createBinaryParser(FileStorage_API* fs)
+{
+    return makePtr<BinaryParser>(fs);
+}
+
+//=====================================================================================
+
+namespace {
+
+#ifdef _WIN32
+static int seekFile(FILE* f, int64 ofs, int origin) { return _fseeki64(f, ofs, origin); }
+#else
+static int seekFile(FILE* f, int64 ofs, int origin) { return fseeko(f, (off_t)ofs, origin); }
+#endif
+
+class FileInput : public BinaryInput
+{
+public:
+    FileInput(const std::string& _filename) : filename(_filename)
+    {
+        f = fopen(filename.c_str(), "rb");
+    }
+    ~FileInput() { if (f) fclose(f); }
+
+    size_t read(void* data, size_t len) CV_OVERRIDE { return fread(data, 1, len, f); }
+    void skip(size_t len) CV_OVERRIDE { seek((uint64)(pos + len)); }
+    void error(const char* msg) CV_OVERRIDE
+    {
+        CV_Error_(cv::Error::StsParseError, ("%s: %s", filename.c_str(), msg));
+    }
+
+    void seek(uint64 ofs)
+    {
+        if (seekFile(f, (int64)ofs, SEEK_SET) != 0)
+            error("Invalid offset");
+        pos = (size_t)ofs;
+    }
+
+    std::string filename;
+    FILE* f;
+};
+
+// skips the value of the record (the tag and the name are read already)
+static void skipRecord(BinaryInput& in, int tag)
+{
+    switch (tag)
+    {
+    case FileNode::INT: in.skip(4); break;
+    case FileNode::REAL: in.skip(8); break;
+    case FileNode::STRING: in.skip(in.getUInt32()); break;
+    case FileNode::SEQ:
+    case FileNode::MAP:
+        in.skip(in.getUInt16());
+        for (;;)
+        {
+            int child = in.getUInt8();
+            if (child == TAG_END)
+                break;
+            if (child & TAG_NAMED)
+                in.skip(in.getUInt16());
+            skipRecord(in, child & ~TAG_NAMED);
+        }
+        break;
+    case TAG_RAW:
+        {
+            in.skip(in.getUInt8());
+            uint64 total = in.getUInt64();
+            in.skip(in.getUInt8());
+            in.skip((size_t)total);
+        }
+        break;
+    default:
+        in.error("Invalid record type");
+    }
+}
+
+// reads the sequence of raw data records written by write(FileStorage&, const String&, const Mat&)
+static void readMatData(BinaryInput& in, std::string& dt, uint64& total, size_t& ofs, int& nrecords)
+{
+    in.skip(in.getUInt16());
+    for (;;)
+    {
+        int tag = in.getUInt8();
+        if (tag == TAG_END)
+            break;
+        if (tag != TAG_RAW)
+            in.error("Matrix data is expected to be stored as raw data");
+        dt = in.getString(in.getUInt8());
+        total = in.getUInt64();
+        in.skip(in.getUInt8());
+        ofs = in.pos;
+        nrecords++;
+        in.skip((size_t)total);
+    }
+}
+
+} // namespace
+
+bool findBinaryStorageMat(const std::string& filename, const std::string& name,
+                          std::vector<int>& sizes, int& type, size_t& dataOffset)
+{
+    FileInput in(filename);
+    if (!in.f)
+        CV_Error_(cv::Error::StsError, ("Can't open file: '%s'", filename.c_str()));
+    in.checkHeader();
+
+    if (seekFile(in.f, -(int64)BINARY_TRAILER_SIZE, SEEK_END) != 0)
+        in.error("Invalid file size");
+    uint64 tocOfs = in.getUInt64();
+    char sig[BINARY_SIGNATURE_SIZE];
+    in.get(sig, sizeof(sig));
+    if (!checkBinaryStorageSignature(sig, sizeof(sig)))
+        in.error("Table of contents is not found");
+
+    in.seek(tocOfs);
+    if (in.getUInt8() != TAG_TOC)
+        in.error("Table of contents is not found");
+    unsigned i, count = in.getUInt32();
+    uint64 nodeOfs = 0;
+    for (i = 0; i < count; i++)
+    {
+        in.getUInt32();
+        std::string key = in.getString(in.getUInt16());
+        uint64 ofs = in.getUInt64();
+        if (key == name)
+        {
+            nodeOfs = ofs;
+            break;
+        }
+    }
+    if (i == count)
+        return false;
+
+    in.seek(nodeOfs);
+    int tag = in.getUInt8();
+    if (tag != (FileNode::MAP | TAG_NAMED))
+        CV_Error_(cv::Error::StsBadArg, ("'%s' is not a matrix", name.c_str()));
+    in.skip(in.getUInt16());
+    std::string type_name = in.getString(in.getUInt16());
+    bool ndmat = type_name == "opencv-nd-matrix";
+    if (!ndmat && type_name != "opencv-matrix")
+        CV_Error_(cv::Error::StsBadArg, ("'%s' is not a matrix", name.c_str()));
+
+    int rows = -1, cols = -1;
+    std::string dt, datadt;
+    uint64 total = 0;
+    int nrecords = 0;
+    sizes.clear();
+    dataOffset = 0;
+
+    for (;;)
+    {
+        tag = in.getUInt8();
+        if (tag == TAG_END)
+            break;
+        std::string key = (tag & TAG_NAMED) ? in.getString(in.getUInt16()) : std::string();
+        tag &= ~TAG_NAMED;
+        if (tag == FileNode::INT && (key == "rows" || key == "cols"))
+            (key == "rows" ? rows : cols) = (int)in.getUInt32();
+        else if (tag == FileNode::STRING && key == "dt")
+            dt = in.getString(in.getUInt32());
+        else if (tag == FileNode::SEQ && key == "sizes")
+        {
+            std::string sizesdt;
+            uint64 sizesTotal = 0;
+            size_t sizesOfs = 0;
+            int n = 0;
+            readMatData(in, sizesdt, sizesTotal, sizesOfs, n);
+            if (n != 1 || sizesdt != "i" || sizesTotal % sizeof(int) != 0 || sizesTotal > CV_MAX_DIM * sizeof(int))
+                in.error("Invalid matrix sizes");
+            size_t endOfs = in.pos;
+            in.seek(sizesOfs);
+            for (size_t k = 0; k < sizesTotal / sizeof(int); k++)
+                sizes.push_back((int)in.getUInt32());
+            in.seek(endOfs);
+        }
+        else if (tag == FileNode::SEQ && key == "data")
+            readMatData(in, datadt, total, dataOffset, nrecords);
+        else
+            skipRecord(in, tag);
+    }
+
+    if (!ndmat)
+    {
+        sizes.clear();
+        sizes.push_back(rows);
+        sizes.push_back(cols);
+    }
+    if (dt.empty() || sizes.size() < 2)
+        in.error("Invalid matrix header");
+    type = fs::decodeSimpleFormat(dt.c_str());
+
+    size_t expected = CV_ELEM_SIZE(type);
+    for (size_t k = 0; k < sizes.size(); k++)
+    {
+        CV_Assert(sizes[k] >= 0);
+        expected *= (size_t)sizes[k];
+    }
+    if (expected == 0)
+        return true;
+    if (nrecords != 1 || fs::decodeSimpleFormat(datadt.c_str()) != type || total != (uint64)expected)
+        CV_Error_(cv::Error::StsNotImplemented,
+                  ("Data of '%s' is not stored as a single block (the matrix was not continuous)", name.c_str()));
+    if (!isLittleEndian())
+        CV_Error(cv::Error::StsNotImplemented, "Mapping of binary file storage requires little-endian platform");
+    return true;
+}
+
+}
@@ -9,6 +9,7 @@
 #include "persistence_base64_encoding.hpp"
 #include <unordered_map>
 #include <iterator>
+#include <functional>
 
 
 namespace cv
@@ -33,10 +34,14 @@ public:
 
     void analyze_file_name( const std::string& file_name, std::vector<std::string>& params );
 
-    bool open( const char* filename_or_buf, int _flags, const char* encoding );
+    bool open( const char* filename_or_buf, int _flags, const char* encoding, size_t bufSize = 0 );
 
     void puts( const char* str );
 
+    void putBytes( const void* data, size_t len );
+
+    size_t getBytes( void* data, size_t len );
+
     char* getsFromFile( char* buf, int count );
 
     char* gets( size_t maxCount );
@@ -131,6 +136,11 @@ public:
 
     void normalizeNodeOfs(size_t& blockIdx, size_t& ofs) const;
 
+    bool isStreamRoot(const FileNode& collection) const;
+
+    // passes the parsed top-level node to stream_callback and releases its storage
+    void emitStreamNode();
+
     Base64State get_state_of_writing_base64();
 
     int get_space();
@@ -153,6 +163,10 @@ public:
 
         bool endOfStream() const;
         char* getPtr() const;
+
+        //! returns decoded data which is not consumed yet
+        const uchar* peek(size_t& count) const;
+        void skip(size_t count);
     protected:
 
         Ptr<FileStorageParser> parser_do_not_use_direct_dereference;
@@ -173,6 +187,29 @@ public:
 
     char* parseBase64(char* ptr, int indent, FileNode& collection);
 
+    // Raw data is kept in the sequence node as is (CV_FS_RAW_SEQ) and read by readRaw() from there,
+    // the element nodes are built once the parsing is finished. If the sequence already has regular
+    // elements or the format differs, the data is converted to the element nodes.
+    size_t addRawNodes( FileNode& collection, const int* fmt_pairs, int fmt_pair_count,
+                        const uchar* data, size_t len, int& pairIdx, int& elemIdx, size_t sizeHint = 0 );
+
+    size_t addRawElementNodes( FileNode& collection, const int* fmt_pairs, int fmt_pair_count,
+                               const uchar* data, size_t len, int& pairIdx, int& elemIdx );
+
+    // converts the raw data sequence being parsed to the sequence of element nodes
+    void expandRawSeq( FileNode& collection );
+
+    // builds the element nodes of the raw data sequences of the parsed node
+    void buildRawSeqElements( const FileNode& node );
+
+    // returns idx-th element of the raw data sequence
+    FileNode getRawSeqElement( const FileNode& seq, size_t idx ) const;
+
+    // reads maxsz structures of the given format (esz bytes each) from the raw data sequence starting
+    // from the idx-th element, returns the number of read elements
+    size_t readRawSeq( const FileNode& seq, size_t idx, const int* fmt_pairs, int fmt_pair_count,
+                       size_t esz, uchar* data, size_t maxsz );
+
     void parseError( const char* func_name, const std::string& err_msg, const char* source_file, int source_line );
 
     const uchar* getNodePtr(size_t blockIdx, size_t ofs) const;
@@ -237,6 +274,12 @@ public:
     str_hash_t str_hash;
     std::vector<char> str_hash_data;
 
+    //! callback of streaming reading (see FileStorage::readTopLevelNodes()), top-level nodes are not kept in memory
+    std::function<bool(const FileNode&)> stream_callback;
+    bool has_stream_root, has_stream_node;
+    size_t stream_root_blockIdx, stream_root_ofs;
+    size_t stream_node_blockIdx, stream_node_ofs;
+
     std::vector<char> strbufv;
     char* strbuf;
     size_t strbufsize;
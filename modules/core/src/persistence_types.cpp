@@ -19,8 +19,11 @@ void write( FileStorage& fs, const String& name, const Mat& m )
         fs << "cols" << m.cols;
         fs << "dt" << fs::encodeFormat( m.type(), dt, sizeof(dt) );
         fs << "data" << "[:";
-        for( int i = 0; i < m.rows; i++ )
-            fs.writeRaw(dt, m.ptr(i), m.cols*m.elemSize());
+        if( m.isContinuous() && fs.getFormat() == FileStorage::FORMAT_BINARY )
+            fs.writeRaw(dt, m.ptr(), m.total()*m.elemSize()); // single block, see utils::mapStorageMat()
+        else
+            for( int i = 0; i < m.rows; i++ )
+                fs.writeRaw(dt, m.ptr(i), m.cols*m.elemSize());
         fs << "]";
         fs.endWriteStruct();
     }
@@ -153,7 +156,19 @@ void read(const FileNode& node, Mat& m, const Mat& default_mat)
     size_t nelems = data_node.size();
     CV_Assert(nelems == m.total()*m.channels());
 
-    data_node.readRaw(dt, (uchar*)m.ptr(), m.total()*m.elemSize());
+    if (m.isContinuous())
+    {
+        data_node.readRaw(dt, (uchar*)m.ptr(), m.total()*m.elemSize());
+        return;
+    }
+
+    // preallocated sub-matrix: the data is read directly into its planes (rows)
+    const Mat* arrays[] = { &m, 0 };
+    uchar* ptrs[1] = { 0 };
+    NAryMatIterator planes(arrays, ptrs);
+    FileNodeIterator it = data_node.begin();
+    for (size_t i = 0; i < planes.nplanes; i++, ++planes)
+        it.readRaw(dt, ptrs[0], planes.size*m.elemSize());
 }
 
 void read( const FileNode& node, SparseMat& m, const SparseMat& default_mat )
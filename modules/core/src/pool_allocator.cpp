@@ -0,0 +1,580 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+#include "bufferpool.impl.hpp"
+#include "opencv2/core/utils/pool_allocator.hpp"
+#include "opencv2/core/utils/buffer_pool.private.hpp"
+
+#include <opencv2/core/utils/configuration.private.hpp>
+#include <opencv2/core/utils/tls.hpp>
+#include <opencv2/core/utils/logger.defines.hpp>
+#undef CV_LOG_STRIP_LEVEL
+#define CV_LOG_STRIP_LEVEL CV_LOG_LEVEL_DEBUG + 1
+#include <opencv2/core/utils/logger.hpp>
+
+#include <atomic>
+
+namespace cv { namespace utils {
+
+PoolAllocatorStatistics::PoolAllocatorStatistics()
+    : allocations(0), hits(0), misses(0), bypassed(0), evictions(0), reservedSize(0)
+{
+    // nothing
+}
+
+namespace {
+
+static const int POOL_MIN_CLASS_LOG2 = 6;  // buffers up to 64 bytes share the first size class
+static const int POOL_CLASS_STEPS_LOG2 = 2;  // 4 size classes per power of two
+
+/** Size class of buffer. Returns -1 for buffers larger than 2^max_size_log2 */
+static inline
+int getSizeClass(size_t size, int max_size_log2, size_t& class_size)
+{
+    if (size <= ((size_t)1 << POOL_MIN_CLASS_LOG2))
+    {
+        class_size = (size_t)1 << POOL_MIN_CLASS_LOG2;
+        return 0;
+    }
+    int k = POOL_MIN_CLASS_LOG2;  // 2^k < size <= 2^(k+1)
+    while (k < max_size_log2 && (size - 1) >> (k + 1))
+        k++;
+    if (k >= max_size_log2)
+        return -1;
+    const size_t base = (size_t)1 << k;
+    const size_t step = base >> POOL_CLASS_STEPS_LOG2;
+    const size_t j = (size - base + step - 1) / step;  // 1..4
+    class_size = base + j * step;
+    return 1 + ((k - POOL_MIN_CLASS_LOG2) << POOL_CLASS_STEPS_LOG2) + (int)(j - 1);
+}
+
+struct PoolEntry
+{
+    void* ptr;
+    uint64 stamp;  // release order
+};
+
+struct PoolBuffer
+{
+    void* ptr;
+    int size_class;
+};
+
+/** Cached buffers grouped by size class */
+class PoolBins
+{
+public:
+    PoolBins() : reservedSize(0), stamp(0) {}
+
+    void init(int num_classes)
+    {
+        bins.resize(num_classes);
+    }
+
+    size_t getReservedSize() const { return reservedSize; }
+
+    /** Takes the most recently released buffer of the class */
+    bool pop(int size_class, size_t class_size, void*& ptr)
+    {
+        std::vector<PoolEntry>& bin = bins[size_class];
+        if (bin.empty())
+            return false;
+        ptr = bin.back().ptr;
+        bin.pop_back();
+        reservedSize -= class_size;
+        return true;
+    }
+
+    void push(int size_class, size_t class_size, void* ptr)
+    {
+        PoolEntry e = { ptr, ++stamp };
+        bins[size_class].push_back(e);
+        reservedSize += class_size;
+    }
+
+    /** Removes the least recently released buffer (among all classes) */
+    bool popOldest(int& size_class, void*& ptr, const std::vector<size_t>& class_sizes)
+    {
+        int oldest = -1;
+        for (size_t i = 0; i < bins.size(); i++)
+        {
+            if (!bins[i].empty() && (oldest < 0 || bins[i].front().stamp < bins[oldest].front().stamp))
+                oldest = (int)i;
+        }
+        if (oldest < 0)
+            return false;
+        std::vector<PoolEntry>& bin = bins[oldest];
+        size_class = oldest;
+        ptr = bin.front().ptr;
+        bin.erase(bin.begin());
+        reservedSize -= class_sizes[oldest];
+        return true;
+    }
+
+    /** Moves all buffers into the list */
+    void popAll(std::vector<void*>& buffers)
+    {
+        for (size_t i = 0; i < bins.size(); i++)
+        {
+            for (size_t j = 0; j < bins[i].size(); j++)
+                buffers.push_back(bins[i][j].ptr);
+            bins[i].clear();
+        }
+        reservedSize = 0;
+    }
+
+protected:
+    std::vector< std::vector<PoolEntry> > bins;
+    size_t reservedSize;
+    uint64 stamp;
+};
+
+class SizeClassBufferPool;
+
+/** Per-thread cache. Mutex is not contended: it is locked by other threads on flushing/statistics requests only */
+struct ThreadCache
+{
+    ThreadCache();
+    ~ThreadCache();
+
+    SizeClassBufferPool* pool;  // set on the first use
+    Mutex mutex;
+    PoolBins bins;
+
+    // written by the owner thread only
+    std::atomic<uint64> allocations, hits, bypassed;
+};
+
+/** @brief Pool of buffers grouped by size classes
+
+Each thread works with own cache, thread caches are backed by the shared pool.
+Least recently released buffers are freed first when limits are exceeded.
+*/
+class SizeClassBufferPool CV_FINAL : public BufferPoolController
+{
+public:
+    /**
+    @param maxBufferSize larger buffers are not cached, 0 disables pooling
+    @param threadCacheSize_ limit of each thread cache
+    @param maxReservedSize_ limit of the shared pool
+    */
+    SizeClassBufferPool(size_t maxBufferSize, size_t threadCacheSize_, size_t maxReservedSize_)
+        : enabled(maxBufferSize > 0),
+          maxBufferSizeLog2(POOL_MIN_CLASS_LOG2 + 1),
+          threadCacheSize(threadCacheSize_),
+          maxReservedSize(maxReservedSize_),
+          evictions(0)
+    {
+        while (maxBufferSizeLog2 < 48 && ((size_t)1 << maxBufferSizeLog2) < maxBufferSize)
+            maxBufferSizeLog2++;
+        size_t class_size = 0;
+        int num_classes = getSizeClass((size_t)1 << maxBufferSizeLog2, maxBufferSizeLog2, class_size) + 1;
+        classSizes.resize(num_classes);
+        for (int i = 0; i < num_classes; i++)
+        {
+            size_t size = (size_t)1 << POOL_MIN_CLASS_LOG2;
+            if (i > 0)
+            {
+                int k = POOL_MIN_CLASS_LOG2 + ((i - 1) >> POOL_CLASS_STEPS_LOG2);
+                size_t base = (size_t)1 << k;
+                size = base + (size_t)((i - 1) % (1 << POOL_CLASS_STEPS_LOG2) + 1) * (base >> POOL_CLASS_STEPS_LOG2);
+            }
+            classSizes[i] = size;
+        }
+        shared.init(num_classes);
+        CV_LOG_DEBUG(NULL, "core(pool_allocator): " << num_classes << " size classes, max buffer size = " << classSizes.back()
+                << (enabled ? "" : " (disabled)"));
+    }
+
+    ~SizeClassBufferPool()
+    {
+        // not reachable: pools are never destroyed, thread caches refer them on thread termination
+    }
+
+    void* allocate(size_t size)
+    {
+        if (!enabled)
+            return fastMalloc(size);
+        ThreadCache& cache = getThreadCache();
+        cache.allocations.fetch_add(1, std::memory_order_relaxed);
+        size_t class_size = 0;
+        int size_class = getSizeClass(size, maxBufferSizeLog2, class_size);
+        if (size_class < 0)
+        {
+            cache.bypassed.fetch_add(1, std::memory_order_relaxed);
+            return fastMalloc(size);
+        }
+        void* ptr = NULL;
+        {
+            AutoLock lock(cache.mutex);
+            if (cache.bins.pop(size_class, class_size, ptr))
+            {
+                cache.hits.fetch_add(1, std::memory_order_relaxed);
+                return ptr;
+            }
+        }
+        {
+            AutoLock lock(mutex_shared);
+            if (shared.pop(size_class, class_size, ptr))
+            {
+                cache.hits.fetch_add(1, std::memory_order_relaxed);
+                return ptr;
+            }
+        }
+        return fastMalloc(class_size);
+    }
+
+    /** size must be the same as passed to allocate() */
+    void release(void* ptr, size_t size)
+    {
+        if (!ptr)
+            return;
+        size_t class_size = 0;
+        int size_class = enabled ? getSizeClass(size, maxBufferSizeLog2, class_size) : -1;
+        if (size_class < 0)
+        {
+            fastFree(ptr);
+            return;
+        }
+        ThreadCache& cache = getThreadCache();
+        std::vector<PoolBuffer> spilled;
+        {
+            AutoLock lock(cache.mutex);
+            cache.bins.push(size_class, class_size, ptr);
+            PoolBuffer b = { NULL, -1 };
+            while (cache.bins.getReservedSize() > threadCacheSize && cache.bins.popOldest(b.size_class, b.ptr, classSizes))
+                spilled.push_back(b);
+        }
+        if (!spilled.empty())
+            moveToSharedPool(spilled);
+    }
+
+    // BufferPoolController interface: limits the shared pool, thread caches are flushed by freeAllReservedBuffers() only
+    size_t getReservedSize() const CV_OVERRIDE
+    {
+        return getStatistics().reservedSize;
+    }
+
+    size_t getMaxReservedSize() const CV_OVERRIDE
+    {
+        AutoLock lock(mutex_shared);
+        return maxReservedSize;
+    }
+
+    void setMaxReservedSize(size_t size) CV_OVERRIDE
+    {
+        std::vector<void*> released;
+        {
+            AutoLock lock(mutex_shared);
+            maxReservedSize = size;
+            _checkSizeOfSharedPool(released);
+        }
+        freeBuffers(released);
+    }
+
+    void freeAllReservedBuffers() CV_OVERRIDE
+    {
+        std::vector<void*> released;
+        {
+            AutoLock lock(mutex_caches);
+            for (size_t i = 0; i < caches.size(); i++)
+            {
+                AutoLock lock_cache(caches[i]->mutex);
+                caches[i]->bins.popAll(released);
+            }
+        }
+        {
+            AutoLock lock(mutex_shared);
+            shared.popAll(released);
+        }
+        CV_LOG_DEBUG(NULL, "core(pool_allocator): release " << released.size() << " cached buffers");
+        freeBuffers(released);
+    }
+
+    PoolAllocatorStatistics getStatistics() const
+    {
+        PoolAllocatorStatistics stat;
+        {
+            AutoLock lock(mutex_caches);
+            stat = retired;
+            for (size_t i = 0; i < caches.size(); i++)
+            {
+                ThreadCache& c = *caches[i];
+                stat.allocations += c.allocations.load(std::memory_order_relaxed);
+                stat.hits += c.hits.load(std::memory_order_relaxed);
+                stat.bypassed += c.bypassed.load(std::memory_order_relaxed);
+                AutoLock lock_cache(c.mutex);
+                stat.reservedSize += c.bins.getReservedSize();
+            }
+        }
+        {
+            AutoLock lock(mutex_shared);
+            stat.evictions = evictions;
+            stat.reservedSize += shared.getReservedSize();
+        }
+        stat.misses = stat.allocations - stat.hits;
+        return stat;
+    }
+
+    void resetStatistics()
+    {
+        {
+            AutoLock lock(mutex_caches);
+            retired = PoolAllocatorStatistics();
+            for (size_t i = 0; i < caches.size(); i++)
+            {
+                ThreadCache& c = *caches[i];
+                c.allocations = 0;
+                c.hits = 0;
+                c.bypassed = 0;
+            }
+        }
+        AutoLock lock(mutex_shared);
+        evictions = 0;
+    }
+
+protected:
+    friend struct ThreadCache;
+
+    ThreadCache& getThreadCache()
+    {
+        ThreadCache& cache = tls.getRef();
+        if (!cache.pool)
+        {
+            cache.pool = this;
+            cache.bins.init((int)classSizes.size());
+            AutoLock lock(mutex_caches);
+            caches.push_back(&cache);
+        }
+        return cache;
+    }
+
+    void moveToSharedPool(const std::vector<PoolBuffer>& buffers)
+    {
+        std::vector<void*> released;
+        {
+            AutoLock lock(mutex_shared);
+            for (size_t i = 0; i < buffers.size(); i++)
+            {
+                const PoolBuffer& b = buffers[i];
+                shared.push(b.size_class, classSizes[b.size_class], b.ptr);
+            }
+            _checkSizeOfSharedPool(released);
+        }
+        freeBuffers(released);
+    }
+
+    // synchronized (mutex_shared)
+    void _checkSizeOfSharedPool(std::vector<void*>& released)
+    {
+        while (shared.getReservedSize() > maxReservedSize)
+        {
+            int c = -1;
+            void* ptr = NULL;
+            if (!shared.popOldest(c, ptr, classSizes))
+                break;
+            released.push_back(ptr);
+            evictions++;
+        }
+    }
+
+    static void freeBuffers(const std::vector<void*>& buffers)
+    {
+        for (size_t i = 0; i < buffers.size(); i++)
+            fastFree(buffers[i]);
+    }
+
+    /** thread is terminated: keep its counters, pass buffers to other threads */
+    void unregisterCache(ThreadCache* cache)
+    {
+        std::vector<PoolBuffer> buffers;
+        {
+            AutoLock lock(mutex_caches);
+            caches.erase(std::remove(caches.begin(), caches.end(), cache), caches.end());
+            retired.allocations += cache->allocations.load();
+            retired.hits += cache->hits.load();
+            retired.bypassed += cache->bypassed.load();
+            AutoLock lock_cache(cache->mutex);
+            PoolBuffer b = { NULL, -1 };
+            while (cache->bins.popOldest(b.size_class, b.ptr, classSizes))
+                buffers.push_back(b);
+        }
+        moveToSharedPool(buffers);
+    }
+
+    const bool enabled;
+    int maxBufferSizeLog2;  // buffers larger than 2^maxBufferSizeLog2 are not cached
+    std::vector<size_t> classSizes;
+    const size_t threadCacheSize;
+
+    mutable Mutex mutex_shared;  // guards fields below
+    PoolBins shared;
+    size_t maxReservedSize;
+    uint64 evictions;
+
+    mutable Mutex mutex_caches;  // guards list of thread caches and counters of terminated threads
+    std::vector<ThreadCache*> caches;
+    PoolAllocatorStatistics retired;
+
+    TLSData<ThreadCache> tls;
+};
+
+ThreadCache::ThreadCache()
+    : pool(NULL)
+{
+    allocations = 0;
+    hits = 0;
+    bypassed = 0;
+}
+
+ThreadCache::~ThreadCache()
+{
+    if (pool)
+        pool->unregisterCache(this);
+}
+
+/** MatAllocator which takes buffers from the pool */
+class PoolMatAllocator CV_FINAL : public MatAllocator
+{
+public:
+    PoolMatAllocator(SizeClassBufferPool& pool_) : pool(pool_) {}
+
+    UMatData* allocate(int dims, const int* sizes, int type,
+                       void* data0, size_t* step, AccessFlag /*flags*/, UMatUsageFlags /*usageFlags*/) const CV_OVERRIDE
+    {
+        size_t total = CV_ELEM_SIZE(type);
+        for( int i = dims-1; i >= 0; i-- )
+        {
+            if( step )
+            {
+                if( data0 && step[i] != CV_AUTOSTEP )
+                {
+                    CV_Assert(total <= step[i]);
+                    total = step[i];
+                }
+                else
+                    step[i] = total;
+            }
+            total *= sizes[i];
+        }
+        uchar* data = data0 ? (uchar*)data0 : (uchar*)pool.allocate(total);
+        UMatData* u = new UMatData(this);
+        u->data = u->origdata = data;
+        u->size = total;
+        if(data0)
+            u->flags |= UMatData::USER_ALLOCATED;
+
+        return u;
+    }
+
+    bool allocate(UMatData* u, AccessFlag /*accessFlags*/, UMatUsageFlags /*usageFlags*/) const CV_OVERRIDE
+    {
+        if(!u) return false;
+        return true;
+    }
+
+    void deallocate(UMatData* u) const CV_OVERRIDE
+    {
+        if(!u)
+            return;
+
+        CV_Assert(u->urefcount == 0);
+        CV_Assert(u->refcount == 0);
+        if( !(u->flags & UMatData::USER_ALLOCATED) )
+        {
+            pool.release(u->origdata, u->size);
+            u->origdata = 0;
+        }
+        delete u;
+    }
+
+    BufferPoolController* getBufferPoolController(const char* id) const CV_OVERRIDE
+    {
+        CV_UNUSED(id);
+        return &pool;
+    }
+
+protected:
+    SizeClassBufferPool& pool;
+};
+
+static size_t CV_POOL_ALLOCATOR_MAX_BUFFER_SIZE = utils::getConfigurationParameterSizeT("OPENCV_POOL_ALLOCATOR_MAX_BUFFER_SIZE", (size_t)64 << 20);
+static size_t CV_POOL_ALLOCATOR_THREAD_CACHE_SIZE = utils::getConfigurationParameterSizeT("OPENCV_POOL_ALLOCATOR_THREAD_CACHE_SIZE", (size_t)32 << 20);
+static size_t CV_POOL_ALLOCATOR_MAX_RESERVED_SIZE = utils::getConfigurationParameterSizeT("OPENCV_POOL_ALLOCATOR_MAX_RESERVED_SIZE", (size_t)256 << 20);
+
+#ifdef OPENCV_ENABLE_MEMORY_SANITIZER
+static const size_t CV_BUFFER_POOL_DEFAULT_MAX_BUFFER_SIZE = 0;  // don't hide use-after-free issues
+#else
+static const size_t CV_BUFFER_POOL_DEFAULT_MAX_BUFFER_SIZE = (size_t)8 << 20;
+#endif
+static size_t CV_BUFFER_POOL_MAX_BUFFER_SIZE = utils::getConfigurationParameterSizeT("OPENCV_BUFFER_POOL_MAX_BUFFER_SIZE", CV_BUFFER_POOL_DEFAULT_MAX_BUFFER_SIZE);
+static size_t CV_BUFFER_POOL_THREAD_CACHE_SIZE = utils::getConfigurationParameterSizeT("OPENCV_BUFFER_POOL_THREAD_CACHE_SIZE", (size_t)8 << 20);
+static size_t CV_BUFFER_POOL_MAX_RESERVED_SIZE = utils::getConfigurationParameterSizeT("OPENCV_BUFFER_POOL_MAX_RESERVED_SIZE", (size_t)32 << 20);
+
+/** Pool for buffers of utils::getPoolMatAllocator() */
+static SizeClassBufferPool& getMatBufferPool()
+{
+    CV_SINGLETON_LAZY_INIT_REF(SizeClassBufferPool, new SizeClassBufferPool(
+            CV_POOL_ALLOCATOR_MAX_BUFFER_SIZE, CV_POOL_ALLOCATOR_THREAD_CACHE_SIZE, CV_POOL_ALLOCATOR_MAX_RESERVED_SIZE))
+}
+
+/** Pool for temporary buffers of OpenCV functions */
+static SizeClassBufferPool& getTemporaryBufferPool()
+{
+    CV_SINGLETON_LAZY_INIT_REF(SizeClassBufferPool, new SizeClassBufferPool(
+            CV_BUFFER_POOL_MAX_BUFFER_SIZE, CV_BUFFER_POOL_THREAD_CACHE_SIZE, CV_BUFFER_POOL_MAX_RESERVED_SIZE))
+}
+
+}  // namespace
+
+
+MatAllocator* getPoolMatAllocator()
+{
+    CV_SINGLETON_LAZY_INIT(MatAllocator, new PoolMatAllocator(getMatBufferPool()))
+}
+
+PoolAllocatorStatistics getPoolMatAllocatorStatistics()
+{
+    return getMatBufferPool().getStatistics();
+}
+
+void resetPoolMatAllocatorStatistics()
+{
+    getMatBufferPool().resetStatistics();
+}
+
+void* allocateTemporaryBuffer(size_t size)
+{
+    return getTemporaryBufferPool().allocate(size);
+}
+
+void releaseTemporaryBuffer(void* ptr, size_t size)
+{
+    getTemporaryBufferPool().release(ptr, size);
+}
+
+MatAllocator* getTemporaryMatAllocator()
+{
+    CV_SINGLETON_LAZY_INIT(MatAllocator, new PoolMatAllocator(getTemporaryBufferPool()))
+}
+
+PoolAllocatorStatistics getTemporaryBufferPoolStatistics()
+{
+    return getTemporaryBufferPool().getStatistics();
+}
+
+void resetTemporaryBufferPoolStatistics()
+{
+    getTemporaryBufferPool().resetStatistics();
+}
+
+}  // namespace utils
+
+BufferPoolController* getTemporaryBufferPoolController()
+{
+    return &utils::getTemporaryBufferPool();
+}
+
+}  // namespace cv
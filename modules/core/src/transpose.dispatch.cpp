@@ -0,0 +1,20 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+
+#include "precomp.hpp"
+#include "transpose.hpp"
+
+#include "transpose.simd.hpp"
+#include "transpose.simd_declarations.hpp" // defines CV_CPU_DISPATCH_MODES_ALL=AVX2,...,BASELINE based on CMakeLists.txt content
+
+namespace cv {
+
+TransposeFunc getTransposeFunc( size_t esz )
+{
+    CV_CPU_DISPATCH(getTransposeFunc, (esz),
+        CV_CPU_DISPATCH_MODES_ALL);
+}
+
+} // namespace
@@ -0,0 +1,21 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+#ifndef OPENCV_CORE_SRC_TRANSPOSE_HPP
+#define OPENCV_CORE_SRC_TRANSPOSE_HPP
+
+namespace cv {
+
+/** @brief Transposes `sz.height` x `sz.width` array: dst(i, j) = src(j, i)
+
+Steps may be negative, this is used for rotation of arrays by 90 degrees.
+*/
+typedef void (*TransposeFunc)( const uchar* src, ptrdiff_t sstep, uchar* dst, ptrdiff_t dstep, Size sz );
+
+/** @brief Returns transposition kernel for elements of `esz` bytes or NULL if the size is not supported */
+TransposeFunc getTransposeFunc( size_t esz );
+
+} // namespace
+
+#endif // OPENCV_CORE_SRC_TRANSPOSE_HPP
@@ -0,0 +1,223 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+#include "precomp.hpp"
+#include "transpose.hpp"
+
+namespace cv {
+
+CV_CPU_OPTIMIZATION_NAMESPACE_BEGIN
+
+TransposeFunc getTransposeFunc( size_t esz );
+
+
+#ifndef CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
+
+namespace {
+
+template<typename T> static void
+transpose_( const uchar* src, ptrdiff_t sstep, uchar* dst, ptrdiff_t dstep, Size sz )
+{
+    int i=0, j, m = sz.width, n = sz.height;
+
+    #if CV_ENABLE_UNROLLED
+    for(; i <= m - 4; i += 4 )
+    {
+        T* d0 = (T*)(dst + dstep*i);
+        T* d1 = (T*)(dst + dstep*(i+1));
+        T* d2 = (T*)(dst + dstep*(i+2));
+        T* d3 = (T*)(dst + dstep*(i+3));
+
+        for( j = 0; j <= n - 4; j += 4 )
+        {
+            const T* s0 = (const T*)(src + i*sizeof(T) + sstep*j);
+            const T* s1 = (const T*)(src + i*sizeof(T) + sstep*(j+1));
+            const T* s2 = (const T*)(src + i*sizeof(T) + sstep*(j+2));
+            const T* s3 = (const T*)(src + i*sizeof(T) + sstep*(j+3));
+
+            d0[j] = s0[0]; d0[j+1] = s1[0]; d0[j+2] = s2[0]; d0[j+3] = s3[0];
+            d1[j] = s0[1]; d1[j+1] = s1[1]; d1[j+2] = s2[1]; d1[j+3] = s3[1];
+            d2[j] = s0[2]; d2[j+1] = s1[2]; d2[j+2] = s2[2]; d2[j+3] = s3[2];
+            d3[j] = s0[3]; d3[j+1] = s1[3]; d3[j+2] = s2[3]; d3[j+3] = s3[3];
+        }
+
+        for( ; j < n; j++ )
+        {
+            const T* s0 = (const T*)(src + i*sizeof(T) + j*sstep);
+            d0[j] = s0[0]; d1[j] = s0[1]; d2[j] = s0[2]; d3[j] = s0[3];
+        }
+    }
+    #endif
+    for( ; i < m; i++ )
+    {
+        T* d0 = (T*)(dst + dstep*i);
+        j = 0;
+        #if CV_ENABLE_UNROLLED
+        for(; j <= n - 4; j += 4 )
+        {
+            const T* s0 = (const T*)(src + i*sizeof(T) + sstep*j);
+            const T* s1 = (const T*)(src + i*sizeof(T) + sstep*(j+1));
+            const T* s2 = (const T*)(src + i*sizeof(T) + sstep*(j+2));
+            const T* s3 = (const T*)(src + i*sizeof(T) + sstep*(j+3));
+
+            d0[j] = s0[0]; d0[j+1] = s1[0]; d0[j+2] = s2[0]; d0[j+3] = s3[0];
+        }
+        #endif
+        for( ; j < n; j++ )
+        {
+            const T* s0 = (const T*)(src + i*sizeof(T) + j*sstep);
+            d0[j] = s0[0];
+        }
+    }
+}
+
+#if CV_SIMD128
+
+// In-register transposition of square blocks: a[k] is the k-th row of the block on input and the k-th column on output
+
+static inline void transposeSquare( v_uint8x16 (&a)[16] )
+{
+    v_uint8x16 b[16];
+    for( int k = 0; k < 16; k += 2 )
+        v_zip(a[k], a[k+1], b[k], b[k+1]);
+    v_uint16x8 c[16];
+    for( int g = 0; g < 16; g += 4 )
+    {
+        v_zip(v_reinterpret_as_u16(b[g]), v_reinterpret_as_u16(b[g+2]), c[g], c[g+1]);
+        v_zip(v_reinterpret_as_u16(b[g+1]), v_reinterpret_as_u16(b[g+3]), c[g+2], c[g+3]);
+    }
+    v_uint32x4 d[16]; // d[8*h + p] contains columns 2*p and 2*p+1 of rows 8*h ... 8*h+7
+    for( int h = 0; h < 2; h++ )
+        for( int q = 0; q < 4; q++ )
+            v_zip(v_reinterpret_as_u32(c[8*h + q]), v_reinterpret_as_u32(c[8*h + 4 + q]), d[8*h + 2*q], d[8*h + 2*q + 1]);
+    for( int p = 0; p < 8; p++ )
+    {
+        a[2*p] = v_reinterpret_as_u8(v_combine_low(d[p], d[8 + p]));
+        a[2*p + 1] = v_reinterpret_as_u8(v_combine_high(d[p], d[8 + p]));
+    }
+}
+
+static inline void transposeSquare( v_uint16x8 (&a)[8] )
+{
+    v_uint16x8 b[8];
+    for( int k = 0; k < 8; k += 2 )
+        v_zip(a[k], a[k+1], b[k], b[k+1]);
+    v_uint32x4 c[8]; // c[4*g + q] contains columns 2*q and 2*q+1 of rows 4*g ... 4*g+3
+    for( int g = 0; g < 8; g += 4 )
+    {
+        v_zip(v_reinterpret_as_u32(b[g]), v_reinterpret_as_u32(b[g+2]), c[g], c[g+1]);
+        v_zip(v_reinterpret_as_u32(b[g+1]), v_reinterpret_as_u32(b[g+3]), c[g+2], c[g+3]);
+    }
+    for( int q = 0; q < 4; q++ )
+    {
+        a[2*q] = v_reinterpret_as_u16(v_combine_low(c[q], c[4 + q]));
+        a[2*q + 1] = v_reinterpret_as_u16(v_combine_high(c[q], c[4 + q]));
+    }
+}
+
+static inline void transposeSquare( v_uint32x4 (&a)[4] )
+{
+    v_uint32x4 b0, b1, b2, b3;
+    v_transpose4x4(a[0], a[1], a[2], a[3], b0, b1, b2, b3);
+    a[0] = b0; a[1] = b1; a[2] = b2; a[3] = b3;
+}
+
+// NxN block of elements with the single lane-sized channel
+template<typename V, int N> static inline void
+transposeBlock_( const uchar* src, ptrdiff_t sstep, uchar* dst, ptrdiff_t dstep )
+{
+    typedef typename VTraits<V>::lane_type T;
+    V a[N];
+    for( int k = 0; k < N; k++ )
+        a[k] = v_load((const T*)(src + sstep*k));
+    transposeSquare(a);
+    for( int k = 0; k < N; k++ )
+        v_store((T*)(dst + dstep*k), a[k]);
+}
+
+// NxN block of 3-channel elements: channels are transposed separately
+template<typename V, int N> static inline void
+transposeBlockC3_( const uchar* src, ptrdiff_t sstep, uchar* dst, ptrdiff_t dstep )
+{
+    typedef typename VTraits<V>::lane_type T;
+    V a[N], b[N], c[N];
+    for( int k = 0; k < N; k++ )
+        v_load_deinterleave((const T*)(src + sstep*k), a[k], b[k], c[k]);
+    transposeSquare(a);
+    transposeSquare(b);
+    transposeSquare(c);
+    for( int k = 0; k < N; k++ )
+        v_store_interleave((T*)(dst + dstep*k), a[k], b[k], c[k]);
+}
+
+template<typename T, typename V, int N, bool C3> static void
+transposeSIMD_( const uchar* src, ptrdiff_t sstep, uchar* dst, ptrdiff_t dstep, Size sz )
+{
+    int i = 0, j, m = sz.width, n = sz.height;
+
+    for( ; i <= m - N; i += N )
+    {
+        for( j = 0; j <= n - N; j += N )
+        {
+            const uchar* s = src + sstep*j + i*sizeof(T);
+            uchar* d = dst + dstep*i + j*sizeof(T);
+            if( C3 )
+                transposeBlockC3_<V, N>(s, sstep, d, dstep);
+            else
+                transposeBlock_<V, N>(s, sstep, d, dstep);
+        }
+        if( j < n )
+            transpose_<T>(src + sstep*j + i*sizeof(T), sstep, dst + dstep*i + j*sizeof(T), dstep, Size(N, n - j));
+    }
+    if( i < m )
+        transpose_<T>(src + i*sizeof(T), sstep, dst + dstep*i, dstep, Size(m - i, n));
+}
+
+#endif // CV_SIMD128
+
+#define DEF_TRANSPOSE_FUNC(suffix, type) \
+static void transpose_##suffix( const uchar* src, ptrdiff_t sstep, uchar* dst, ptrdiff_t dstep, Size sz ) \
+{ transpose_<type>(src, sstep, dst, dstep, sz); }
+
+#define DEF_TRANSPOSE_FUNC_SIMD(suffix, type, vtype, N, C3) \
+static void transpose_##suffix( const uchar* src, ptrdiff_t sstep, uchar* dst, ptrdiff_t dstep, Size sz ) \
+{ transposeSIMD_<type, vtype, N, C3>(src, sstep, dst, dstep, sz); }
+
+#if CV_SIMD128
+DEF_TRANSPOSE_FUNC_SIMD(8u, uchar, v_uint8x16, 16, false)
+DEF_TRANSPOSE_FUNC_SIMD(16u, ushort, v_uint16x8, 8, false)
+DEF_TRANSPOSE_FUNC_SIMD(8uC3, Vec3b, v_uint8x16, 16, true)
+DEF_TRANSPOSE_FUNC_SIMD(32s, int, v_uint32x4, 4, false)
+DEF_TRANSPOSE_FUNC_SIMD(16uC3, Vec3s, v_uint16x8, 8, true)
+#else
+DEF_TRANSPOSE_FUNC(8u, uchar)
+DEF_TRANSPOSE_FUNC(16u, ushort)
+DEF_TRANSPOSE_FUNC(8uC3, Vec3b)
+DEF_TRANSPOSE_FUNC(32s, int)
+DEF_TRANSPOSE_FUNC(16uC3, Vec3s)
+#endif
+// wide elements are moved by scalar code: SIMD shuffles don't outperform it
+DEF_TRANSPOSE_FUNC(32sC2, Vec2i)
+DEF_TRANSPOSE_FUNC(32sC3, Vec3i)
+DEF_TRANSPOSE_FUNC(32sC4, Vec4i)
+DEF_TRANSPOSE_FUNC(32sC6, Vec6i)
+DEF_TRANSPOSE_FUNC(32sC8, Vec8i)
+
+} // namespace
+
+TransposeFunc getTransposeFunc( size_t esz )
+{
+    static TransposeFunc transposeTab[] =
+    {
+        0, transpose_8u, transpose_16u, transpose_8uC3, transpose_32s, 0, transpose_16uC3, 0,
+        transpose_32sC2, 0, 0, 0, transpose_32sC3, 0, 0, 0, transpose_32sC4,
+        0, 0, 0, 0, 0, 0, 0, transpose_32sC6, 0, 0, 0, 0, 0, 0, 0, transpose_32sC8
+    };
+    return esz < sizeof(transposeTab)/sizeof(transposeTab[0]) ? transposeTab[esz] : 0;
+}
+
+#endif // CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
+
+CV_CPU_OPTIMIZATION_NAMESPACE_END
+} // namespace
@@ -2454,6 +2454,65 @@ INSTANTIATE_TEST_CASE_P(Arithm, FlipND, testing::Combine(
     testing::Values(perf::MatType(CV_8UC1), CV_32FC1)
 ));
 
+typedef testing::TestWithParam<perf::MatType> Core_TransposeFlipRotate;
+
+static Mat referenceRemap(const Mat& src, Size dsize, int code)  // dst(y, x) = src(...)
+{
+    Mat dst(dsize, src.type());
+    size_t esz = src.elemSize();
+    for (int y = 0; y < dst.rows; y++)
+        for (int x = 0; x < dst.cols; x++)
+        {
+            Point p = code == 0 ? Point(y, x) :                              // transpose
+                      code == 1 ? Point(src.cols - 1 - x, y) :               // flip(1)
+                      code == 2 ? Point(x, src.rows - 1 - y) :               // flip(0)
+                      code == 3 ? Point(src.cols - 1 - x, src.rows - 1 - y) : // flip(-1)
+                      code == 4 ? Point(y, src.rows - 1 - x) :               // ROTATE_90_CLOCKWISE
+                                  Point(src.cols - 1 - y, x);                // ROTATE_90_COUNTERCLOCKWISE
+            memcpy(dst.ptr(y, x), src.ptr(p.y, p.x), esz);
+        }
+    return dst;
+}
+
+TEST_P(Core_TransposeFlipRotate, blocked)
+{
+    const int type = GetParam();
+    Mat big(300, 280, type);
+    randu(big, Scalar::all(0), Scalar::all(255));
+    // sizes are not multiples of tiles and SIMD blocks, the submatrix is not continuous
+    Mat src = big(Rect(3, 5, 263, 131));
+    Size tsize(src.rows, src.cols);
+
+    Mat dst;
+    cv::transpose(src, dst);
+    EXPECT_EQ(0, cvtest::norm(dst, referenceRemap(src, tsize, 0), NORM_INF));
+    cv::flip(src, dst, 1);
+    EXPECT_EQ(0, cvtest::norm(dst, referenceRemap(src, src.size(), 1), NORM_INF));
+    cv::flip(src, dst, 0);
+    EXPECT_EQ(0, cvtest::norm(dst, referenceRemap(src, src.size(), 2), NORM_INF));
+    cv::flip(src, dst, -1);
+    EXPECT_EQ(0, cvtest::norm(dst, referenceRemap(src, src.size(), 3), NORM_INF));
+    cv::rotate(src, dst, ROTATE_90_CLOCKWISE);
+    EXPECT_EQ(0, cvtest::norm(dst, referenceRemap(src, tsize, 4), NORM_INF));
+    cv::rotate(src, dst, ROTATE_90_COUNTERCLOCKWISE);
+    EXPECT_EQ(0, cvtest::norm(dst, referenceRemap(src, tsize, 5), NORM_INF));
+
+    // in-place operations
+    Mat square = big(Rect(1, 2, 277, 277)), ref = square.clone();
+    cv::transpose(square, square);
+    EXPECT_EQ(0, cvtest::norm(square, referenceRemap(ref, ref.size(), 0), NORM_INF));
+    ref = square.clone();
+    cv::flip(square, square, -1);
+    EXPECT_EQ(0, cvtest::norm(square, referenceRemap(ref, ref.size(), 3), NORM_INF));
+    ref = square.clone();
+    cv::rotate(square, square, ROTATE_90_CLOCKWISE);
+    EXPECT_EQ(0, cvtest::norm(square, referenceRemap(ref, ref.size(), 4), NORM_INF));
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Core_TransposeFlipRotate, testing::Values(
+    CV_8UC1, CV_8UC2, CV_8UC3, CV_8UC4, CV_16UC1, CV_16UC3, CV_16SC4, CV_32FC1,
+    CV_32SC2, CV_32FC3, CV_32FC4, CV_64FC3, CV_64FC4));
+
 TEST(BroadcastTo, basic) {
     std::vector<int> shape_src{2, 1};
     std::vector<int> data_src{1, 2};
@@ -10,6 +10,7 @@
 #if !defined(OPENCV_DISABLE_THREAD_SUPPORT)
 #include <thread>
 #include <chrono>
+#include <atomic>
 #endif
 
 namespace opencv_test { namespace {
@@ -150,6 +151,107 @@ TEST(Core_Async, AsyncThread_DetachedResult)
     EXPECT_TRUE(exception_ok);
 }
 
+TEST(Core_Async, parallel_for_async)
+{
+    Mat m(100, 100, CV_32SC1, Scalar::all(0));
+    AsyncArray r = parallel_for_async(Range(0, m.rows), [&](const Range& range)
+    {
+        for (int y = range.start; y < range.end; y++)
+            m.row(y).setTo(y);
+    });
+    EXPECT_TRUE(r.valid());
+    Mat dummy;
+    EXPECT_NO_THROW(r.get(dummy));
+    EXPECT_TRUE(dummy.empty());
+    for (int y = 0; y < m.rows; y++)
+        ASSERT_EQ(y, m.at<int>(y, m.cols - 1)) << "y=" << y;
+
+    AsyncArray r2 = parallel_for_async(Range(0, 10), [&](const Range&)
+    {
+        CV_Error(Error::StsOk, "Test: Generated async error");
+    });
+    EXPECT_THROW(r2.get(dummy), cv::Exception);
+}
+
+TEST(Core_Async, AsyncTaskGraph_dependencies)
+{
+    Mat a, b(64, 64, CV_32FC1), c, d;
+    AsyncTaskGraph graph;
+    int t_a = graph.addTask([&]() { a = Mat(64, 64, CV_32FC1, Scalar::all(1)); });
+    int t_b = graph.addParallelTask(Range(0, 64), [&](const Range& r)
+    {
+        // writes into preallocated rows only
+        for (int y = r.start; y < r.end; y++)
+            b.row(y).setTo(2);
+    }, {t_a});
+    int t_c = graph.addTask([&]() { c = a * 3; }, {t_a});
+    graph.addTask([&]() { d = b + c; }, {t_b, t_c});
+    EXPECT_EQ((size_t)4, graph.size());
+
+    AsyncArray r = graph.run();
+    Mat dummy;
+    EXPECT_NO_THROW(r.get(dummy));
+    EXPECT_EQ(0, cvtest::norm(d, Mat(64, 64, CV_32FC1, Scalar::all(5)), NORM_INF));
+
+    EXPECT_THROW(graph.run(), cv::Exception);  // once only
+    EXPECT_THROW(graph.addTask([]() {}), cv::Exception);
+}
+
+TEST(Core_Async, AsyncTaskGraph_exception)
+{
+    AsyncTaskGraph graph;
+    EXPECT_THROW(graph.addTask([]() {}, {0}), cv::Exception);  // not added yet
+
+    bool executed = false;
+    int t0 = graph.addTask([]() { CV_Error(Error::StsOk, "Test: Generated async error"); });
+    graph.addTask([&]() { executed = true; }, {t0});
+    AsyncArray r = graph.run();
+    try
+    {
+        Mat dummy;
+        r.get(dummy);
+        FAIL() << "Exception is expected";
+    }
+    catch (const cv::Exception& e)
+    {
+        EXPECT_EQ(Error::StsOk, e.code) << e.what();
+    }
+    EXPECT_FALSE(executed);
+}
+
+TEST(Core_Async, AsyncTaskGraph_exception_waits_running_tasks)
+{
+    for (int iter = 0; iter < 10; iter++)
+    {
+        std::atomic<int> started(0), finished(0);
+        AsyncTaskGraph graph;
+        graph.addTask([]() { CV_Error(Error::StsOk, "Test: Generated async error"); });
+        for (int i = 0; i < 4; i++)
+        {
+            graph.addTask([&]()
+            {
+                started++;
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                finished++;
+            });
+        }
+        AsyncArray r = graph.run();
+        Mat dummy;
+        EXPECT_THROW(r.get(dummy), cv::Exception);
+        // the tasks started before the error are completed, their captured state is still alive
+        EXPECT_EQ(started.load(), finished.load());
+    }
+}
+
+TEST(Core_Async, AsyncTaskGraph_empty)
+{
+    AsyncTaskGraph graph;
+    AsyncArray r = graph.run();
+    Mat dummy;
+    EXPECT_TRUE(r.wait_for((int64)0));
+    EXPECT_NO_THROW(r.get(dummy));
+}
+
 #endif
 
 }} // namespace
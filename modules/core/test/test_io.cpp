@@ -2003,4 +2003,348 @@ TEST(Core_InputOutput, FileStorage_invalid_attribute_value_regression_25946)
     ASSERT_EQ(0, std::remove(fileName.c_str()));
 }
 
+typedef testing::TestWithParam<std::string> Core_InputOutput_streaming;
+
+TEST_P(Core_InputOutput_streaming, read_top_level_nodes)
+{
+    const std::string fileName = cv::tempfile(GetParam().c_str());
+    Mat m1(30, 40, CV_32FC3), m2(17, 5, CV_16SC1);
+    randu(m1, -100, 100);
+    randu(m2, -1000, 1000);
+    {
+        FileStorage fs(fileName, FileStorage::WRITE);
+        fs << "i" << 5;
+        fs << "m1" << m1;
+        fs << "s" << "text";
+        fs << "nested" << "{" << "a" << 1 << "seq" << "[" << 1 << 2 << 3 << "]" << "}";
+        fs << "m2" << m2;
+        fs << "last" << 3.5;
+    }
+
+    std::vector<std::string> names;
+    Mat r1, r2;
+    int nestedSum = 0;
+    double last = 0;
+    ASSERT_TRUE(FileStorage::readTopLevelNodes(fileName, [&](const FileNode& node) {
+        names.push_back(node.name());
+        if (node.name() == "m1")
+            node >> r1;
+        else if (node.name() == "m2")
+            node >> r2;
+        else if (node.name() == "nested")
+        {
+            std::vector<int> seq;
+            node["seq"] >> seq;
+            nestedSum = (int)node["a"] + seq[0] + seq[1] + seq[2];
+        }
+        else if (node.name() == "last")
+            last = (double)node;
+        return true;
+    }));
+    ASSERT_EQ(6u, names.size());
+    EXPECT_EQ("i", names[0]);
+    EXPECT_EQ("s", names[2]);
+    EXPECT_EQ("last", names[5]);
+    EXPECT_LE(cvtest::norm(m1, r1, NORM_INF), 1e-4);
+    EXPECT_EQ(0, cvtest::norm(m2, r2, NORM_INF));
+    EXPECT_EQ(7, nestedSum);
+    EXPECT_EQ(3.5, last);
+
+    // stop after the second node
+    int calls = 0;
+    ASSERT_TRUE(FileStorage::readTopLevelNodes(fileName, [&](const FileNode&) { return ++calls < 2; }));
+    EXPECT_EQ(2, calls);
+
+    EXPECT_EQ(0, remove(fileName.c_str()));
+}
+
+TEST_P(Core_InputOutput_streaming, base64_matrix_to_submatrix)
+{
+    const std::string fileName = cv::tempfile(GetParam().c_str());
+    Mat m(45, 37, CV_64FC2), m8s(10, 9, CV_8SC3);
+    randu(m, -1, 1);
+    randu(m8s, -128, 128);
+    {
+        FileStorage fs(fileName, FileStorage::WRITE_BASE64);
+        fs << "m" << m << "m8s" << m8s << "i" << 7;
+    }
+    Mat big(60, 60, CV_64FC2, Scalar::all(-5));
+    Mat roi = big(Rect(3, 4, 37, 45));
+    Mat r8s;
+    int calls = 0;
+    ASSERT_TRUE(FileStorage::readTopLevelNodes(fileName, [&](const FileNode& node) {
+        calls++;
+        if (node.name() == "m")
+            node >> roi;
+        else if (node.name() == "m8s")
+            node >> r8s;
+        return true;
+    }));
+    EXPECT_EQ(3, calls);
+    EXPECT_EQ(big.data, roi.datastart);
+    EXPECT_EQ(0, cvtest::norm(m, roi, NORM_INF));
+    EXPECT_NEAR(-5 * 2 * (60 * 60 - 45 * 37), cv::sum(big)[0] + cv::sum(big)[1] - cv::sum(roi)[0] - cv::sum(roi)[1], 1e-6);
+    EXPECT_EQ(0, cvtest::norm(m8s, r8s, NORM_INF));
+
+    // regular reading of the same file
+    FileStorage fs(fileName, FileStorage::READ);
+    Mat r;
+    fs["m"] >> r;
+    EXPECT_EQ(0, cvtest::norm(m, r, NORM_INF));
+    EXPECT_EQ(7, (int)fs["i"]);
+    fs.release();
+    EXPECT_EQ(0, remove(fileName.c_str()));
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Core_InputOutput_streaming, Values(".xml", ".yml", ".json", ".yml.gz", ".cvbin"));
+
+TEST(Core_InputOutput, FileStorage_streaming_multiple_documents)
+{
+    const std::string content = "%YAML:1.0\n---\na: 1\nb: [ 2, 3 ]\n...\n---\nc: 4\n";
+    std::vector<std::string> names;
+    int sum = 0;
+    ASSERT_TRUE(FileStorage::readTopLevelNodes(content, [&](const FileNode& node) {
+        names.push_back(node.name());
+        for (FileNodeIterator it = node.begin(); it != node.end(); ++it)
+            sum += (int)*it;
+        return true;
+    }, FileStorage::READ | FileStorage::MEMORY));
+    ASSERT_EQ(3u, names.size());
+    EXPECT_EQ("a", names[0]);
+    EXPECT_EQ("b", names[1]);
+    EXPECT_EQ("c", names[2]);
+    EXPECT_EQ(10, sum);
+}
+
+typedef testing::TestWithParam<std::string> Core_InputOutput_binary;
+
+TEST_P(Core_InputOutput_binary, roundtrip)
+{
+    const bool memory = GetParam() == "memory";
+    const std::string fileName = memory ? std::string(".cvbin") : cv::tempfile(GetParam().c_str());
+    RNG& rng = theRNG();
+    Mat m8u(31, 17, CV_8UC3), big(50, 40, CV_32FC1), m16f(5, 6, CV_16FC2);
+    rng.fill(m8u, RNG::UNIFORM, 0, 256);
+    rng.fill(big, RNG::UNIFORM, -1000, 1000);
+    Mat roi = big(Rect(3, 5, 20, 30));
+    Mat(5, 6, CV_32FC2, Scalar(0.5, -2)).convertTo(m16f, CV_16F);
+    int ndsizes[] = { 4, 3, 5 };
+    Mat nd(3, ndsizes, CV_16SC2);
+    rng.fill(nd, RNG::UNIFORM, -30000, 30000);
+    int sp_idx[] = { 3, 1, 7 };
+    SparseMat sp(3, ndsizes, CV_64F);
+    sp.ref<double>(sp_idx[0] % 4, sp_idx[1], sp_idx[2] % 5) = 3.25;
+    std::vector<KeyPoint> kpts(2);
+    kpts[0] = KeyPoint(1.5f, 2.5f, 3.f, 45.f, 0.25f, 1, 7);
+    kpts[1] = KeyPoint(10.f, 20.f, 5.f, -1.f, 1.f, 2, -1);
+    // structure with padding between the fields
+    struct { uchar u; double d; } raw[3] = { { 1, 0.5 }, { 2, -1e300 }, { 255, 3.0 } };
+
+    std::string content;
+    {
+        FileStorage fs(fileName, FileStorage::WRITE + (memory ? FileStorage::MEMORY : 0));
+        ASSERT_TRUE(fs.isOpened());
+        EXPECT_EQ(FileStorage::FORMAT_BINARY, fs.getFormat());
+        fs << "i" << -123456 << "d" << 1.0/3 << "s" << "text with \"quotes\"\nand new line";
+        fs << "nested" << "{" << "seq" << "[" << 1 << "two" << 3.5 << "[:" << 4 << 5 << "]" << "]"
+                       << "empty_map" << "{" << "}" << "empty_seq" << "[" << "]" << "}";
+        fs << "m8u" << m8u << "roi" << roi << "m16f" << m16f << "nd" << nd << "sp" << sp;
+        fs << "empty" << Mat() << "kpts" << kpts;
+        fs << "raw" << "[";
+        fs.writeRaw("ud", raw, sizeof(raw));
+        fs << "]";
+        fs.writeComment("comments are skipped");
+        if (memory)
+            content = fs.releaseAndGetString();
+    }
+    if (!memory)
+    {
+        std::ifstream f(fileName.c_str(), std::ios::binary);
+        ASSERT_TRUE(f.is_open());
+        content.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    }
+    ASSERT_FALSE(content.empty());
+    if (GetParam() == ".cvbin" || memory)
+    {
+        EXPECT_EQ(std::string("\x89" "CVBIN"), content.substr(0, 6));
+    }
+
+    FileStorage fs(memory ? content : fileName, FileStorage::READ + (memory ? FileStorage::MEMORY : 0));
+    ASSERT_TRUE(fs.isOpened());
+    EXPECT_EQ(FileStorage::FORMAT_BINARY, fs.getFormat());
+    EXPECT_EQ(-123456, (int)fs["i"]);
+    EXPECT_EQ(1.0/3, (double)fs["d"]);
+    EXPECT_EQ("text with \"quotes\"\nand new line", (std::string)fs["s"]);
+
+    FileNode seq = fs["nested"]["seq"];
+    ASSERT_TRUE(seq.isSeq());
+    ASSERT_EQ(4u, seq.size());
+    EXPECT_EQ(1, (int)seq[0]);
+    EXPECT_EQ("two", (std::string)seq[1]);
+    EXPECT_EQ(3.5, (double)seq[2]);
+    EXPECT_EQ(2u, seq[3].size());
+    EXPECT_EQ(5, (int)seq[3][1]);
+    EXPECT_TRUE(fs["nested"]["empty_map"].isMap());
+    EXPECT_EQ(0u, fs["nested"]["empty_map"].size());
+    EXPECT_TRUE(fs["nested"]["empty_seq"].isSeq());
+    EXPECT_EQ(0u, fs["nested"]["empty_seq"].size());
+
+    Mat r8u, rroi, r16f, rnd, rempty;
+    SparseMat rsp;
+    std::vector<KeyPoint> rkpts;
+    fs["m8u"] >> r8u;
+    fs["roi"] >> rroi;
+    fs["m16f"] >> r16f;
+    fs["nd"] >> rnd;
+    fs["sp"] >> rsp;
+    fs["empty"] >> rempty;
+    fs["kpts"] >> rkpts;
+    EXPECT_EQ(0, cvtest::norm(m8u, r8u, NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(roi, rroi, NORM_INF));
+    ASSERT_EQ(CV_16FC2, r16f.type());
+    EXPECT_EQ(0, cvtest::norm(m16f, r16f, NORM_INF));
+    ASSERT_EQ(3, rnd.dims);
+    EXPECT_EQ(0, cvtest::norm(nd, rnd, NORM_INF));
+    EXPECT_EQ(1u, rsp.nzcount());
+    EXPECT_EQ(3.25, rsp.value<double>(sp_idx[0] % 4, sp_idx[1], sp_idx[2] % 5));
+    EXPECT_TRUE(rempty.empty());
+    ASSERT_EQ(2u, rkpts.size());
+    EXPECT_EQ(kpts[0].pt, rkpts[0].pt);
+    EXPECT_EQ(kpts[0].class_id, rkpts[0].class_id);
+    EXPECT_EQ(kpts[1].octave, rkpts[1].octave);
+
+    FileNode rawnode = fs["raw"];
+    ASSERT_EQ(6u, rawnode.size());
+    struct { uchar u; double d; } rraw[3] = {};
+    rawnode.readRaw("ud", rraw, sizeof(rraw));
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(raw[i].u, rraw[i].u);
+        EXPECT_EQ(raw[i].d, rraw[i].d);
+    }
+    fs.release();
+
+    if (!memory)
+    {
+        EXPECT_EQ(0, remove(fileName.c_str()));
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Core_InputOutput_binary, Values(".cvbin", ".cvbin.gz", "memory"));
+
+typedef testing::TestWithParam<std::string> Core_InputOutput_raw_data;
+
+TEST_P(Core_InputOutput_raw_data, no_element_nodes)
+{
+    const bool binary = GetParam() == ".cvbin";
+    const std::string fileName = cv::tempfile(GetParam().c_str());
+    Mat m(64, 50, CV_8UC3), s(7, 9, CV_16SC2);
+    randu(m, 0, 256);
+    randu(s, -1000, 1000);
+    std::vector<float> v(1000);
+    randu(v, -1, 1);
+    int ints[] = { 1, -2, 3 };
+    float floats[] = { 0.5f, -4.f };
+    {
+        FileStorage fs(fileName, binary ? FileStorage::WRITE : FileStorage::WRITE_BASE64);
+        ASSERT_TRUE(fs.isOpened());
+        fs << "m" << m << "s" << s << "v" << v;
+        if (binary)
+        {
+            // raw data of different formats and regular nodes in the same sequence
+            fs << "mixed" << "[";
+            fs.writeRaw("i", ints, sizeof(ints));
+            fs.writeRaw("f", floats, sizeof(floats));
+            fs << 7 << "[" << 8 << "]";
+            fs.writeRaw("i", ints, sizeof(ints));
+            fs << "]";
+        }
+    }
+
+    FileStorage fs(fileName, FileStorage::READ);
+    ASSERT_TRUE(fs.isOpened());
+
+    // the data is kept as is, it takes 1 byte per element instead of 5 bytes of the INT node
+    FileNode data = fs["m"]["data"];
+    ASSERT_EQ(m.total() * m.channels(), data.size());
+    EXPECT_LT(data.rawSize(), m.total() * m.elemSize() + 256);
+    Mat rm;
+    fs["m"] >> rm;
+    EXPECT_EQ(0, cvtest::norm(m, rm, NORM_INF));
+
+    // non-continuous destination
+    Mat big(20, 20, CV_16SC2, Scalar::all(5));
+    Mat roi = big(Rect(2, 3, 9, 7));
+    fs["s"] >> roi;
+    EXPECT_EQ(big.data, roi.datastart);
+    EXPECT_EQ(0, cvtest::norm(s, roi, NORM_INF));
+    EXPECT_EQ(5 * 2 * (20 * 20 - 9 * 7), cv::sum(big)[0] + cv::sum(big)[1] - cv::sum(roi)[0] - cv::sum(roi)[1]);
+
+    std::vector<float> rv;
+    fs["v"] >> rv;
+    EXPECT_EQ(v, rv);
+
+    // the element nodes are built after parsing, reading them doesn't modify the storage
+    FileNode vn = fs["v"];
+    ASSERT_EQ(v.size(), vn.size());
+    EXPECT_TRUE(vn[999].isReal());
+    EXPECT_EQ(v[999], (float)vn[999]);
+    size_t i = 0;
+    for (FileNodeIterator it = vn.begin(); it != vn.end(); ++it, i++)
+        ASSERT_EQ(v[i], (float)*it) << i;
+    EXPECT_EQ(v.size(), i);
+    std::vector<int> rvi;
+    vn >> rvi;
+    ASSERT_EQ(v.size(), rvi.size());
+    EXPECT_EQ(cvRound(v[10]), rvi[10]);
+    std::vector<float> rv2;
+    vn >> rv2;
+    EXPECT_EQ(v, rv2);
+
+    // concurrent reads of the same storage
+    std::vector<int> mismatches(8, 0);
+    parallel_for_(Range(0, (int)mismatches.size()), [&](const Range& r)
+    {
+        for (int t = r.start; t < r.end; t++)
+        {
+            size_t j = 0;
+            for (FileNodeIterator it = vn.begin(); it != vn.end(); ++it, j++)
+                mismatches[t] += v[j] != (float)*it;
+            mismatches[t] += (int)(j != v.size());
+        }
+    });
+    EXPECT_EQ(0, cv::sum(mismatches)[0]);
+
+    if (binary)
+    {
+        FileNode mixed = fs["mixed"];
+        ASSERT_EQ(10u, mixed.size());
+        EXPECT_EQ(-2, (int)mixed[1]);
+        EXPECT_EQ(0.5, (double)mixed[3]);
+        EXPECT_EQ(-4.0, (double)mixed[4]);
+        EXPECT_EQ(7, (int)mixed[5]);
+        EXPECT_EQ(8, (int)mixed[6][0]);
+        EXPECT_EQ(3, (int)mixed[9]);
+    }
+    fs.release();
+    EXPECT_EQ(0, remove(fileName.c_str()));
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Core_InputOutput_raw_data, Values(".cvbin", ".xml", ".yml", ".json"));
+
+TEST(Core_InputOutput, FileStorage_binary_invalid)
+{
+    const std::string content = std::string("\x89" "CVBIN\r\n") + std::string(8, '\0') + "\x05\x03";
+    EXPECT_ANY_THROW(FileStorage fs(content, FileStorage::READ + FileStorage::MEMORY));
+
+    const std::string fileName = cv::tempfile(".cvbin");
+    {
+        FileStorage fs(fileName, FileStorage::WRITE);
+        fs << "i" << 1;
+    }
+    EXPECT_THROW(FileStorage fs(fileName, FileStorage::APPEND), cv::Exception);
+    EXPECT_EQ(0, remove(fileName.c_str()));
+}
+
+
 }} // namespace
@@ -10,6 +10,7 @@
 #endif
 
 #include "opencv2/core/cuda.hpp"
+#include "opencv2/core/utils/pool_allocator.hpp"
 
 namespace opencv_test { namespace {
 
@@ -2619,4 +2620,122 @@ TEST(Mat, Recreate1DMatWithSameMeta)
     EXPECT_NO_THROW(m.create(dims, depth));
 }
 
+TEST(Mat, PoolAllocator_reuse)
+{
+    MatAllocator* pool = utils::getPoolMatAllocator();
+    BufferPoolController* controller = pool->getBufferPoolController();
+    ASSERT_TRUE(controller != NULL);
+    controller->freeAllReservedBuffers();
+    utils::resetPoolMatAllocatorStatistics();
+
+    const uchar* data = NULL;
+    {
+        Mat m;
+        m.allocator = pool;
+        m.create(480, 640, CV_8UC3);
+        m.setTo(Scalar::all(1));
+        data = m.data;
+    }
+    utils::PoolAllocatorStatistics stat = utils::getPoolMatAllocatorStatistics();
+    EXPECT_EQ(1u, stat.allocations);
+    EXPECT_EQ(0u, stat.hits);
+    EXPECT_LE((size_t)(480 * 640 * 3), stat.reservedSize);
+
+    const uchar* small_data = NULL;
+    for (int i = 0; i < 10; i++)
+    {
+        Mat m;
+        m.allocator = pool;
+        m.create(479, 640, CV_8UC3);  // same size class
+        EXPECT_EQ(data, m.data);
+        Mat small;
+        small.allocator = pool;
+        small.create(4, 4, CV_32FC1);  // first iteration is a miss of the smallest size class
+        if (i == 0)
+            small_data = small.data;
+        else
+            EXPECT_EQ(small_data, small.data);
+    }
+    stat = utils::getPoolMatAllocatorStatistics();
+    EXPECT_EQ(21u, stat.allocations);
+    EXPECT_EQ(19u, stat.hits);
+    EXPECT_EQ(2u, stat.misses);
+    EXPECT_GT(stat.hitRate(), 0.9);
+
+    controller->freeAllReservedBuffers();
+    EXPECT_EQ(0u, controller->getReservedSize());
+}
+
+#if !defined(OPENCV_DISABLE_THREAD_SUPPORT)
+TEST(Mat, PoolAllocator_threads)
+{
+    MatAllocator* pool = utils::getPoolMatAllocator();
+    BufferPoolController* controller = pool->getBufferPoolController();
+    controller->freeAllReservedBuffers();
+    utils::resetPoolMatAllocatorStatistics();
+    const size_t maxReservedSize = controller->getMaxReservedSize();
+
+    // buffers of terminated thread are passed to the shared pool
+    const uchar* data = NULL;
+    std::thread t([&]()
+    {
+        Mat m;
+        m.allocator = pool;
+        m.create(100, 100, CV_32FC1);
+        data = m.data;
+    });
+    t.join();
+    {
+        Mat m;
+        m.allocator = pool;
+        m.create(100, 100, CV_32FC1);
+        EXPECT_EQ(data, m.data);
+    }
+    utils::PoolAllocatorStatistics stat = utils::getPoolMatAllocatorStatistics();
+    EXPECT_EQ(2u, stat.allocations);
+    EXPECT_EQ(1u, stat.hits);
+
+    // shared pool limit
+    std::thread t2([&]()
+    {
+        Mat m;
+        m.allocator = pool;
+        m.create(200, 100, CV_32FC1);
+    });
+    t2.join();
+    EXPECT_LE((size_t)(200 * 100 * 4), controller->getReservedSize());
+    controller->setMaxReservedSize(0);
+    stat = utils::getPoolMatAllocatorStatistics();
+    EXPECT_EQ(1u, stat.evictions);
+    controller->setMaxReservedSize(maxReservedSize);
+
+    controller->freeAllReservedBuffers();
+    EXPECT_EQ(0u, controller->getReservedSize());
+}
+
+TEST(Mat, setThreadDefaultMatAllocator)
+{
+    MatAllocator* pool = utils::getPoolMatAllocator();
+    MatAllocator* defaultAllocator = Mat::getDefaultAllocator();
+    ASSERT_NE(pool, defaultAllocator);
+
+    utils::setThreadDefaultMatAllocator(pool);
+    EXPECT_EQ(pool, Mat::getDefaultAllocator());
+    Mat m(10, 10, CV_8UC1, Scalar::all(0));
+    EXPECT_EQ(pool, m.u->currAllocator);
+    std::thread t([&]()
+    {
+        EXPECT_EQ(defaultAllocator, Mat::getDefaultAllocator());
+        Mat m2 = m.clone();
+        EXPECT_EQ(defaultAllocator, m2.u->currAllocator);
+    });
+    t.join();
+
+    utils::setThreadDefaultMatAllocator(NULL);
+    EXPECT_EQ(defaultAllocator, Mat::getDefaultAllocator());
+    m.release();  // released by the pool
+    pool->getBufferPoolController()->freeAllReservedBuffers();
+}
+#endif
+
 }} // namespace
@@ -7,6 +7,8 @@
 #include "opencv2/core/utils/logger.hpp"
 
 #include <opencv2/core/utils/fp_control_utils.hpp>
+#include <opencv2/core/parallel/parallel_backend.hpp>
+#include <opencv2/core/utils/thread_pool.private.hpp>
 
 #include <chrono>
 #include <thread>
@@ -304,6 +306,186 @@ TEST(Core_Parallel, propagate_fp_denormals_ignore_hint)
     }
 }
 
+class NestedParallelLoopBody : public cv::ParallelLoopBody
+{
+public:
+    NestedParallelLoopBody(cv::Mat& dst) : dst_(dst) {}
+    void operator()(const cv::Range& r) const CV_OVERRIDE
+    {
+        for (int i = r.start; i < r.end; i++)
+        {
+            Mat row = dst_.row(i);
+            // uneven stripes: the first rows are much more expensive
+            int repeat = i < 4 ? 50 : 1;
+            parallel_for_(cv::Range(0, row.cols), [&](const cv::Range& c)
+            {
+                for (int j = c.start; j < c.end; j++)
+                {
+                    int v = 0;
+                    for (int k = 0; k < repeat; k++)
+                        v = cvRound(std::sqrt((double)(i + j) * (i + j)));
+                    row.at<int>(j) += v;  // each element must be processed exactly once
+                }
+            });
+        }
+    }
+protected:
+    Mat dst_;
+};
+
+TEST(Core_Parallel, work_stealing_backend)
+{
+    const int prevNumThreads = cv::getNumThreads();
+    ASSERT_TRUE(cv::parallel::setParallelForBackend("WORK_STEALING"));
+    EXPECT_STREQ("work_stealing", cv::currentParallelFramework());
+    cv::setNumThreads(4);  // force worker threads even on single core systems
+
+    Mat dst(100, 1000, CV_32SC1, Scalar::all(0));
+    EXPECT_NO_THROW(parallel_for_(cv::Range(0, dst.rows), NestedParallelLoopBody(dst)));
+    Mat expected(dst.size(), dst.type());
+    for (int i = 0; i < expected.rows; i++)
+        for (int j = 0; j < expected.cols; j++)
+            expected.at<int>(i, j) = i + j;
+    EXPECT_EQ(0, cvtest::norm(dst, expected, NORM_INF));
+
+    Mat dst2(1000, 100, CV_8SC1, Scalar::all(0));
+    EXPECT_THROW(parallel_for_(cv::Range(0, dst2.rows), ThrowErrorParallelLoopBody(dst2, dst2.rows / 2)), cv::Exception);
+
+    cv::parallel::setParallelForBackend("");  // restore default backend
+    cv::setNumThreads(prevNumThreads);
+}
+
+static void checkThreadPoolBackend()
+{
+    if (std::string(cv::currentParallelFramework() ? cv::currentParallelFramework() : "") != "pthreads")
+        throw SkipTestException("builtin pthreads thread pool is not used");
+}
+
+TEST(Core_Parallel, thread_pool_first_touch)
+{
+    checkThreadPoolBackend();
+    const int prevNumThreads = cv::getNumThreads();
+    cv::setNumThreads(4);
+
+    Mat buf(1, 8 << 20, CV_8UC1);
+    cv::randu(buf, Scalar::all(0), Scalar::all(256));
+    Mat expected = buf.clone();
+
+    // default configuration, NUMA mode on the detected topology (single node here or real NUMA system)
+    utils::threadPoolFirstTouch(buf.data, buf.total());
+    EXPECT_EQ(0, cvtest::norm(buf, expected, NORM_INF));
+    utils::setThreadPoolNUMAConfiguration(true);
+    utils::threadPoolFirstTouch(buf.data, buf.total());
+    EXPECT_EQ(0, cvtest::norm(buf, expected, NORM_INF));
+
+    // forced 2-node topology: pages are touched by workers
+    utils::setThreadPoolNUMAConfiguration(true, "0;1");
+    EXPECT_EQ(2, utils::getThreadPoolNUMANodes());
+    utils::threadPoolFirstTouch(buf.data, buf.total());
+    EXPECT_EQ(0, cvtest::norm(buf, expected, NORM_INF));
+    utils::threadPoolFirstTouch(buf.data + 1, buf.total() - 3);  // unaligned
+    EXPECT_EQ(0, cvtest::norm(buf, expected, NORM_INF));
+    Mat m(2048, 4096, CV_8UC1, Scalar::all(7));  // touched by StdMatAllocator
+    EXPECT_EQ(7, cvtest::norm(m, NORM_INF));
+
+    utils::setThreadPoolNUMAConfiguration(false);
+    cv::setNumThreads(prevNumThreads);
+}
+
+TEST(Core_Parallel, thread_pool_numa_partitions_dont_depend_on_caller)
+{
+    checkThreadPoolBackend();
+    const int prevNumThreads = cv::getNumThreads();
+    cv::setNumThreads(4);
+
+    Mat buf(1, 8 << 20, CV_8UC1, Scalar::all(3));
+    const int num_pages = (int)((buf.total() + 4095) / 4096);
+
+    // the calling thread (on CPU 0 here) is on node 0 with the first topology and on node 1 with the second one,
+    // the workers layout is the same
+    const char* configurations[] = { "0;1", "1;0" };
+    std::vector<Range> partitions[2];
+    for (int c = 0; c < 2; c++)
+    {
+        SCOPED_TRACE(configurations[c]);
+        utils::setThreadPoolNUMAConfiguration(true, configurations[c]);
+        utils::threadPoolFirstTouch(buf.data, buf.total());
+        partitions[c] = utils::getThreadPoolNUMAPartitions(Range(0, num_pages));
+        ASSERT_EQ(2u, partitions[c].size());
+        EXPECT_EQ(0, partitions[c][0].start);
+        EXPECT_EQ(partitions[c][0].end, partitions[c][1].start);
+        EXPECT_EQ(num_pages, partitions[c][1].end);
+
+        // a later job over the same rows: each stripe stays within one partition
+        cv::Mutex mutex;
+        std::vector<Range> stripes;
+        parallel_for_(Range(0, num_pages), [&](const Range& r)
+        {
+            cv::AutoLock lock(mutex);
+            stripes.push_back(r);
+        });
+        for (size_t i = 0; i < stripes.size(); i++)
+        {
+            const Range& r = stripes[i];
+            EXPECT_TRUE((r.start >= partitions[c][0].start && r.end <= partitions[c][0].end) ||
+                        (r.start >= partitions[c][1].start && r.end <= partitions[c][1].end))
+                << "[" << r.start << ", " << r.end << ")";
+        }
+    }
+    EXPECT_EQ(partitions[0][0], partitions[1][0]);
+    EXPECT_EQ(partitions[0][1], partitions[1][1]);
+    EXPECT_EQ(3, cvtest::norm(buf, NORM_INF));
+
+    utils::setThreadPoolNUMAConfiguration(false);
+    cv::setNumThreads(prevNumThreads);
+}
+
+class SumRowsParallelLoopBody : public cv::ParallelLoopBody
+{
+public:
+    SumRowsParallelLoopBody(const Mat& src, Mat& dst) : src_(src), dst_(dst.ptr<double>()) {}
+    void operator()(const cv::Range& r) const CV_OVERRIDE
+    {
+        for (int i = r.start; i < r.end; i++)
+            dst_[i] += cv::sum(src_.row(i))[0];  // each row must be processed exactly once
+    }
+protected:
+    Mat src_;
+    double* dst_;
+};
+
+TEST(Core_Parallel, thread_pool_numa_topology)
+{
+    checkThreadPoolBackend();
+    const int prevNumThreads = cv::getNumThreads();
+
+    Mat src(1001, 257, CV_32FC1);
+    cv::randu(src, Scalar::all(-1), Scalar::all(1));
+    Mat expected(src.rows, 1, CV_64FC1);
+    for (int i = 0; i < src.rows; i++)
+        expected.at<double>(i) = cv::sum(src.row(i))[0];
+
+    const char* configurations[] = { "", "0;1", "0-1;2;3-5", "0;0;0;0;0;0;0;0" };
+    for (size_t c = 0; c < sizeof(configurations)/sizeof(configurations[0]); c++)
+    {
+        SCOPED_TRACE(configurations[c]);
+        utils::setThreadPoolNUMAConfiguration(true, configurations[c]);
+        for (int threads = 2; threads <= 8; threads *= 2)
+        {
+            cv::setNumThreads(threads);
+            for (int iter = 0; iter < 10; iter++)
+            {
+                Mat dst(src.rows, 1, CV_64FC1, Scalar::all(0));
+                parallel_for_(cv::Range(0, src.rows), SumRowsParallelLoopBody(src, dst), iter % 2 ? 7 : -1);
+                ASSERT_EQ(0, cvtest::norm(dst, expected, NORM_INF)) << "threads=" << threads;
+            }
+        }
+    }
+
+    utils::setThreadPoolNUMAConfiguration(false);
+    cv::setNumThreads(prevNumThreads);
+}
+
 TEST(Core_Version, consistency)
 {
     // this test verifies that OpenCV version loaded in runtime
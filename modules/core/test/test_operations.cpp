@@ -1561,6 +1561,113 @@ TEST(Core_MatExpr, empty_check_15760)
     EXPECT_THROW(Mat c = Mat().cross(Mat()), cv::Exception);
 }
 
+typedef testing::TestWithParam<perf::MatType> Core_MatExpr_Fused;
+
+TEST_P(Core_MatExpr_Fused, accuracy)
+{
+    const int type = GetParam();
+    const double eps = CV_MAT_DEPTH(type) == CV_32F ? 1e-5 : 1e-12;
+    RNG& rng = theRNG();
+    Mat a(31, 1027, type), b(31, 1027, type), c(31, 1027, type), big(40, 1100, type);
+    rng.fill(a, RNG::UNIFORM, -10, 10);
+    rng.fill(b, RNG::UNIFORM, -10, 10);
+    rng.fill(big, RNG::UNIFORM, 1, 10);
+    Mat d = big(Rect(5, 3, 1027, 31));  // non-continuous operand
+    rng.fill(c, RNG::UNIFORM, 1, 10);
+    const Scalar s(1, 2, 3, 4);
+
+    Mat ref, t1, t2;
+    {
+        cv::subtract(a, b, t1); cv::multiply(t1, c, t2); cv::add(t2, d, ref);
+        Mat res = (a - b).mul(c) + d;
+        EXPECT_LE(cvtest::norm(res, ref, NORM_INF), eps * 100) << "(a - b).mul(c) + d";
+    }
+    {
+        cv::addWeighted(a, 2, b, 3, 0, t1); cv::divide(t1, c, t2, 0.5); cv::subtract(t2, d, t1); cv::absdiff(t1, Scalar::all(0), ref);
+        Mat res = abs((a*2 + b*3) * 0.5 / c - d);
+        EXPECT_LE(cvtest::norm(res, ref, NORM_INF), eps * 100) << "abs((a*2 + b*3) * 0.5 / c - d)";
+    }
+    {
+        cv::min(a, b, t1); cv::max(c, d, t2); cv::multiply(t1, t2, ref); cv::add(ref, s, ref); cv::subtract(ref, a, ref);
+        Mat res = min(a, b).mul(max(c, d)) + s - a;
+        EXPECT_LE(cvtest::norm(res, ref, NORM_INF), eps * 1000) << "min(a, b).mul(max(c, d)) + s - a";
+    }
+    {
+        cv::add(a, b, t1); cv::divide(3., c, t2); cv::multiply(t1, t2, ref); cv::subtract(s, ref, ref);
+        Mat res = s - (a + b).mul(3. / c);
+        EXPECT_LE(cvtest::norm(res, ref, NORM_INF), eps * 100) << "s - (a + b).mul(3. / c)";
+    }
+    if (a.channels() == 1)
+    {
+        // output type conversion
+        cv::add(a, b, t1); cv::multiply(t1, c, t2); t2.convertTo(ref, CV_16S);
+        Mat_<short> res = (a + b).mul(c);
+        EXPECT_LE(cvtest::norm(res, ref, NORM_INF), 1) << "(a + b).mul(c) -> CV_16S";
+    }
+    {
+        // in-place and augmented assignment
+        Mat x = a.clone();
+        cv::subtract(x, b, t1); cv::multiply(t1, x, t2); cv::add(x, t2, ref);
+        x += (x - b).mul(x);
+        EXPECT_LE(cvtest::norm(x, ref, NORM_INF), eps * 1000) << "x += (x - b).mul(x)";
+        x = a.clone();
+        cv::subtract(x, b, t1); cv::multiply(t1, c, ref);
+        x = (x - b).mul(c);
+        EXPECT_LE(cvtest::norm(x, ref, NORM_INF), eps * 100) << "x = (x - b).mul(c)";
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Core_MatExpr_Fused, testing::Values(CV_32FC1, CV_32FC3, CV_64FC1, CV_64FC4));
+
+TEST(Core_MatExpr, fused_nd_and_size_mismatch)
+{
+    const int sz[] = { 3, 4, 100 };
+    Mat a(3, sz, CV_32F), b(3, sz, CV_32F), ref;
+    randu(a, -1, 1);
+    randu(b, -1, 1);
+    cv::add(a, b, ref);
+    cv::multiply(ref, a, ref);
+    Mat res = (a + b).mul(a);
+    EXPECT_EQ(0, cvtest::norm(res, ref, NORM_INF));
+
+    Mat small(2, 2, CV_32F, Scalar::all(1));
+    EXPECT_THROW(Mat c = (a + b).mul(small), cv::Exception);
+}
+
+class CountingMatOp : public MatOp
+{
+public:
+    CountingMatOp() : count(0) {}
+    void assign(const MatExpr& expr, Mat& m, int type = -1) const CV_OVERRIDE
+    {
+        count++;
+        expr.a.convertTo(m, type);
+    }
+    mutable int count;
+};
+
+TEST(Core_MatExpr, fused_non_fusable_operand_evaluated_once)
+{
+    Mat a(8, 16, CV_32F), b(8, 16, CV_32F, Scalar::all(1)), c(8, 16, CV_32F);
+    randu(a, -1, 1);
+    randu(c, -1, 1);
+    CountingMatOp op;
+    const MatExpr counted(&op, 0, c);
+
+    // the chain grows past the instructions limit of fused programs at some iteration
+    MatExpr e = a.mul(b);
+    Mat ref = a.clone();
+    for (int k = 0; k < 40; k++)
+    {
+        op.count = 0;
+        Mat res = e + counted;
+        EXPECT_EQ(1, op.count) << "k=" << k;
+        EXPECT_LE(cvtest::norm(res, ref + c, NORM_INF), 1e-4) << "k=" << k;
+        e = e.mul(b) + a;
+        ref = ref + a;
+    }
+}
+
 TEST(Core_Arithm, scalar_handling_19599)  // https://github.com/opencv/opencv/issues/19599 (OpenCV 4.x+ only)
 {
     Mat a(1, 1, CV_32F, Scalar::all(1));
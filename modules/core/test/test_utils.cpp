@@ -7,6 +7,8 @@
 #define CV_LOG_STRIP_LEVEL CV_LOG_LEVEL_VERBOSE + 1
 #include "opencv2/core/utils/logger.hpp"
 #include "opencv2/core/utils/buffer_area.private.hpp"
+#include "opencv2/core/utils/buffer_pool.private.hpp"
+#include "opencv2/core/utils/mapped_mat.hpp"
 
 #include "opencv2/core/utils/filesystem.private.hpp"
 
@@ -494,5 +496,212 @@ TEST_P(BufferArea, bad)
 
 INSTANTIATE_TEST_CASE_P(/**/, BufferArea, testing::Values(true, false));
 
+TEST(BufferPool, temporary_buffers)
+{
+    BufferPoolController* controller = Mat::getStdAllocator()->getBufferPoolController();
+    ASSERT_TRUE(controller != NULL);
+    controller->freeAllReservedBuffers();
+    EXPECT_EQ(0u, controller->getReservedSize());
+    utils::resetTemporaryBufferPoolStatistics();
+
+    void* ptr = utils::allocateTemporaryBuffer(10000);
+    ASSERT_TRUE(ptr != NULL);
+    EXPECT_EQ(0u, (size_t)ptr % CV_MALLOC_ALIGN);
+    memset(ptr, 0, 10000);
+    utils::releaseTemporaryBuffer(ptr, 10000);
+    if (controller->getReservedSize() == 0)
+        throw SkipTestException("CPU buffer pool is disabled");  // OPENCV_BUFFER_POOL_* settings
+    EXPECT_LE(10000u, controller->getReservedSize());
+
+    for (int i = 0; i < 10; i++)
+    {
+        utils::PooledAutoBuffer<int> buf(2500);
+        EXPECT_EQ(ptr, (void*)buf.data());
+        EXPECT_EQ(2500u, buf.size());
+    }
+    {
+        utils::PooledAutoBuffer<int> buf(16);  // on stack
+        EXPECT_EQ(16u, buf.size());
+    }
+    {
+        Mat m;
+        m.allocator = utils::getTemporaryMatAllocator();
+        m.create(50, 50, CV_32FC1);
+        EXPECT_EQ(ptr, (void*)m.data);
+    }
+    {
+        std::vector<uchar, utils::PooledStdAllocator<uchar> > v(10000, 1);
+        EXPECT_EQ(ptr, (void*)&v[0]);
+    }
+
+    utils::PoolAllocatorStatistics stat = utils::getTemporaryBufferPoolStatistics();
+    EXPECT_EQ(13u, stat.allocations);
+    EXPECT_EQ(12u, stat.hits);
+
+    controller->freeAllReservedBuffers();
+    EXPECT_EQ(0u, controller->getReservedSize());
+}
+
+
+static void writeTestFile(const std::string& filename, const std::string& prefix, const Mat& m)
+{
+    std::ofstream f(filename.c_str(), std::ios::binary);
+    f.write(prefix.data(), prefix.size());
+    f.write((const char*)m.data, m.total() * m.elemSize());
+}
+
+static Mat readTestFile(const std::string& filename, size_t offset, int rows, int cols, int type)
+{
+    Mat m(rows, cols, type);
+    std::ifstream f(filename.c_str(), std::ios::binary);
+    f.seekg(offset);
+    f.read((char*)m.data, m.total() * m.elemSize());
+    return m;
+}
+
+TEST(MappedMat, raw_file)
+{
+    const std::string filename = cv::tempfile(".bin");
+    Mat src(37, 41, CV_32FC3);
+    randu(src, -100, 100);
+    writeTestFile(filename, std::string(13, 'x'), src);
+
+    Mat roi;
+    {
+        Mat m = utils::mapMatFile(filename, std::vector<int>{37, 41}, CV_32FC3, 13);
+        ASSERT_EQ(src.size(), m.size());
+        ASSERT_EQ(CV_32FC3, m.type());
+        EXPECT_TRUE(m.isContinuous());
+        EXPECT_MAT_NEAR(src, m, 0);
+        roi = m(Rect(5, 7, 10, 10));
+    }
+    // the mapping is owned by the sub-matrix
+    EXPECT_MAT_NEAR(src(Rect(5, 7, 10, 10)), roi, 0);
+    roi.release();
+
+    {
+        Mat m = utils::mapMatFile(filename, std::vector<int>{37, 41}, CV_32FC3, 13, utils::MAPPED_MAT_COPY_ON_WRITE);
+        m.setTo(Scalar::all(1));
+    }
+    EXPECT_MAT_NEAR(src, readTestFile(filename, 13, 37, 41, CV_32FC3), 0);
+
+    {
+        Mat m = utils::mapMatFile(filename, std::vector<int>{37, 41}, CV_32FC3, 13, utils::MAPPED_MAT_READ_WRITE);
+        m.row(3).setTo(Scalar::all(1));
+    }
+    src.row(3).setTo(Scalar::all(1));
+    EXPECT_MAT_NEAR(src, readTestFile(filename, 13, 37, 41, CV_32FC3), 0);
+
+    EXPECT_THROW(utils::mapMatFile(filename, std::vector<int>{38, 41}, CV_32FC3, 13), cv::Exception);
+    EXPECT_THROW(utils::mapMatFile(filename + ".missing", std::vector<int>{37, 41}, CV_32FC3), cv::Exception);
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
+static std::string npyHeader(const std::string& dict)
+{
+    std::string header = dict;
+    while ((10 + header.size() + 1) % 64 != 0)
+        header += ' ';
+    header += '\n';
+    std::string prefix("\x93NUMPY\x01\x00", 8);
+    prefix += (char)(header.size() & 255);
+    prefix += (char)(header.size() >> 8);
+    return prefix + header;
+}
+
+TEST(MappedMat, npy_file)
+{
+    const std::string filename = cv::tempfile(".npy");
+    Mat src(std::vector<int>{3, 4, 5}, CV_16S);
+    randu(src, -1000, 1000);
+    writeTestFile(filename, npyHeader("{'descr': '<i2', 'fortran_order': False, 'shape': (3, 4, 5), }"), src);
+    {
+        Mat m = utils::mapNpyFile(filename);
+        ASSERT_EQ(3, m.dims);
+        EXPECT_EQ(3, m.size[0]);
+        EXPECT_EQ(4, m.size[1]);
+        EXPECT_EQ(5, m.size[2]);
+        ASSERT_EQ(CV_16SC1, m.type());
+        EXPECT_EQ(0, cvtest::norm(src, m, NORM_INF));
+    }
+
+    Mat col(6, 1, CV_64F);
+    randu(col, 0, 1);
+    writeTestFile(filename, npyHeader("{'descr': '<f8', 'fortran_order': False, 'shape': (6,), }"), col);
+    EXPECT_MAT_NEAR(col, utils::mapNpyFile(filename), 0);
+
+    writeTestFile(filename, npyHeader("{'descr': '<f8', 'fortran_order': True, 'shape': (2, 3), }"), col);
+    EXPECT_THROW(utils::mapNpyFile(filename), cv::Exception);
+    writeTestFile(filename, npyHeader("{'descr': '<c16', 'fortran_order': False, 'shape': (3,), }"), col);
+    EXPECT_THROW(utils::mapNpyFile(filename), cv::Exception);
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
+TEST(MappedMat, storage_mat)
+{
+    const std::string filename = cv::tempfile(".cvbin");
+    Mat src(123, 45, CV_32FC3), big(20, 30, CV_16UC1), nd(std::vector<int>{3, 4, 5}, CV_64F);
+    randu(src, -100, 100);
+    randu(big, 0, 1000);
+    randu(nd, -1, 1);
+    {
+        FileStorage fs(filename, FileStorage::WRITE);
+        fs << "header" << "{" << "version" << 2 << "}";
+        fs << "src" << src << "roi" << big(Rect(2, 3, 10, 10)) << "nd" << nd << "empty" << Mat();
+        fs << "extra" << big;
+    }
+    {
+        Mat m = utils::mapStorageMat(filename, "src");
+        ASSERT_EQ(src.size(), m.size());
+        ASSERT_EQ(CV_32FC3, m.type());
+        EXPECT_EQ(0u, (size_t)m.data % 64);  // aligned payload and page-aligned mapping
+        EXPECT_EQ(0, cvtest::norm(src, m, NORM_INF));
+    }
+    Mat m = utils::mapStorageMat(filename, "nd");
+    ASSERT_EQ(3, m.dims);
+    EXPECT_EQ(0, cvtest::norm(nd, m, NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(big, utils::mapStorageMat(filename, "extra"), NORM_INF));
+    EXPECT_TRUE(utils::mapStorageMat(filename, "empty").empty());
+    m.release();
+
+    EXPECT_THROW(utils::mapStorageMat(filename, "roi"), cv::Exception);  // not continuous
+    EXPECT_THROW(utils::mapStorageMat(filename, "header"), cv::Exception);
+    EXPECT_THROW(utils::mapStorageMat(filename, "unknown"), cv::Exception);
+
+    // the storage is readable as usual
+    FileStorage fs(filename, FileStorage::READ);
+    Mat roi;
+    fs["roi"] >> roi;
+    EXPECT_EQ(0, cvtest::norm(big(Rect(2, 3, 10, 10)), roi, NORM_INF));
+    EXPECT_EQ(2, (int)fs["header"]["version"]);
+    fs.release();
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
+#if !defined(__ANDROID__) && !defined(__EMSCRIPTEN__)
+TEST(MappedMat, shared_memory)
+{
+#ifdef _WIN32
+    const char* prefix = "Local\\";
+#else
+    const char* prefix = "/";
+#endif
+    const std::string name = cv::format("%sopencv_test_%u", prefix, (unsigned)cv::getTickCount());
+    utils::removeSharedMemory(name);
+    Mat m1 = utils::createSharedMemoryMat(name, std::vector<int>{100, 200}, CV_8UC1);
+    ASSERT_EQ(Size(200, 100), m1.size());
+    EXPECT_EQ(0, cvtest::norm(m1, NORM_INF));
+    EXPECT_THROW(utils::createSharedMemoryMat(name, std::vector<int>{100, 200}, CV_8UC1), cv::Exception);
+
+    Mat m2 = utils::mapSharedMemoryMat(name, std::vector<int>{100, 200}, CV_8UC1);
+    EXPECT_NE(m1.data, m2.data);
+    m1.setTo(Scalar::all(7));
+    EXPECT_EQ(7 * 100 * 200, (int)cv::sum(m2)[0]);
+
+    EXPECT_TRUE(utils::removeSharedMemory(name));
+    EXPECT_EQ(7 * 100 * 200, (int)cv::sum(m2)[0]);  // still mapped
+}
+#endif
+
 
 }} // namespace
@@ -45,6 +45,8 @@
 
 #include "opencv2/core.hpp"
 
+#include <functional>
+
 /**
   @defgroup imgcodecs Image file reading and writing
   @{
@@ -95,12 +97,15 @@ enum ImwriteFlags {
        IMWRITE_PNG_COMPRESSION     = 16, //!< For PNG, it can be the compression level from 0 to 9. A higher value means a smaller size and longer compression time. If specified, strategy is changed to IMWRITE_PNG_STRATEGY_DEFAULT (Z_DEFAULT_STRATEGY). Default value is 1 (best speed setting).
        IMWRITE_PNG_STRATEGY        = 17, //!< One of cv::ImwritePNGFlags, default is IMWRITE_PNG_STRATEGY_RLE.
        IMWRITE_PNG_BILEVEL         = 18, //!< Binary level PNG, 0 or 1, default is 0.
+       IMWRITE_PNG_PARALLEL        = 19, //!< For PNG, multithreaded encoding, 0 or 1, default is 0. The rows are filtered and deflated in independent chunks by cv::parallel_for_, the output is still a single standard zlib stream. Not used together with IMWRITE_PNG_BILEVEL.
        IMWRITE_PXM_BINARY          = 32, //!< For PPM, PGM, or PBM, it can be a binary format flag, 0 or 1. Default value is 1.
        IMWRITE_EXR_TYPE            = (3 << 4) + 0 /* 48 */, //!< override EXR storage type (FLOAT (FP32) is default)
        IMWRITE_EXR_COMPRESSION     = (3 << 4) + 1 /* 49 */, //!< override EXR compression type (ZIP_COMPRESSION = 3 is default)
        IMWRITE_EXR_DWA_COMPRESSION_LEVEL = (3 << 4) + 2 /* 50 */, //!< override EXR DWA compression level (45 is default)
+       IMWRITE_EXR_MIPMAP          = (3 << 4) + 3 /* 51 */, //!< For EXR, 0 or 1, default is 0. If set, the image is stored in 64x64 tiles together with its mipmap levels down to 1x1, each computed from the previous one by cv::pyrDown. See cv::imreadLevel.
        IMWRITE_WEBP_QUALITY        = 64, //!< For WEBP, it can be a quality from 1 to 100 (the higher is the better). By default (without any parameter) and for quality above 100 the lossless compression is used.
        IMWRITE_HDR_COMPRESSION     = (5 << 4) + 0 /* 80 */, //!< specify HDR compression
+       IMWRITE_CVFL_PREDICTOR      = (6 << 4) + 0 /* 96 */, //!< For CVFL, the predictor applied before packing of the residuals. See cv::ImwriteCVFLPredictorFlags, default is IMWRITE_CVFL_PREDICTOR_GRADIENT.
        IMWRITE_PAM_TUPLETYPE       = 128,//!< For PAM, sets the TUPLETYPE field to the corresponding string value that is defined for the format
        IMWRITE_TIFF_RESUNIT        = 256,//!< For TIFF, use to specify which DPI resolution unit to set; see libtiff documentation for valid values
        IMWRITE_TIFF_XDPI           = 257,//!< For TIFF, use to specify the X direction DPI
@@ -108,6 +113,9 @@ enum ImwriteFlags {
        IMWRITE_TIFF_COMPRESSION    = 259,//!< For TIFF, use to specify the image compression scheme. See cv::ImwriteTiffCompressionFlags. Note, for images whose depth is CV_32F, only libtiff's SGILOG compression scheme is used. For other supported depths, the compression scheme can be specified by this flag; LZW compression is the default.
        IMWRITE_TIFF_ROWSPERSTRIP   = 278,//!< For TIFF, use to specify the number of rows per strip.
        IMWRITE_TIFF_PREDICTOR      = 317,//!< For TIFF, use to specify predictor. See cv::ImwriteTiffPredictorFlags.
+       IMWRITE_TIFF_TILE_SIZE      = 322,//!< For TIFF, the width and height of the tiles, a multiple of 16. If set, the pages are stored in tiles instead of strips. Default is 256 when IMWRITE_TIFF_PYRAMID_LEVELS is set.
+       IMWRITE_TIFF_PYRAMID_LEVELS = 330,//!< For TIFF, the number of reduced resolution levels stored as SubIFDs of each page, each computed from the previous one by cv::pyrDown. -1 adds the levels until the image fits a tile. Default is 0. The pages are tiled, see IMWRITE_TIFF_TILE_SIZE and cv::imreadLevel.
+       IMWRITE_TIFF_PARALLEL       = 260,//!< For TIFF, multithreaded encoding, 0 or 1, default is 0. The strips of the deflate-compressed (IMWRITE_TIFF_COMPRESSION_ADOBE_DEFLATE or IMWRITE_TIFF_COMPRESSION_DEFLATE) integer images are compressed by cv::parallel_for_. Other compression schemes are written as usual.
        IMWRITE_JPEG2000_COMPRESSION_X1000 = 272,//!< For JPEG2000, use to specify the target compression rate (multiplied by 1000). The value can be from 0 to 1000. Default is 1000.
        IMWRITE_AVIF_QUALITY        = 512,//!< For AVIF, it can be a quality between 0 and 100 (the higher the better). Default is 95.
        IMWRITE_AVIF_DEPTH          = 513,//!< For AVIF, it can be 8, 10 or 12. If >8, it is stored/read as CV_32F. Default is 8.
@@ -216,6 +224,14 @@ enum ImwriteHDRCompressionFlags {
     IMWRITE_HDR_COMPRESSION_RLE = 1
 };
 
+//! Imwrite CVFL specific values for IMWRITE_CVFL_PREDICTOR parameter key
+enum ImwriteCVFLPredictorFlags {
+    IMWRITE_CVFL_PREDICTOR_NONE     = 0, //!< the samples are stored as is
+    IMWRITE_CVFL_PREDICTOR_LEFT     = 1, //!< difference with the previous pixel of the row
+    IMWRITE_CVFL_PREDICTOR_UP       = 2, //!< difference with the pixel above
+    IMWRITE_CVFL_PREDICTOR_GRADIENT = 3  //!< difference with left + above - above-left
+};
+
 //! @} imgcodecs_flags
 
 /** @brief Loads an image from a file.
@@ -240,6 +256,7 @@ Currently, the following file formats are supported:
 -   TIFF files - \*.tiff, \*.tif (see the *Note* section)
 -   OpenEXR Image files - \*.exr (see the *Note* section)
 -   Radiance HDR - \*.hdr, \*.pic (always supported)
+-   OpenCV fast lossless images - \*.cvfl (always supported)
 -   Raster and Vector geospatial data supported by GDAL (see the *Note* section)
 
 @note
@@ -282,6 +299,60 @@ The image passing through the img parameter can be pre-allocated. The memory is
  */
 CV_EXPORTS_W void imread( const String& filename, OutputArray dst, int flags = IMREAD_COLOR_BGR );
 
+/** @brief Loads a rectangular region of an image from a file.
+
+The function returns the same pixels as `imread(filename, flags)(roi)` without EXIF orientation applied, but
+JPEG, PNG, TIFF and OpenEXR decoders read only the part of the file covering the region: JPEG decodes only the
+iMCU rows and columns intersecting it (libjpeg-turbo), PNG stops after the last row of the region, TIFF reads
+only the intersecting tiles or strips and OpenEXR only the intersecting scanlines. Other formats, interlaced PNG,
+TIFF images with non-default orientation and OpenEXR images with subsampled channels are decoded completely and
+cropped.
+
+@param filename Name of the file to be loaded.
+@param roi Region of the image to load, in the coordinates of the image stored in the file (for the
+`IMREAD_REDUCED_*` modes, in the coordinates of the reduced image). It is clipped to the image bounds; if it
+doesn't intersect the image, an empty matrix is returned.
+@param flags Flag that can take values of cv::ImreadModes. The EXIF orientation is never applied.
+@sa cv::imread, cv::imdecodeROI
+*/
+CV_EXPORTS_W Mat imreadROI( const String& filename, const Rect& roi, int flags = IMREAD_COLOR_BGR );
+
+/** @brief Loads an image from a file scaled to the given size.
+
+JPEG images are decoded with the smallest libjpeg-turbo DCT scaling factor M/8 (M = 1..16) which gives an image
+not smaller than @p dsize, so most of the downscaling is done by skipping the high frequency coefficients.
+If @p exact is true, the rest of the downscaling is done with area interpolation on the decoded rows in the
+same pass, without keeping the full resolution image in memory. Images of other formats are decoded
+completely and resized with cv::INTER_AREA interpolation.
+
+@param filename Name of the file to be loaded.
+@param dsize Target size, in the coordinates of the image stored in the file (before EXIF orientation).
+@param flags Flag that can take values of cv::ImreadModes, the `IMREAD_REDUCED_*` scaling is ignored.
+@param exact If true, the result has exactly @p dsize. If false, JPEG images are returned at the size of the
+selected M/8 scaling factor, which is not smaller than @p dsize (unless @p dsize is more than two times larger
+than the image) and has the original aspect ratio.
+@sa cv::imread, cv::imdecodeScaled
+*/
+CV_EXPORTS_W Mat imreadScaled( const String& filename, Size dsize, int flags = IMREAD_COLOR_BGR, bool exact = true );
+
+/** @brief Loads a resolution level of a multi-resolution image from a file.
+
+Pyramidal TIFF images store the reduced resolution levels of a page as its SubIFDs (see
+cv::IMWRITE_TIFF_PYRAMID_LEVELS), and tiled OpenEXR images can store the mipmap levels (see
+cv::IMWRITE_EXR_MIPMAP). Only the requested level is decoded, and with @p roi only its tiles intersecting the
+region, so a viewer pays one tile decode at any zoom level. The level 0 is the full resolution image, images
+of other formats have this level only; the number of levels is reported by cv::imreadHeader.
+
+@param filename Name of the file to be loaded.
+@param level Resolution level, from 0 to ImageHeader::levelCount - 1.
+@param flags Flag that can take values of cv::ImreadModes.
+@param roi Region of the level to load, in the coordinates of the level and clipped to its bounds. If it's empty,
+the whole level is loaded. The EXIF orientation is not applied with a region.
+@return The level, or an empty matrix if the file has no such level or the region doesn't intersect it.
+@sa cv::imread, cv::imreadROI
+*/
+CV_EXPORTS_W Mat imreadLevel( const String& filename, int level, int flags = IMREAD_COLOR_BGR, const Rect& roi = Rect() );
+
 /** @brief Loads a multi-page image from a file.
 
 The function imreadmulti loads a multi-page image from the specified file into a vector of Mat objects.
@@ -314,6 +385,37 @@ If the image cannot be decoded, 0 is returned.
 */
 CV_EXPORTS_W size_t imcount(const String& filename, int flags = IMREAD_ANYCOLOR);
 
+/** @brief Image properties returned by cv::imreadHeader and cv::imdecodeHeader.
+
+The size, channels and depth are the ones of the image stored in the file, i.e. of the image returned by
+cv::imread with cv::IMREAD_UNCHANGED, before the EXIF orientation is applied.
+*/
+struct CV_EXPORTS_W_SIMPLE ImageHeader
+{
+    CV_WRAP ImageHeader();
+
+    CV_PROP_RW int width;       //!< width of the image
+    CV_PROP_RW int height;      //!< height of the image
+    CV_PROP_RW int channels;    //!< number of channels
+    CV_PROP_RW int depth;       //!< depth of the samples, CV_8U, CV_16U, CV_32F etc.
+    CV_PROP_RW int pageCount;   //!< number of pages or frames, see cv::imcount
+    CV_PROP_RW int levelCount;  //!< number of resolution levels of the first page, see cv::imreadLevel
+    CV_PROP_RW int orientation; //!< EXIF orientation (1..8), 1 if the image has no orientation tag
+    CV_PROP_RW String codec;    //!< short lowercase name of the format, e.g. "jpeg", "png" or "tiff"
+};
+
+/** @brief Reads the properties of an image without decoding it.
+
+Only the file signature and the header of the image are read, no memory is allocated for the pixels, so the
+function is much faster than cv::imread for checking the size or the type of images. The EXIF orientation is
+reported for JPEG images, and for PNG images if the EXIF data precedes the image data; for other formats it is 1.
+@param filename Name of the file to be probed.
+@param header Output image properties.
+@return true if the file was recognized and its header was read.
+@sa cv::imdecodeHeader, cv::imread
+*/
+CV_EXPORTS_W bool imreadHeader(const String& filename, CV_OUT ImageHeader& header);
+
 /** @brief Saves an image to a specified file.
 
 The function imwrite saves the image to the specified file. The image format is chosen based on the
@@ -332,6 +434,8 @@ can be saved using this function, with these exceptions:
     8-bit (or 16-bit) 4-channel image BGRA, where the alpha channel goes last. Fully transparent pixels
     should have alpha set to 0, fully opaque pixels should have alpha set to 255/65535 (see the code sample below).
 - With PGM/PPM encoder, 8-bit unsigned (CV_8U) and 16-bit unsigned (CV_16U) images can be saved.
+- With CVFL encoder, 8-bit, 16-bit and 32-bit signed integer (CV_8U, CV_8S, CV_16U, CV_16S, CV_32S)
+  and 32-bit float (CV_32F) images with 1, 3 or 4 channels are saved losslessly.
 - With TIFF encoder, 8-bit unsigned (CV_8U), 16-bit unsigned (CV_16U),
                      32-bit float (CV_32F) and 64-bit float (CV_64F) images can be saved.
   - Multiple images (vector of Mat) can be saved in TIFF format (see the code sample below).
@@ -384,6 +488,80 @@ failure the function returns empty cv::Mat object, but does not release user-pro
 */
 CV_EXPORTS Mat imdecode( InputArray buf, int flags, Mat* dst);
 
+/** @brief Decodes an image from a buffer in memory into the given array, without reallocating it.
+
+The destination can be a part of a larger array, e.g. a region of an image or an image of a batch blob:
+- a 2D array with the number of channels of the decoded image (see cv::ImreadModes), in which case
+  JPEG, PNG, WebP and most other decoders write the pixels directly into it when its depth is the decoded one;
+- a single-channel C x H x W or 1 x C x H x W array of planes (NCHW layout), C being the number of channels
+  of the decoded image.
+
+If the depth of the destination differs from the decoded one, the samples are converted as by
+cv::Mat::convertTo without scaling. The conversion to another depth or to planes is done by bands of rows
+for the decoders which can read the image by rows (JPEG, PNG, TIFF, PxM), so the full image is never stored
+in the decoded layout. The EXIF orientation is not applied.
+
+@code
+    Mat blob({batchSize, 3, 224, 224}, CV_32F);
+    Range ranges[] = { Range(i, i + 1), Range::all(), Range::all(), Range::all() };
+    imdecodeTo(jpegBytes, IMREAD_COLOR_RGB, blob(ranges));
+@endcode
+
+@param buf Input array or vector of bytes.
+@param flags The same flags as in cv::imread, except cv::IMREAD_LOAD_GDAL and `IMREAD_REDUCED_*`.
+@param dst Destination array of the size of the image. If it is empty, it is allocated as in cv::imdecode.
+@return true if the image was decoded, false if the buffer can't be decoded or the image size doesn't
+match the destination size. The layouts which don't match the flags raise an error.
+*/
+CV_EXPORTS_W bool imdecodeTo( InputArray buf, int flags, InputOutputArray dst );
+
+/** @brief Decodes a batch of images from buffers in memory in parallel.
+
+The function decodes each buffer like cv::imdecode. The buffers are distributed across the threads of the
+OpenCV thread pool (see cv::setNumThreads). Each thread checks the format of the previously decoded buffer
+first, so batches of same-format images skip the search through all registered codecs. The JPEG and PNG
+decoders of a thread are reused for the following buffers of the same format, together with the libjpeg
+decompressor or the memory of the libpng context.
+
+@param bufs Vector of encoded buffers (e.g. `std::vector<std::vector<uchar>>` or `std::vector<Mat>` of bytes).
+@param flags The same flags as in cv::imread, see cv::ImreadModes.
+@param dst Decoded images, resized to the number of buffers. Matrices already present in the vector are
+reused when their size and type match the decoded image. The images which can't be decoded are empty.
+@param errors Descriptions of the failures, an empty string for each decoded image.
+@return Number of successfully decoded images.
+*/
+CV_EXPORTS int imdecodeBatch( InputArrayOfArrays bufs, int flags, CV_IN_OUT std::vector<Mat>& dst,
+                              CV_OUT std::vector<String>& errors );
+
+/** @overload
+@param bufs Vector of encoded buffers.
+@param flags The same flags as in cv::imread, see cv::ImreadModes.
+@param dst Decoded images, an empty matrix for each buffer which can't be decoded.
+*/
+CV_EXPORTS_W int imdecodeBatch( InputArrayOfArrays bufs, int flags, CV_IN_OUT std::vector<Mat>& dst );
+
+/** @brief Reads a rectangular region of an image from a buffer in memory.
+
+See cv::imreadROI for the description of the region and of the formats decoding only the part of the data
+covering it.
+
+@param buf Input array or vector of bytes.
+@param roi Region of the image to decode, clipped to the image bounds.
+@param flags The same flags as in cv::imread, see cv::ImreadModes. The EXIF orientation is never applied.
+*/
+CV_EXPORTS_W Mat imdecodeROI( InputArray buf, const Rect& roi, int flags = IMREAD_COLOR_BGR );
+
+/** @brief Reads an image from a buffer in memory scaled to the given size.
+
+See cv::imreadScaled for the description of the scaling.
+
+@param buf Input array or vector of bytes.
+@param dsize Target size.
+@param flags The same flags as in cv::imread, see cv::ImreadModes.
+@param exact If true, the result has exactly @p dsize, see cv::imreadScaled.
+*/
+CV_EXPORTS_W Mat imdecodeScaled( InputArray buf, Size dsize, int flags = IMREAD_COLOR_BGR, bool exact = true );
+
 /** @brief Reads a multi-page image from a buffer in memory.
 
 The function imdecodemulti reads a multi-page image from the specified buffer in the memory. If the buffer is too short or
@@ -399,6 +577,15 @@ See cv::imreadmulti for the list of supported formats and flags description.
 */
 CV_EXPORTS_W bool imdecodemulti(InputArray buf, int flags, CV_OUT std::vector<Mat>& mats, const cv::Range& range = Range::all());
 
+/** @brief Reads the properties of an image in a memory buffer without decoding it.
+
+@param buf Input array or vector of bytes.
+@param header Output image properties.
+@return true if the buffer was recognized and its header was read.
+@sa cv::imreadHeader, cv::imdecode
+*/
+CV_EXPORTS_W bool imdecodeHeader(InputArray buf, CV_OUT ImageHeader& header);
+
 /** @brief Encodes an image into a memory buffer.
 
 The function imencode compresses the image and stores it in the memory buffer that is resized to fit the
@@ -491,6 +678,202 @@ protected:
     Ptr<Impl> pImpl;
 };
 
+/** @brief Reads an image by bands of rows, for images which do not fit into memory.
+
+Only the decoder state and the requested band are kept in memory, so the peak memory usage is proportional
+to the band height rather than to the image size. Non-interlaced PNG, JPEG, TIFF and PxM (PBM/PGM/PPM)
+images are decoded by rows, images of other formats are decoded completely on the first read() call.
+The rows are the same as the rows of the image loaded by cv::imread, except that EXIF orientation is not applied.
+
+@code
+    ImageStreamReader reader("mosaic.tif", IMREAD_COLOR);
+    Mat band;
+    while (reader.read(band, 256) > 0)
+        process(band, reader.position() - band.rows);
+@endcode
+
+@sa cv::ImageStreamWriter
+*/
+class CV_EXPORTS ImageStreamReader
+{
+public:
+    ImageStreamReader();
+
+    /** @overload
+    @param filename Name of the file to be loaded.
+    @param flags Flag that can take values of cv::ImreadModes, see open().
+    */
+    ImageStreamReader(const String& filename, int flags = IMREAD_COLOR_BGR);
+    ~ImageStreamReader();
+
+    /** @brief Opens the image and reads its header.
+    @param filename Name of the file to be loaded.
+    @param flags Flag that can take values of cv::ImreadModes, except cv::IMREAD_LOAD_GDAL and `IMREAD_REDUCED_*`.
+    @return true if the image can be read.
+    */
+    bool open(const String& filename, int flags = IMREAD_COLOR_BGR);
+
+    //! Returns true if the image is open and not all rows are read.
+    bool isOpened() const;
+
+    //! Closes the image.
+    void release();
+
+    //! Returns the size of the image.
+    Size size() const;
+
+    //! Returns the type of the rows.
+    int type() const;
+
+    //! Returns the number of rows which are already read.
+    int position() const;
+
+    /** @brief Reads the next rows of the image.
+    @param band Output rows, of the image width and type().
+    @param maxRows The maximal number of rows to read, band has fewer rows at the end of the image.
+    @return The number of read rows. It is 0 after the last row and in case of an error, then the reader is released.
+    */
+    int read(OutputArray band, int maxRows);
+
+    class Impl;
+protected:
+    Ptr<Impl> pImpl;
+};
+
+/** @brief Writes an image by bands of rows, for images which do not fit into memory.
+
+PNG, JPEG, TIFF and PxM (PBM/PGM/PPM) encoders compress the rows as they are written, so only the band
+is kept in memory. For other formats the whole image is collected in memory and encoded after the last row.
+The file is complete after the last row is written; if the writer is released earlier, the file is removed.
+The encoding parameters and the conversion of unsupported depths are the same as in cv::imwrite.
+
+@sa cv::ImageStreamReader
+*/
+class CV_EXPORTS ImageStreamWriter
+{
+public:
+    ImageStreamWriter();
+
+    /** @overload
+    @param filename Name of the file.
+    @param size Size of the image.
+    @param type Type of the rows.
+    @param params Format-specific parameters, see cv::imwrite and cv::ImwriteFlags.
+    */
+    ImageStreamWriter(const String& filename, Size size, int type, const std::vector<int>& params = std::vector<int>());
+    ~ImageStreamWriter();
+
+    /** @brief Creates the file and writes the image header.
+    @param filename Name of the file, its extension selects the format.
+    @param size Size of the image.
+    @param type Type of the rows, with 1, 3 or 4 channels.
+    @param params Format-specific parameters, see cv::imwrite and cv::ImwriteFlags.
+    @return true if the file was created.
+    */
+    bool open(const String& filename, Size size, int type, const std::vector<int>& params = std::vector<int>());
+
+    //! Returns true if the file is open and not all rows are written.
+    bool isOpened() const;
+
+    //! Closes the file, it is removed if not all rows are written.
+    void release();
+
+    //! Returns the number of rows which are already written.
+    int position() const;
+
+    /** @brief Writes the next rows of the image.
+    @param band Rows of the image width and the type given to open(). The file is completed after the last row.
+    @return true if the rows were written, false in case of an error, then the writer is released.
+    */
+    bool write(InputArray band);
+
+    class Impl;
+protected:
+    Ptr<Impl> pImpl;
+};
+
+/** @brief Writes images to files in background threads.
+
+The images are encoded in parallel by a pool of worker threads, as cv::imwrite would encode them, and the
+files are written in the order of the write() calls. The images are not copied, so the data of an image must
+not be modified until it is written (the writer keeps a reference to it). The number of images which are
+queued or being encoded is bounded; when the queue is full, write() either waits or drops an image,
+depending on the policy.
+
+@code
+    AsyncImageWriter writer(2, 8, AsyncImageWriter::DROP_OLDEST);
+    for (int i = 0; cap.read(frame); i++)
+        writer.write(format("frame%05d.png", i), frame.clone());
+    writer.flush();
+@endcode
+
+If OpenCV is built without thread support, the images are written synchronously by write().
+*/
+class CV_EXPORTS AsyncImageWriter
+{
+public:
+    //! What write() does when the queue is full
+    enum QueueFullPolicy
+    {
+        BLOCK       = 0, //!< wait until a queued image is written
+        DROP_NEWEST = 1, //!< drop the new image
+        DROP_OLDEST = 2  //!< drop the oldest queued image which is not being encoded yet, or the new one if there is none
+    };
+
+    //! Statistics of the writer, since its creation
+    struct Stats
+    {
+        size_t queued;      //!< images accepted by write()
+        size_t written;     //!< images written to files
+        size_t failed;      //!< images which could not be encoded or written
+        size_t dropped;     //!< images dropped because the queue was full
+        size_t bytes;       //!< total size of the written files
+        double encodeTime;  //!< total time spent by the workers encoding images, in seconds
+        double writeTime;   //!< total time spent writing the files, in seconds
+        double elapsedTime; //!< time since the creation of the writer, in seconds
+    };
+
+    /** @brief Called after an image is written, or dropped or failed (then success is false).
+    The callbacks are called in the order of the write() calls, from a worker thread, except for the images
+    dropped by write() itself. A callback may write() the next image, the image is already removed from
+    the queue, but it must not call flush().
+    */
+    typedef std::function<void(const String& filename, bool success)> Callback;
+
+    /** @brief Creates the writer and starts the worker threads.
+    @param numWorkers The number of encoding threads, cv::getNumberOfCPUs() if it is not positive.
+    @param maxQueueSize The maximal number of images which are queued, being encoded or waiting to be written.
+    @param policy What write() does when the queue is full, see QueueFullPolicy.
+    */
+    AsyncImageWriter(int numWorkers = 0, int maxQueueSize = 16, int policy = BLOCK);
+
+    //! Writes the queued images and stops the worker threads.
+    ~AsyncImageWriter();
+
+    /** @brief Queues an image to be written.
+    @param filename Name of the file, its extension selects the format as in cv::imwrite.
+    @param img Image to be written, it is not copied.
+    @param params Format-specific parameters, see cv::imwrite and cv::ImwriteFlags.
+    @param onDone Optional callback called after the image is written.
+    @return true if the image was queued, false if it was dropped or no encoder is found for the extension.
+    */
+    bool write(const String& filename, InputArray img, const std::vector<int>& params = std::vector<int>(),
+               const Callback& onDone = Callback());
+
+    //! Waits until all queued images are written and their callbacks are completed.
+    void flush();
+
+    //! Returns the number of images which are queued, being encoded or waiting to be written.
+    int queueSize() const;
+
+    //! Returns the statistics of the writer.
+    Stats getStats() const;
+
+    class Impl;
+protected:
+    Ptr<Impl> pImpl;
+};
+
 //! @} imgcodecs
 
 } // cv
@@ -0,0 +1,65 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+#include "perf_precomp.hpp"
+
+namespace opencv_test
+{
+
+#ifdef HAVE_IMGCODEC_CVFL
+
+using namespace perf;
+
+typedef tuple<MatType, int> Cvfl_Type_Predictor_t;
+typedef perf::TestBaseWithParam<Cvfl_Type_Predictor_t> Cvfl_Type_Predictor;
+
+#define CVFL_TYPES       CV_8UC3, CV_16UC1, CV_16UC3, CV_32FC1
+#define CVFL_PREDICTORS  (int)IMWRITE_CVFL_PREDICTOR_LEFT, (int)IMWRITE_CVFL_PREDICTOR_GRADIENT
+
+static Mat makeCvflImage(int type)
+{
+    // a smooth gradient with some noise on top, closer to a real image than uniform noise
+    Mat img(1080, 1920, type);
+    Mat noise(img.size(), type);
+    for (int y = 0; y < img.rows; y++)
+        img.row(y).setTo(Scalar::all(y % 256));
+    randu(noise, Scalar::all(0), Scalar::all(16));
+    img += noise;
+    return img;
+}
+
+PERF_TEST_P(Cvfl_Type_Predictor, encode,
+            testing::Combine(testing::Values(CVFL_TYPES), testing::Values(CVFL_PREDICTORS)))
+{
+    Mat img = makeCvflImage(get<0>(GetParam()));
+    std::vector<int> params;
+    params.push_back(IMWRITE_CVFL_PREDICTOR);
+    params.push_back(get<1>(GetParam()));
+
+    vector<uchar> buf;
+    TEST_CYCLE() imencode(".cvfl", img, buf, params);
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(Cvfl_Type_Predictor, decode,
+            testing::Combine(testing::Values(CVFL_TYPES), testing::Values(CVFL_PREDICTORS)))
+{
+    Mat img = makeCvflImage(get<0>(GetParam()));
+    std::vector<int> params;
+    params.push_back(IMWRITE_CVFL_PREDICTOR);
+    params.push_back(get<1>(GetParam()));
+
+    vector<uchar> buf;
+    ASSERT_TRUE(imencode(".cvfl", img, buf, params));
+
+    Mat dst;
+    TEST_CYCLE() dst = imdecode(buf, IMREAD_UNCHANGED);
+
+    SANITY_CHECK_NOTHING();
+}
+
+#endif // HAVE_IMGCODEC_CVFL
+
+} // namespace
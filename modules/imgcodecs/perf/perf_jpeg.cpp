@@ -55,6 +55,39 @@ PERF_TEST(JPEG, Encode)
     SANITY_CHECK_NOTHING();
 }
 
+PERF_TEST(JPEG, DecodeBatch)
+{
+    std::vector<std::vector<uchar> > bufs(64);
+    for (size_t i = 0; i < bufs.size(); i++)
+    {
+        Mat img(240, 320, CV_8UC3);
+        randu(img, Scalar::all(0), Scalar::all(256));
+        GaussianBlur(img, img, Size(5, 5), 0);
+        ASSERT_TRUE(imencode(".jpg", img, bufs[i]));
+    }
+    std::vector<Mat> dst;
+
+    TEST_CYCLE() imdecodeBatch(bufs, IMREAD_COLOR, dst);
+
+    ASSERT_EQ(bufs.size(), dst.size());
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST(JPEG, DecodeScaled)
+{
+    Mat img(1536, 2048, CV_8UC3);
+    randu(img, Scalar::all(0), Scalar::all(256));
+    GaussianBlur(img, img, Size(9, 9), 0);
+    std::vector<uchar> buf;
+    ASSERT_TRUE(imencode(".jpg", img, buf));
+    Mat dst;
+
+    TEST_CYCLE() dst = imdecodeScaled(buf, Size(300, 225));
+
+    ASSERT_EQ(Size(300, 225), dst.size());
+    SANITY_CHECK_NOTHING();
+}
+
 #endif // HAVE_JPEG
 
 } // namespace
\ No newline at end of file
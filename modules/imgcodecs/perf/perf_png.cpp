@@ -58,6 +58,20 @@ PERF_TEST(PNG, encode)
     SANITY_CHECK_NOTHING();
 }
 
+PERF_TEST(PNG, encode_parallel)
+{
+    String filename = getDataPath("perf/2560x1600.png");
+    cv::Mat src = imread(filename);
+
+    vector<uchar> buf;
+    vector<int> params;
+    params.push_back(IMWRITE_PNG_PARALLEL);
+    params.push_back(1);
+    TEST_CYCLE() imencode(".png", src, buf, params);
+
+    SANITY_CHECK_NOTHING();
+}
+
 #endif // HAVE_PNG
 
 } // namespace
@@ -0,0 +1,355 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+
+#include <opencv2/core/utils/logger.hpp>
+
+#include <deque>
+#include <map>
+
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#endif
+
+namespace cv
+{
+
+namespace {
+
+struct WriteJob
+{
+    String filename;
+    Mat img;
+    std::vector<int> params;
+    AsyncImageWriter::Callback onDone;
+    std::vector<uchar> buf;
+    bool encoded;
+    double encodeTime;
+
+    WriteJob() : encoded(false), encodeTime(0) {}
+
+    // called by the workers in parallel
+    void encode()
+    {
+        int64 t = getTickCount();
+        try
+        {
+            const size_t dot = filename.rfind('.');
+            encoded = dot != String::npos && imencode(filename.substr(dot), img, buf, params);
+        }
+        catch (const cv::Exception& e)
+        {
+            CV_LOG_ERROR(NULL, "AsyncImageWriter('" << filename << "'): can't encode the image: " << e.what());
+        }
+        catch (...)
+        {
+            CV_LOG_ERROR(NULL, "AsyncImageWriter('" << filename << "'): can't encode the image: unknown exception");
+        }
+        img.release();
+        encodeTime = (getTickCount() - t) / getTickFrequency();
+    }
+
+    // called in the order of the jobs
+    bool store() const
+    {
+        if (!encoded)
+            return false;
+        FILE* f = fopen(filename.c_str(), "wb");
+        if (!f)
+        {
+            CV_LOG_ERROR(NULL, "AsyncImageWriter('" << filename << "'): can't open the file for writing");
+            return false;
+        }
+        bool ok = buf.empty() || fwrite(&buf[0], 1, buf.size(), f) == buf.size();
+        ok = fclose(f) == 0 && ok;
+        if (!ok)
+            CV_LOG_ERROR(NULL, "AsyncImageWriter('" << filename << "'): can't write the file");
+        return ok;
+    }
+
+    void finish(bool success) const
+    {
+        if (!onDone)
+            return;
+        try
+        {
+            onDone(filename, success);
+        }
+        catch (...)
+        {
+            CV_LOG_ERROR(NULL, "AsyncImageWriter('" << filename << "'): exception in the callback is ignored");
+        }
+    }
+};
+
+} // namespace
+
+class AsyncImageWriter::Impl
+{
+public:
+    Impl(int numWorkers, int maxQueueSize, int policy);
+    ~Impl();
+    bool write(const String& filename, const Mat& img, const std::vector<int>& params, const Callback& onDone);
+    void flush();
+    int queueSize() const;
+    Stats getStats() const;
+
+protected:
+    // stores the job and the following encoded ones if it is next in the order, called with the mutex locked
+    void storeJobs(const Ptr<WriteJob>& job, uint64 seq);
+
+    int m_maxQueueSize;
+    int m_policy;
+    int64 m_startTick;
+    Stats m_stats;
+    int m_queued;                          // jobs accepted and not written yet
+    int m_callbacks;                       // callbacks of the written jobs being called
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+    void run();
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_jobReady;    // a job is queued or the writer is stopped
+    std::condition_variable m_jobDone;     // a job is written or dropped
+    std::deque<std::pair<uint64, Ptr<WriteJob> > > m_pending;  // jobs waiting for a worker
+    std::map<uint64, Ptr<WriteJob> > m_encoded;  // jobs waiting for the previous ones, empty for the dropped jobs
+    uint64 m_nextSeq;                      // the number of the next job
+    uint64 m_nextStore;                    // the number of the next job to write
+    bool m_storing;                        // a worker is writing files
+    bool m_stop;
+    std::vector<std::thread> m_workers;
+#endif
+};
+
+AsyncImageWriter::Impl::Impl(int numWorkers, int maxQueueSize, int policy)
+    : m_maxQueueSize(maxQueueSize), m_policy(policy), m_startTick(getTickCount()), m_queued(0), m_callbacks(0)
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+    , m_nextSeq(0), m_nextStore(0), m_storing(false), m_stop(false)
+#endif
+{
+    CV_CheckGT(maxQueueSize, 0, "");
+    CV_Check(policy, policy == BLOCK || policy == DROP_NEWEST || policy == DROP_OLDEST, "");
+    memset(&m_stats, 0, sizeof(m_stats));
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+    if (numWorkers <= 0)
+        numWorkers = getNumberOfCPUs();
+    for (int i = 0; i < numWorkers; i++)
+        m_workers.push_back(std::thread(&AsyncImageWriter::Impl::run, this));
+#else
+    CV_UNUSED(numWorkers);
+#endif
+}
+
+AsyncImageWriter::Impl::~Impl()
+{
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_jobReady.notify_all();
+    for (size_t i = 0; i < m_workers.size(); i++)
+        m_workers[i].join();
+#endif
+}
+
+bool AsyncImageWriter::Impl::write(const String& filename, const Mat& img, const std::vector<int>& params,
+                                   const Callback& onDone)
+{
+    CV_Assert(!img.empty());
+    CV_Check(params.size(), (params.size() & 1) == 0, "Encoding 'params' must be key-value pairs");
+    if (!haveImageWriter(filename))
+    {
+        CV_LOG_ERROR(NULL, "AsyncImageWriter('" << filename << "'): no encoder for the file extension");
+        return false;
+    }
+
+    Ptr<WriteJob> job = makePtr<WriteJob>();
+    job->filename = filename;
+    job->img = img;
+    job->params = params;
+    job->onDone = onDone;
+
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+    Ptr<WriteJob> dropped;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_queued >= m_maxQueueSize)
+        {
+            if (m_policy == BLOCK)
+                m_jobDone.wait(lock, [&] { return m_queued < m_maxQueueSize; });
+            else if (m_policy == DROP_OLDEST && !m_pending.empty())
+            {
+                // the order of the files is kept by an empty job in its place
+                m_encoded[m_pending.front().first] = Ptr<WriteJob>();
+                dropped = m_pending.front().second;
+                m_pending.pop_front();
+                m_queued--;
+            }
+            else
+                dropped = job;
+            if (dropped)
+                m_stats.dropped++;
+        }
+        if (dropped != job)
+        {
+            m_pending.push_back(std::make_pair(m_nextSeq++, job));
+            m_queued++;
+            m_stats.queued++;
+        }
+    }
+    if (dropped != job)
+        m_jobReady.notify_one();
+    if (dropped)
+        dropped->finish(false);
+    return dropped != job;
+#else
+    m_stats.queued++;
+    job->encode();
+    int64 t = getTickCount();
+    bool ok = job->store();
+    m_stats.writeTime += (getTickCount() - t) / getTickFrequency();
+    m_stats.encodeTime += job->encodeTime;
+    if (ok)
+    {
+        m_stats.written++;
+        m_stats.bytes += job->buf.size();
+    }
+    else
+        m_stats.failed++;
+    job->finish(ok);
+    return true;
+#endif
+}
+
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+void AsyncImageWriter::Impl::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;)
+    {
+        m_jobReady.wait(lock, [&] { return m_stop || !m_pending.empty(); });
+        if (m_pending.empty())
+            break;
+        uint64 seq = m_pending.front().first;
+        Ptr<WriteJob> job = m_pending.front().second;
+        m_pending.pop_front();
+
+        lock.unlock();
+        job->encode();
+        lock.lock();
+
+        m_stats.encodeTime += job->encodeTime;
+        storeJobs(job, seq);
+    }
+}
+
+void AsyncImageWriter::Impl::storeJobs(const Ptr<WriteJob>& job, uint64 seq)
+{
+    m_encoded[seq] = job;
+    if (m_storing)
+        return;  // the worker which is writing files will write this one too
+
+    // only one worker writes files at a time, others keep encoding
+    m_storing = true;
+    std::map<uint64, Ptr<WriteJob> >::iterator it;
+    while ((it = m_encoded.find(m_nextStore)) != m_encoded.end())
+    {
+        Ptr<WriteJob> next = it->second;
+        m_encoded.erase(it);
+        m_nextStore++;
+        if (!next)
+            continue;  // dropped
+
+        m_mutex.unlock();
+        int64 t = getTickCount();
+        bool ok = next->store();
+        double writeTime = (getTickCount() - t) / getTickFrequency();
+        m_mutex.lock();
+
+        m_stats.writeTime += writeTime;
+        if (ok)
+        {
+            m_stats.written++;
+            m_stats.bytes += next->buf.size();
+        }
+        else
+            m_stats.failed++;
+        // the slot is freed before the callback, it may write() the next image with the BLOCK policy
+        m_queued--;
+        m_callbacks++;
+        m_jobDone.notify_all();
+
+        m_mutex.unlock();
+        next->finish(ok);
+        m_mutex.lock();
+        m_callbacks--;
+        m_jobDone.notify_all();
+    }
+    m_storing = false;
+}
+#endif
+
+void AsyncImageWriter::Impl::flush()
+{
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_jobDone.wait(lock, [&] { return m_queued == 0 && m_callbacks == 0; });
+#endif
+}
+
+int AsyncImageWriter::Impl::queueSize() const
+{
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+    std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+    return m_queued;
+}
+
+AsyncImageWriter::Stats AsyncImageWriter::Impl::getStats() const
+{
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+    std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+    Stats stats = m_stats;
+    stats.elapsedTime = (getTickCount() - m_startTick) / getTickFrequency();
+    return stats;
+}
+
+AsyncImageWriter::AsyncImageWriter(int numWorkers, int maxQueueSize, int policy)
+    : pImpl(makePtr<Impl>(numWorkers, maxQueueSize, policy))
+{
+}
+
+AsyncImageWriter::~AsyncImageWriter()
+{
+}
+
+bool AsyncImageWriter::write(const String& filename, InputArray img, const std::vector<int>& params,
+                             const Callback& onDone)
+{
+    CV_TRACE_FUNCTION();
+    return pImpl->write(filename, img.getMat(), params, onDone);
+}
+
+void AsyncImageWriter::flush()
+{
+    CV_TRACE_FUNCTION();
+    pImpl->flush();
+}
+
+int AsyncImageWriter::queueSize() const
+{
+    return pImpl->queueSize();
+}
+
+AsyncImageWriter::Stats AsyncImageWriter::getStats() const
+{
+    return pImpl->getStats();
+}
+
+} // namespace cv
@@ -140,6 +140,7 @@ static const size_t kParamMaxFileSize = utils::getConfigurationParameterSizeT(
 static constexpr size_t kAvifSignatureSize = 500;
 
 AvifDecoder::AvifDecoder() {
+  m_codec_name = "avif";
   m_buf_supported = true;
   channels_ = 0;
   decoder_ = avifDecoderCreate();
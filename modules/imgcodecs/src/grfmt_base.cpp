@@ -58,6 +58,20 @@ BaseImageDecoder::BaseImageDecoder()
 }
 
 
+bool BaseImageDecoder::reset()
+{
+    m_width = m_height = 0;
+    m_type = -1;
+    m_scale_denom = 1;
+    m_use_rgb = false;
+    m_frame_count = 1;
+    m_filename = String();
+    m_buf.release();
+    m_exif = ExifReader();
+    m_roi = Rect();
+    return false;
+}
+
 ExifEntry_t BaseImageDecoder::getExifTag(const ExifTagName tag) const
 {
     return m_exif.getTag(tag);
@@ -101,6 +115,41 @@ void BaseImageDecoder::setRGB(bool useRGB)
     m_use_rgb = useRGB;
 }
 
+bool BaseImageDecoder::setTargetSize(const Size& size, bool exact)
+{
+    CV_UNUSED(size);
+    CV_UNUSED(exact);
+    return false;
+}
+
+bool BaseImageDecoder::setROI(const Rect& roi)
+{
+    CV_UNUSED(roi);
+    return false;
+}
+
+int BaseImageDecoder::getLevelCount() const
+{
+    return 1;
+}
+
+bool BaseImageDecoder::setLevel(int level)
+{
+    return level == 0;
+}
+
+bool BaseImageDecoder::startReadRows(int type)
+{
+    CV_UNUSED(type);
+    return false;
+}
+
+bool BaseImageDecoder::readRows(Mat& band)
+{
+    CV_UNUSED(band);
+    return false;
+}
+
 ImageDecoder BaseImageDecoder::newDecoder() const
 {
     return ImageDecoder();
@@ -144,6 +193,25 @@ bool BaseImageEncoder::writemulti(const std::vector<Mat>&, const std::vector<int
     return false;
 }
 
+bool BaseImageEncoder::startWriteRows(Size size, int type, const std::vector<int>& params)
+{
+    CV_UNUSED(size);
+    CV_UNUSED(type);
+    CV_UNUSED(params);
+    return false;
+}
+
+bool BaseImageEncoder::writeRows(const Mat& band)
+{
+    CV_UNUSED(band);
+    return false;
+}
+
+bool BaseImageEncoder::finishWriteRows()
+{
+    return false;
+}
+
 ImageEncoder BaseImageEncoder::newEncoder() const
 {
     return ImageEncoder();
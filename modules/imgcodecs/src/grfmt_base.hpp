@@ -58,6 +58,12 @@ public:
      */
     size_t getFrameCount() const { return m_frame_count; }
 
+    /**
+     * @brief Get the short name of the image format, see imreadHeader().
+     * @return The lowercase name of the format, e.g. "png" or "tiff".
+     */
+    const String& getCodecName() const { return m_codec_name; }
+
     /**
      * @brief Get the type of the image (e.g., color format, depth).
      * @return The type of the image.
@@ -92,9 +98,22 @@ public:
      */
     virtual int setScale(const int& scale_denom);
 
+    /**
+     * @brief Ask the decoder to produce an image of the given size, see imreadScaled().
+     * Called before readHeader(). A decoder with native scaling decodes at the smallest scale which is not
+     * smaller than size, width() and height() report the decoded size. If exact is true, the decoder may
+     * also resize the decoded rows to size in the same pass, then width() and height() are equal to size.
+     * The default implementation returns false.
+     * @param size The target size.
+     * @param exact Whether the decoder may resize the decoded rows to size.
+     * @return true if the decoder scales the image, false if it decodes the image at its original size.
+     */
+    virtual bool setTargetSize(const Size& size, bool exact);
+
     /**
      * @brief Read the image header to extract basic properties (width, height, type).
      * This is a pure virtual function that must be implemented by derived classes.
+     * EXIF data which precedes the pixel data should be parsed here, so that imreadHeader() reports the orientation.
      * @return true if the header was successfully read, false otherwise.
      */
     virtual bool readHeader() = 0;
@@ -107,6 +126,48 @@ public:
      */
     virtual bool readData(Mat& img) = 0;
 
+    /**
+     * @brief Restrict the next readData() call to a rectangular part of the image.
+     * Called after readHeader(). If the decoder accepts the rectangle, readData() receives a Mat of roi.size()
+     * and decodes only the tiles, strips or rows covering it. The default implementation returns false.
+     * @param roi The rectangle in the coordinates of the decoded image, it lies inside the image and is not empty.
+     * @return true if the decoder decodes only the rectangle, false if the whole image must be decoded.
+     */
+    virtual bool setROI(const Rect& roi);
+
+    /**
+     * @brief Get the number of resolution levels of the current page, see imreadLevel().
+     * Called after readHeader(). The level 0 is the full resolution image. The default implementation returns 1.
+     * @return The number of levels stored in the file.
+     */
+    virtual int getLevelCount() const;
+
+    /**
+     * @brief Switch to a reduced resolution level of the current page, see imreadLevel().
+     * Called after readHeader(), then width(), height() and type() describe the level, and setROI() and
+     * readData() work on it. The default implementation accepts the level 0 only.
+     * @param level The level, from 0 to getLevelCount() - 1.
+     * @return true if the level is stored in the file.
+     */
+    virtual bool setLevel(int level);
+
+    /**
+     * @brief Prepare the decoder to decode the image by bands of rows, see ImageStreamReader.
+     * Called after readHeader() instead of readData(). The default implementation returns false.
+     * @param type The type of the decoded rows, the same as the type of the Mat passed to readData().
+     * @return true if the decoder can decode the image by rows, false if readData() must be used.
+     */
+    virtual bool startReadRows(int type);
+
+    /**
+     * @brief Decode the next band.rows rows of the image.
+     * Called after a successful startReadRows(). The band has the full width of the image and the type
+     * given to startReadRows(). The default implementation returns false.
+     * @param band The Mat object where the rows will be stored.
+     * @return true if the rows were successfully read, false otherwise.
+     */
+    virtual bool readRows(Mat& band);
+
     /**
      * @brief Set whether to decode the image in RGB order instead of the default BGR.
      * @param useRGB If true, the image will be decoded in RGB order.
@@ -139,6 +200,15 @@ public:
      */
     virtual ImageDecoder newDecoder() const;
 
+    /**
+     * @brief Prepare the decoder for the next image of the same format, see imdecodeBatch().
+     * Called instead of newDecoder(). The decoder keeps the codec context which does not depend on the image
+     * (e.g. the libjpeg decompressor) and resets everything else. The default implementation resets the members
+     * of this class and returns false.
+     * @return true if the decoder can be reused, false if a new one must be created by newDecoder().
+     */
+    virtual bool reset();
+
 protected:
     int m_width;          ///< Width of the image (set by readHeader).
     int m_height;         ///< Height of the image (set by readHeader).
@@ -146,11 +216,13 @@ protected:
     int m_scale_denom;    ///< Scale factor denominator for resizing the image.
     String m_filename;    ///< Name of the file that is being decoded.
     String m_signature;   ///< Signature for identifying the image format.
+    String m_codec_name;  ///< Short name of the image format (set by the derived decoders).
     Mat m_buf;            ///< Buffer holding the image data when loaded from memory.
     bool m_buf_supported; ///< Flag indicating whether buffer-based loading is supported.
     bool m_use_rgb;       ///< Flag indicating whether to decode the image in RGB order.
     ExifReader m_exif;    ///< Object for reading EXIF metadata from the image.
     size_t m_frame_count; ///< Number of frames in the image (for animations and multi-page images).
+    Rect m_roi;           ///< Part of the image to decode (set by setROI), empty to decode the whole image.
 };
 
 
@@ -215,6 +287,30 @@ public:
      */
     virtual bool writemulti(const std::vector<Mat>& img_vec, const std::vector<int>& params);
 
+    /**
+     * @brief Start writing an image by bands of rows, see ImageStreamWriter.
+     * The encoder writes the header, then writeRows() encodes the rows as they come and finishWriteRows()
+     * completes the file. The default implementation returns false.
+     * @param size The size of the whole image.
+     * @param type The type of the rows.
+     * @param params A vector of parameters controlling the encoding process, the same as in write().
+     * @return true if the encoder can write the image by rows, false if write() must be used.
+     */
+    virtual bool startWriteRows(Size size, int type, const std::vector<int>& params);
+
+    /**
+     * @brief Encode the next rows of the image started by startWriteRows().
+     * @param band The rows, they have the width and the type given to startWriteRows().
+     * @return true if the rows were successfully written, false otherwise.
+     */
+    virtual bool writeRows(const Mat& band);
+
+    /**
+     * @brief Complete the image started by startWriteRows() after all its rows were written.
+     * @return true if the image was successfully written, false otherwise.
+     */
+    virtual bool finishWriteRows();
+
     /**
      * @brief Get a description of the image encoder (e.g., the format it supports).
      * @return A string describing the encoder.
@@ -52,6 +52,7 @@ static const char* fmtSignBmp = "BM";
 
 BmpDecoder::BmpDecoder()
 {
+    m_codec_name = "bmp";
     m_signature = fmtSignBmp;
     m_offset = -1;
     m_buf_supported = true;
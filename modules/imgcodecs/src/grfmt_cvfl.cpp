@@ -0,0 +1,824 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+#include "grfmt_cvfl.hpp"
+#include "utils.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+
+#ifdef HAVE_IMGCODEC_CVFL
+
+/*
+    File layout (all the numbers are little-endian):
+
+    offset  size
+    0       4       "CVFL"
+    4       1       version (1)
+    5       1       depth: CV_8U, CV_8S, CV_16U, CV_16S, CV_32S or CV_32F
+    6       1       number of channels: 1, 3 or 4
+    7       1       predictor, cv::ImwriteCVFLPredictorFlags
+    8       4       width
+    12      4       height
+    16      4       rows per block
+    20      8*N     sizes of the N = ceil(height / rows per block) blocks
+    ...             blocks
+
+    The samples of a block are processed as 8-, 16- or 32-bit unsigned integers
+    (32-bit floats are mapped to the integers of the same order first).
+    Every row is replaced by the predictor residuals with the wrap-around arithmetic,
+    the first row of the block is predicted from the left neighbours only.
+    The residuals r are zigzag-coded, (r << 1) ^ (r < 0 ? -1 : 0), and packed
+    in groups of 128 values (the last one is padded by zeros):
+
+        1 byte      number of bits b per value
+        16*b bytes  the values packed as b 128-bit words of 16-bit lanes (8- and 16-bit
+                    samples) or 32-bit lanes (32-bit samples): the value i of the group
+                    goes to the lane i % L of the words, L is the number of lanes,
+                    the values of a lane are stored from the lowest bits up.
+*/
+
+namespace cv
+{
+
+static const char cvflSignature[] = "CVFL";
+enum { CVFL_VERSION = 1, CVFL_HEADER_SIZE = 20, CVFL_GROUP = 128 };
+// the approximate number of samples coded as one block
+static const int CVFL_BLOCK_SAMPLES = 1 << 16;
+
+static void putUInt32LE( uchar* dst, uint32_t val )
+{
+    for( int i = 0; i < 4; i++ )
+        dst[i] = (uchar)(val >> (i*8));
+}
+
+static uint32_t getUInt32LE( const uchar* src )
+{
+    return (uint32_t)src[0] | ((uint32_t)src[1] << 8) | ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+static void putUInt64LE( uchar* dst, uint64_t val )
+{
+    for( int i = 0; i < 8; i++ )
+        dst[i] = (uchar)(val >> (i*8));
+}
+
+static uint64_t getUInt64LE( const uchar* src )
+{
+    return (uint64_t)getUInt32LE(src) | ((uint64_t)getUInt32LE(src + 4) << 32);
+}
+
+static bool isCvflDepth( int depth )
+{
+    return depth == CV_8U || depth == CV_8S || depth == CV_16U || depth == CV_16S ||
+           depth == CV_32S || depth == CV_32F;
+}
+
+static int bitWidth( uint32_t v )
+{
+    int b = 0;
+    while( b < 32 && (v >> b) != 0 )
+        b++;
+    return b;
+}
+
+template<typename LT> static inline LT lowBitsMask( int bits )
+{
+    return (LT)(((uint64_t)1 << bits) - 1);
+}
+
+////////////////////////////// bit packing //////////////////////////////
+
+// T is the sample type (uchar, ushort or unsigned), LT is the lane type (ushort or unsigned)
+
+#if CV_SIMD128 || CV_SIMD128_CPP
+
+static inline v_uint16x8 cvflLoad( const uchar* ptr ) { return v_load_expand(ptr); }
+static inline v_uint16x8 cvflLoad( const ushort* ptr ) { return v_load(ptr); }
+static inline v_uint32x4 cvflLoad( const unsigned* ptr ) { return v_load(ptr); }
+static inline void cvflStore( uchar* ptr, const v_uint16x8& v ) { v_pack_store(ptr, v); }
+static inline void cvflStore( ushort* ptr, const v_uint16x8& v ) { v_store(ptr, v); }
+static inline void cvflStore( unsigned* ptr, const v_uint32x4& v ) { v_store(ptr, v); }
+static inline v_uint16x8 cvflSetAll( ushort v ) { return v_setall_u16(v); }
+static inline v_uint32x4 cvflSetAll( unsigned v ) { return v_setall_u32(v); }
+
+// all ones in the lanes where the bit is set
+static inline v_uint16x8 cvflBitMask( const v_uint16x8& v, int bit )
+{
+    return v_reinterpret_as_u16(v_shr(v_reinterpret_as_s16(v_shl(v, 15 - bit)), 15));
+}
+static inline v_uint32x4 cvflBitMask( const v_uint32x4& v, int bit )
+{
+    return v_reinterpret_as_u32(v_shr(v_reinterpret_as_s32(v_shl(v, 31 - bit)), 31));
+}
+
+template<typename T, typename VT> static uchar* packGroup( const T* src, uchar* dst )
+{
+    typedef typename VT::lane_type LT;
+    const int W = sizeof(T)*8, LW = sizeof(LT)*8, nlanes = VT::nlanes;
+    const VT vmask = cvflSetAll(lowBitsMask<LT>(W)), vzero = cvflSetAll((LT)0);
+
+    VT z[32], all = vzero;
+    for( int j = 0; j < LW; j++ )
+    {
+        VT r = cvflLoad(src + j*nlanes);
+        z[j] = v_and(v_xor(v_shl(r, 1), cvflBitMask(r, W - 1)), vmask);
+        all = v_or(all, z[j]);
+    }
+    int b = bitWidth((uint32_t)v_reduce_max(all));
+    *dst++ = (uchar)b;
+    if( b == 0 )
+        return dst;
+
+    VT acc = vzero;
+    for( int j = 0, shift = 0; j < LW; j++ )
+    {
+        acc = v_or(acc, v_shl(z[j], shift));
+        shift += b;
+        if( shift >= LW )
+        {
+            v_store((LT*)dst, acc);
+            dst += 16;
+            shift -= LW;
+            acc = shift > 0 ? v_shr(z[j], b - shift) : vzero;
+        }
+    }
+    return dst;
+}
+
+template<typename T, typename VT> static void unpackGroup( const uchar* src, int b, T* dst )
+{
+    typedef typename VT::lane_type LT;
+    const int W = sizeof(T)*8, LW = sizeof(LT)*8, nlanes = VT::nlanes;
+    const VT vmask = cvflSetAll(lowBitsMask<LT>(W)), bmask = cvflSetAll(lowBitsMask<LT>(b));
+
+    VT cur = v_load((const LT*)src);
+    for( int j = 0, k = 0, shift = 0; j < LW; j++ )
+    {
+        VT v = v_shr(cur, shift);
+        int next = shift + b;
+        if( next >= LW )
+        {
+            next -= LW;
+            if( ++k < b )
+            {
+                cur = v_load((const LT*)(src + k*16));
+                if( next > 0 )
+                    v = v_or(v, v_shl(cur, b - next));
+            }
+        }
+        v = v_and(v, bmask);
+        cvflStore(dst + j*nlanes, v_and(v_xor(v_shr(v, 1), cvflBitMask(v, 0)), vmask));
+        shift = next;
+    }
+}
+
+#else
+
+template<typename T, typename LT> static uchar* packGroup( const T* src, uchar* dst )
+{
+    const int W = sizeof(T)*8, LW = sizeof(LT)*8, nlanes = 16 / sizeof(LT);
+    const LT mask = lowBitsMask<LT>(W);
+
+    LT z[CVFL_GROUP], all = 0;
+    for( int i = 0; i < CVFL_GROUP; i++ )
+    {
+        LT r = (LT)src[i];
+        z[i] = (LT)(((LT)(r << 1) ^ ((r >> (W - 1)) & 1 ? mask : 0)) & mask);
+        all |= z[i];
+    }
+    int b = bitWidth(all);
+    *dst++ = (uchar)b;
+    if( b == 0 )
+        return dst;
+
+    LT words[CVFL_GROUP];
+    for( int l = 0; l < nlanes; l++ )
+    {
+        LT acc = 0;
+        for( int j = 0, k = 0, shift = 0; j < LW; j++ )
+        {
+            LT v = z[j*nlanes + l];
+            acc |= (LT)(v << shift);
+            shift += b;
+            if( shift >= LW )
+            {
+                words[(k++)*nlanes + l] = acc;
+                shift -= LW;
+                acc = shift > 0 ? (LT)(v >> (b - shift)) : 0;
+            }
+        }
+    }
+    memcpy(dst, words, (size_t)b*16);
+    return dst + (size_t)b*16;
+}
+
+template<typename T, typename LT> static void unpackGroup( const uchar* src, int b, T* dst )
+{
+    const int W = sizeof(T)*8, LW = sizeof(LT)*8, nlanes = 16 / sizeof(LT);
+    const LT mask = lowBitsMask<LT>(W), bmask = lowBitsMask<LT>(b);
+
+    LT words[CVFL_GROUP];
+    memcpy(words, src, (size_t)b*16);
+    for( int l = 0; l < nlanes; l++ )
+    {
+        LT cur = words[l];
+        for( int j = 0, k = 0, shift = 0; j < LW; j++ )
+        {
+            LT v = (LT)(cur >> shift);
+            int next = shift + b;
+            if( next >= LW )
+            {
+                next -= LW;
+                if( ++k < b )
+                {
+                    cur = words[k*nlanes + l];
+                    if( next > 0 )
+                        v |= (LT)(cur << (b - next));
+                }
+            }
+            v &= bmask;
+            dst[j*nlanes + l] = (T)(((v >> 1) ^ (v & 1 ? mask : 0)) & mask);
+            shift = next;
+        }
+    }
+}
+
+#endif
+
+template<typename T> struct CvflLanes;
+#if CV_SIMD128 || CV_SIMD128_CPP
+template<> struct CvflLanes<uchar> { typedef v_uint16x8 type; };
+template<> struct CvflLanes<ushort> { typedef v_uint16x8 type; };
+template<> struct CvflLanes<unsigned> { typedef v_uint32x4 type; };
+#else
+template<> struct CvflLanes<uchar> { typedef ushort type; };
+template<> struct CvflLanes<ushort> { typedef ushort type; };
+template<> struct CvflLanes<unsigned> { typedef unsigned type; };
+#endif
+
+////////////////////////////// prediction //////////////////////////////
+
+#if CV_SIMD128 || CV_SIMD128_CPP
+static inline v_uint8x16 cvflSub( const v_uint8x16& a, const v_uint8x16& b ) { return v_sub_wrap(a, b); }
+static inline v_uint16x8 cvflSub( const v_uint16x8& a, const v_uint16x8& b ) { return v_sub_wrap(a, b); }
+static inline v_uint32x4 cvflSub( const v_uint32x4& a, const v_uint32x4& b ) { return v_sub(a, b); }
+static inline v_uint8x16 cvflAdd( const v_uint8x16& a, const v_uint8x16& b ) { return v_add_wrap(a, b); }
+static inline v_uint16x8 cvflAdd( const v_uint16x8& a, const v_uint16x8& b ) { return v_add_wrap(a, b); }
+static inline v_uint32x4 cvflAdd( const v_uint32x4& a, const v_uint32x4& b ) { return v_add(a, b); }
+
+template<typename T> struct CvflVec;
+template<> struct CvflVec<uchar> { typedef v_uint8x16 type; };
+template<> struct CvflVec<ushort> { typedef v_uint16x8 type; };
+template<> struct CvflVec<unsigned> { typedef v_uint32x4 type; };
+#endif
+
+// the residuals of the row; prev is NULL for the first row of the block
+template<typename T> static void predictRow( const T* cur, const T* prev, T* r, int n, int cn, int predictor )
+{
+    if( !prev )
+        predictor = predictor == IMWRITE_CVFL_PREDICTOR_GRADIENT ? IMWRITE_CVFL_PREDICTOR_LEFT :
+                    predictor == IMWRITE_CVFL_PREDICTOR_UP ? IMWRITE_CVFL_PREDICTOR_NONE : predictor;
+    int i = 0;
+#if CV_SIMD128 || CV_SIMD128_CPP
+    typedef typename CvflVec<T>::type VT;
+    const int nlanes = VT::nlanes;
+#endif
+
+    switch( predictor )
+    {
+    case IMWRITE_CVFL_PREDICTOR_UP:
+#if CV_SIMD128 || CV_SIMD128_CPP
+        for( ; i <= n - nlanes; i += nlanes )
+            v_store(r + i, cvflSub(v_load(cur + i), v_load(prev + i)));
+#endif
+        for( ; i < n; i++ )
+            r[i] = (T)(cur[i] - prev[i]);
+        break;
+    case IMWRITE_CVFL_PREDICTOR_LEFT:
+        for( ; i < cn && i < n; i++ )
+            r[i] = cur[i];
+#if CV_SIMD128 || CV_SIMD128_CPP
+        for( ; i <= n - nlanes; i += nlanes )
+            v_store(r + i, cvflSub(v_load(cur + i), v_load(cur + i - cn)));
+#endif
+        for( ; i < n; i++ )
+            r[i] = (T)(cur[i] - cur[i - cn]);
+        break;
+    case IMWRITE_CVFL_PREDICTOR_GRADIENT:
+        // (x - up) - (left - upper-left)
+        for( ; i < cn && i < n; i++ )
+            r[i] = (T)(cur[i] - prev[i]);
+#if CV_SIMD128 || CV_SIMD128_CPP
+        for( ; i <= n - nlanes; i += nlanes )
+            v_store(r + i, cvflSub(cvflSub(v_load(cur + i), v_load(prev + i)),
+                                   cvflSub(v_load(cur + i - cn), v_load(prev + i - cn))));
+#endif
+        for( ; i < n; i++ )
+            r[i] = (T)((T)(cur[i] - prev[i]) - (T)(cur[i - cn] - prev[i - cn]));
+        break;
+    default:
+        memcpy(r, cur, n*sizeof(T));
+    }
+}
+
+// in-place running sum along the row, separately for each channel;
+// the sums are kept in registers so the loop is not bound by store-to-load forwarding
+template<typename T> static void accumulateRow( T* x, int n, int cn )
+{
+    int i = cn;
+    if( cn == 1 )
+    {
+        T a = x[0];
+        for( ; i < n; i++ )
+            x[i] = a = (T)(a + x[i]);
+    }
+    else if( cn == 3 )
+    {
+        T a0 = x[0], a1 = x[1], a2 = x[2];
+        for( ; i <= n - 3; i += 3 )
+        {
+            x[i] = a0 = (T)(a0 + x[i]);
+            x[i + 1] = a1 = (T)(a1 + x[i + 1]);
+            x[i + 2] = a2 = (T)(a2 + x[i + 2]);
+        }
+    }
+    else if( cn == 4 )
+    {
+        T a0 = x[0], a1 = x[1], a2 = x[2], a3 = x[3];
+        for( ; i <= n - 4; i += 4 )
+        {
+            x[i] = a0 = (T)(a0 + x[i]);
+            x[i + 1] = a1 = (T)(a1 + x[i + 1]);
+            x[i + 2] = a2 = (T)(a2 + x[i + 2]);
+            x[i + 3] = a3 = (T)(a3 + x[i + 3]);
+        }
+    }
+    for( ; i < n; i++ )
+        x[i] = (T)(x[i] + x[i - cn]);
+}
+
+// the inverse of predictRow()
+template<typename T> static void reconstructRow( const T* r, const T* prev, T* x, int n, int cn, int predictor )
+{
+    if( !prev )
+        predictor = predictor == IMWRITE_CVFL_PREDICTOR_GRADIENT ? IMWRITE_CVFL_PREDICTOR_LEFT :
+                    predictor == IMWRITE_CVFL_PREDICTOR_UP ? IMWRITE_CVFL_PREDICTOR_NONE : predictor;
+    int i = 0;
+#if CV_SIMD128 || CV_SIMD128_CPP
+    typedef typename CvflVec<T>::type VT;
+    const int nlanes = VT::nlanes;
+#endif
+
+    switch( predictor )
+    {
+    case IMWRITE_CVFL_PREDICTOR_UP:
+#if CV_SIMD128 || CV_SIMD128_CPP
+        for( ; i <= n - nlanes; i += nlanes )
+            v_store(x + i, cvflAdd(v_load(r + i), v_load(prev + i)));
+#endif
+        for( ; i < n; i++ )
+            x[i] = (T)(r[i] + prev[i]);
+        break;
+    case IMWRITE_CVFL_PREDICTOR_LEFT:
+        memcpy(x, r, n*sizeof(T));
+        accumulateRow(x, n, cn);
+        break;
+    case IMWRITE_CVFL_PREDICTOR_GRADIENT:
+        // the vertical part is added to all the residuals first, then the running sum along the row
+        for( ; i < cn && i < n; i++ )
+            x[i] = (T)(r[i] + prev[i]);
+#if CV_SIMD128 || CV_SIMD128_CPP
+        for( ; i <= n - nlanes; i += nlanes )
+            v_store(x + i, cvflAdd(v_load(r + i), cvflSub(v_load(prev + i), v_load(prev + i - cn))));
+#endif
+        for( ; i < n; i++ )
+            x[i] = (T)(r[i] + (T)(prev[i] - prev[i - cn]));
+        accumulateRow(x, n, cn);
+        break;
+    default:
+        memcpy(x, r, n*sizeof(T));
+    }
+}
+
+// maps the float bit patterns to the unsigned integers of the same order and back
+static void floatToOrdered( const unsigned* src, unsigned* dst, int n )
+{
+    int i = 0;
+#if CV_SIMD128 || CV_SIMD128_CPP
+    const v_uint32x4 sign = v_setall_u32(0x80000000u);
+    for( ; i <= n - 4; i += 4 )
+    {
+        v_uint32x4 v = v_load(src + i);
+        v_uint32x4 m = v_reinterpret_as_u32(v_shr(v_reinterpret_as_s32(v), 31));
+        v_store(dst + i, v_xor(v, v_or(m, sign)));
+    }
+#endif
+    for( ; i < n; i++ )
+        dst[i] = src[i] ^ ((unsigned)((int)src[i] >> 31) | 0x80000000u);
+}
+
+static void orderedToFloat( unsigned* data, int n )
+{
+    int i = 0;
+#if CV_SIMD128 || CV_SIMD128_CPP
+    const v_uint32x4 sign = v_setall_u32(0x80000000u);
+    for( ; i <= n - 4; i += 4 )
+    {
+        v_uint32x4 v = v_load(data + i);
+        v_uint32x4 m = v_not(v_reinterpret_as_u32(v_shr(v_reinterpret_as_s32(v), 31)));
+        v_store(data + i, v_xor(v, v_or(m, sign)));
+    }
+#endif
+    for( ; i < n; i++ )
+        data[i] ^= (unsigned)~((int)data[i] >> 31) | 0x80000000u;
+}
+
+////////////////////////////// blocks //////////////////////////////
+
+template<typename T> static void encodeBlock( const Mat& img, int y0, int y1, int predictor, std::vector<uchar>& dst )
+{
+    typedef typename CvflLanes<T>::type VT;
+    const int n = img.cols*img.channels(), cn = img.channels();
+    const size_t total = (size_t)(y1 - y0)*n;
+    const size_t ngroups = (total + CVFL_GROUP - 1)/CVFL_GROUP;
+    const bool isFloat = img.depth() == CV_32F;
+
+    AutoBuffer<T> _residuals(ngroups*CVFL_GROUP);
+    T* residuals = _residuals.data();
+    memset(residuals + total, 0, (ngroups*CVFL_GROUP - total)*sizeof(T));
+
+    AutoBuffer<T> _rows(isFloat ? (size_t)n*2 : 1);
+    T* cur = _rows.data();
+    T* prev = isFloat ? cur + n : NULL;
+    for( int y = y0; y < y1; y++ )
+    {
+        const T* src = img.ptr<T>(y);
+        if( isFloat )
+        {
+            std::swap(cur, prev);
+            floatToOrdered((const unsigned*)src, (unsigned*)cur, n);
+            src = cur;
+        }
+        const T* up = y == y0 ? NULL : isFloat ? prev : img.ptr<T>(y - 1);
+        predictRow(src, up, residuals + (size_t)(y - y0)*n, n, cn, predictor);
+    }
+
+    dst.resize(ngroups*(1 + sizeof(T)*8*16));
+    uchar* ptr = dst.data();
+    for( size_t g = 0; g < ngroups; g++ )
+        ptr = packGroup<T, VT>(residuals + g*CVFL_GROUP, ptr);
+    dst.resize(ptr - dst.data());
+}
+
+template<typename T> static bool decodeBlock( const uchar* src, size_t size, Mat& img, int y0, int y1, int predictor )
+{
+    typedef typename CvflLanes<T>::type VT;
+    const int W = sizeof(T)*8;
+    const int n = img.cols*img.channels(), cn = img.channels();
+    const size_t total = (size_t)(y1 - y0)*n;
+    const size_t ngroups = (total + CVFL_GROUP - 1)/CVFL_GROUP;
+
+    AutoBuffer<T> _residuals(ngroups*CVFL_GROUP);
+    T* residuals = _residuals.data();
+    const uchar* end = src + size;
+    for( size_t g = 0; g < ngroups; g++ )
+    {
+        if( src >= end )
+            return false;
+        int b = *src++;
+        if( b > W || (size_t)(end - src) < (size_t)b*16 )
+            return false;
+        if( b == 0 )
+            memset(residuals + g*CVFL_GROUP, 0, CVFL_GROUP*sizeof(T));
+        else
+            unpackGroup<T, VT>(src, b, residuals + g*CVFL_GROUP);
+        src += (size_t)b*16;
+    }
+    if( src != end )
+        return false;
+
+    for( int y = y0; y < y1; y++ )
+        reconstructRow(residuals + (size_t)(y - y0)*n, y == y0 ? NULL : img.ptr<T>(y - 1),
+                       img.ptr<T>(y), n, cn, predictor);
+    if( img.depth() == CV_32F )
+    {
+        for( int y = y0; y < y1; y++ )
+            orderedToFloat(img.ptr<unsigned>(y), n);
+    }
+    return true;
+}
+
+static void encodeBlock( const Mat& img, int y0, int y1, int predictor, std::vector<uchar>& dst )
+{
+    switch( img.elemSize1() )
+    {
+    case 1: encodeBlock<uchar>(img, y0, y1, predictor, dst); break;
+    case 2: encodeBlock<ushort>(img, y0, y1, predictor, dst); break;
+    default: encodeBlock<unsigned>(img, y0, y1, predictor, dst);
+    }
+}
+
+static bool decodeBlock( const uchar* src, size_t size, Mat& img, int y0, int y1, int predictor )
+{
+    switch( img.elemSize1() )
+    {
+    case 1: return decodeBlock<uchar>(src, size, img, y0, y1, predictor);
+    case 2: return decodeBlock<ushort>(src, size, img, y0, y1, predictor);
+    default: return decodeBlock<unsigned>(src, size, img, y0, y1, predictor);
+    }
+}
+
+// the blocks are coded in batches to limit the memory used by the compressed data
+static int cvflBatchSize()
+{
+    return std::max(getNumThreads(), 1)*4;
+}
+
+/////////////////////////////////// CvflDecoder ///////////////////////////////////
+
+CvflDecoder::CvflDecoder()
+{
+    m_codec_name = "cvfl";
+    m_signature = cvflSignature;
+    m_buf_supported = true;
+    m_file = 0;
+    m_predictor = IMWRITE_CVFL_PREDICTOR_NONE;
+    m_block_rows = 0;
+    m_data_offset = 0;
+}
+
+CvflDecoder::~CvflDecoder()
+{
+    close();
+}
+
+void CvflDecoder::close()
+{
+    if( m_file )
+    {
+        fclose(m_file);
+        m_file = 0;
+    }
+}
+
+bool CvflDecoder::readHeader()
+{
+    close();
+
+    uchar header[CVFL_HEADER_SIZE];
+    const uchar* buf = NULL;
+    size_t buf_size = 0;
+    if( !m_buf.empty() )
+    {
+        buf = m_buf.ptr();
+        buf_size = m_buf.total()*m_buf.elemSize();
+        if( buf_size < CVFL_HEADER_SIZE )
+            return false;
+        memcpy(header, buf, CVFL_HEADER_SIZE);
+    }
+    else
+    {
+        m_file = fopen(m_filename.c_str(), "rb");
+        if( !m_file || fread(header, 1, CVFL_HEADER_SIZE, m_file) != CVFL_HEADER_SIZE )
+            return false;
+    }
+
+    int version = header[4], depth = header[5], cn = header[6];
+    m_predictor = header[7];
+    m_width = (int)getUInt32LE(header + 8);
+    m_height = (int)getUInt32LE(header + 12);
+    m_block_rows = (int)getUInt32LE(header + 16);
+    if( memcmp(header, cvflSignature, 4) != 0 || version != CVFL_VERSION || !isCvflDepth(depth) ||
+        (cn != 1 && cn != 3 && cn != 4) || m_predictor > IMWRITE_CVFL_PREDICTOR_GRADIENT ||
+        m_width <= 0 || m_height <= 0 || m_block_rows <= 0 )
+        return false;
+    m_type = CV_MAKETYPE(depth, cn);
+    validateInputImageSize(Size(m_width, m_height));
+
+    // the block table and the block sizes are untrusted, they are checked against the bytes
+    // remaining in the buffer (file) before anything is allocated
+    uint64_t remaining = 0;
+    if( buf )
+        remaining = buf_size - CVFL_HEADER_SIZE;
+    else
+    {
+        long file_size = fseek(m_file, 0, SEEK_END) == 0 ? ftell(m_file) : -1;
+        if( file_size < CVFL_HEADER_SIZE || fseek(m_file, CVFL_HEADER_SIZE, SEEK_SET) != 0 )
+            return false;
+        remaining = (uint64_t)file_size - CVFL_HEADER_SIZE;
+    }
+
+    size_t nblocks = (m_height + (size_t)m_block_rows - 1)/m_block_rows;
+    if( remaining < nblocks*8 )
+        return false;
+    remaining -= nblocks*8;
+    std::vector<uchar> table(nblocks*8);
+    if( buf )
+        memcpy(table.data(), buf + CVFL_HEADER_SIZE, table.size());
+    else if( fread(table.data(), 1, table.size(), m_file) != table.size() )
+        return false;
+
+    m_block_sizes.resize(nblocks);
+    for( size_t i = 0; i < nblocks; i++ )
+    {
+        m_block_sizes[i] = getUInt64LE(&table[i*8]);
+        if( m_block_sizes[i] > remaining )
+            return false;
+        remaining -= m_block_sizes[i];
+    }
+    m_data_offset = CVFL_HEADER_SIZE + table.size();
+    return true;
+}
+
+bool CvflDecoder::readBlocks( Mat& img )
+{
+    const uchar* buf = m_buf.empty() ? NULL : m_buf.ptr() + m_data_offset;
+    const int nblocks = (int)m_block_sizes.size();
+    const int batch = buf ? nblocks : cvflBatchSize();
+    std::vector<size_t> offsets;
+    std::vector<uchar> data;
+
+    for( int b0 = 0; b0 < nblocks; b0 += batch )
+    {
+        int b1 = std::min(nblocks, b0 + batch);
+        offsets.assign(1, 0);
+        for( int i = b0; i < b1; i++ )
+            offsets.push_back(offsets.back() + (size_t)m_block_sizes[i]);
+
+        const uchar* src = buf;
+        if( !buf )
+        {
+            data.resize(offsets.back());
+            if( !m_file || fread(data.data(), 1, data.size(), m_file) != data.size() )
+                return false;
+            src = data.data();
+        }
+
+        std::vector<uchar> status(b1 - b0);
+        parallel_for_(Range(b0, b1), [&](const Range& range)
+        {
+            for( int i = range.start; i < range.end; i++ )
+            {
+                int y0 = i*m_block_rows, y1 = std::min(m_height, y0 + m_block_rows);
+                status[i - b0] = decodeBlock(src + offsets[i - b0], offsets[i - b0 + 1] - offsets[i - b0],
+                                             img, y0, y1, m_predictor);
+            }
+        });
+        for( size_t i = 0; i < status.size(); i++ )
+        {
+            if( !status[i] )
+                return false;
+        }
+    }
+    return true;
+}
+
+bool CvflDecoder::readData( Mat& img )
+{
+    if( m_buf.empty() && (!m_file || fseek(m_file, (long)m_data_offset, SEEK_SET) != 0) )
+        return false;
+
+    // decode in place, unless the stored samples have to be converted or swapped into RGB order
+    bool inplace = img.type() == m_type && !(m_use_rgb && CV_MAT_CN(m_type) > 1);
+    Mat native = inplace ? img : Mat(m_height, m_width, m_type);
+    bool result = readBlocks(native);
+    close();
+    if( !result || native.data == img.data )
+        return result;
+
+    // the conversion to the requested type
+    int depth = img.depth(), cn = img.channels(), src_cn = native.channels();
+    if( native.depth() != depth )
+    {
+        double scale = native.elemSize1() == 2 && depth == CV_8U ? 1./256 : 1.;
+        native.convertTo(native, depth, scale);
+    }
+
+    int code = -1;
+    if( cn == 1 )
+        code = src_cn == 3 ? COLOR_BGR2GRAY : src_cn == 4 ? COLOR_BGRA2GRAY : -1;
+    else if( cn == 3 )
+        code = src_cn == 1 ? COLOR_GRAY2BGR : src_cn == 4 ? (m_use_rgb ? COLOR_BGRA2RGB : COLOR_BGRA2BGR) :
+               m_use_rgb ? COLOR_BGR2RGB : -1;
+    else if( cn == 4 )
+        code = src_cn == 1 ? COLOR_GRAY2BGRA : src_cn == 3 ? (m_use_rgb ? COLOR_BGR2RGBA : COLOR_BGR2BGRA) :
+               m_use_rgb ? COLOR_BGRA2RGBA : -1;
+
+    if( code < 0 )
+        native.copyTo(img);
+    else if( depth == CV_8U || depth == CV_16U || depth == CV_32F )
+        cvtColor(native, img, code);
+    else
+    {
+        // cvtColor doesn't support the signed integer types
+        Mat tmp;
+        native.convertTo(tmp, CV_32F);
+        cvtColor(tmp, tmp, code);
+        tmp.convertTo(img, img.type());
+    }
+    return true;
+}
+
+/////////////////////////////////// CvflEncoder ///////////////////////////////////
+
+CvflEncoder::CvflEncoder()
+{
+    m_description = "OpenCV fast lossless image (*.cvfl)";
+    m_buf_supported = true;
+}
+
+CvflEncoder::~CvflEncoder()
+{
+}
+
+bool CvflEncoder::isFormatSupported( int depth ) const
+{
+    return isCvflDepth(depth);
+}
+
+bool CvflEncoder::write( const Mat& img, const std::vector<int>& params )
+{
+    const int depth = img.depth(), cn = img.channels();
+    CV_CheckDepth(depth, isCvflDepth(depth), "");
+    CV_Check(cn, cn == 1 || cn == 3 || cn == 4, "CVFL: 1, 3 or 4 channels are supported");
+    CV_Assert(!img.empty());
+
+    int predictor = IMWRITE_CVFL_PREDICTOR_GRADIENT;
+    for( size_t i = 0; i + 1 < params.size(); i += 2 )
+    {
+        if( params[i] == IMWRITE_CVFL_PREDICTOR )
+        {
+            predictor = params[i+1];
+            CV_CheckGE(predictor, (int)IMWRITE_CVFL_PREDICTOR_NONE, "");
+            CV_CheckLE(predictor, (int)IMWRITE_CVFL_PREDICTOR_GRADIENT, "");
+        }
+    }
+
+    const int width = img.cols, height = img.rows;
+    const int block_rows = std::max(1, CVFL_BLOCK_SAMPLES/(width*cn));
+    const int nblocks = (height + block_rows - 1)/block_rows;
+
+    std::vector<uchar> header(CVFL_HEADER_SIZE + (size_t)nblocks*8, (uchar)0);
+    memcpy(&header[0], cvflSignature, 4);
+    header[4] = (uchar)CVFL_VERSION;
+    header[5] = (uchar)depth;
+    header[6] = (uchar)cn;
+    header[7] = (uchar)predictor;
+    putUInt32LE(&header[8], (uint32_t)width);
+    putUInt32LE(&header[12], (uint32_t)height);
+    putUInt32LE(&header[16], (uint32_t)block_rows);
+
+    FILE* f = NULL;
+    if( m_buf )
+        m_buf->assign(header.begin(), header.end());
+    else
+    {
+        f = fopen(m_filename.c_str(), "wb");
+        if( !f )
+            return false;
+        if( fwrite(header.data(), 1, header.size(), f) != header.size() )
+        {
+            fclose(f);
+            return false;
+        }
+    }
+
+    // the block sizes are filled in the table when all the blocks are written
+    const int batch = cvflBatchSize();
+    std::vector<std::vector<uchar> > blocks(std::min(batch, nblocks));
+    bool result = true;
+    for( int b0 = 0; b0 < nblocks && result; b0 += batch )
+    {
+        int b1 = std::min(nblocks, b0 + batch);
+        parallel_for_(Range(b0, b1), [&](const Range& range)
+        {
+            for( int i = range.start; i < range.end; i++ )
+                encodeBlock(img, i*block_rows, std::min(height, (i + 1)*block_rows), predictor, blocks[i - b0]);
+        });
+
+        for( int i = b0; i < b1 && result; i++ )
+        {
+            const std::vector<uchar>& block = blocks[i - b0];
+            putUInt64LE(&header[CVFL_HEADER_SIZE + (size_t)i*8], block.size());
+            if( m_buf )
+                m_buf->insert(m_buf->end(), block.begin(), block.end());
+            else
+                result = fwrite(block.data(), 1, block.size(), f) == block.size();
+        }
+    }
+
+    if( m_buf )
+    {
+        memcpy(m_buf->data() + CVFL_HEADER_SIZE, &header[CVFL_HEADER_SIZE], (size_t)nblocks*8);
+        return true;
+    }
+    result = result && fseek(f, CVFL_HEADER_SIZE, SEEK_SET) == 0 &&
+             fwrite(&header[CVFL_HEADER_SIZE], 1, (size_t)nblocks*8, f) == (size_t)nblocks*8;
+    result = fclose(f) == 0 && result;
+    return result;
+}
+
+}
+
+#endif // HAVE_IMGCODEC_CVFL
@@ -0,0 +1,62 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef _GRFMT_CVFL_H_
+#define _GRFMT_CVFL_H_
+
+#include "grfmt_base.hpp"
+
+#ifdef HAVE_IMGCODEC_CVFL
+namespace cv
+{
+
+// OpenCV fast lossless format (*.cvfl):
+// the image is split into bands of rows which are coded independently;
+// the samples of a band are replaced by the residuals of a simple predictor
+// and the zigzag-coded residuals are bit-packed in groups of 128 values.
+class CvflDecoder CV_FINAL : public BaseImageDecoder
+{
+public:
+    CvflDecoder();
+    virtual ~CvflDecoder() CV_OVERRIDE;
+
+    bool  readData( Mat& img ) CV_OVERRIDE;
+    bool  readHeader() CV_OVERRIDE;
+    void  close();
+
+    ImageDecoder newDecoder() const CV_OVERRIDE
+    {
+        return makePtr<CvflDecoder>();
+    }
+
+protected:
+    bool  readBlocks( Mat& img );
+
+    FILE* m_file;
+    int   m_predictor;
+    int   m_block_rows;
+    size_t m_data_offset;
+    std::vector<uint64_t> m_block_sizes;
+};
+
+class CvflEncoder CV_FINAL : public BaseImageEncoder
+{
+public:
+    CvflEncoder();
+    virtual ~CvflEncoder() CV_OVERRIDE;
+
+    bool  isFormatSupported( int depth ) const CV_OVERRIDE;
+    bool  write( const Mat& img, const std::vector<int>& params ) CV_OVERRIDE;
+
+    ImageEncoder newEncoder() const CV_OVERRIDE
+    {
+        return makePtr<CvflEncoder>();
+    }
+};
+
+}
+
+#endif // HAVE_IMGCODEC_CVFL
+
+#endif/*_GRFMT_CVFL_H_*/
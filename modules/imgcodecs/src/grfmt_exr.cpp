@@ -63,6 +63,7 @@
 #include <ImfHeader.h>
 #include <ImfInputFile.h>
 #include <ImfOutputFile.h>
+#include <ImfTiledOutputFile.h>
 #include <ImfChannelList.h>
 #include <ImfStandardAttributes.h>
 #include <half.h>
@@ -108,8 +109,13 @@ static void initOpenEXR()
 
 ExrDecoder::ExrDecoder()
 {
+    m_codec_name = "exr";
     m_signature = "\x76\x2f\x31\x01";
     m_file = 0;
+    m_tiled = 0;
+    m_level = 0;
+    m_level_count = 1;
+    m_reading_tiles = false;
     m_red = m_green = m_blue = m_alpha = 0;
     m_type = ((Imf::PixelType)0);
     m_iscolor = false;
@@ -135,6 +141,11 @@ void  ExrDecoder::close()
         delete m_file;
         m_file = 0;
     }
+    if( m_tiled )
+    {
+        delete m_tiled;
+        m_tiled = 0;
+    }
 }
 
 
@@ -157,6 +168,16 @@ bool  ExrDecoder::readHeader()
     m_width = m_datawindow.max.x - m_datawindow.min.x + 1;
     m_height = m_datawindow.max.y - m_datawindow.min.y + 1;
 
+    // the mipmap levels of a tiled file halve the size down to 1x1, see setLevel()
+    m_level_count = 1;
+    if( m_file->header().hasTileDescription() &&
+        m_file->header().tileDescription().mode == MIPMAP_LEVELS )
+    {
+        const bool roundup = m_file->header().tileDescription().roundingMode == ROUND_UP;
+        for( int size = std::max( m_width, m_height ); size > 1; m_level_count++ )
+            size = roundup ? (size + 1) / 2 : size / 2;
+    }
+
     // the type HALF is converted to 32 bit float
     // and the other types supported by OpenEXR are 32 bit anyway
     m_bit_depth = 32;
@@ -211,8 +232,107 @@ bool  ExrDecoder::readHeader()
 }
 
 
+bool  ExrDecoder::setROI( const Rect& roi )
+{
+    // subsampled channels are upsampled over the whole image
+    const Channel* channels[] = { m_red, m_green, m_blue, m_alpha };
+    for( const Channel* ch : channels )
+        if( ch && (ch->xSampling != 1 || ch->ySampling != 1) )
+            return false;
+    m_roi = roi;
+    return true;
+}
+
+
+int  ExrDecoder::getLevelCount() const
+{
+    return m_level_count;
+}
+
+
+bool  ExrDecoder::setLevel( int level )
+{
+    if( level == 0 )
+        return true;
+    if( !m_file || level < 0 || level >= m_level_count )
+        return false;
+    // the channels of the tiled files are never subsampled, so the tiles are read into the image directly
+    m_tiled = new TiledInputFile( m_filename.c_str() );
+    m_level = level;
+    m_datawindow = m_tiled->dataWindowForLevel( level );
+    m_width = m_datawindow.max.x - m_datawindow.min.x + 1;
+    m_height = m_datawindow.max.y - m_datawindow.min.y + 1;
+    return true;
+}
+
+
+bool  ExrDecoder::readLevel( Mat& img )
+{
+    // the rows of tiles covering the ROI are decoded with the native type, then cropped and converted
+    const Rect roi = m_roi.empty() ? Rect( 0, 0, m_width, m_height ) : m_roi;
+    const int tileHeight = (int)m_tiled->tileYSize();
+    const int y0 = roi.y / tileHeight * tileHeight;
+    const int y1 = std::min( m_height, (roi.y + roi.height + tileHeight - 1) / tileHeight * tileHeight );
+    const Box2i datawindow = m_datawindow;
+    const int height = m_height;
+    m_roi = Rect();
+    m_datawindow.min.y += y0;
+    m_datawindow.max.y = m_datawindow.min.y + (y1 - y0) - 1;
+    m_height = y1 - y0;
+    m_reading_tiles = true;
+    Mat rows( y1 - y0, m_width, type() );
+    bool result = readData( rows );
+    m_reading_tiles = false;
+    m_datawindow = datawindow;
+    m_height = height;
+    if( !result )
+        return false;
+
+    Mat src = rows( Rect( roi.x, roi.y - y0, roi.width, roi.height ) ), dst;
+    const int scn = src.channels(), dcn = img.channels();
+    if( scn == dcn )
+        dst = src;
+    else if( scn == 2 )
+    {
+        extractChannel( src, dst, 0 );
+        if( dcn == 3 )
+            cvtColor( dst, dst, COLOR_GRAY2BGR );
+    }
+    else if( dcn == 1 )
+        cvtColor( src, dst, scn == 4 ? (m_use_rgb ? COLOR_RGBA2GRAY : COLOR_BGRA2GRAY) : (m_use_rgb ? COLOR_RGB2GRAY : COLOR_BGR2GRAY) );
+    else if( scn == 1 )
+        cvtColor( src, dst, COLOR_GRAY2BGR );
+    else
+        cvtColor( src, dst, COLOR_BGRA2BGR );
+    dst.convertTo( img, img.depth() );
+    return true;
+}
+
+
 bool  ExrDecoder::readData( Mat& img )
 {
+    if( m_tiled && !m_reading_tiles )
+        return readLevel( img );
+
+    if( !m_roi.empty() )
+    {
+        // read only the scanlines covering the ROI by narrowing the data window, then crop the columns
+        const Rect roi = m_roi;
+        const Box2i datawindow = m_datawindow;
+        const int height = m_height;
+        m_roi = Rect();
+        m_datawindow.min.y += roi.y;
+        m_datawindow.max.y = m_datawindow.min.y + roi.height - 1;
+        m_height = roi.height;
+        Mat rows( roi.height, m_width, img.type() );
+        bool result = readData( rows );
+        m_datawindow = datawindow;
+        m_height = height;
+        if( result )
+            rows.colRange( roi.x, roi.x + roi.width ).copyTo( img );
+        return result;
+    }
+
     m_native_depth = CV_MAT_DEPTH(type()) == img.depth();
     bool color = img.channels() > 2; // output mat has 3+ channels; Y or YA are the 1 and 2 channel scenario
     bool alphasupported = ( img.channels() % 2 == 0 );  // even number of channels indicates alpha
@@ -366,10 +486,22 @@ bool  ExrDecoder::readData( Mat& img )
         return false;
     }
 
-    m_file->setFrameBuffer( frame );
+    if( m_tiled )
+    {
+        // readLevel() narrows the data window to whole rows of tiles
+        CV_Assert( justcopy );
+        const int top = m_tiled->dataWindowForLevel( m_level ).min.y;
+        const int tileHeight = (int)m_tiled->tileYSize();
+        m_tiled->setFrameBuffer( frame );
+        m_tiled->readTiles( 0, m_tiled->numXTiles( m_level ) - 1,
+                            (m_datawindow.min.y - top) / tileHeight, (m_datawindow.max.y - top) / tileHeight, m_level );
+    }
+    else
+        m_file->setFrameBuffer( frame );
     if( justcopy )
     {
-        m_file->readPixels( m_datawindow.min.y, m_datawindow.max.y );
+        if( !m_tiled )
+            m_file->readPixels( m_datawindow.min.y, m_datawindow.max.y );
 
         if( m_iscolor )
         {
@@ -709,6 +841,7 @@ bool  ExrEncoder::write( const Mat& img, const std::vector<int>& params )
     bool result = false;
     Header header( width, height );
     Imf::PixelType type = FLOAT;
+    bool mipmap = false;
 
     for( size_t i = 0; i < params.size(); i += 2 )
     {
@@ -774,6 +907,10 @@ bool  ExrEncoder::write( const Mat& img, const std::vector<int>& params )
             CV_LOG_ONCE_WARNING(NULL, "Setting `IMWRITE_EXR_DWA_COMPRESSION_LEVEL` not supported in OpenEXR version " + std::to_string(OPENEXR_VERSION_MAJOR) + " (version 3 is required)");
 #endif
         }
+        if( params[i] == IMWRITE_EXR_MIPMAP )
+        {
+            mipmap = params[i + 1] != 0;
+        }
     }
 
     if( channels == 3 || channels == 4 )
@@ -794,14 +931,37 @@ bool  ExrEncoder::write( const Mat& img, const std::vector<int>& params )
         header.channels().insert( "A", Channel( type ) );
     }
 
+    if( mipmap )
+        return writeMipmap( img, header, type );
+
     OutputFile file( m_filename.c_str(), header );
 
     FrameBuffer frame;
+    Mat exrMat;
+    setFrameBuffer( img, type, frame, exrMat );
+    file.setFrameBuffer( frame );
+
+    result = true;
+    try
+    {
+        file.writePixels( height );
+    }
+    catch(...)
+    {
+        result = false;
+    }
+
+    return result;
+}
+
 
+// describes the pixels of img for OpenEXR, converted to exrMat if they are stored as HALF
+void  ExrEncoder::setFrameBuffer( const Mat& img, Imf::PixelType type, FrameBuffer& frame, Mat& exrMat )
+{
+    int channels = img.channels();
     char *buffer;
     size_t bufferstep;
     int size;
-    Mat exrMat;
     if( type == HALF )
     {
         img.convertTo(exrMat, CV_16F);
@@ -829,13 +989,32 @@ bool  ExrEncoder::write( const Mat& img, const std::vector<int>& params )
     { // even channel count indicates Alpha channel
         frame.insert( "A", Slice( type, buffer + size * (channels - 1), size * channels, bufferstep ));
     }
+}
 
-    file.setFrameBuffer( frame );
 
-    result = true;
+// the image is tiled and each mipmap level is computed from the previous one by pyrDown(),
+// which gives the same sizes as the ROUND_UP rounding mode
+bool  ExrEncoder::writeMipmap( const Mat& img, Header& header, Imf::PixelType type )
+{
+    header.setTileDescription( TileDescription( 64, 64, MIPMAP_LEVELS, ROUND_UP ) );
+
+    bool result = true;
     try
     {
-        file.writePixels( height );
+        TiledOutputFile file( m_filename.c_str(), header );
+        Mat level = img;
+        for( int l = 0; l < file.numLevels(); l++ )
+        {
+            if( l > 0 )
+                pyrDown( level, level );
+            CV_Assert( level.cols == file.levelWidth( l ) && level.rows == file.levelHeight( l ) );
+
+            FrameBuffer frame;
+            Mat exrMat;
+            setFrameBuffer( level, type, frame, exrMat );
+            file.setFrameBuffer( frame );
+            file.writeTiles( 0, file.numXTiles( l ) - 1, 0, file.numYTiles( l ) - 1, l );
+        }
     }
     catch(...)
     {
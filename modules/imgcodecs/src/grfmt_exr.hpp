@@ -51,9 +51,12 @@
 
 #include <ImfChromaticities.h>
 #include <ImfInputFile.h>
+#include <ImfTiledInputFile.h>
 #include <ImfChannelList.h>
 #include <ImathBox.h>
 #include <ImfRgbaFile.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
 #include "grfmt_base.hpp"
 
 namespace cv
@@ -73,12 +76,16 @@ public:
 
     int   type() const CV_OVERRIDE;
     bool  readData( Mat& img ) CV_OVERRIDE;
+    bool  setROI( const Rect& roi ) CV_OVERRIDE;
+    int   getLevelCount() const CV_OVERRIDE;
+    bool  setLevel( int level ) CV_OVERRIDE;
     bool  readHeader() CV_OVERRIDE;
     void  close();
 
     ImageDecoder newDecoder() const CV_OVERRIDE;
 
 protected:
+    bool  readLevel( Mat& img );
     void  UpSample( uchar *data, int xstep, int ystep, int xsample, int ysample );
     void  UpSampleX( float *data, int xstep, int xsample );
     void  UpSampleY( uchar *data, int xstep, int ystep, int ysample );
@@ -87,6 +94,10 @@ protected:
     void  RGBToGray( float *in, float *out );
 
     InputFile      *m_file;
+    TiledInputFile *m_tiled;        // opened by setLevel() for the reduced resolution levels
+    int             m_level;
+    int             m_level_count;
+    bool            m_reading_tiles;
     Imf::PixelType  m_type;
     Box2i           m_datawindow;
     bool            m_ischroma;
@@ -116,6 +127,10 @@ public:
     bool  isFormatSupported( int depth ) const CV_OVERRIDE;
     bool  write( const Mat& img, const std::vector<int>& params ) CV_OVERRIDE;
     ImageEncoder newEncoder() const CV_OVERRIDE;
+
+protected:
+    void  setFrameBuffer( const Mat& img, Imf::PixelType type, FrameBuffer& frame, Mat& exrMat );
+    bool  writeMipmap( const Mat& img, Header& header, Imf::PixelType type );
 };
 
 }
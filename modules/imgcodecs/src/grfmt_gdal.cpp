@@ -136,6 +136,7 @@ int gdal2opencv( const GDALDataType& gdalType, const int& channels ){
  * GDAL Decoder Constructor
 */
 GdalDecoder::GdalDecoder(){
+    m_codec_name = "gdal";
 
     // set a dummy signature
     m_signature="0";
@@ -65,6 +65,7 @@ namespace cv
 
 DICOMDecoder::DICOMDecoder()
 {
+    m_codec_name = "dicom";
     // DICOM preamble is 128 bytes (can have any value, defaults to 0) + 4 bytes magic number (DICM)
     m_signature = String(preamble_skip, (char)'\x0') + getMagic();
     m_buf_supported = false;
@@ -51,6 +51,7 @@ namespace cv
 
 HdrDecoder::HdrDecoder()
 {
+    m_codec_name = "hdr";
     m_signature = "#?RGBE";
     m_signature_alt = "#?RADIANCE";
     file = NULL;
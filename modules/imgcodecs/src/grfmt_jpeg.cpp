@@ -88,6 +88,10 @@ extern "C" {
   #undef CV_MANUAL_JPEG_STD_HUFF_TABLES
 #endif
 
+#if defined(LIBJPEG_TURBO_VERSION_NUMBER) && LIBJPEG_TURBO_VERSION_NUMBER >= 1005000
+  #define CV_JPEG_CROP_SCANLINE 1  // jpeg_crop_scanline() and jpeg_skip_scanlines() are available since 1.5
+#endif
+
 namespace cv
 {
 
@@ -108,6 +112,8 @@ struct JpegState
     jpeg_decompress_struct cinfo; // IJG JPEG codec structure
     JpegErrorMgr jerr; // error processing manager state
     JpegSource source; // memory buffer source
+    JSAMPARRAY rows; // scanline buffer of readRows(), NULL if the image is not read by rows
+    bool direct; // readRows() decodes the scanlines directly into the band
 };
 
 /////////////////////// Error processing /////////////////////
@@ -179,10 +185,13 @@ error_exit( j_common_ptr cinfo )
 
 JpegDecoder::JpegDecoder()
 {
+    m_codec_name = "jpeg";
     m_signature = "\xFF\xD8\xFF";
     m_state = 0;
     m_f = 0;
     m_buf_supported = true;
+    m_target_exact = false;
+    m_resize_rows = false;
 }
 
 
@@ -217,19 +226,49 @@ ImageDecoder JpegDecoder::newDecoder() const
     return makePtr<JpegDecoder>();
 }
 
+bool  JpegDecoder::reset()
+{
+    // the decompressor is kept, readHeader() reuses it for the next buffer
+    if( m_f )
+    {
+        fclose( m_f );
+        m_f = 0;
+    }
+    m_target_size = Size();
+    m_target_exact = false;
+    m_resize_rows = false;
+    BaseImageDecoder::reset();
+    return true;
+}
+
 bool  JpegDecoder::readHeader()
 {
     volatile bool result = false;
-    close();
-
-    JpegState* state = new JpegState;
-    m_state = state;
-    state->cinfo.err = jpeg_std_error(&state->jerr.pub);
-    state->jerr.pub.error_exit = error_exit;
+    // jpeg_stdio_src() can't replace a source of another kind, so only the memory buffers reuse the decompressor
+    const bool reuse = m_state && !m_buf.empty();
+    if( !reuse )
+    {
+        close();
+        JpegState* state = new JpegState;
+        m_state = state;
+        state->cinfo.err = jpeg_std_error(&state->jerr.pub);
+        state->jerr.pub.error_exit = error_exit;
+    }
+    else
+    {
+        m_width = m_height = 0;
+        m_type = -1;
+    }
+    JpegState* state = (JpegState*)m_state;
+    state->rows = 0;
+    state->direct = false;
 
     if( setjmp( state->jerr.setjmp_buffer ) == 0 )
     {
-        jpeg_create_decompress( &state->cinfo );
+        if( reuse )
+            jpeg_abort_decompress( &state->cinfo ); // releases the memory of the previous image
+        else
+            jpeg_create_decompress( &state->cinfo );
 
         if( !m_buf.empty() )
         {
@@ -249,12 +288,56 @@ bool  JpegDecoder::readHeader()
             jpeg_save_markers(&state->cinfo, APP1, 0xffff);
             jpeg_read_header( &state->cinfo, TRUE );
 
-            state->cinfo.scale_num=1;
-            state->cinfo.scale_denom = m_scale_denom;
+            // Check for Exif marker APP1
+            jpeg_saved_marker_ptr exif_marker = NULL;
+            jpeg_saved_marker_ptr cmarker = state->cinfo.marker_list;
+            while( cmarker && exif_marker == NULL )
+            {
+                if (cmarker->marker == APP1)
+                    exif_marker = cmarker;
+
+                cmarker = cmarker->next;
+            }
+
+            // Parse Exif data
+            if( exif_marker )
+            {
+                const std::streamsize offsetToTiffHeader = 6; //bytes from Exif size field to the first TIFF header
+
+                if (exif_marker->data_length > offsetToTiffHeader)
+                {
+                    m_exif.parseExif(exif_marker->data + offsetToTiffHeader, exif_marker->data_length - offsetToTiffHeader);
+                }
+            }
+
+            if( !m_target_size.empty() )
+            {
+                // the smallest M/8 scale which is not smaller than the target size,
+                // libjpeg-turbo supports M = 1..16, older libjpeg versions round it to 1/8, 1/4, 1/2 or 1
+                const int w = (int)state->cinfo.image_width, h = (int)state->cinfo.image_height;
+                int num = 1;
+                while( num < 16 && ((w*num + 7)/8 < m_target_size.width || (h*num + 7)/8 < m_target_size.height) )
+                    num++;
+                state->cinfo.scale_num = num;
+                state->cinfo.scale_denom = 8;
+            }
+            else
+            {
+                state->cinfo.scale_num=1;
+                state->cinfo.scale_denom = m_scale_denom;
+            }
             m_scale_denom=1; // trick! to know which decoder used scale_denom see imread_
             jpeg_calc_output_dimensions(&state->cinfo);
             m_width = state->cinfo.output_width;
             m_height = state->cinfo.output_height;
+            // the remaining downscaling is done on the decoded rows, see readData()
+            m_resize_rows = m_target_exact && m_width >= m_target_size.width && m_height >= m_target_size.height &&
+                            (m_width != m_target_size.width || m_height != m_target_size.height);
+            if( m_resize_rows )
+            {
+                m_width = m_target_size.width;
+                m_height = m_target_size.height;
+            }
             m_type = state->cinfo.num_components > 1 ? CV_8UC3 : CV_8UC1;
             result = true;
         }
@@ -399,104 +482,232 @@ int my_jpeg_load_dht (struct jpeg_decompress_struct *info, unsigned char *dht,
  ***************************************************************************/
 #endif  // CV_MANUAL_JPEG_STD_HUFF_TABLES
 
-bool  JpegDecoder::readData( Mat& img )
+bool  JpegDecoder::setTargetSize( const Size& size, bool exact )
 {
-    volatile bool result = false;
-    const bool color = img.channels() > 1;
+    m_target_size = size;
+    m_target_exact = exact;
+    return true;
+}
 
-    if( m_state && m_width && m_height )
-    {
-        jpeg_decompress_struct* cinfo = &((JpegState*)m_state)->cinfo;
-        JpegErrorMgr* jerr = &((JpegState*)m_state)->jerr;
+bool  JpegDecoder::setROI( const Rect& roi )
+{
+    m_roi = roi;
+    return true;
+}
+
+// selects the output color space for the given image type and starts decompression.
+// Called under the setjmp() of the caller. Returns true if the scanlines are decoded in the image format.
+bool  JpegDecoder::startDecompress( int type )
+{
+    jpeg_decompress_struct* cinfo = &((JpegState*)m_state)->cinfo;
+    const bool color = CV_MAT_CN(type) > 1;
 
-        if( setjmp( jerr->setjmp_buffer ) == 0 )
-        {
 #ifdef CV_MANUAL_JPEG_STD_HUFF_TABLES
-            /* check if this is a mjpeg image format */
-            if ( cinfo->ac_huff_tbl_ptrs[0] == NULL &&
-                cinfo->ac_huff_tbl_ptrs[1] == NULL &&
-                cinfo->dc_huff_tbl_ptrs[0] == NULL &&
-                cinfo->dc_huff_tbl_ptrs[1] == NULL )
-            {
-                /* yes, this is a mjpeg image format, so load the correct
-                huffman table */
-                my_jpeg_load_dht( cinfo,
-                    my_jpeg_odml_dht,
-                    cinfo->ac_huff_tbl_ptrs,
-                    cinfo->dc_huff_tbl_ptrs );
-            }
+    /* check if this is a mjpeg image format */
+    if ( cinfo->ac_huff_tbl_ptrs[0] == NULL &&
+        cinfo->ac_huff_tbl_ptrs[1] == NULL &&
+        cinfo->dc_huff_tbl_ptrs[0] == NULL &&
+        cinfo->dc_huff_tbl_ptrs[1] == NULL )
+    {
+        /* yes, this is a mjpeg image format, so load the correct
+        huffman table */
+        my_jpeg_load_dht( cinfo,
+            my_jpeg_odml_dht,
+            cinfo->ac_huff_tbl_ptrs,
+            cinfo->dc_huff_tbl_ptrs );
+    }
 #endif
 
-            // See https://github.com/opencv/opencv/issues/25274
-            // Conversion CMYK->BGR is not supported in libjpeg-turbo.
-            // So supporting both directly and indirectly is necessary.
-            bool doDirectRead = false;
+    // See https://github.com/opencv/opencv/issues/25274
+    // Conversion CMYK->BGR is not supported in libjpeg-turbo.
+    // So supporting both directly and indirectly is necessary.
+    bool doDirectRead = false;
 
-            if( color )
-            {
-                if( cinfo->num_components != 4 )
-                {
+    if( color )
+    {
+        if( cinfo->num_components != 4 )
+        {
 #ifdef JCS_EXTENSIONS
-                    cinfo->out_color_space = m_use_rgb ? JCS_EXT_RGB : JCS_EXT_BGR;
-                    cinfo->out_color_components = 3;
-                    doDirectRead = true; // BGR -> BGR
+            cinfo->out_color_space = m_use_rgb ? JCS_EXT_RGB : JCS_EXT_BGR;
+            cinfo->out_color_components = 3;
+            doDirectRead = true; // BGR -> BGR
 #else
-                    cinfo->out_color_space = JCS_RGB;
-                    cinfo->out_color_components = 3;
-                    doDirectRead = m_use_rgb ? true : false; // RGB -> BGR
+            cinfo->out_color_space = JCS_RGB;
+            cinfo->out_color_components = 3;
+            doDirectRead = m_use_rgb ? true : false; // RGB -> BGR
 #endif
-                }
-                else
-                {
-                    cinfo->out_color_space = JCS_CMYK;
-                    cinfo->out_color_components = 4;
-                    doDirectRead = false; // CMYK -> BGR
-                }
-            }
+        }
+        else
+        {
+            cinfo->out_color_space = JCS_CMYK;
+            cinfo->out_color_components = 4;
+            doDirectRead = false; // CMYK -> BGR
+        }
+    }
+    else
+    {
+        if( cinfo->num_components != 4 )
+        {
+            cinfo->out_color_space = JCS_GRAYSCALE;
+            cinfo->out_color_components = 1;
+            doDirectRead = true; // GRAY -> GRAY
+        }
+        else
+        {
+            cinfo->out_color_space = JCS_CMYK;
+            cinfo->out_color_components = 4;
+            doDirectRead = false; // CMYK -> GRAY
+        }
+    }
+
+    jpeg_start_decompress( cinfo );
+
+    return doDirectRead;
+}
+
+// converts a decoded scanline which is not in the image format
+static void convertScanline( const jpeg_decompress_struct* cinfo, const uchar* src, uchar* data,
+                             int width, bool color, bool use_rgb )
+{
+    if( color )
+    {
+        if (use_rgb)
+        {
+            if( cinfo->out_color_components == 3 )
+                icvCvt_BGR2RGB_8u_C3R( src, 0, data, 0, Size(width,1) );
+            else
+                icvCvt_CMYK2RGB_8u_C4C3R( src, 0, data, 0, Size(width,1) );
+        }
+        else
+        {
+            if( cinfo->out_color_components == 3 )
+                icvCvt_RGB2BGR_8u_C3R( src, 0, data, 0, Size(width,1) );
             else
+                icvCvt_CMYK2BGR_8u_C4C3R( src, 0, data, 0, Size(width,1) );
+        }
+    }
+    else
+    {
+        if( cinfo->out_color_components == 1 )
+            memcpy( data, src, width );
+        else
+            icvCvt_CMYK2Gray_8u_C4C1R( src, 0, data, 0, Size(width,1) );
+    }
+}
+
+bool  JpegDecoder::startReadRows( int type )
+{
+    volatile bool result = false;
+
+    if( m_state && m_width && m_height && m_roi.empty() && !m_resize_rows )
+    {
+        JpegState* state = (JpegState*)m_state;
+        jpeg_decompress_struct* cinfo = &state->cinfo;
+
+        if( setjmp( state->jerr.setjmp_buffer ) == 0 )
+        {
+            state->direct = startDecompress( type );
+            state->rows = (*cinfo->mem->alloc_sarray)((j_common_ptr)cinfo,
+                                                      JPOOL_IMAGE, cinfo->output_width*4, 1 );
+            result = true;
+        }
+    }
+
+    return result;
+}
+
+bool  JpegDecoder::readRows( Mat& band )
+{
+    volatile bool result = false;
+    const bool color = band.channels() > 1;
+    JpegState* state = (JpegState*)m_state;
+
+    if( state && state->rows )
+    {
+        jpeg_decompress_struct* cinfo = &state->cinfo;
+        CV_CheckLE( (int)cinfo->output_scanline + band.rows, (int)cinfo->output_height, "" );
+
+        if( setjmp( state->jerr.setjmp_buffer ) == 0 )
+        {
+            for( int iy = 0; iy < band.rows; iy++ )
             {
-                if( cinfo->num_components != 4 )
+                uchar* data = band.ptr<uchar>(iy);
+                if( state->direct )
                 {
-                    cinfo->out_color_space = JCS_GRAYSCALE;
-                    cinfo->out_color_components = 1;
-                    doDirectRead = true; // GRAY -> GRAY
+                    if (jpeg_read_scanlines( cinfo, &data, 1 ) != 1) return false;
                 }
                 else
                 {
-                    cinfo->out_color_space = JCS_CMYK;
-                    cinfo->out_color_components = 4;
-                    doDirectRead = false; // CMYK -> GRAY
+                    if (jpeg_read_scanlines( cinfo, state->rows, 1 ) != 1) return false;
+                    convertScanline( cinfo, state->rows[0], data, band.cols, color, m_use_rgb );
                 }
             }
 
-            // Check for Exif marker APP1
-            jpeg_saved_marker_ptr exif_marker = NULL;
-            jpeg_saved_marker_ptr cmarker = cinfo->marker_list;
-            while( cmarker && exif_marker == NULL )
+            if( cinfo->output_scanline == cinfo->output_height )
             {
-                if (cmarker->marker == APP1)
-                    exif_marker = cmarker;
-
-                cmarker = cmarker->next;
+                state->rows = 0; // freed with the image pool
+                jpeg_finish_decompress( cinfo );
             }
+            result = true;
+        }
+    }
 
-            // Parse Exif data
-            if( exif_marker )
-            {
-                const std::streamsize offsetToTiffHeader = 6; //bytes from Exif size field to the first TIFF header
+    return result;
+}
 
-                if (exif_marker->data_length > offsetToTiffHeader)
-                {
-                    m_exif.parseExif(exif_marker->data + offsetToTiffHeader, exif_marker->data_length - offsetToTiffHeader);
-                }
-            }
+bool  JpegDecoder::readData( Mat& img )
+{
+    volatile bool result = false;
+    const bool color = img.channels() > 1;
+
+    if( m_state && m_width && m_height )
+    {
+        jpeg_decompress_struct* cinfo = &((JpegState*)m_state)->cinfo;
+        JpegErrorMgr* jerr = &((JpegState*)m_state)->jerr;
+        // the objects with destructors are set up before setjmp(), their values must not change until longjmp()
+        Mat resizedRow;
+        Ptr<RowAreaResizer> resizer;
+        if( m_resize_rows )
+        {
+            // the output size is known since readHeader()
+            const Size decodedSize( (int)cinfo->output_width, (int)cinfo->output_height );
+            resizedRow.create(1, decodedSize.width, img.type());
+            resizer.reset( new RowAreaResizer( decodedSize, img ) );
+        }
 
+        if( setjmp( jerr->setjmp_buffer ) == 0 )
+        {
+            const bool doDirectRead = startDecompress( img.type() );
 
-            jpeg_start_decompress( cinfo );
+            const bool crop = !m_roi.empty();
+            int xofs = 0; // offset of the ROI in the decoded scanlines
+            if( crop )
+            {
+                JDIMENSION xoffset = 0;
+                int skip = 0;
+#ifdef CV_JPEG_CROP_SCANLINE
+                // decode only the iMCU columns and rows covering the ROI. The margin keeps the neighbours
+                // used by fancy upsampling, so the pixels are the same as in the full decode
+                const int margin = 16; // the largest iMCU size
+                const int x0 = std::max(m_roi.x - margin, 0);
+                JDIMENSION xwidth = (JDIMENSION)(std::min(m_roi.x + m_roi.width + margin, m_width) - x0);
+                xoffset = (JDIMENSION)x0;
+                jpeg_crop_scanline( cinfo, &xoffset, &xwidth );
+                skip = std::max(m_roi.y - 2*margin, 0);
+                if( jpeg_skip_scanlines( cinfo, (JDIMENSION)skip ) != (JDIMENSION)skip ) return false;
+#endif
+                JSAMPARRAY skipbuf = (*cinfo->mem->alloc_sarray)((j_common_ptr)cinfo,
+                                                                  JPOOL_IMAGE, cinfo->output_width*4, 1 );
+                for( ; skip < m_roi.y; skip++ )
+                    if (jpeg_read_scanlines( cinfo, skipbuf, 1 ) != 1) return false;
+                xofs = m_roi.x - (int)xoffset;
+            }
+            const int width = m_resize_rows ? (int)cinfo->output_width : img.cols;
+            const int height = m_resize_rows ? (int)cinfo->output_height : img.rows;
 
-            if( doDirectRead)
+            if( doDirectRead && !crop && !resizer )
             {
-                for( int iy = 0 ; iy < m_height; iy ++ )
+                for( int iy = 0 ; iy < height; iy ++ )
                 {
                     uchar* data = img.ptr<uchar>(iy);
                     if (jpeg_read_scanlines( cinfo, &data, 1 ) != 1) return false;
@@ -505,42 +716,29 @@ bool  JpegDecoder::readData( Mat& img )
             else
             {
                 JSAMPARRAY buffer = (*cinfo->mem->alloc_sarray)((j_common_ptr)cinfo,
-                                                                 JPOOL_IMAGE, m_width*4, 1 );
+                                                                 JPOOL_IMAGE, cinfo->output_width*4, 1 );
 
-                for( int iy = 0 ; iy < m_height; iy ++ )
+                for( int iy = 0 ; iy < height; iy ++ )
                 {
-                    uchar* data = img.ptr<uchar>(iy);
+                    uchar* data = resizer ? resizedRow.ptr() : img.ptr<uchar>(iy);
                     if (jpeg_read_scanlines( cinfo, buffer, 1 ) != 1) return false;
+                    const uchar* src = buffer[0] + xofs*cinfo->out_color_components;
 
-                    if( color )
-                    {
-                        if (m_use_rgb)
-                        {
-                            if( cinfo->out_color_components == 3 )
-                                icvCvt_BGR2RGB_8u_C3R( buffer[0], 0, data, 0, Size(m_width,1) );
-                            else
-                                icvCvt_CMYK2RGB_8u_C4C3R( buffer[0], 0, data, 0, Size(m_width,1) );
-                        }
-                        else
-                        {
-                            if( cinfo->out_color_components == 3 )
-                                icvCvt_RGB2BGR_8u_C3R( buffer[0], 0, data, 0, Size(m_width,1) );
-                            else
-                                icvCvt_CMYK2BGR_8u_C4C3R( buffer[0], 0, data, 0, Size(m_width,1) );
-                        }
-                    }
+                    if( doDirectRead )
+                        memcpy( data, src, width*img.elemSize() );
                     else
-                    {
-                        if( cinfo->out_color_components == 1 )
-                            memcpy( data, buffer[0], m_width );
-                        else
-                            icvCvt_CMYK2Gray_8u_C4C1R( buffer[0], 0, data, 0, Size(m_width,1) );
-                    }
+                        convertScanline( cinfo, src, data, width, color, m_use_rgb );
+
+                    if( resizer )
+                        resizer->addRow( data );
                 }
             }
 
             result = true;
-            jpeg_finish_decompress( cinfo );
+            if( cinfo->output_scanline < cinfo->output_height )
+                jpeg_abort_decompress( cinfo ); // the rows below the ROI are not needed
+            else
+                jpeg_finish_decompress( cinfo );
         }
     }
 
@@ -596,15 +794,28 @@ static void jpeg_buffer_dest(j_compress_ptr cinfo, JpegDestination* destination)
 }
 
 
+struct JpegEncoderState
+{
+    jpeg_compress_struct cinfo; // IJG JPEG codec structure
+    JpegErrorMgr jerr; // error processing manager state
+    JpegDestination dest; // memory buffer destination
+    std::vector<uchar> out_buf;
+    FILE* f;
+    bool direct; // the rows are passed to the codec as is
+    AutoBuffer<uchar> buffer; // converted row
+};
+
 JpegEncoder::JpegEncoder()
 {
     m_description = "JPEG files (*.jpeg;*.jpg;*.jpe)";
     m_buf_supported = true;
+    m_state = 0;
 }
 
 
 JpegEncoder::~JpegEncoder()
 {
+    close();
 }
 
 ImageEncoder JpegEncoder::newEncoder() const
@@ -612,84 +823,106 @@ ImageEncoder JpegEncoder::newEncoder() const
     return makePtr<JpegEncoder>();
 }
 
-bool JpegEncoder::write( const Mat& img, const std::vector<int>& params )
+void JpegEncoder::close()
 {
-    m_last_error.clear();
-
-    struct fileWrapper
+    if( m_state )
     {
-        FILE* f;
+        JpegEncoderState* state = (JpegEncoderState*)m_state;
+        jpeg_destroy_compress( &state->cinfo );
+        if( state->f )
+            fclose( state->f );
+        delete state;
+        m_state = 0;
+    }
+}
 
-        fileWrapper() : f(0) {}
-        ~fileWrapper() { if(f) fclose(f); }
-    };
-    volatile bool result = false;
-    fileWrapper fw;
-    int width = img.cols, height = img.rows;
+void JpegEncoder::setLastError()
+{
+    JpegEncoderState* state = (JpegEncoderState*)m_state;
+    char jmsg_buf[JMSG_LENGTH_MAX];
+    state->jerr.pub.format_message((j_common_ptr)&state->cinfo, jmsg_buf);
+    m_last_error = jmsg_buf;
+    close();
+}
 
-    std::vector<uchar> out_buf(1 << 12);
+bool JpegEncoder::write( const Mat& img, const std::vector<int>& params )
+{
+    return startWriteRows( img.size(), img.type(), params ) && writeRows( img ) && finishWriteRows();
+}
+
+bool JpegEncoder::startWriteRows( Size size, int type, const std::vector<int>& params )
+{
+    m_last_error.clear();
+    close();
 
-    struct jpeg_compress_struct cinfo;
-    JpegErrorMgr jerr;
-    JpegDestination dest;
+    volatile bool result = false;
+    JpegEncoderState* state = new JpegEncoderState;
+    m_state = state;
+    state->f = 0;
+    state->direct = false;
+    jpeg_compress_struct* cinfo = &state->cinfo;
 
-    cinfo.err = jpeg_std_error(&jerr.pub);
-    jerr.pub.error_exit = error_exit;
-    jpeg_create_compress(&cinfo);
+    cinfo->err = jpeg_std_error(&state->jerr.pub);
+    state->jerr.pub.error_exit = error_exit;
+    jpeg_create_compress(cinfo);
 
     if( !m_buf )
     {
-        fw.f = fopen( m_filename.c_str(), "wb" );
-        if( !fw.f )
-            goto _exit_;
-        jpeg_stdio_dest( &cinfo, fw.f );
+        state->f = fopen( m_filename.c_str(), "wb" );
+        if( !state->f )
+        {
+            setLastError();
+            return false;
+        }
+        jpeg_stdio_dest( cinfo, state->f );
     }
     else
     {
-        dest.dst = m_buf;
-        dest.buf = &out_buf;
+        state->out_buf.resize(1 << 12);
+        state->dest.dst = m_buf;
+        state->dest.buf = &state->out_buf;
 
-        jpeg_buffer_dest( &cinfo, &dest );
+        jpeg_buffer_dest( cinfo, &state->dest );
 
-        dest.pub.next_output_byte = &out_buf[0];
-        dest.pub.free_in_buffer = out_buf.size();
+        state->dest.pub.next_output_byte = &state->out_buf[0];
+        state->dest.pub.free_in_buffer = state->out_buf.size();
     }
 
-    if( setjmp( jerr.setjmp_buffer ) == 0 )
+    if( setjmp( state->jerr.setjmp_buffer ) == 0 )
     {
-        cinfo.image_width = width;
-        cinfo.image_height = height;
+        cinfo->image_width = size.width;
+        cinfo->image_height = size.height;
 
-        int _channels = img.channels();
+        int _channels = CV_MAT_CN(type);
         int channels = _channels > 1 ? 3 : 1;
 
         bool doDirectWrite = false;
         switch( _channels )
         {
             case 1:
-                cinfo.input_components = 1;
-                cinfo.in_color_space = JCS_GRAYSCALE;
+                cinfo->input_components = 1;
+                cinfo->in_color_space = JCS_GRAYSCALE;
                 doDirectWrite = true; // GRAY -> GRAY
                 break;
             case 3:
 #ifdef JCS_EXTENSIONS
-                cinfo.input_components = 3;
-                cinfo.in_color_space = JCS_EXT_BGR;
+                cinfo->input_components = 3;
+                cinfo->in_color_space = JCS_EXT_BGR;
                 doDirectWrite = true; // BGR -> BGR
 #else
-                cinfo.input_components = 3;
-                cinfo.in_color_space = JCS_RGB;
+                cinfo->input_components = 3;
+                cinfo->in_color_space = JCS_RGB;
                 doDirectWrite = false; // BGR -> RGB
 #endif
                 break;
             case 4:
 #ifdef JCS_EXTENSIONS
-                cinfo.input_components = 4;
-                cinfo.in_color_space = JCS_EXT_BGRX;
+                cinfo->input_components = 4;
+                cinfo->in_color_space = JCS_EXT_BGRX;
                 doDirectWrite = true; // BGRX -> BGRX
 #else
-                cinfo.input_components = 3;
-                cinfo.in_color_space = JCS_RGB;
+                cinfo->input_components = 3;
+                cinfo->in_color_space = JCS_RGB;
                 doDirectWrite = false; // BGRA -> RGB
 #endif
                 break;
@@ -775,61 +1008,81 @@ bool JpegEncoder::write( const Mat& img, const std::vector<int>& params )
             }
         }
 
-        jpeg_set_defaults( &cinfo );
-        cinfo.restart_interval = rst_interval;
+        jpeg_set_defaults( cinfo );
+        cinfo->restart_interval = rst_interval;
 
-        jpeg_set_quality( &cinfo, quality,
+        jpeg_set_quality( cinfo, quality,
                           TRUE /* limit to baseline-JPEG values */ );
         if( progressive )
-            jpeg_simple_progression( &cinfo );
+            jpeg_simple_progression( cinfo );
         if( optimize )
-            cinfo.optimize_coding = TRUE;
+            cinfo->optimize_coding = TRUE;
 
         if( (channels > 1) && ( sampling_factor != 0 ) )
         {
-            cinfo.comp_info[0].v_samp_factor = (sampling_factor >> 16 ) & 0xF;
-            cinfo.comp_info[0].h_samp_factor = (sampling_factor >> 20 ) & 0xF;
-            cinfo.comp_info[1].v_samp_factor = 1;
-            cinfo.comp_info[1].h_samp_factor = 1;
+            cinfo->comp_info[0].v_samp_factor = (sampling_factor >> 16 ) & 0xF;
+            cinfo->comp_info[0].h_samp_factor = (sampling_factor >> 20 ) & 0xF;
+            cinfo->comp_info[1].v_samp_factor = 1;
+            cinfo->comp_info[1].h_samp_factor = 1;
         }
 
         if (luma_quality >= 0 && chroma_quality >= 0)
         {
 #if JPEG_LIB_VERSION >= 70
-            cinfo.q_scale_factor[0] = jpeg_quality_scaling(luma_quality);
-            cinfo.q_scale_factor[1] = jpeg_quality_scaling(chroma_quality);
+            cinfo->q_scale_factor[0] = jpeg_quality_scaling(luma_quality);
+            cinfo->q_scale_factor[1] = jpeg_quality_scaling(chroma_quality);
             if ( luma_quality != chroma_quality )
             {
                 /* disable subsampling - ref. Libjpeg.txt */
-                cinfo.comp_info[0].v_samp_factor = 1;
-                cinfo.comp_info[0].h_samp_factor = 1;
-                cinfo.comp_info[1].v_samp_factor = 1;
-                cinfo.comp_info[1].h_samp_factor = 1;
+                cinfo->comp_info[0].v_samp_factor = 1;
+                cinfo->comp_info[0].h_samp_factor = 1;
+                cinfo->comp_info[1].v_samp_factor = 1;
+                cinfo->comp_info[1].h_samp_factor = 1;
             }
-            jpeg_default_qtables( &cinfo, TRUE );
+            jpeg_default_qtables( cinfo, TRUE );
 #else
             // See https://github.com/opencv/opencv/issues/25646
             CV_LOG_ONCE_WARNING(NULL, cv::format("IMWRITE_JPEG_LUMA/CHROMA_QUALITY are not supported bacause JPEG_LIB_VERSION < 70."));
 #endif // #if JPEG_LIB_VERSION >= 70
         }
 
-        jpeg_start_compress( &cinfo, TRUE );
+        jpeg_start_compress( cinfo, TRUE );
+
+        state->direct = doDirectWrite;
+        if( !doDirectWrite )
+            state->buffer.allocate(size.width*channels);
+        result = true;
+    }
+
+    if( !result )
+        setLastError();
+    return result;
+}
+
+bool JpegEncoder::writeRows( const Mat& img )
+{
+    volatile bool result = false;
+    JpegEncoderState* state = (JpegEncoderState*)m_state;
+    CV_Assert( state );
+    jpeg_compress_struct* cinfo = &state->cinfo;
+    int width = img.cols, height = img.rows;
 
-        if( doDirectWrite )
+    if( setjmp( state->jerr.setjmp_buffer ) == 0 )
+    {
+        if( state->direct )
         {
             for( int y = 0; y < height; y++ )
             {
                 uchar *data = const_cast<uchar*>(img.ptr<uchar>(y));
-                jpeg_write_scanlines( &cinfo, &data, 1 );
+                jpeg_write_scanlines( cinfo, &data, 1 );
             }
         }
         else
         {
+            const int _channels = img.channels();
             CV_Check(_channels, (_channels == 3) || (_channels == 4), "Unsupported number of channels(indirect write)");
 
-            AutoBuffer<uchar> _buffer;
-            _buffer.allocate(width*channels);
-            uchar *buffer = _buffer.data();
+            uchar *buffer = state->buffer.data();
 
             for( int y = 0; y < height; y++ )
             {
@@ -842,25 +1095,33 @@ bool JpegEncoder::write( const Mat& img, const std::vector<int>& params )
                 {
                     icvCvt_BGRA2BGR_8u_C4C3R( data, 0, buffer, 0, Size(width,1), 2 );
                 }
-                jpeg_write_scanlines( &cinfo, &buffer, 1 );
+                jpeg_write_scanlines( cinfo, &buffer, 1 );
             }
         }
-
-        jpeg_finish_compress( &cinfo );
         result = true;
     }
 
-_exit_:
+    if( !result )
+        setLastError();
+    return result;
+}
+
+bool JpegEncoder::finishWriteRows()
+{
+    volatile bool result = false;
+    JpegEncoderState* state = (JpegEncoderState*)m_state;
+    CV_Assert( state );
 
-    if(!result)
+    if( setjmp( state->jerr.setjmp_buffer ) == 0 )
     {
-        char jmsg_buf[JMSG_LENGTH_MAX];
-        jerr.pub.format_message((j_common_ptr)&cinfo, jmsg_buf);
-        m_last_error = jmsg_buf;
+        jpeg_finish_compress( &state->cinfo );
+        result = true;
     }
 
-    jpeg_destroy_compress( &cinfo );
-
+    if( !result )
+        setLastError();
+    else
+        close();
     return result;
 }
 
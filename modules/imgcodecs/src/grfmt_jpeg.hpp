@@ -80,15 +80,24 @@ public:
     virtual ~JpegDecoder();
 
     bool  readData( Mat& img ) CV_OVERRIDE;
+    bool  setROI( const Rect& roi ) CV_OVERRIDE;
+    bool  setTargetSize( const Size& size, bool exact ) CV_OVERRIDE;
     bool  readHeader() CV_OVERRIDE;
+    bool  startReadRows( int type ) CV_OVERRIDE;
+    bool  readRows( Mat& band ) CV_OVERRIDE;
     void  close();
 
     ImageDecoder newDecoder() const CV_OVERRIDE;
+    bool  reset() CV_OVERRIDE;
 
 protected:
+    bool  startDecompress( int type );
 
     FILE* m_f;
     void* m_state;
+    Size  m_target_size;  // see setTargetSize()
+    bool  m_target_exact;
+    bool  m_resize_rows;   // decoded rows are resized to m_target_size in readData()
 
 private:
     JpegDecoder(const JpegDecoder &); // copy disabled
@@ -103,7 +112,20 @@ public:
     virtual ~JpegEncoder();
 
     bool  write( const Mat& img, const std::vector<int>& params ) CV_OVERRIDE;
+    bool  startWriteRows( Size size, int type, const std::vector<int>& params ) CV_OVERRIDE;
+    bool  writeRows( const Mat& band ) CV_OVERRIDE;
+    bool  finishWriteRows() CV_OVERRIDE;
+    void  close();
     ImageEncoder newEncoder() const CV_OVERRIDE;
+
+protected:
+    void  setLastError();  // stores the codec error message and closes the encoder
+
+    void* m_state;
+
+private:
+    JpegEncoder(const JpegEncoder &); // copy disabled
+    JpegEncoder& operator=(const JpegEncoder &); // assign disabled
 };
 
 }
@@ -110,6 +110,7 @@ static JasperInitializer& initJasper()
 
 Jpeg2KDecoder::Jpeg2KDecoder()
 {
+    m_codec_name = "jpeg2000";
     static const unsigned char signature_[12] = { 0, 0, 0, 0x0c, 'j', 'P', ' ', ' ', 13, 10, 0x87, 10};
     m_signature = String((const char*)signature_, (const char*)signature_ + sizeof(signature_));
     m_stream = 0;
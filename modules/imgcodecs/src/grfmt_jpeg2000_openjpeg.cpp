@@ -659,6 +659,7 @@ bool Jpeg2KOpjDecoderBase::readData( Mat& img )
 Jpeg2KJP2OpjDecoder::Jpeg2KJP2OpjDecoder()
     : Jpeg2KOpjDecoderBase(OPJ_CODEC_JP2)
 {
+    m_codec_name = "jpeg2000";
     static const unsigned char JP2Signature[] = { 0, 0, 0, 0x0c, 'j', 'P', ' ', ' ', 13, 10, 0x87, 10 };
     m_signature = String((const char*) JP2Signature, sizeof(JP2Signature));
 }
@@ -671,6 +672,7 @@ ImageDecoder Jpeg2KJP2OpjDecoder::newDecoder() const
 Jpeg2KJ2KOpjDecoder::Jpeg2KJ2KOpjDecoder()
     : Jpeg2KOpjDecoderBase(OPJ_CODEC_J2K)
 {
+    m_codec_name = "jpeg2000";
     static const unsigned char J2KSignature[] = { 0xff, 0x4f, 0xff, 0x51 };
     m_signature = String((const char*) J2KSignature, sizeof(J2KSignature));
 }
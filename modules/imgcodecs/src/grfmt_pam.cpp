@@ -358,6 +358,7 @@ static int ParseInt(const char *str, int len)
 
 PAMDecoder::PAMDecoder()
 {
+    m_codec_name = "pam";
     m_offset = -1;
     m_buf_supported = true;
     bit_mode = false;
@@ -81,6 +81,7 @@ PFMDecoder::~PFMDecoder()
 
 PFMDecoder::PFMDecoder() : m_scale_factor(0), m_swap_byte_order(false)
 {
+  m_codec_name = "pfm";
   m_buf_supported = true;
 }
 
@@ -80,6 +80,7 @@ namespace cv
 
 PngDecoder::PngDecoder()
 {
+    m_codec_name = "png";
     m_signature = "\x89\x50\x4e\x47\xd\xa\x1a\xa";
     m_color_type = 0;
     m_png_ptr = 0;
@@ -94,6 +95,8 @@ PngDecoder::PngDecoder()
 PngDecoder::~PngDecoder()
 {
     close();
+    for( size_t i = 0; i < m_free_blocks.size(); i++ )
+        free( m_free_blocks[i] );
 }
 
 ImageDecoder PngDecoder::newDecoder() const
@@ -101,6 +104,52 @@ ImageDecoder PngDecoder::newDecoder() const
     return makePtr<PngDecoder>();
 }
 
+bool  PngDecoder::reset()
+{
+    // libpng can't restart a read struct, but its memory is kept for the next one, see allocPng()
+    close();
+    m_buf_pos = 0;
+    BaseImageDecoder::reset();
+    return true;
+}
+
+// libpng and zlib allocate the blocks of the same sizes for each image, so the blocks released
+// by png_destroy_read_struct() are kept by the decoder and given to the next read struct
+enum { PNG_BLOCK_HEADER = 16, PNG_MAX_FREE_BLOCKS = 32 };
+
+void* PngDecoder::allocPng( void* png_ptr, size_t size )
+{
+    PngDecoder* decoder = (PngDecoder*)png_get_mem_ptr( (png_structp)png_ptr );
+    std::vector<void*>& blocks = decoder->m_free_blocks;
+    for( size_t i = 0; i < blocks.size(); i++ )
+    {
+        if( *(size_t*)blocks[i] == size )
+        {
+            uchar* block = (uchar*)blocks[i];
+            blocks[i] = blocks.back();
+            blocks.pop_back();
+            return block + PNG_BLOCK_HEADER;
+        }
+    }
+    uchar* block = (uchar*)malloc( size + PNG_BLOCK_HEADER );
+    if( !block )
+        return 0;
+    *(size_t*)block = size;
+    return block + PNG_BLOCK_HEADER;
+}
+
+void  PngDecoder::freePng( void* png_ptr, void* ptr )
+{
+    if( !ptr )
+        return;
+    PngDecoder* decoder = (PngDecoder*)png_get_mem_ptr( (png_structp)png_ptr );
+    uchar* block = (uchar*)ptr - PNG_BLOCK_HEADER;
+    if( decoder->m_free_blocks.size() < (size_t)PNG_MAX_FREE_BLOCKS )
+        decoder->m_free_blocks.push_back( block );
+    else
+        free( block );
+}
+
 void  PngDecoder::close()
 {
     if( m_f )
@@ -140,7 +189,12 @@ bool  PngDecoder::readHeader()
     volatile bool result = false;
     close();
 
+#ifdef PNG_USER_MEM_SUPPORTED
+    png_structp png_ptr = png_create_read_struct_2( PNG_LIBPNG_VER_STRING, 0, 0, 0,
+                                                    this, (png_malloc_ptr)allocPng, (png_free_ptr)freePng );
+#else
     png_structp png_ptr = png_create_read_struct( PNG_LIBPNG_VER_STRING, 0, 0, 0 );
+#endif
 
     if( png_ptr )
     {
@@ -182,6 +236,16 @@ bool  PngDecoder::readHeader()
                     m_color_type = color_type;
                     m_bit_depth = bit_depth;
 
+#ifdef PNG_eXIf_SUPPORTED
+                    // Exif info which precedes the image data, readData() checks end_info as well
+                    png_uint_32 num_exif = 0;
+                    png_bytep exif = 0;
+                    if( png_get_valid(png_ptr, info_ptr, PNG_INFO_eXIf) )
+                        png_get_eXIf_1(png_ptr, info_ptr, &num_exif, &exif);
+                    if( exif && num_exif > 0 )
+                        m_exif.parseExif(exif, num_exif);
+#endif
+
                     if( bit_depth <= 8 || bit_depth == 16 )
                     {
                         switch(color_type)
@@ -214,16 +278,116 @@ bool  PngDecoder::readHeader()
 }
 
 
+bool  PngDecoder::setROI( const Rect& roi )
+{
+    // rows of interlaced images are complete only after the last pass
+    if( !m_png_ptr || !m_info_ptr ||
+        png_get_interlace_type( (png_structp)m_png_ptr, (png_infop)m_info_ptr ) != PNG_INTERLACE_NONE )
+        return false;
+    m_roi = roi;
+    return true;
+}
+
+
+// called from readData() and startReadRows() under their setjmp(), png errors return there
+void  PngDecoder::setTransforms( int type )
+{
+    png_structp png_ptr = (png_structp)m_png_ptr;
+    png_infop info_ptr = (png_infop)m_info_ptr;
+    bool color = CV_MAT_CN(type) > 1;
+
+    if( CV_MAT_DEPTH(type) == CV_8U && m_bit_depth == 16 )
+        png_set_strip_16( png_ptr );
+    else if( !isBigEndian() )
+        png_set_swap( png_ptr );
+
+    if(CV_MAT_CN(type) < 4)
+    {
+        /* observation: png_read_image() writes 400 bytes beyond
+         * end of data when reading a 400x118 color png
+         * "mpplus_sand.png".  OpenCV crashes even with demo
+         * programs.  Looking at the loaded image I'd say we get 4
+         * bytes per pixel instead of 3 bytes per pixel.  Test
+         * indicate that it is a good idea to always ask for
+         * stripping alpha..  18.11.2004 Axel Walthelm
+         */
+         png_set_strip_alpha( png_ptr );
+    } else
+        png_set_tRNS_to_alpha( png_ptr );
+
+    if( m_color_type == PNG_COLOR_TYPE_PALETTE )
+        png_set_palette_to_rgb( png_ptr );
+
+    if( (m_color_type & PNG_COLOR_MASK_COLOR) == 0 && m_bit_depth < 8 )
+#if (PNG_LIBPNG_VER_MAJOR*10000 + PNG_LIBPNG_VER_MINOR*100 + PNG_LIBPNG_VER_RELEASE >= 10209) || \
+    (PNG_LIBPNG_VER_MAJOR == 1 && PNG_LIBPNG_VER_MINOR == 0 && PNG_LIBPNG_VER_RELEASE >= 18)
+        png_set_expand_gray_1_2_4_to_8( png_ptr );
+#else
+        png_set_gray_1_2_4_to_8( png_ptr );
+#endif
+
+    if( (m_color_type & PNG_COLOR_MASK_COLOR) && color && !m_use_rgb)
+        png_set_bgr( png_ptr ); // convert RGB to BGR
+    else if( color )
+        png_set_gray_to_rgb( png_ptr ); // Gray->RGB
+    else
+        png_set_rgb_to_gray( png_ptr, 1, 0.299, 0.587 ); // RGB->Gray
+
+    png_set_interlace_handling( png_ptr );
+    png_read_update_info( png_ptr, info_ptr );
+}
+
+
+bool  PngDecoder::startReadRows( int type )
+{
+    volatile bool result = false;
+    png_structp png_ptr = (png_structp)m_png_ptr;
+
+    // rows of interlaced images are complete only after the last pass
+    if( m_png_ptr && m_info_ptr && m_end_info && m_width && m_height &&
+        png_get_interlace_type( png_ptr, (png_infop)m_info_ptr ) == PNG_INTERLACE_NONE )
+    {
+        if( setjmp( png_jmpbuf ( png_ptr ) ) == 0 )
+        {
+            setTransforms( type );
+            result = true;
+        }
+    }
+
+    return result;
+}
+
+
+bool  PngDecoder::readRows( Mat& band )
+{
+    volatile bool result = false;
+    png_structp png_ptr = (png_structp)m_png_ptr;
+
+    if( m_png_ptr )
+    {
+        if( setjmp( png_jmpbuf ( png_ptr ) ) == 0 )
+        {
+            for( int y = 0; y < band.rows; y++ )
+                png_read_row( png_ptr, band.ptr(y), NULL );
+            result = true;
+        }
+    }
+
+    return result;
+}
+
+
 bool  PngDecoder::readData( Mat& img )
 {
     volatile bool result = false;
     AutoBuffer<uchar*> _buffer(m_height);
     uchar** buffer = _buffer.data();
-    bool color = img.channels() > 1;
+    // the buffers must be allocated before setjmp(), longjmp() skips the destructors of the later ones
+    AutoBuffer<uchar> _row(m_roi.empty() ? 1 : (size_t)m_width*img.elemSize());
 
-    png_structp png_ptr = (png_structp)m_png_ptr;
-    png_infop info_ptr = (png_infop)m_info_ptr;
-    png_infop end_info = (png_infop)m_end_info;
+    png_structp volatile png_ptr = (png_structp)m_png_ptr;
+    png_infop volatile info_ptr = (png_infop)m_info_ptr;
+    png_infop volatile end_info = (png_infop)m_end_info;
 
     if( m_png_ptr && m_info_ptr && m_end_info && m_width && m_height )
     {
@@ -231,51 +395,29 @@ bool  PngDecoder::readData( Mat& img )
         {
             int y;
 
-            if( img.depth() == CV_8U && m_bit_depth == 16 )
-                png_set_strip_16( png_ptr );
-            else if( !isBigEndian() )
-                png_set_swap( png_ptr );
+            setTransforms( img.type() );
 
-            if(img.channels() < 4)
+            if( !m_roi.empty() )
             {
-                /* observation: png_read_image() writes 400 bytes beyond
-                 * end of data when reading a 400x118 color png
-                 * "mpplus_sand.png".  OpenCV crashes even with demo
-                 * programs.  Looking at the loaded image I'd say we get 4
-                 * bytes per pixel instead of 3 bytes per pixel.  Test
-                 * indicate that it is a good idea to always ask for
-                 * stripping alpha..  18.11.2004 Axel Walthelm
-                 */
-                 png_set_strip_alpha( png_ptr );
-            } else
-                png_set_tRNS_to_alpha( png_ptr );
-
-            if( m_color_type == PNG_COLOR_TYPE_PALETTE )
-                png_set_palette_to_rgb( png_ptr );
-
-            if( (m_color_type & PNG_COLOR_MASK_COLOR) == 0 && m_bit_depth < 8 )
-#if (PNG_LIBPNG_VER_MAJOR*10000 + PNG_LIBPNG_VER_MINOR*100 + PNG_LIBPNG_VER_RELEASE >= 10209) || \
-    (PNG_LIBPNG_VER_MAJOR == 1 && PNG_LIBPNG_VER_MINOR == 0 && PNG_LIBPNG_VER_RELEASE >= 18)
-                png_set_expand_gray_1_2_4_to_8( png_ptr );
-#else
-                png_set_gray_1_2_4_to_8( png_ptr );
-#endif
-
-            if( (m_color_type & PNG_COLOR_MASK_COLOR) && color && !m_use_rgb)
-                png_set_bgr( png_ptr ); // convert RGB to BGR
-            else if( color )
-                png_set_gray_to_rgb( png_ptr ); // Gray->RGB
+                // decode the rows sequentially and stop after the last row of the ROI
+                CV_Assert( png_get_rowbytes( png_ptr, info_ptr ) <= _row.size() );
+                uchar* row = _row.data();
+                const size_t esz = img.elemSize();
+                for( y = 0; y < m_roi.y + m_roi.height; y++ )
+                {
+                    png_read_row( png_ptr, row, NULL );
+                    if( y >= m_roi.y )
+                        memcpy( img.ptr(y - m_roi.y), row + m_roi.x*esz, img.cols*esz );
+                }
+            }
             else
-                png_set_rgb_to_gray( png_ptr, 1, 0.299, 0.587 ); // RGB->Gray
-
-            png_set_interlace_handling( png_ptr );
-            png_read_update_info( png_ptr, info_ptr );
-
-            for( y = 0; y < m_height; y++ )
-                buffer[y] = img.data + y*img.step;
+            {
+                for( y = 0; y < m_height; y++ )
+                    buffer[y] = img.data + y*img.step;
 
-            png_read_image( png_ptr, buffer );
-            png_read_end( png_ptr, end_info );
+                png_read_image( png_ptr, buffer );
+                png_read_end( png_ptr, end_info );
+            }
 
 #ifdef PNG_eXIf_SUPPORTED
             png_uint_32 num_exif = 0;
@@ -308,11 +450,32 @@ PngEncoder::PngEncoder()
 {
     m_description = "Portable Network Graphics files (*.png)";
     m_buf_supported = true;
+    m_png_ptr = m_info_ptr = 0;
+    m_f = 0;
 }
 
 
 PngEncoder::~PngEncoder()
 {
+    close();
+}
+
+
+void  PngEncoder::close()
+{
+    if( m_png_ptr )
+    {
+        png_structp png_ptr = (png_structp)m_png_ptr;
+        png_infop info_ptr = (png_infop)m_info_ptr;
+        png_destroy_write_struct( &png_ptr, &info_ptr );
+        m_png_ptr = m_info_ptr = 0;
+    }
+
+    if( m_f )
+    {
+        fclose( m_f );
+        m_f = 0;
+    }
 }
 
 
@@ -344,22 +507,65 @@ void PngEncoder::flushBuf(void*)
 {
 }
 
+static void readPngParams( const std::vector<int>& params, int& compression_level,
+                           int& compression_strategy, bool& isBilevel, bool& isParallel )
+{
+    for( size_t i = 0; i + 1 < params.size(); i += 2 )
+    {
+        if( params[i] == IMWRITE_PNG_COMPRESSION )
+        {
+            compression_strategy = IMWRITE_PNG_STRATEGY_DEFAULT; // Default strategy
+            compression_level = params[i+1];
+            compression_level = MIN(MAX(compression_level, 0), Z_BEST_COMPRESSION);
+        }
+        if( params[i] == IMWRITE_PNG_STRATEGY )
+        {
+            compression_strategy = params[i+1];
+            compression_strategy = MIN(MAX(compression_strategy, 0), Z_FIXED);
+        }
+        if( params[i] == IMWRITE_PNG_BILEVEL )
+        {
+            isBilevel = params[i+1] != 0;
+        }
+        if( params[i] == IMWRITE_PNG_PARALLEL )
+        {
+            isParallel = params[i+1] != 0;
+        }
+    }
+}
+
 bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
 {
-    png_structp png_ptr = png_create_write_struct( PNG_LIBPNG_VER_STRING, 0, 0, 0 );
-    png_infop info_ptr = 0;
-    FILE * volatile f = 0;
-    int y, width = img.cols, height = img.rows;
-    int depth = img.depth(), channels = img.channels();
+    int compression_level = -1;
+    int compression_strategy = IMWRITE_PNG_STRATEGY_RLE;
+    bool isBilevel = false, isParallel = false;
+    readPngParams( params, compression_level, compression_strategy, isBilevel, isParallel );
+    if( isParallel && !isBilevel )
+        return writeParallel( img, compression_level, compression_strategy );
+
+    bool result = startWriteRows( img.size(), img.type(), params ) && writeRows( img ) && finishWriteRows();
+    close();
+    return result;
+}
+
+bool  PngEncoder::startWriteRows( Size size, int type, const std::vector<int>& params )
+{
+    int width = size.width, height = size.height;
+    int depth = CV_MAT_DEPTH(type), channels = CV_MAT_CN(type);
     volatile bool result = false;
-    AutoBuffer<uchar*> buffer;
 
+    close();
     if( depth != CV_8U && depth != CV_16U )
         return false;
 
+    png_structp png_ptr = png_create_write_struct( PNG_LIBPNG_VER_STRING, 0, 0, 0 );
+    png_infop info_ptr = 0;
+    m_png_ptr = png_ptr;
+
     if( png_ptr )
     {
         info_ptr = png_create_info_struct( png_ptr );
+        m_info_ptr = info_ptr;
 
         if( info_ptr )
         {
@@ -372,35 +578,17 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
                 }
                 else
                 {
-                    f = fopen( m_filename.c_str(), "wb" );
-                    if( f )
-                        png_init_io( png_ptr, (png_FILE_p)f );
+                    m_f = fopen( m_filename.c_str(), "wb" );
+                    if( m_f )
+                        png_init_io( png_ptr, (png_FILE_p)m_f );
                 }
 
                 int compression_level = -1; // Invalid value to allow setting 0-9 as valid
                 int compression_strategy = IMWRITE_PNG_STRATEGY_RLE; // Default strategy
-                bool isBilevel = false;
+                bool isBilevel = false, isParallel = false;
+                readPngParams( params, compression_level, compression_strategy, isBilevel, isParallel );
 
-                for( size_t i = 0; i < params.size(); i += 2 )
-                {
-                    if( params[i] == IMWRITE_PNG_COMPRESSION )
-                    {
-                        compression_strategy = IMWRITE_PNG_STRATEGY_DEFAULT; // Default strategy
-                        compression_level = params[i+1];
-                        compression_level = MIN(MAX(compression_level, 0), Z_BEST_COMPRESSION);
-                    }
-                    if( params[i] == IMWRITE_PNG_STRATEGY )
-                    {
-                        compression_strategy = params[i+1];
-                        compression_strategy = MIN(MAX(compression_strategy, 0), Z_FIXED);
-                    }
-                    if( params[i] == IMWRITE_PNG_BILEVEL )
-                    {
-                        isBilevel = params[i+1] != 0;
-                    }
-                }
-
-                if( m_buf || f )
+                if( m_buf || m_f )
                 {
                     if( compression_level >= 0 )
                     {
@@ -430,22 +618,334 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
                     if( !isBigEndian() )
                         png_set_swap( png_ptr );
 
-                    buffer.allocate(height);
-                    for( y = 0; y < height; y++ )
-                        buffer[y] = img.data + y*img.step;
-
-                    png_write_image( png_ptr, buffer.data() );
-                    png_write_end( png_ptr, info_ptr );
-
                     result = true;
                 }
             }
         }
     }
 
-    png_destroy_write_struct( &png_ptr, &info_ptr );
-    if(f) fclose( (FILE*)f );
+    if( !result )
+        close();
+    return result;
+}
 
+bool  PngEncoder::writeRows( const Mat& band )
+{
+    volatile bool result = false;
+    png_structp png_ptr = (png_structp)m_png_ptr;
+
+    if( png_ptr )
+    {
+        if( setjmp( png_jmpbuf ( png_ptr ) ) == 0 )
+        {
+            for( int y = 0; y < band.rows; y++ )
+                png_write_row( png_ptr, (png_bytep)band.ptr(y) );
+            result = true;
+        }
+    }
+
+    if( !result )
+        close();
+    return result;
+}
+
+bool  PngEncoder::finishWriteRows()
+{
+    volatile bool result = false;
+    png_structp png_ptr = (png_structp)m_png_ptr;
+
+    if( png_ptr )
+    {
+        if( setjmp( png_jmpbuf ( png_ptr ) ) == 0 )
+        {
+            png_write_end( png_ptr, (png_infop)m_info_ptr );
+            result = true;
+        }
+    }
+
+    close();
+    return result;
+}
+
+//////////////////// multithreaded PNG encoding ////////////////////
+
+// rows of this size are deflated as one chunk; each chunk is primed
+// with the preceding 32K of the filtered data, so the compression ratio
+// stays close to the one of a single stream
+static const size_t PNG_PARALLEL_CHUNK_SIZE = 256 << 10;
+static const size_t PNG_DEFLATE_WINDOW = 32768;
+
+static void putUInt32BE( uchar* dst, unsigned val )
+{
+    dst[0] = (uchar)(val >> 24);
+    dst[1] = (uchar)(val >> 16);
+    dst[2] = (uchar)(val >> 8);
+    dst[3] = (uchar)val;
+}
+
+static void appendPngChunk( std::vector<uchar>& out, const char* name, const uchar* data, size_t size )
+{
+    CV_Assert( size < ((size_t)1 << 31) );
+    uchar header[8], crc_buf[4];
+    putUInt32BE( header, (unsigned)size );
+    memcpy( header + 4, name, 4 );
+
+    uLong crc = crc32( 0L, header + 4, 4 );
+    if( size > 0 )
+        crc = crc32( crc, data, (uInt)size );
+    putUInt32BE( crc_buf, (unsigned)crc );
+
+    out.insert( out.end(), header, header + 8 );
+    out.insert( out.end(), data, data + size );
+    out.insert( out.end(), crc_buf, crc_buf + 4 );
+}
+
+// BGR(A) -> RGB(A), 16-bit samples are stored in the network byte order
+static void convertPngRow( const uchar* src, uchar* dst, int width, int cn, bool is16 )
+{
+    int b = cn >= 3 ? 2 : 0, r = cn >= 3 ? 0 : 2;
+    if( !is16 )
+    {
+        if( cn < 3 )
+        {
+            memcpy( dst, src, (size_t)width * cn );
+            return;
+        }
+        for( int x = 0; x < width; x++, src += cn, dst += cn )
+        {
+            dst[0] = src[b]; dst[1] = src[1]; dst[2] = src[r];
+            if( cn == 4 )
+                dst[3] = src[3];
+        }
+        return;
+    }
+
+    const ushort* src16 = (const ushort*)src;
+    for( int x = 0; x < width; x++, src16 += cn )
+    {
+        for( int c = 0; c < cn; c++, dst += 2 )
+        {
+            int sc = c == 0 ? b : c == 2 ? r : c;
+            ushort v = src16[sc];
+            dst[0] = (uchar)(v >> 8);
+            dst[1] = (uchar)v;
+        }
+    }
+}
+
+static inline int paethPredictor( int a, int b, int c )
+{
+    int p = b - c, q = a - c;
+    int pa = std::abs(p), pb = std::abs(q), pc = std::abs(p + q);
+    return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+}
+
+// writes the filter type byte and the filtered row; prev is NULL for the first row
+static void filterPngRow( int filter, const uchar* cur, const uchar* prev, uchar* dst, size_t len, int bpp )
+{
+    dst[0] = (uchar)filter;
+    dst++;
+    size_t i = 0, n = std::min( len, (size_t)bpp );
+    switch( filter )
+    {
+    case 1: // Sub
+        for( ; i < n; i++ )
+            dst[i] = cur[i];
+        for( ; i < len; i++ )
+            dst[i] = (uchar)(cur[i] - cur[i - bpp]);
+        break;
+    case 2: // Up
+        if( !prev )
+            memcpy( dst, cur, len );
+        else
+            for( ; i < len; i++ )
+                dst[i] = (uchar)(cur[i] - prev[i]);
+        break;
+    case 3: // Average
+        for( ; i < n; i++ )
+            dst[i] = (uchar)(cur[i] - ((prev ? prev[i] : 0) >> 1));
+        for( ; i < len; i++ )
+            dst[i] = (uchar)(cur[i] - ((cur[i - bpp] + (prev ? prev[i] : 0)) >> 1));
+        break;
+    case 4: // Paeth
+        if( !prev )
+        {
+            // degenerates to Sub
+            filterPngRow( 1, cur, NULL, dst - 1, len, bpp );
+            dst[-1] = (uchar)filter;
+            break;
+        }
+        for( ; i < n; i++ )
+            dst[i] = (uchar)(cur[i] - prev[i]);
+        for( ; i < len; i++ )
+            dst[i] = (uchar)(cur[i] - paethPredictor( cur[i - bpp], prev[i], prev[i - bpp] ));
+        break;
+    default: // None
+        memcpy( dst, cur, len );
+    }
+}
+
+// the filter with the minimal sum of absolute differences, as libpng does by default
+static void filterPngRowAdaptive( const uchar* cur, const uchar* prev, uchar* dst, uchar* tmp, size_t len, int bpp )
+{
+    size_t best_sum = 0;
+    for( int filter = 0; filter < 5; filter++ )
+    {
+        uchar* buf = filter == 0 ? dst : tmp;
+        filterPngRow( filter, cur, prev, buf, len, bpp );
+        size_t sum = 0;
+        for( size_t i = 1; i <= len; i++ )
+            sum += buf[i] < 128 ? buf[i] : 256 - buf[i];
+        if( filter == 0 || sum < best_sum )
+        {
+            best_sum = sum;
+            if( buf != dst )
+                memcpy( dst, buf, len + 1 );
+        }
+    }
+}
+
+bool  PngEncoder::writeParallel( const Mat& img, int compression_level, int compression_strategy )
+{
+    CV_Assert( !img.empty() );
+    int width = img.cols, height = img.rows;
+    int depth = img.depth(), channels = img.channels();
+    if( depth != CV_8U && depth != CV_16U )
+        return false;
+    CV_CheckType( img.type(), channels == 1 || channels == 3 || channels == 4, "" );
+
+    // same defaults as in startWriteRows()
+    bool adaptive = compression_level >= 0;
+    int level = adaptive ? compression_level : Z_BEST_SPEED;
+    const bool is16 = depth == CV_16U;
+    const int bpp = channels * (is16 ? 2 : 1);
+    const size_t row_size = (size_t)width * bpp, stride = row_size + 1;
+
+    std::vector<uchar> filtered( stride * height );
+    parallel_for_(Range(0, height), [&](const Range& range)
+    {
+        AutoBuffer<uchar> _rows( row_size * 2 + stride );
+        uchar* prev = _rows.data();
+        uchar* cur = prev + row_size;
+        uchar* tmp = cur + row_size;
+        if( range.start > 0 )
+            convertPngRow( img.ptr(range.start - 1), prev, width, channels, is16 );
+        for( int y = range.start; y < range.end; y++ )
+        {
+            convertPngRow( img.ptr(y), cur, width, channels, is16 );
+            uchar* dst = &filtered[stride * y];
+            const uchar* up = y > 0 ? prev : NULL;
+            if( adaptive )
+                filterPngRowAdaptive( cur, up, dst, tmp, row_size, bpp );
+            else
+                filterPngRow( 1, cur, up, dst, row_size, bpp ); // PNG_FILTER_SUB
+            std::swap( prev, cur );
+        }
+    });
+
+    const int chunk_rows = (int)std::max( (size_t)1, PNG_PARALLEL_CHUNK_SIZE / stride );
+    const int nchunks = (height + chunk_rows - 1) / chunk_rows;
+    std::vector<std::vector<uchar> > chunks( nchunks );
+    std::vector<uLong> adlers( nchunks );
+    std::vector<uchar> status( nchunks, (uchar)0 );
+
+    parallel_for_(Range(0, nchunks), [&](const Range& range)
+    {
+        for( int i = range.start; i < range.end; i++ )
+        {
+            size_t start = stride * i * chunk_rows;
+            size_t len = stride * (std::min( height, (i + 1) * chunk_rows ) - i * chunk_rows);
+            const uchar* src = &filtered[start];
+            bool last = i == nchunks - 1;
+            adlers[i] = adler32( adler32(0L, Z_NULL, 0), src, (uInt)len );
+
+            // raw deflate data; the zlib header and the checksum are added below
+            z_stream strm;
+            memset( &strm, 0, sizeof(strm) );
+            if( deflateInit2( &strm, level, Z_DEFLATED, -15, 8, compression_strategy ) != Z_OK )
+                continue;
+            if( start > 0 )
+            {
+                size_t dict_size = std::min( start, PNG_DEFLATE_WINDOW );
+                deflateSetDictionary( &strm, src - dict_size, (uInt)dict_size );
+            }
+
+            // the first chunk reserves the place for the zlib header
+            std::vector<uchar>& out = chunks[i];
+            size_t pos = i == 0 ? 2 : 0;
+            out.resize( pos + deflateBound( &strm, (uLong)len ) + 16 );
+            strm.next_in = (Bytef*)src;
+            strm.avail_in = (uInt)len;
+            int flush = last ? Z_FINISH : Z_SYNC_FLUSH; // the sync flush aligns the chunk to a byte boundary
+            int err = Z_OK;
+            for( ;; )
+            {
+                if( pos == out.size() )
+                    out.resize( out.size() * 2 );
+                strm.next_out = &out[pos];
+                strm.avail_out = (uInt)(out.size() - pos);
+                err = deflate( &strm, flush );
+                pos = out.size() - strm.avail_out;
+                if( err != Z_OK || (!last && strm.avail_in == 0 && strm.avail_out > 0) )
+                    break;
+            }
+            status[i] = last ? err == Z_STREAM_END : err == Z_OK;
+            deflateEnd( &strm );
+            out.resize( pos );
+        }
+    });
+    for( int i = 0; i < nchunks; i++ )
+        if( !status[i] )
+            return false;
+
+    // zlib header: 32K window, the compression level hint
+    int flevel = level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+    int cmf = 0x78, flg = flevel << 6;
+    flg += 31 - ((cmf << 8) + flg) % 31;
+    chunks[0][0] = (uchar)cmf;
+    chunks[0][1] = (uchar)flg;
+
+    uLong adler = adlers[0];
+    for( int i = 1; i < nchunks; i++ )
+    {
+        size_t len = stride * (std::min( height, (i + 1) * chunk_rows ) - i * chunk_rows);
+        adler = adler32_combine( adler, adlers[i], (z_off_t)len );
+    }
+    uchar adler_buf[4];
+    putUInt32BE( adler_buf, (unsigned)adler );
+    chunks[nchunks - 1].insert( chunks[nchunks - 1].end(), adler_buf, adler_buf + 4 );
+
+    static const uchar signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    uchar ihdr[13];
+    putUInt32BE( ihdr, (unsigned)width );
+    putUInt32BE( ihdr + 4, (unsigned)height );
+    ihdr[8] = (uchar)(is16 ? 16 : 8);
+    ihdr[9] = (uchar)(channels == 1 ? PNG_COLOR_TYPE_GRAY : channels == 3 ? PNG_COLOR_TYPE_RGB : PNG_COLOR_TYPE_RGBA);
+    ihdr[10] = PNG_COMPRESSION_TYPE_BASE;
+    ihdr[11] = PNG_FILTER_TYPE_BASE;
+    ihdr[12] = PNG_INTERLACE_NONE;
+
+    std::vector<uchar> local_buf;
+    std::vector<uchar>& out = m_buf ? *m_buf : local_buf;
+    out.clear();
+    out.insert( out.end(), signature, signature + sizeof(signature) );
+    appendPngChunk( out, "IHDR", ihdr, sizeof(ihdr) );
+    for( int i = 0; i < nchunks; i++ )
+    {
+        if( !chunks[i].empty() )
+            appendPngChunk( out, "IDAT", &chunks[i][0], chunks[i].size() );
+        std::vector<uchar>().swap( chunks[i] );
+    }
+    appendPngChunk( out, "IEND", NULL, 0 );
+
+    if( m_buf )
+        return true;
+
+    FILE* f = fopen( m_filename.c_str(), "wb" );
+    if( !f )
+        return false;
+    bool result = fwrite( &out[0], 1, out.size(), f ) == out.size();
+    result = fclose( f ) == 0 && result;
     return result;
 }
 
@@ -59,14 +59,21 @@ public:
     virtual ~PngDecoder();
 
     bool  readData( Mat& img ) CV_OVERRIDE;
+    bool  setROI( const Rect& roi ) CV_OVERRIDE;
     bool  readHeader() CV_OVERRIDE;
+    bool  startReadRows( int type ) CV_OVERRIDE;
+    bool  readRows( Mat& band ) CV_OVERRIDE;
     void  close();
 
     ImageDecoder newDecoder() const CV_OVERRIDE;
+    bool  reset() CV_OVERRIDE;
 
 protected:
 
     static void readDataFromBuf(void* png_ptr, uchar* dst, size_t size);
+    static void* allocPng(void* png_ptr, size_t size);
+    static void freePng(void* png_ptr, void* ptr);
+    void  setTransforms( int type );
 
     int   m_bit_depth;
     void* m_png_ptr;  // pointer to decompression structure
@@ -75,6 +82,7 @@ protected:
     FILE* m_f;
     int   m_color_type;
     size_t m_buf_pos;
+    std::vector<void*> m_free_blocks; // memory of the released libpng contexts, see allocPng()
 };
 
 
@@ -86,12 +94,21 @@ public:
 
     bool  isFormatSupported( int depth ) const CV_OVERRIDE;
     bool  write( const Mat& img, const std::vector<int>& params ) CV_OVERRIDE;
+    bool  startWriteRows( Size size, int type, const std::vector<int>& params ) CV_OVERRIDE;
+    bool  writeRows( const Mat& band ) CV_OVERRIDE;
+    bool  finishWriteRows() CV_OVERRIDE;
+    void  close();
 
     ImageEncoder newEncoder() const CV_OVERRIDE;
 
 protected:
     static void writeDataToBuf(void* png_ptr, uchar* src, size_t size);
     static void flushBuf(void* png_ptr);
+    bool  writeParallel( const Mat& img, int compression_level, int compression_strategy );
+
+    void* m_png_ptr;  // pointer to compression structure
+    void* m_info_ptr; // pointer to image information structure
+    FILE* m_f;
 };
 
 }
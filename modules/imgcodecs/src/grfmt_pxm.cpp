@@ -102,6 +102,7 @@ static int ReadNumber(RLByteStream& strm, int maxdigits = 0)
 
 PxMDecoder::PxMDecoder()
 {
+    m_codec_name = "pxm";
     m_offset = -1;
     m_buf_supported = true;
     m_bpp = 0;
@@ -206,6 +207,33 @@ bool PxMDecoder::readHeader()
 
 
 bool PxMDecoder::readData( Mat& img )
+{
+    if( m_offset < 0 || !m_strm.isOpened())
+        return false;
+
+    m_strm.setPos( m_offset );
+    return decodeRows( img );
+}
+
+
+bool PxMDecoder::startReadRows( int type )
+{
+    CV_UNUSED(type);
+    if( m_offset < 0 || !m_strm.isOpened())
+        return false;
+
+    m_strm.setPos( m_offset );
+    return true;
+}
+
+
+bool PxMDecoder::readRows( Mat& band )
+{
+    return decodeRows( band );
+}
+
+
+bool PxMDecoder::decodeRows( Mat& img )
 {
     bool color = img.channels() > 1;
     uchar* data = img.ptr();
@@ -216,9 +244,6 @@ bool PxMDecoder::readData( Mat& img )
     int  nch = CV_MAT_CN(m_type);
     int  width3 = m_width*nch;
 
-    if( m_offset < 0 || !m_strm.isOpened())
-        return false;
-
     uchar gray_palette[256] = {0};
 
     // create LUT for converting colors
@@ -234,8 +259,6 @@ bool PxMDecoder::readData( Mat& img )
 
     try
     {
-        m_strm.setPos( m_offset );
-
         switch( m_bpp )
         {
         ////////////////////////// 1 BPP /////////////////////////
@@ -246,7 +269,7 @@ bool PxMDecoder::readData( Mat& img )
                 AutoBuffer<uchar> _src(m_width);
                 uchar* src = _src.data();
 
-                for (int y = 0; y < m_height; y++, data += img.step)
+                for (int y = 0; y < img.rows; y++, data += img.step)
                 {
                     for (int x = 0; x < m_width; x++)
                         src[x] = ReadNumber(m_strm, 1) != 0;
@@ -262,7 +285,7 @@ bool PxMDecoder::readData( Mat& img )
                 AutoBuffer<uchar> _src(src_pitch);
                 uchar* src = _src.data();
 
-                for (int y = 0; y < m_height; y++, data += img.step)
+                for (int y = 0; y < img.rows; y++, data += img.step)
                 {
                     m_strm.getBytes( src, src_pitch );
 
@@ -282,7 +305,7 @@ bool PxMDecoder::readData( Mat& img )
             AutoBuffer<uchar> _src(std::max<size_t>(width3*2, src_pitch));
             uchar* src = _src.data();
 
-            for (int y = 0; y < m_height; y++, data += img.step)
+            for (int y = 0; y < img.rows; y++, data += img.step)
             {
                 if( !m_binary )
                 {
@@ -366,7 +389,7 @@ bool PxMDecoder::readData( Mat& img )
     }
     catch (...)
     {
-        CV_LOG_ERROR(NULL, "PXM::readData(): unknown exception");
+        CV_LOG_ERROR(NULL, "PXM::decodeRows(): unknown exception");
         throw;
     }
 
@@ -377,7 +400,7 @@ bool PxMDecoder::readData( Mat& img )
 //////////////////////////////////////////////////////////////////////////////////////////
 
 PxMEncoder::PxMEncoder(PxMMode mode) :
-    mode_(mode)
+    mode_(mode), m_mode(mode), m_binary(true)
 {
     switch (mode)
     {
@@ -403,14 +426,18 @@ bool PxMEncoder::isFormatSupported(int depth) const
 }
 
 bool PxMEncoder::write(const Mat& img, const std::vector<int>& params)
+{
+    return startWriteRows(img.size(), img.type(), params) && writeRows(img) && finishWriteRows();
+}
+
+bool PxMEncoder::startWriteRows(Size size, int type, const std::vector<int>& params)
 {
     bool isBinary = true;
 
-    int  width = img.cols, height = img.rows;
-    int  _channels = img.channels(), depth = (int)img.elemSize1()*8;
+    int  width = size.width, height = size.height;
+    int  _channels = CV_MAT_CN(type), depth = CV_ELEM_SIZE1(type)*8;
     int  channels = _channels > 1 ? 3 : 1;
-    int  fileStep = width*(int)img.elemSize();
-    int  x, y;
+    int  fileStep = width*CV_ELEM_SIZE(type);
 
     for( size_t i = 0; i < params.size(); i += 2 )
     {
@@ -421,49 +448,48 @@ bool PxMEncoder::write(const Mat& img, const std::vector<int>& params)
     int mode = mode_;
     if (mode == PXM_TYPE_AUTO)
     {
-        mode = img.channels() == 1 ? PXM_TYPE_PGM : PXM_TYPE_PPM;
+        mode = _channels == 1 ? PXM_TYPE_PGM : PXM_TYPE_PPM;
     }
 
-    if (mode == PXM_TYPE_PGM && img.channels() > 1)
+    if (mode == PXM_TYPE_PGM && _channels > 1)
     {
         CV_Error(Error::StsBadArg, "Portable bitmap(.pgm) expects gray image");
     }
-    if (mode == PXM_TYPE_PPM && img.channels() != 3)
+    if (mode == PXM_TYPE_PPM && _channels != 3)
     {
         CV_Error(Error::StsBadArg, "Portable bitmap(.ppm) expects BGR image");
     }
-    if (mode == PXM_TYPE_PBM && img.type() != CV_8UC1)
+    if (mode == PXM_TYPE_PBM && type != CV_8UC1)
     {
         CV_Error(Error::StsBadArg, "For portable bitmap(.pbm) type must be CV_8UC1");
     }
 
-    WLByteStream strm;
-
+    m_strm.close();
     if( m_buf )
     {
-        if( !strm.open(*m_buf) )
+        if( !m_strm.open(*m_buf) )
             return false;
-        int t = CV_MAKETYPE(img.depth(), channels);
+        int t = CV_MAKETYPE(CV_MAT_DEPTH(type), channels);
         m_buf->reserve( alignSize(256 + (isBinary ? fileStep*height :
             ((t == CV_8UC1 ? 4 : t == CV_8UC3 ? 4*3+2 :
             t == CV_16UC1 ? 6 : 6*3+2)*width+1)*height), 256));
     }
-    else if( !strm.open(m_filename) )
+    else if( !m_strm.open(m_filename) )
         return false;
 
     int  lineLength;
     int  bufferSize = 128; // buffer that should fit a header
 
     if( isBinary )
-        lineLength = width * (int)img.elemSize();
+        lineLength = fileStep;
     else
         lineLength = (6 * channels + (channels > 1 ? 2 : 0)) * width + 32;
 
     if( bufferSize < lineLength )
         bufferSize = lineLength;
 
-    AutoBuffer<char> _buffer(bufferSize);
-    char* buffer = _buffer.data();
+    m_buffer.allocate(bufferSize);
+    char* buffer = m_buffer.data();
 
     // write header;
     const int code = ((mode == PXM_TYPE_PBM) ? 1 : (mode == PXM_TYPE_PGM) ? 2 : 3)
@@ -479,7 +505,26 @@ bool PxMEncoder::write(const Mat& img, const std::vector<int>& params)
         header_sz += sz;
     }
 
-    CHECK_WRITE(strm.putBytes(buffer, header_sz));
+    CHECK_WRITE(m_strm.putBytes(buffer, header_sz));
+
+    m_mode = mode;
+    m_binary = isBinary;
+    return true;
+}
+
+bool PxMEncoder::writeRows(const Mat& img)
+{
+    const bool isBinary = m_binary;
+    const int  mode = m_mode;
+    int  width = img.cols, height = img.rows;
+    int  _channels = img.channels(), depth = (int)img.elemSize1()*8;
+    int  channels = _channels > 1 ? 3 : 1;
+    int  fileStep = width*(int)img.elemSize();
+    int  bufferSize = (int)m_buffer.size();
+    char* buffer = m_buffer.data();
+    int  x, y;
+
+    CV_Assert(m_strm.isOpened());
 
     for( y = 0; y < height; y++ )
     {
@@ -512,7 +557,7 @@ bool PxMEncoder::write(const Mat& img, const std::vector<int>& params)
                 {
                     *ptr++ = byte;
                 }
-                CHECK_WRITE(strm.putBytes(buffer, (int)(ptr - buffer)));
+                CHECK_WRITE(m_strm.putBytes(buffer, (int)(ptr - buffer)));
                 continue;
             }
 
@@ -539,7 +584,7 @@ bool PxMEncoder::write(const Mat& img, const std::vector<int>& params)
                 }
             }
 
-            CHECK_WRITE(strm.putBytes( (channels > 1 || depth > 8) ? buffer : (const char*)data, fileStep));
+            CHECK_WRITE(m_strm.putBytes( (channels > 1 || depth > 8) ? buffer : (const char*)data, fileStep));
         }
         else
         {
@@ -610,11 +655,18 @@ bool PxMEncoder::write(const Mat& img, const std::vector<int>& params)
 
             *ptr++ = '\n';
 
-            CHECK_WRITE(strm.putBytes( buffer, (int)(ptr - buffer) ));
+            CHECK_WRITE(m_strm.putBytes( buffer, (int)(ptr - buffer) ));
         }
     }
 
-    strm.close();
+    return true;
+}
+
+bool PxMEncoder::finishWriteRows()
+{
+    if( !m_strm.isOpened() )
+        return false;
+    m_strm.close();
     return true;
 }
 
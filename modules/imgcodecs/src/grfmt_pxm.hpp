@@ -68,6 +68,8 @@ public:
 
     bool  readData( Mat& img ) CV_OVERRIDE;
     bool  readHeader() CV_OVERRIDE;
+    bool  startReadRows( int type ) CV_OVERRIDE;
+    bool  readRows( Mat& band ) CV_OVERRIDE;
     void  close();
 
     size_t signatureLength() const CV_OVERRIDE;
@@ -75,6 +77,8 @@ public:
     ImageDecoder newDecoder() const CV_OVERRIDE;
 
 protected:
+    // decodes img.rows rows starting at the current stream position
+    bool  decodeRows( Mat& img );
 
     RLByteStream    m_strm;
     PaletteEntry    m_palette[256];
@@ -92,6 +96,9 @@ public:
 
     bool  isFormatSupported( int depth ) const CV_OVERRIDE;
     bool  write( const Mat& img, const std::vector<int>& params ) CV_OVERRIDE;
+    bool  startWriteRows( Size size, int type, const std::vector<int>& params ) CV_OVERRIDE;
+    bool  writeRows( const Mat& band ) CV_OVERRIDE;
+    bool  finishWriteRows() CV_OVERRIDE;
 
     ImageEncoder newEncoder() const CV_OVERRIDE
     {
@@ -99,6 +106,12 @@ public:
     }
 
     const PxMMode mode_;
+
+protected:
+    WLByteStream      m_strm;
+    AutoBuffer<char>  m_buffer;  // row buffer, fits the header too
+    int               m_mode;    // mode_ resolved for the image type
+    bool              m_binary;
 };
 
 }
@@ -50,6 +50,7 @@ namespace cv
 
 SPngDecoder::SPngDecoder()
 {
+    m_codec_name = "png";
     m_signature = "\x89\x50\x4e\x47\xd\xa\x1a\xa";
     m_color_type = 0;
     m_ctx = 0;
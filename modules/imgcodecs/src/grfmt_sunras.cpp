@@ -16,6 +16,7 @@ static const char* fmtSignSunRas = "\x59\xA6\x6A\x95";
 
 SunRasterDecoder::SunRasterDecoder()
 {
+    m_codec_name = "sunras";
     m_offset = -1;
     m_signature = fmtSignSunRas;
     m_bpp = 0;
@@ -55,6 +55,7 @@
 
 #include "tiff.h"
 #include "tiffio.h"
+#include <zlib.h>
 
 namespace cv
 {
@@ -111,15 +112,21 @@ static const char fmtSignBigTiffMM[] = "MM\x00\x2b";
 
 TiffDecoder::TiffDecoder()
 {
+    m_codec_name = "tiff";
     m_hdr = false;
     m_buf_supported = true;
     m_buf_pos = 0;
+    m_rows_read = 0;
+    m_read_rows = false;
+    m_rows_cache_y = -1;
 }
 
 
 void TiffDecoder::close()
 {
     m_tif.release();
+    m_rows_cache.release();
+    m_rows_cache_y = -1;
 }
 
 TiffDecoder::~TiffDecoder()
@@ -280,6 +287,14 @@ bool TiffDecoder::readHeader()
             m_width = wdth;
             m_height = hght;
             m_frame_count = TIFFNumberOfDirectories(tif);
+
+            // the reduced resolution levels of a pyramidal TIFF, see setLevel()
+            m_level_offsets.clear();
+            uint16_t nsubifd = 0;
+            const toff_t* subifd = NULL;
+            if (TIFFGetField(tif, TIFFTAG_SUBIFD, &nsubifd, &subifd) && subifd)
+                m_level_offsets.assign(subifd, subifd + nsubifd);
+
             if (ncn == 3 && photometric == PHOTOMETRIC_LOGLUV)
             {
                 m_type = CV_32FC3;
@@ -584,6 +599,66 @@ static void _unpack14To16(const uchar* src, const uchar* srcEnd, ushort* dst, us
 }
 //end _unpack14To16()
 
+bool  TiffDecoder::setROI( const Rect& roi )
+{
+    if (m_tif.empty())
+        return false;
+    // the orientation is fixed up on the whole decoded image, see fixOrientation()
+    uint16_t img_orientation = ORIENTATION_TOPLEFT;
+    CV_TIFF_CHECK_CALL_DEBUG(TIFFGetField((TIFF*)m_tif.get(), TIFFTAG_ORIENTATION, &img_orientation));
+    if (img_orientation != ORIENTATION_TOPLEFT)
+        return false;
+    m_roi = roi;
+    return true;
+}
+
+int  TiffDecoder::getLevelCount() const
+{
+    return 1 + (int)m_level_offsets.size();
+}
+
+bool  TiffDecoder::setLevel( int level )
+{
+    if (level == 0)
+        return true;
+    if (m_tif.empty() || level < 0 || level > (int)m_level_offsets.size())
+        return false;
+    // the SubIFD becomes the current directory, the tiles or strips of the level are read as usual
+    const toff_t offset = (toff_t)m_level_offsets[level - 1];
+    return TIFFSetSubDirectory((TIFF*)m_tif.get(), offset) && readHeader();
+}
+
+bool  TiffDecoder::startReadRows( int type )
+{
+    CV_UNUSED(type);
+    // each band is decoded as a ROI, the contiguous strips by scanlines, otherwise a row of strips (tiles)
+    // is decoded once and kept for the next bands
+    if (!setROI(Rect(0, 0, m_width, m_height)))
+        return false;
+    m_roi = Rect();
+    m_rows_read = 0;
+    m_rows_cache.release();
+    m_rows_cache_y = -1;
+    return true;
+}
+
+bool  TiffDecoder::readRows( Mat& band )
+{
+    CV_CheckLE(m_rows_read + band.rows, m_height, "");
+    m_roi = Rect(0, m_rows_read, m_width, band.rows);
+    m_read_rows = true;
+    bool result = readData(band);
+    m_read_rows = false;
+    m_roi = Rect();
+    m_rows_read += band.rows;
+    if (m_rows_read == m_height)
+    {
+        m_rows_cache.release();
+        m_rows_cache_y = -1;
+    }
+    return result;
+}
+
 bool  TiffDecoder::readData( Mat& img )
 {
     int type = img.type();
@@ -625,6 +700,15 @@ bool  TiffDecoder::readData( Mat& img )
         int wanted_channels = normalizeChannelsNumber(img.channels());
         bool doReadScanline = false;
 
+        // readRows() reads the contiguous strips by scanlines, whatever their size,
+        // MINISWHITE is inverted by the TIFFReadRGBA* functions only
+        bool streamScanlines = false;
+        if (m_read_rows && !is_tiled && photometric != PHOTOMETRIC_MINISWHITE)
+        {
+            uint16_t planarConfig = (uint16_t)-1;
+            streamScanlines = TIFFGetField(tif, TIFFTAG_PLANARCONFIG, &planarConfig) && planarConfig != PLANARCONFIG_SEPARATE;
+        }
+
         uint32_t tile_width0 = m_width, tile_height0 = 0;
 
         if (is_tiled)
@@ -666,6 +750,8 @@ bool  TiffDecoder::readData( Mat& img )
                     (uint64_t)tile_width0 * tile_height0 * _ncn * std::max(1, (int)(_bpp / bitsPerByte))
                     >=
                     ( (uint64_t) MAX_TILE_SIZE * 95 / 100)
+                    ||
+                    streamScanlines
                 )
                 {
                     uint16_t planerConfig = (uint16_t)-1;
@@ -677,7 +763,7 @@ bool  TiffDecoder::readData( Mat& img )
                                      &&
                                      ( ( bpp == 8 ) || ( bpp == 16 ) )
                                      &&
-                                     (tile_height0 == (uint32_t) m_height) // single strip
+                                     (tile_height0 == (uint32_t) m_height || streamScanlines) // single strip
                                      &&
                                      (
                                          (photometric == PHOTOMETRIC_MINISWHITE)
@@ -722,6 +808,8 @@ bool  TiffDecoder::readData( Mat& img )
                     (uint64_t)tile_width0 * tile_height0 * ncn * std::max(1, (int)(bpp / bitsPerByte))
                     >=
                     MAX_TILE_SIZE * 95 / 100
+                    ||
+                    streamScanlines
                 )
                 {
                     uint16_t planerConfig = (uint16_t)-1;
@@ -733,7 +821,7 @@ bool  TiffDecoder::readData( Mat& img )
                                      &&
                                      ( ( bpp == 8 ) || ( bpp == 16 ) )
                                      &&
-                                     (tile_height0 == (uint32_t) m_height) // single strip
+                                     (tile_height0 == (uint32_t) m_height || streamScanlines) // single strip
                                      &&
                                      (
                                          (photometric == PHOTOMETRIC_MINISWHITE)
@@ -759,6 +847,7 @@ bool  TiffDecoder::readData( Mat& img )
             {
                 CV_Assert(ncn == img.channels());
                 CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_IEEEFP));
+                doReadScanline = streamScanlines;
             }
 
             if ( doReadScanline )
@@ -773,10 +862,10 @@ bool  TiffDecoder::readData( Mat& img )
             const size_t src_buffer_unpacked_bytes_per_row = divUp(static_cast<size_t>(ncn * tile_width0 * dst_bpp), static_cast<size_t>(bitsPerByte));
             const size_t src_buffer_unpacked_size = tile_height0 * src_buffer_unpacked_bytes_per_row;
             const bool needsUnpacking = (bpp < dst_bpp);
-            AutoBuffer<uchar> _src_buffer(src_buffer_size);
-            uchar* src_buffer = _src_buffer.data();
-            AutoBuffer<uchar> _src_buffer_unpacked(needsUnpacking ? src_buffer_unpacked_size : 0);
-            uchar* src_buffer_unpacked = needsUnpacking ? _src_buffer_unpacked.data() : nullptr;
+            // the buffers are allocated for the first decoded row of tiles (strips), readRows() may have it already
+            AutoBuffer<uchar> _src_buffer, _src_buffer_unpacked;
+            uchar* src_buffer = nullptr;
+            uchar* src_buffer_unpacked = nullptr;
 
             if ( doReadScanline )
             {
@@ -785,21 +874,59 @@ bool  TiffDecoder::readData( Mat& img )
                            "src_buffer_size is smaller than TIFFScanlineSize().");
             }
 
-            int tileidx = 0;
-
             #define MAKE_FLAG(a,b) ( (a << 8) | b )
             const int  convert_flag = MAKE_FLAG( ncn, wanted_channels );
             const bool isNeedConvert16to8 = ( doReadScanline ) && ( bpp == 16 ) && ( dst_bpp == 8);
 
-            for (int y = 0; y < m_height; y += (int)tile_height0)
+            // with ROI only the tiles (strips) intersecting it are decoded, a row of them at a time into
+            // the band buffer, then the intersection is copied to img
+            const bool partial = !m_roi.empty();
+            const Rect roi = partial ? m_roi : Rect(0, 0, m_width, m_height);
+            const int tiles_per_row = (int)divUp((size_t)m_width, (size_t)tile_width0);
+            const int tile_x0 = roi.x / (int)tile_width0 * (int)tile_width0;
+            const int tile_x1 = std::min(m_width, (int)divUp((size_t)(roi.x + roi.width), (size_t)tile_width0) * (int)tile_width0);
+            Mat band;
+
+            for (int y = roi.y / (int)tile_height0 * (int)tile_height0; y < roi.y + roi.height; y += (int)tile_height0)
             {
                 int tile_height = std::min((int)tile_height0, m_height - y);
 
                 const int img_y = vert_flip ? m_height - y - tile_height : y;
 
-                for(int x = 0; x < m_width; x += (int)tile_width0, tileidx++)
+                // tiles are written to dst at (x - dst_x, img_y - dst_y)
+                Mat dst = img;
+                int dst_x = 0, dst_y = 0;
+                const bool decoded = m_read_rows && y == m_rows_cache_y;  // by the previous readRows()
+                if (partial)
+                {
+                    if (decoded)
+                        band = m_rows_cache;
+                    else
+                        band.create(tile_height, tile_x1 - tile_x0, img.type());
+                    dst = band;
+                    dst_x = tile_x0;
+                    dst_y = img_y;
+                }
+                if (!decoded)
+                {
+                    // band may share the data with the cache
+                    m_rows_cache_y = -1;
+                    if (!src_buffer)
+                    {
+                        _src_buffer.allocate(src_buffer_size);
+                        src_buffer = _src_buffer.data();
+                        if (needsUnpacking)
+                        {
+                            _src_buffer_unpacked.allocate(src_buffer_unpacked_size);
+                            src_buffer_unpacked = _src_buffer_unpacked.data();
+                        }
+                    }
+                }
+
+                for(int x = tile_x0; x < tile_x1 && !decoded; x += (int)tile_width0)
                 {
                     int tile_width = std::min((int)tile_width0, m_width - x);
+                    const int tileidx = y / (int)tile_height0 * tiles_per_row + x / (int)tile_width0;
 
                     switch (dst_bpp)
                     {
@@ -839,7 +966,7 @@ bool  TiffDecoder::readData( Mat& img )
                                 bstart += (tile_height0 - tile_height) * tile_width0 * 4;
                             }
 
-                            uchar* img_line_buffer = (uchar*) img.ptr(y, 0);
+                            uchar* img_line_buffer = (uchar*) dst.ptr(y - dst_y, 0);
 
                             for (int i = 0; i < tile_height; i++)
                             {
@@ -862,14 +989,14 @@ bool  TiffDecoder::readData( Mat& img )
                                     case MAKE_FLAG( 3, 1): // RGB to GRAY
                                         icvCvt_BGR2Gray_8u_C3C1R( bstart, 0,
                                                 img_line_buffer, 0,
-                                                Size(tile_width, 1) );
+                                                Size(tile_width, 1), 2 );
                                         break;
 
                                     case MAKE_FLAG( 3, 3 ): // RGB to BGR
                                         if (m_use_rgb)
                                             memcpy( (void*) img_line_buffer,
                                                     (void*) bstart,
-                                                    tile_width * sizeof(uchar) );
+                                                    tile_width * 3 * sizeof(uchar) );
                                         else
                                             icvCvt_BGR2RGB_8u_C3R( bstart, 0,
                                                     img_line_buffer, 0,
@@ -879,7 +1006,7 @@ bool  TiffDecoder::readData( Mat& img )
                                     case MAKE_FLAG( 4, 1 ): // RGBA to GRAY
                                         icvCvt_BGRA2Gray_8u_C4C1R( bstart, 0,
                                                 img_line_buffer, 0,
-                                                Size(tile_width, 1) );
+                                                Size(tile_width, 1), 2 );
                                         break;
 
                                     case MAKE_FLAG( 4, 3 ): // RGBA to BGR
@@ -907,14 +1034,14 @@ bool  TiffDecoder::readData( Mat& img )
                                     if (wanted_channels == 4)
                                     {
                                         icvCvt_BGRA2RGBA_8u_C4R(bstart + i*tile_width0*4, 0,
-                                                img.ptr(img_y + tile_height - i - 1, x), 0,
+                                                dst.ptr(img_y - dst_y + tile_height - i - 1, x - dst_x), 0,
                                                 Size(tile_width, 1) );
                                     }
                                     else
                                     {
                                         CV_CheckEQ(wanted_channels, 3, "TIFF-8bpp: BGR/BGRA images are supported only");
                                         icvCvt_BGRA2BGR_8u_C4C3R(bstart + i*tile_width0*4, 0,
-                                                img.ptr(img_y + tile_height - i - 1, x), 0,
+                                                dst.ptr(img_y - dst_y + tile_height - i - 1, x - dst_x), 0,
                                                 Size(tile_width, 1), m_use_rgb ? 0 : 2);
                                     }
                                 }
@@ -922,7 +1049,7 @@ bool  TiffDecoder::readData( Mat& img )
                                 {
                                     CV_CheckEQ(wanted_channels, 1, "");
                                     icvCvt_BGRA2Gray_8u_C4C1R( bstart + i*tile_width0*4, 0,
-                                            img.ptr(img_y + tile_height - i - 1, x), 0,
+                                            dst.ptr(img_y - dst_y + tile_height - i - 1, x - dst_x), 0,
                                             Size(tile_width, 1), 2);
                                 }
                             }
@@ -972,17 +1099,17 @@ bool  TiffDecoder::readData( Mat& img )
                                     {
                                         CV_CheckEQ(wanted_channels, 3, "");
                                         icvCvt_Gray2BGR_16u_C1C3R(buffer16, 0,
-                                                img.ptr<ushort>(img_y + i, x), 0,
+                                                dst.ptr<ushort>(img_y - dst_y + i, x - dst_x), 0,
                                                 Size(tile_width, 1));
                                     }
                                     else if (ncn == 3)
                                     {
                                         CV_CheckEQ(wanted_channels, 3, "");
                                         if (m_use_rgb)
-                                            memcpy(buffer16, img.ptr<ushort>(img_y + i, x), tile_width * sizeof(ushort));
+                                            memcpy(buffer16, dst.ptr<ushort>(img_y - dst_y + i, x - dst_x), tile_width * sizeof(ushort));
                                         else
                                             icvCvt_RGB2BGR_16u_C3R(buffer16, 0,
-                                                    img.ptr<ushort>(img_y + i, x), 0,
+                                                    dst.ptr<ushort>(img_y - dst_y + i, x - dst_x), 0,
                                                     Size(tile_width, 1));
                                     }
                                     else if (ncn == 4)
@@ -990,14 +1117,14 @@ bool  TiffDecoder::readData( Mat& img )
                                         if (wanted_channels == 4)
                                         {
                                             icvCvt_BGRA2RGBA_16u_C4R(buffer16, 0,
-                                                img.ptr<ushort>(img_y + i, x), 0,
+                                                dst.ptr<ushort>(img_y - dst_y + i, x - dst_x), 0,
                                                 Size(tile_width, 1));
                                         }
                                         else
                                         {
                                             CV_CheckEQ(wanted_channels, 3, "TIFF-16bpp: BGR/BGRA images are supported only");
                                             icvCvt_BGRA2BGR_16u_C4C3R(buffer16, 0,
-                                                img.ptr<ushort>(img_y + i, x), 0,
+                                                dst.ptr<ushort>(img_y - dst_y + i, x - dst_x), 0,
                                                 Size(tile_width, 1), m_use_rgb ? 0 : 2);
                                         }
                                     }
@@ -1011,14 +1138,14 @@ bool  TiffDecoder::readData( Mat& img )
                                     CV_CheckEQ(wanted_channels, 1, "");
                                     if( ncn == 1 )
                                     {
-                                        memcpy(img.ptr<ushort>(img_y + i, x),
+                                        memcpy(dst.ptr<ushort>(img_y - dst_y + i, x - dst_x),
                                                buffer16,
                                                tile_width*sizeof(ushort));
                                     }
                                     else
                                     {
                                         icvCvt_BGRA2Gray_16u_CnC1R(buffer16, 0,
-                                                img.ptr<ushort>(img_y + i, x), 0,
+                                                dst.ptr<ushort>(img_y - dst_y + i, x - dst_x), 0,
                                                 Size(tile_width, 1), ncn, 2);
                                     }
                                 }
@@ -1029,7 +1156,11 @@ bool  TiffDecoder::readData( Mat& img )
                         case 32:
                         case 64:
                         {
-                            if( !is_tiled )
+                            if (doReadScanline)
+                            {
+                                CV_TIFF_CHECK_CALL((int)TIFFReadScanline(tif, src_buffer, y) >= 0);
+                            }
+                            else if( !is_tiled )
                             {
                                 CV_TIFF_CHECK_CALL((int)TIFFReadEncodedStrip(tif, tileidx, src_buffer, src_buffer_size) >= 0);
                             }
@@ -1040,13 +1171,13 @@ bool  TiffDecoder::readData( Mat& img )
 
                             Mat m_tile(Size(tile_width0, tile_height0), CV_MAKETYPE((dst_bpp == 32) ? (depth == CV_32S ? CV_32S : CV_32F) : CV_64F, ncn), src_buffer);
                             Rect roi_tile(0, 0, tile_width, tile_height);
-                            Rect roi_img(x, img_y, tile_width, tile_height);
+                            Rect roi_img(x - dst_x, img_y - dst_y, tile_width, tile_height);
                             if (!m_hdr && ncn == 3 && !m_use_rgb)
-                                extend_cvtColor(m_tile(roi_tile), img(roi_img), COLOR_RGB2BGR);
+                                extend_cvtColor(m_tile(roi_tile), dst(roi_img), COLOR_RGB2BGR);
                             else if (!m_hdr && ncn == 4)
-                                extend_cvtColor(m_tile(roi_tile), img(roi_img), COLOR_RGBA2BGRA);
+                                extend_cvtColor(m_tile(roi_tile), dst(roi_img), COLOR_RGBA2BGRA);
                             else
-                                m_tile(roi_tile).copyTo(img(roi_img));
+                                m_tile(roi_tile).copyTo(dst(roi_img));
                             break;
                         }
                         default:
@@ -1055,6 +1186,17 @@ bool  TiffDecoder::readData( Mat& img )
                         }
                     }  // switch (dst_bpp)
                 }  // for x
+
+                if (partial)
+                {
+                    const Rect r = Rect(dst_x, dst_y, band.cols, band.rows) & roi;
+                    band(r - Point(dst_x, dst_y)).copyTo(img(r - roi.tl()));
+                }
+                if (m_read_rows && !decoded)
+                {
+                    m_rows_cache = band;
+                    m_rows_cache_y = y;
+                }
             }  // for y
         }
         if (bpp < dst_bpp)
@@ -1083,6 +1225,12 @@ TiffEncoder::TiffEncoder()
 {
     m_description = "TIFF Files (*.tiff;*.tif)";
     m_buf_supported = true;
+    m_sgilog = false;
+    m_rows_written = 0;
+    m_parallel = false;
+    m_tile_size = 0;
+    m_predictor = PREDICTOR_NONE;
+    m_rows_per_strip = 0;
 }
 
 TiffEncoder::~TiffEncoder()
@@ -1190,28 +1338,17 @@ static bool readParam(const std::vector<int>& params, int key, int& value)
     return false;
 }
 
-bool TiffEncoder::writeLibTiff( const std::vector<Mat>& img_vec, const std::vector<int>& params)
+bool TiffEncoder::writePageHeader( void* tif_, Size size, int type, const std::vector<int>& params )
 {
-    // do NOT put "wb" as the mode, because the b means "big endian" mode, not "binary" mode.
-    // http://www.simplesystems.org/libtiff/functions/TIFFOpen.html
-    TIFF* tif = NULL;
+    TIFF* tif = (TIFF*)tif_;
+    CV_Assert(tif);
 
-    TiffEncoderBufHelper buf_helper(m_buf);
-    if ( m_buf )
-    {
-        tif = buf_helper.open();
-    }
-    else
-    {
-        tif = TIFFOpen(m_filename.c_str(), "w");
-    }
-    if (!tif)
-    {
-        return false;
-    }
-    cv::Ptr<void> tif_cleanup(tif, cv_tiffCloseHandle);
+    int channels = CV_MAT_CN(type);
+    int width = size.width, height = size.height;
+    int depth = CV_MAT_DEPTH(type);
+    CV_CheckType(type, depth == CV_8U || depth == CV_8S || depth == CV_16U || depth == CV_16S || depth == CV_32S || depth == CV_32F || depth == CV_64F, "");
+    CV_CheckType(type, channels >= 1 && channels <= 4, "");
 
-    //Settings that matter to all images
     int compression = COMPRESSION_LZW;
     int predictor = PREDICTOR_HORIZONTAL;
     int resUnit = -1, dpiX = -1, dpiY = -1;
@@ -1222,188 +1359,458 @@ bool TiffEncoder::writeLibTiff( const std::vector<Mat>& img_vec, const std::vect
     readParam(params, IMWRITE_TIFF_XDPI, dpiX);
     readParam(params, IMWRITE_TIFF_YDPI, dpiY);
 
-    //Iterate through each image in the vector and write them out as Tiff directories
-    for (size_t page = 0; page < img_vec.size(); page++)
+    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, width));
+    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_IMAGELENGTH, height));
+
+    // the pyramidal images are tiled, so that a region of any level is read from a few tiles
+    int tileSize = 0, pyramidLevels = 0;
+    readParam(params, IMWRITE_TIFF_PYRAMID_LEVELS, pyramidLevels);
+    if (!readParam(params, IMWRITE_TIFF_TILE_SIZE, tileSize) && pyramidLevels != 0)
+        tileSize = 256;
+    CV_Check(tileSize, tileSize >= 0 && tileSize % 16 == 0, "TIFF tile size must be a multiple of 16");
+    m_tile_size = tileSize;
+    if (tileSize > 0)
     {
-        const Mat& img = img_vec[page];
-        CV_Assert(!img.empty());
-        int channels = img.channels();
-        int width = img.cols, height = img.rows;
-        int type = img.type();
-        int depth = CV_MAT_DEPTH(type);
-        CV_CheckType(type, depth == CV_8U || depth == CV_8S || depth == CV_16U || depth == CV_16S || depth == CV_32S || depth == CV_32F || depth == CV_64F, "");
-        CV_CheckType(type, channels >= 1 && channels <= 4, "");
+        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_TILEWIDTH, tileSize));
+        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_TILELENGTH, tileSize));
+    }
+
+    int compression_param = -1;  // OPENCV_FUTURE
+    m_parallel = false;
+    m_sgilog = type == CV_32FC3 && (!readParam(params, IMWRITE_TIFF_COMPRESSION, compression_param) || compression_param == COMPRESSION_SGILOG);
+    if (m_sgilog)
+    {
+        // the rows are converted to XYZ in writePageRows()
+        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, 3));
+        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, 32));
+        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_COMPRESSION, COMPRESSION_SGILOG));
+        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_LOGLUV));
+        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG));
+        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_SGILOGDATAFMT, SGILOGDATAFMT_FLOAT));
+        if (tileSize == 0)
+            CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, 1));
+        return true;
+    }
 
-        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, width));
-        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_IMAGELENGTH, height));
+    int page_compression = compression;
 
-        if (img_vec.size() > 1)
+    int bitsPerChannel = -1;
+    uint16_t sample_format = SAMPLEFORMAT_INT;
+    switch (depth)
+    {
+        case CV_8U:
+            sample_format = SAMPLEFORMAT_UINT;
+            /* FALLTHRU */
+        case CV_8S:
         {
-            CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_SUBFILETYPE, FILETYPE_PAGE));
-            CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_PAGENUMBER, page, img_vec.size()));
+            bitsPerChannel = 8;
+            break;
         }
 
-        int compression_param = -1;  // OPENCV_FUTURE
-        if (type == CV_32FC3 && (!readParam(params, IMWRITE_TIFF_COMPRESSION, compression_param) || compression_param == COMPRESSION_SGILOG))
+        case CV_16U:
+            sample_format = SAMPLEFORMAT_UINT;
+            /* FALLTHRU */
+        case CV_16S:
         {
-            if (!write_32FC3_SGILOG(img, tif))
-                return false;
-            continue;
+            bitsPerChannel = 16;
+            break;
+        }
+
+        case CV_32S:
+        {
+            bitsPerChannel = 32;
+            sample_format = SAMPLEFORMAT_INT;
+            break;
+        }
+        case CV_32F:
+        {
+            bitsPerChannel = 32;
+            page_compression = COMPRESSION_NONE;
+            sample_format = SAMPLEFORMAT_IEEEFP;
+            break;
+        }
+        case CV_64F:
+        {
+            bitsPerChannel = 64;
+            page_compression = COMPRESSION_NONE;
+            sample_format = SAMPLEFORMAT_IEEEFP;
+            break;
+        }
+        default:
+        {
+            return false;
         }
+    }
+
+    const int bitsPerByte = 8;
+    size_t fileStep = (width * channels * bitsPerChannel) / bitsPerByte;
+    CV_Assert(fileStep > 0);
 
-        int page_compression = compression;
+    int rowsPerStrip = (int)((1 << 13) / fileStep);
+    readParam(params, IMWRITE_TIFF_ROWSPERSTRIP, rowsPerStrip);
+    rowsPerStrip = std::max(1, std::min(height, rowsPerStrip));
 
-        int bitsPerChannel = -1;
-        uint16_t sample_format = SAMPLEFORMAT_INT;
-        switch (depth)
+    int colorspace = channels > 1 ? PHOTOMETRIC_RGB : PHOTOMETRIC_MINISBLACK;
+
+    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, bitsPerChannel));
+    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_COMPRESSION, page_compression));
+    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, colorspace));
+    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, channels));
+    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG));
+    if (tileSize == 0)
+        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, rowsPerStrip));
+
+    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_SAMPLEFORMAT, sample_format));
+
+    if (page_compression == COMPRESSION_LZW || page_compression == COMPRESSION_ADOBE_DEFLATE || page_compression == COMPRESSION_DEFLATE)
+    {
+        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_PREDICTOR, predictor));
+    }
+
+    // the strips are compressed by zlib directly, so only the layouts
+    // that need no help from libtiff are handled in parallel
+    int parallel = 0;
+    readParam(params, IMWRITE_TIFF_PARALLEL, parallel);
+    m_parallel = parallel != 0 && tileSize == 0 &&
+        (page_compression == COMPRESSION_ADOBE_DEFLATE || page_compression == COMPRESSION_DEFLATE) &&
+        (predictor == PREDICTOR_NONE || predictor == PREDICTOR_HORIZONTAL) &&
+        !TIFFIsByteSwapped(tif);
+    m_predictor = predictor;
+    m_rows_per_strip = rowsPerStrip;
+
+    if (resUnit >= RESUNIT_NONE && resUnit <= RESUNIT_CENTIMETER)
+    {
+        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_RESOLUTIONUNIT, resUnit));
+    }
+    if (dpiX >= 0)
+    {
+        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_XRESOLUTION, (float)dpiX));
+    }
+    if (dpiY >= 0)
+    {
+        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_YRESOLUTION, (float)dpiY));
+    }
+    return true;
+}
+
+bool TiffEncoder::writePageRows( void* tif_, const Mat& img, int y0 )
+{
+    TIFF* tif = (TIFF*)tif_;
+    CV_Assert(tif);
+
+    int channels = img.channels();
+    int width = img.cols, height = img.rows;
+    int depth = img.depth();
+
+    if (m_sgilog)
+    {
+        Mat xyz;
+        cvtColor(img, xyz, COLOR_BGR2XYZ);
+
+        const int strip_size = 3 * width;
+        for (int i = 0; i < height; i++)
         {
-            case CV_8U:
-                sample_format = SAMPLEFORMAT_UINT;
-                /* FALLTHRU */
-            case CV_8S:
-            {
-                bitsPerChannel = 8;
-                break;
-            }
+            CV_TIFF_CHECK_CALL(TIFFWriteEncodedStrip(tif, y0 + i, (tdata_t)xyz.ptr<float>(i), strip_size * sizeof(float)) != (tsize_t)-1);
+        }
+        return true;
+    }
 
-            case CV_16U:
-                sample_format = SAMPLEFORMAT_UINT;
-                /* FALLTHRU */
-            case CV_16S:
-            {
-                bitsPerChannel = 16;
-                break;
-            }
+    // row buffer, because TIFFWriteScanline modifies the original data!
+    size_t scanlineSize = TIFFScanlineSize(tif);
+    AutoBuffer<uchar> _buffer(scanlineSize + 32);
+    uchar* buffer = _buffer.data(); CV_DbgAssert(buffer);
+    Mat m_buffer(Size(width, 1), CV_MAKETYPE(depth, channels), buffer, (size_t)scanlineSize);
 
-            case CV_32S:
+    for (int y = 0; y < height; ++y)
+    {
+        switch (channels)
+        {
+            case 1:
             {
-                bitsPerChannel = 32;
-                sample_format = SAMPLEFORMAT_INT;
+                memcpy(buffer, img.ptr(y), scanlineSize);
                 break;
             }
-            case CV_32F:
+
+            case 3:
             {
-                bitsPerChannel = 32;
-                page_compression = COMPRESSION_NONE;
-                sample_format = SAMPLEFORMAT_IEEEFP;
+                extend_cvtColor(img(Rect(0, y, width, 1)), (const Mat&)m_buffer, COLOR_BGR2RGB);
                 break;
             }
-            case CV_64F:
+
+            case 4:
             {
-                bitsPerChannel = 64;
-                page_compression = COMPRESSION_NONE;
-                sample_format = SAMPLEFORMAT_IEEEFP;
+                extend_cvtColor(img(Rect(0, y, width, 1)), (const Mat&)m_buffer, COLOR_BGRA2RGBA);
                 break;
             }
+
             default:
             {
-                return false;
+                CV_Assert(0);
             }
         }
 
-        const int bitsPerByte = 8;
-        size_t fileStep = (width * channels * bitsPerChannel) / bitsPerByte;
-        CV_Assert(fileStep > 0);
-
-        int rowsPerStrip = (int)((1 << 13) / fileStep);
-        readParam(params, IMWRITE_TIFF_ROWSPERSTRIP, rowsPerStrip);
-        rowsPerStrip = std::max(1, std::min(height, rowsPerStrip));
+        CV_TIFF_CHECK_CALL(TIFFWriteScanline(tif, buffer, y0 + y, 0) == 1);
+    }
+    return true;
+}
 
-        int colorspace = channels > 1 ? PHOTOMETRIC_RGB : PHOTOMETRIC_MINISBLACK;
+// converts the row to RGB(A) order and applies the horizontal differencing predictor in place
+template<typename T> static void
+prepareDeflateRow( T* row, int width, int channels, bool horizontal )
+{
+    if (channels >= 3)
+    {
+        for (int x = 0; x < width; x++)
+            std::swap(row[x * channels], row[x * channels + 2]);
+    }
+    if (horizontal)
+    {
+        for (int i = width * channels - 1; i >= channels; i--)
+            row[i] = (T)(row[i] - row[i - channels]);
+    }
+}
 
-        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, bitsPerChannel));
-        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_COMPRESSION, page_compression));
-        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, colorspace));
-        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, channels));
-        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG));
-        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, rowsPerStrip));
+bool TiffEncoder::writePageStrips( void* tif_, const Mat& img )
+{
+    TIFF* tif = (TIFF*)tif_;
+    CV_Assert(tif);
+    CV_Assert(m_rows_per_strip > 0);
+
+    int channels = img.channels();
+    int width = img.cols, height = img.rows;
+    size_t elemSize1 = img.elemSize1();
+    size_t scanlineSize = (size_t)width * channels * elemSize1;
+    CV_Assert((size_t)TIFFScanlineSize(tif) == scanlineSize);
+    const bool horizontal = m_predictor == PREDICTOR_HORIZONTAL;
+
+    const int rowsPerStrip = m_rows_per_strip;
+    const int nstrips = (height + rowsPerStrip - 1) / rowsPerStrip;
+    // the strips are written in batches to limit the memory held by the compressed data
+    const int batchSize = std::max(getNumThreads(), 1) * 4;
+    std::vector<std::vector<uchar> > strips(batchSize);
+    std::vector<uchar> status(batchSize);
+
+    for (int s0 = 0; s0 < nstrips; s0 += batchSize)
+    {
+        int s1 = std::min(nstrips, s0 + batchSize);
+        parallel_for_(Range(s0, s1), [&](const Range& range)
+        {
+            std::vector<uchar> raw;
+            for (int s = range.start; s < range.end; s++)
+            {
+                int y0 = s * rowsPerStrip, y1 = std::min(height, y0 + rowsPerStrip);
+                raw.resize(scanlineSize * (y1 - y0));
+                for (int y = y0; y < y1; y++)
+                {
+                    uchar* row = &raw[scanlineSize * (y - y0)];
+                    memcpy(row, img.ptr(y), scanlineSize);
+                    if (elemSize1 == 1)
+                        prepareDeflateRow(row, width, channels, horizontal);
+                    else if (elemSize1 == 2)
+                        prepareDeflateRow((ushort*)row, width, channels, horizontal);
+                    else
+                        prepareDeflateRow((unsigned*)row, width, channels, horizontal);
+                }
 
-        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_SAMPLEFORMAT, sample_format));
+                // the same zlib stream as produced by the libtiff ZIP codec with the default quality
+                std::vector<uchar>& dst = strips[s - s0];
+                uLongf dstSize = compressBound((uLong)raw.size());
+                dst.resize(dstSize);
+                status[s - s0] = compress2(&dst[0], &dstSize, &raw[0], (uLong)raw.size(), Z_DEFAULT_COMPRESSION) == Z_OK;
+                dst.resize(dstSize);
+            }
+        });
 
-        if (page_compression == COMPRESSION_LZW || page_compression == COMPRESSION_ADOBE_DEFLATE || page_compression == COMPRESSION_DEFLATE)
+        for (int s = s0; s < s1; s++)
         {
-            CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_PREDICTOR, predictor));
+            std::vector<uchar>& dst = strips[s - s0];
+            if (!status[s - s0])
+                return false;
+            CV_TIFF_CHECK_CALL(TIFFWriteRawStrip(tif, s, &dst[0], (tmsize_t)dst.size()) != (tmsize_t)-1);
         }
+    }
+    return true;
+}
 
-        if (resUnit >= RESUNIT_NONE && resUnit <= RESUNIT_CENTIMETER)
-        {
-            CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_RESOLUTIONUNIT, resUnit));
-        }
-        if (dpiX >= 0)
-        {
-            CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_XRESOLUTION, (float)dpiX));
-        }
-        if (dpiY >= 0)
+bool TiffEncoder::writePageTiles( void* tif_, const Mat& img )
+{
+    TIFF* tif = (TIFF*)tif_;
+    CV_Assert(tif);
+    CV_Assert(m_tile_size > 0);
+
+    const int tileSize = m_tile_size;
+    const int channels = img.channels();
+    // the tiles on the right and bottom edges are padded with zeros
+    Mat tile(tileSize, tileSize, m_sgilog ? CV_32FC3 : img.type());
+    const tmsize_t tileBytes = (tmsize_t)(tile.total() * tile.elemSize());
+    CV_CheckEQ((size_t)TIFFTileSize(tif), (size_t)tileBytes, "");
+
+    for (int y = 0; y < img.rows; y += tileSize)
+    {
+        for (int x = 0; x < img.cols; x += tileSize)
         {
-            CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_YRESOLUTION, (float)dpiY));
+            const Rect r = Rect(x, y, tileSize, tileSize) & Rect(0, 0, img.cols, img.rows);
+            if (r.size() != tile.size())
+                tile.setTo(Scalar::all(0));
+            Mat dst = tile(Rect(0, 0, r.width, r.height));
+            if (m_sgilog)
+                cvtColor(img(r), dst, COLOR_BGR2XYZ);
+            else if (channels == 3)
+                extend_cvtColor(img(r), dst, COLOR_BGR2RGB);
+            else if (channels == 4)
+                extend_cvtColor(img(r), dst, COLOR_BGRA2RGBA);
+            else
+                img(r).copyTo(dst);
+            CV_TIFF_CHECK_CALL(TIFFWriteEncodedTile(tif, TIFFComputeTile(tif, x, y, 0, 0), tile.ptr(), tileBytes) != (tmsize_t)-1);
         }
+    }
+    return true;
+}
 
-        // row buffer, because TIFFWriteScanline modifies the original data!
-        size_t scanlineSize = TIFFScanlineSize(tif);
-        AutoBuffer<uchar> _buffer(scanlineSize + 32);
-        uchar* buffer = _buffer.data(); CV_DbgAssert(buffer);
-        Mat m_buffer(Size(width, 1), CV_MAKETYPE(depth, channels), buffer, (size_t)scanlineSize);
+bool TiffEncoder::writePageData( void* tif, const Mat& img )
+{
+    if (m_tile_size > 0)
+        return writePageTiles(tif, img);
+    return m_parallel ? writePageStrips(tif, img) : writePageRows(tif, img, 0);
+}
 
-        for (int y = 0; y < height; ++y)
-        {
-            switch (channels)
-            {
-                case 1:
-                {
-                    memcpy(buffer, img.ptr(y), scanlineSize);
-                    break;
-                }
+// the next level of the pyramid stored in the SubIFDs, pyrDown() doesn't support 8S and 32S
+static void pyrDownLevel( const Mat& src, Mat& dst )
+{
+    const int depth = src.depth();
+    if (depth == CV_8S || depth == CV_32S)
+    {
+        Mat tmp;
+        src.convertTo(tmp, CV_64F);
+        pyrDown(tmp, tmp);
+        tmp.convertTo(dst, depth);
+    }
+    else
+    {
+        pyrDown(src, dst);
+    }
+}
 
-                case 3:
-                {
-                    extend_cvtColor(img(Rect(0, y, width, 1)), (const Mat&)m_buffer, COLOR_BGR2RGB);
-                    break;
-                }
+// the number of the reduced resolution levels, a negative value asks for the levels until the image fits a tile
+static int countPyramidLevels( Size size, int levels, int tileSize )
+{
+    int count = 0;
+    while ((levels < 0 ? size.width > tileSize || size.height > tileSize : count < levels) &&
+           (size.width > 1 || size.height > 1))
+    {
+        size = Size((size.width + 1) / 2, (size.height + 1) / 2);
+        count++;
+    }
+    return count;
+}
 
-                case 4:
-                {
-                    extend_cvtColor(img(Rect(0, y, width, 1)), (const Mat&)m_buffer, COLOR_BGRA2RGBA);
-                    break;
-                }
+bool TiffEncoder::writeLibTiff( const std::vector<Mat>& img_vec, const std::vector<int>& params)
+{
+    // do NOT put "wb" as the mode, because the b means "big endian" mode, not "binary" mode.
+    // http://www.simplesystems.org/libtiff/functions/TIFFOpen.html
+    TIFF* tif = NULL;
 
-                default:
-                {
-                    CV_Assert(0);
-                }
-            }
+    TiffEncoderBufHelper buf_helper(m_buf);
+    if ( m_buf )
+    {
+        tif = buf_helper.open();
+    }
+    else
+    {
+        tif = TIFFOpen(m_filename.c_str(), "w");
+    }
+    if (!tif)
+    {
+        return false;
+    }
+    cv::Ptr<void> tif_cleanup(tif, cv_tiffCloseHandle);
+
+    int pyramidLevels = 0;
+    readParam(params, IMWRITE_TIFF_PYRAMID_LEVELS, pyramidLevels);
+
+    //Iterate through each image in the vector and write them out as Tiff directories
+    for (size_t page = 0; page < img_vec.size(); page++)
+    {
+        const Mat& img = img_vec[page];
+        CV_Assert(!img.empty());
+
+        if (!writePageHeader(tif, img.size(), img.type(), params))
+            return false;
 
-            CV_TIFF_CHECK_CALL(TIFFWriteScanline(tif, buffer, y, 0) == 1);
+        if (img_vec.size() > 1)
+        {
+            CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_SUBFILETYPE, FILETYPE_PAGE));
+            CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_PAGENUMBER, page, img_vec.size()));
         }
 
+        // libtiff writes the directories following the page as its SubIFDs and fills their offsets
+        const int levels = countPyramidLevels(img.size(), pyramidLevels, m_tile_size);
+        if (levels > 0)
+        {
+            std::vector<toff_t> offsets(levels, 0);
+            CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_SUBIFD, (uint16_t)levels, &offsets[0]));
+        }
+
+        if (!writePageData(tif, img))
+            return false;
+
         CV_TIFF_CHECK_CALL(TIFFWriteDirectory(tif));
+
+        Mat level = img;
+        for (int i = 0; i < levels; i++)
+        {
+            pyrDownLevel(level, level);
+            if (!writePageHeader(tif, level.size(), level.type(), params))
+                return false;
+            CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_SUBFILETYPE, FILETYPE_REDUCEDIMAGE));
+            if (!writePageData(tif, level))
+                return false;
+            CV_TIFF_CHECK_CALL(TIFFWriteDirectory(tif));
+        }
     }
 
     return true;
 }
 
-bool TiffEncoder::write_32FC3_SGILOG(const Mat& _img, void* tif_)
+bool TiffEncoder::startWriteRows( Size size, int type, const std::vector<int>& params )
 {
-    TIFF* tif = (TIFF*)tif_;
-    CV_Assert(tif);
+    // only to a file, the pages written to a memory buffer are kept in it anyway;
+    // the tiles and the pyramid levels need the whole image
+    m_tif.release();
+    int value = 0;
+    if (m_buf || readParam(params, IMWRITE_TIFF_TILE_SIZE, value) ||
+        (readParam(params, IMWRITE_TIFF_PYRAMID_LEVELS, value) && value != 0))
+        return false;
 
-    Mat img;
-    cvtColor(_img, img, COLOR_BGR2XYZ);
+    TIFF* tif = TIFFOpen(m_filename.c_str(), "w");
+    if (!tif)
+        return false;
+    m_tif.reset(tif, cv_tiffCloseHandle);
 
-    //done by caller: CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, img.cols));
-    //done by caller: CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_IMAGELENGTH, img.rows));
-    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, 3));
-    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, 32));
-    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_COMPRESSION, COMPRESSION_SGILOG));
-    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_LOGLUV));
-    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG));
-    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_SGILOGDATAFMT, SGILOGDATAFMT_FLOAT));
-    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, 1));
-    const int strip_size = 3 * img.cols;
-    for (int i = 0; i < img.rows; i++)
+    if (!writePageHeader(tif, size, type, params))
     {
-        CV_TIFF_CHECK_CALL(TIFFWriteEncodedStrip(tif, i, (tdata_t)img.ptr<float>(i), strip_size * sizeof(float)) != (tsize_t)-1);
+        m_tif.release();
+        return false;
     }
-    CV_TIFF_CHECK_CALL(TIFFWriteDirectory(tif));
+    m_parallel = false;  // the bands are not aligned to the strips
+    m_rows_written = 0;
+    return true;
+}
+
+bool TiffEncoder::writeRows( const Mat& band )
+{
+    CV_Assert(!m_tif.empty());
+    if (!writePageRows(m_tif.get(), band, m_rows_written))
+        return false;
+    m_rows_written += band.rows;
+    return true;
+}
+
+bool TiffEncoder::finishWriteRows()
+{
+    CV_Assert(!m_tif.empty());
+    CV_TIFF_CHECK_CALL(TIFFWriteDirectory((TIFF*)m_tif.get()));
+    m_tif.release();
     return true;
 }
 
@@ -98,6 +98,11 @@ public:
 
     bool  readHeader() CV_OVERRIDE;
     bool  readData( Mat& img ) CV_OVERRIDE;
+    bool  setROI( const Rect& roi ) CV_OVERRIDE;
+    int   getLevelCount() const CV_OVERRIDE;
+    bool  setLevel( int level ) CV_OVERRIDE;
+    bool  startReadRows( int type ) CV_OVERRIDE;
+    bool  readRows( Mat& band ) CV_OVERRIDE;
     void  close();
     bool  nextPage() CV_OVERRIDE;
 
@@ -110,6 +115,11 @@ protected:
     int normalizeChannelsNumber(int channels) const;
     bool m_hdr;
     size_t m_buf_pos;
+    int m_rows_read;  // rows returned by readRows()
+    bool m_read_rows;  // readData() is called by readRows()
+    Mat m_rows_cache;  // the last row of strips (tiles) decoded by readRows()
+    int m_rows_cache_y;  // its first row, -1 if there is none
+    std::vector<uint64> m_level_offsets;  // SubIFDs of the page, the reduced resolution levels
 
 private:
     TiffDecoder(const TiffDecoder &); // copy disabled
@@ -129,11 +139,27 @@ public:
 
     bool writemulti(const std::vector<Mat>& img_vec, const std::vector<int>& params) CV_OVERRIDE;
 
+    bool  startWriteRows( Size size, int type, const std::vector<int>& params ) CV_OVERRIDE;
+    bool  writeRows( const Mat& band ) CV_OVERRIDE;
+    bool  finishWriteRows() CV_OVERRIDE;
+
     ImageEncoder newEncoder() const CV_OVERRIDE;
 
 protected:
     bool writeLibTiff( const std::vector<Mat>& img_vec, const std::vector<int>& params );
-    bool write_32FC3_SGILOG(const Mat& img, void* tif);
+    bool writePageHeader( void* tif, Size size, int type, const std::vector<int>& params );
+    bool writePageRows( void* tif, const Mat& img, int y0 );
+    bool writePageStrips( void* tif, const Mat& img );
+    bool writePageTiles( void* tif, const Mat& img );
+    bool writePageData( void* tif, const Mat& img );
+
+    cv::Ptr<void> m_tif;  // file written by rows
+    bool m_sgilog;        // the page is written as 32FC3 SGILOG
+    int m_rows_written;
+    bool m_parallel;      // the deflate strips of the page are compressed in parallel
+    int m_predictor;
+    int m_rows_per_strip;
+    int m_tile_size;      // the page is written in square tiles of this size, 0 for strips
 
 private:
     TiffEncoder(const TiffEncoder &); // copy disabled
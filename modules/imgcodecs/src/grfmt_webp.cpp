@@ -66,6 +66,7 @@ static const size_t WEBP_HEADER_SIZE = 32;
 
 WebPDecoder::WebPDecoder()
 {
+    m_codec_name = "webp";
     m_buf_supported = true;
     channels = 0;
     fs_size = 0;
@@ -168,9 +169,11 @@ bool WebPDecoder::readData(Mat &img)
     {
         Mat read_img;
         CV_CheckType(img.type(), img.type() == CV_8UC1 || img.type() == CV_8UC3 || img.type() == CV_8UC4, "");
-        if (img.type() != m_type)
+        // libwebp decodes directly into 3 or 4 channels (dropping the alpha or setting it to 255),
+        // so only the grayscale images need a temporary buffer
+        if (img.type() == CV_8UC1)
         {
-            read_img.create(m_height, m_width, m_type);
+            read_img.create(m_height, m_width, CV_8UC3);
         }
         else
         {
@@ -181,9 +184,8 @@ bool WebPDecoder::readData(Mat &img)
         size_t out_data_size = read_img.dataend - out_data;
 
         uchar *res_ptr = NULL;
-        if (channels == 3)
+        if (read_img.channels() == 3)
         {
-            CV_CheckTypeEQ(read_img.type(), CV_8UC3, "");
             if (m_use_rgb)
                 res_ptr = WebPDecodeRGBInto(data.ptr(), data.total(), out_data,
                                             (int)out_data_size, (int)read_img.step);
@@ -191,9 +193,8 @@ bool WebPDecoder::readData(Mat &img)
                 res_ptr = WebPDecodeBGRInto(data.ptr(), data.total(), out_data,
                                             (int)out_data_size, (int)read_img.step);
         }
-        else if (channels == 4)
+        else
         {
-            CV_CheckTypeEQ(read_img.type(), CV_8UC4, "");
             if (m_use_rgb)
                 res_ptr = WebPDecodeRGBAInto(data.ptr(), data.total(), out_data,
                                              (int)out_data_size, (int)read_img.step);
@@ -205,26 +206,10 @@ bool WebPDecoder::readData(Mat &img)
         if (res_ptr != out_data)
             return false;
 
-        if (read_img.data == img.data && img.type() == m_type)
-        {
-            // nothing
-        }
-        else if (img.type() == CV_8UC1)
+        if (read_img.data != img.data)
         {
             cvtColor(read_img, img, COLOR_BGR2GRAY);
         }
-        else if (img.type() == CV_8UC3 && m_type == CV_8UC4)
-        {
-            cvtColor(read_img, img, COLOR_BGRA2BGR);
-        }
-        else if (img.type() == CV_8UC4 && m_type == CV_8UC3)
-        {
-            cvtColor(read_img, img, COLOR_BGR2BGRA);
-        }
-        else
-        {
-            CV_Error(Error::StsInternal, "");
-        }
     }
     return true;
 }
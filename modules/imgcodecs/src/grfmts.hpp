@@ -49,6 +49,7 @@
 #include "grfmt_jpeg.hpp"
 #include "grfmt_pxm.hpp"
 #include "grfmt_pfm.hpp"
+#include "grfmt_cvfl.hpp"
 #include "grfmt_tiff.hpp"
 #include "grfmt_spng.hpp"
 #include "grfmt_png.hpp"
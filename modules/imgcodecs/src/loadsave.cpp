@@ -52,8 +52,10 @@
 #include <iostream>
 #include <fstream>
 #include <cerrno>
+#include <atomic>
 #include <opencv2/core/utils/logger.hpp>
 #include <opencv2/core/utils/configuration.private.hpp>
+#include <opencv2/core/utils/tls.hpp>
 #include <opencv2/imgcodecs.hpp>
 
 
@@ -69,7 +71,7 @@ static const size_t CV_IO_MAX_IMAGE_WIDTH = utils::getConfigurationParameterSize
 static const size_t CV_IO_MAX_IMAGE_HEIGHT = utils::getConfigurationParameterSizeT("OPENCV_IO_MAX_IMAGE_HEIGHT", 1 << 20);
 static const size_t CV_IO_MAX_IMAGE_PIXELS = utils::getConfigurationParameterSizeT("OPENCV_IO_MAX_IMAGE_PIXELS", 1 << 30);
 
-static Size validateInputImageSize(const Size& size)
+Size validateInputImageSize(const Size& size)
 {
     CV_Assert(size.width > 0);
     CV_Assert(static_cast<size_t>(size.width) <= CV_IO_MAX_IMAGE_WIDTH);
@@ -185,6 +187,10 @@ struct ImageCodecInitializer
         decoders.push_back( makePtr<PFMDecoder>() );
         encoders.push_back( makePtr<PFMEncoder>() );
     #endif
+    #ifdef HAVE_IMGCODEC_CVFL
+        decoders.push_back( makePtr<CvflDecoder>() );
+        encoders.push_back( makePtr<CvflEncoder>() );
+    #endif
     #ifdef HAVE_TIFF
         decoders.push_back( makePtr<TiffDecoder>() );
         encoders.push_back( makePtr<TiffEncoder>() );
@@ -392,6 +398,28 @@ static void ApplyExifOrientation(ExifEntry_t orientationTag, OutputArray img)
     }
 }
 
+/**
+ * Clip the requested region to the image and offer it to the decoder
+ *
+ * @param[in] decoder Decoder after readHeader()
+ * @param[in] roi Requested region in the coordinates of the resulting (possibly reduced) image
+ * @param[in] scale_denom Reduction applied after decoding, 1 if the decoder scales by itself
+ * @param[in,out] size Size of the Mat passed to readData()
+ * @param[out] crop Region to cut from the decoded image when the decoder can't decode the region only
+ * @return false if the region doesn't intersect the image
+*/
+static bool setupROI(ImageDecoder& decoder, const Rect& roi, int scale_denom, Size& size, Rect& crop)
+{
+    const Rect r = roi & Rect(0, 0, size.width / scale_denom, size.height / scale_denom);
+    if (r.empty())
+        return false;
+    if (scale_denom == 1 && decoder->setROI(r))
+        size = r.size();
+    else
+        crop = r;
+    return true;
+}
+
 /**
  * Read an image into memory and return the information
  *
@@ -401,7 +429,8 @@ static void ApplyExifOrientation(ExifEntry_t orientationTag, OutputArray img)
  *
 */
 static bool
-imread_( const String& filename, int flags, OutputArray mat )
+imread_( const String& filename, int flags, OutputArray mat, const Rect* roi = NULL,
+         const Size* dsize = NULL, bool exact = true, int level = 0 )
 {
     /// Search for the relevant decoder to handle the imagery
     ImageDecoder decoder;
@@ -422,7 +451,7 @@ imread_( const String& filename, int flags, OutputArray mat )
     }
 
     int scale_denom = 1;
-    if( flags > IMREAD_LOAD_GDAL )
+    if( flags > IMREAD_LOAD_GDAL && !dsize )
     {
         if( flags & IMREAD_REDUCED_GRAYSCALE_2 )
             scale_denom = 2;
@@ -441,6 +470,8 @@ imread_( const String& filename, int flags, OutputArray mat )
     /// set the scale_denom in the driver
     decoder->setScale( scale_denom );
 
+    const bool scaledByDecoder = dsize && decoder->setTargetSize( *dsize, exact );
+
     /// set the filename in the driver
     decoder->setSource( filename );
 
@@ -449,6 +480,8 @@ imread_( const String& filename, int flags, OutputArray mat )
         // read the header to make sure it succeeds
         if( !decoder->readHeader() )
             return 0;
+        if( level != 0 && !decoder->setLevel( level ) )
+            return 0;
     }
     catch (const cv::Exception& e)
     {
@@ -468,6 +501,13 @@ imread_( const String& filename, int flags, OutputArray mat )
     // grab the decoded type
     const int type = calcType(decoder->type(), flags);
 
+    // if decoder is JpegDecoder then decoder->setScale always returns 1
+    const bool resizeAfter = decoder->setScale( scale_denom ) > 1;
+
+    Rect crop;
+    if( roi && !setupROI(decoder, *roi, resizeAfter ? scale_denom : 1, size, crop) )
+        return false;
+
     if (mat.empty())
     {
         mat.create( size.height, size.width, type );
@@ -505,13 +545,24 @@ imread_( const String& filename, int flags, OutputArray mat )
         return false;
     }
 
-    if( decoder->setScale( scale_denom ) > 1 ) // if decoder is JpegDecoder then decoder->setScale always returns 1
+    if( resizeAfter )
     {
         resize( mat, mat, Size( size.width / scale_denom, size.height / scale_denom ), 0, 0, INTER_LINEAR_EXACT);
     }
 
+    if( !crop.empty() )
+    {
+        Mat cropped = mat.getMat()(crop).clone();
+        mat.assign(cropped);
+    }
+
+    if( dsize && mat.size() != *dsize && (exact || !scaledByDecoder) )
+    {
+        resize( mat, mat, *dsize, 0, 0, INTER_AREA );
+    }
+
     /// optionally rotate the data if EXIF orientation flag says so
-    if (!mat.empty() && (flags & IMREAD_IGNORE_ORIENTATION) == 0 && flags != IMREAD_UNCHANGED )
+    if (!mat.empty() && !roi && (flags & IMREAD_IGNORE_ORIENTATION) == 0 && flags != IMREAD_UNCHANGED )
     {
         ApplyExifOrientation(decoder->getExifTag(ORIENTATION), mat);
     }
@@ -649,6 +700,39 @@ Mat imread( const String& filename, int flags )
     return img;
 }
 
+Mat imreadROI( const String& filename, const Rect& roi, int flags )
+{
+    CV_TRACE_FUNCTION();
+    CV_CheckGT(roi.width, 0, ""); CV_CheckGT(roi.height, 0, "");
+
+    Mat img;
+    imread_( filename, flags, img, &roi );
+
+    return img;
+}
+
+Mat imreadLevel( const String& filename, int level, int flags, const Rect& roi )
+{
+    CV_TRACE_FUNCTION();
+    CV_CheckGE(level, 0, "");
+
+    Mat img;
+    imread_( filename, flags, img, roi.empty() ? NULL : &roi, NULL, true, level );
+
+    return img;
+}
+
+Mat imreadScaled( const String& filename, Size dsize, int flags, bool exact )
+{
+    CV_TRACE_FUNCTION();
+    CV_CheckGT(dsize.width, 0, ""); CV_CheckGT(dsize.height, 0, "");
+
+    Mat img;
+    imread_( filename, flags, img, NULL, &dsize, exact );
+
+    return img;
+}
+
 void imread( const String& filename, OutputArray dst, int flags )
 {
     CV_TRACE_FUNCTION();
@@ -702,6 +786,65 @@ size_t imcount(const String& filename, int flags)
     return imcount_(filename, flags);
 }
 
+ImageHeader::ImageHeader()
+    : width(0), height(0), channels(0), depth(-1), pageCount(0), levelCount(0), orientation(IMAGE_ORIENTATION_TL)
+{
+}
+
+// fills the image properties from a decoder after a successful readHeader()
+static bool getImageHeader( const ImageDecoder& decoder, ImageHeader& header )
+{
+    const int type = decoder->type();
+    if( decoder->width() <= 0 || decoder->height() <= 0 || type < 0 )
+        return false;
+
+    header.width = decoder->width();
+    header.height = decoder->height();
+    header.channels = CV_MAT_CN(type);
+    header.depth = CV_MAT_DEPTH(type);
+    header.pageCount = (int)decoder->getFrameCount();
+    header.levelCount = decoder->getLevelCount();
+    ExifEntry_t orientationTag = decoder->getExifTag(ORIENTATION);
+    if( orientationTag.tag != INVALID_TAG )
+        header.orientation = orientationTag.field_u16;
+    header.codec = decoder->getCodecName();
+    return true;
+}
+
+static bool imreadHeader_( const String& filename, ImageHeader& header )
+{
+    ImageDecoder decoder = findDecoder( filename );
+    if( !decoder )
+        return false;
+
+    decoder->setSource( filename );
+    try
+    {
+        if( !decoder->readHeader() )
+            return false;
+    }
+    catch (const cv::Exception& e)
+    {
+        CV_LOG_ERROR(NULL, "imreadHeader_('" << filename << "'): can't read header: " << e.what());
+        return false;
+    }
+    catch (...)
+    {
+        CV_LOG_ERROR(NULL, "imreadHeader_('" << filename << "'): can't read header: unknown exception");
+        return false;
+    }
+
+    return getImageHeader( decoder, header );
+}
+
+bool imreadHeader( const String& filename, ImageHeader& header )
+{
+    CV_TRACE_FUNCTION();
+
+    header = ImageHeader();
+    return imreadHeader_( filename, header );
+}
+
 
 static bool imwrite_( const String& filename, const std::vector<Mat>& img_vec,
                       const std::vector<int>& params_, bool flipv )
@@ -813,8 +956,42 @@ bool imwrite( const String& filename, InputArray _img,
     return imwrite_(filename, img_vec, params, false);
 }
 
+/**
+ * Find the decoder, checking the decoder of the previous buffer first
+ *
+ * The decoder of the previous buffer is reused with its codec context when it supports
+ * BaseImageDecoder::reset(), otherwise a new instance of it is created.
+ *
+ * @param[in] buf Buffer to search
+ * @param[in,out] last Decoder found for the previous buffer, updated
+*/
+static ImageDecoder findDecoder( const Mat& buf, ImageDecoder& last )
+{
+    if( last )
+    {
+        size_t len = std::min(last->signatureLength(), buf.total()*buf.elemSize());
+        if( last->checkSignature(String((const char*)buf.ptr(), len)) )
+            return last->reset() ? last : (last = last->newDecoder());
+    }
+    return last = findDecoder(buf);
+}
+
+/**
+ * Decode an image from a buffer
+ *
+ * @param[in] buf Encoded data
+ * @param[in] flags Flags
+ * @param[out] mat Decoded image, reused if the size and the type match
+ * @param[in] roi Optional region to decode, see imdecodeROI()
+ * @param[in] dsize Optional size to scale the image to, see imdecodeScaled()
+ * @param[in] exact Whether the result must have exactly dsize, see imdecodeScaled()
+ * @param[in,out] lastDecoder Optional decoder of the previous call, see imdecodeBatch()
+ * @param[out] error Optional description of the failure
+*/
 static bool
-imdecode_( const Mat& buf, int flags, Mat& mat )
+imdecode_( const Mat& buf, int flags, Mat& mat, const Rect* roi = NULL,
+           const Size* dsize = NULL, bool exact = true,
+           ImageDecoder* lastDecoder = NULL, String* error = NULL )
 {
     CV_Assert(!buf.empty());
     CV_Assert(buf.isContinuous());
@@ -823,12 +1000,16 @@ imdecode_( const Mat& buf, int flags, Mat& mat )
 
     String filename;
 
-    ImageDecoder decoder = findDecoder(buf_row);
+    ImageDecoder decoder = lastDecoder ? findDecoder(buf_row, *lastDecoder) : findDecoder(buf_row);
     if( !decoder )
+    {
+        if (error)
+            *error = "unknown image format";
         return false;
+    }
 
     int scale_denom = 1;
-    if( flags > IMREAD_LOAD_GDAL )
+    if( flags > IMREAD_LOAD_GDAL && !dsize )
     {
         if( flags & IMREAD_REDUCED_GRAYSCALE_2 )
             scale_denom = 2;
@@ -847,6 +1028,8 @@ imdecode_( const Mat& buf, int flags, Mat& mat )
     /// set the scale_denom in the driver
     decoder->setScale( scale_denom );
 
+    const bool scaledByDecoder = dsize && decoder->setTargetSize( *dsize, exact );
+
     if( !decoder->setSource(buf_row) )
     {
         filename = tempfile();
@@ -875,6 +1058,8 @@ imdecode_( const Mat& buf, int flags, Mat& mat )
     catch (const cv::Exception& e)
     {
         CV_LOG_ERROR(NULL, "imdecode_('" << filename << "'): can't read header: " << e.what());
+        if (error)
+            *error = e.what();
     }
     catch (...)
     {
@@ -882,6 +1067,8 @@ imdecode_( const Mat& buf, int flags, Mat& mat )
     }
     if (!success)
     {
+        if (error && error->empty())
+            *error = "can't read header";
         decoder.release();
         if (!filename.empty())
         {
@@ -898,21 +1085,38 @@ imdecode_( const Mat& buf, int flags, Mat& mat )
 
     const int type = calcType(decoder->type(), flags);
 
-    mat.create( size.height, size.width, type );
+    // if decoder is JpegDecoder then decoder->setScale always returns 1
+    const bool resizeAfter = decoder->setScale( scale_denom ) > 1;
 
-    success = false;
-    try
-    {
-        if (decoder->readData(mat))
-            success = true;
-    }
-    catch (const cv::Exception& e)
+    Rect crop;
+    success = !roi || setupROI(decoder, *roi, resizeAfter ? scale_denom : 1, size, crop);
+
+    if (success)
     {
-        CV_LOG_ERROR(NULL, "imdecode_('" << filename << "'): can't read data: " << e.what());
+        mat.create( size.height, size.width, type );
+
+        success = false;
+        try
+        {
+            if (decoder->readData(mat))
+                success = true;
+        }
+        catch (const cv::Exception& e)
+        {
+            CV_LOG_ERROR(NULL, "imdecode_('" << filename << "'): can't read data: " << e.what());
+            if (error)
+                *error = e.what();
+        }
+        catch (...)
+        {
+            CV_LOG_ERROR(NULL, "imdecode_('" << filename << "'): can't read data: unknown exception");
+        }
+        if (!success && error && error->empty())
+            *error = "can't read data";
     }
-    catch (...)
+    else if (error)
     {
-        CV_LOG_ERROR(NULL, "imdecode_('" << filename << "'): can't read data: unknown exception");
+        *error = "the region is outside of the image";
     }
 
     if (!filename.empty())
@@ -928,13 +1132,21 @@ imdecode_( const Mat& buf, int flags, Mat& mat )
         return false;
     }
 
-    if( decoder->setScale( scale_denom ) > 1 ) // if decoder is JpegDecoder then decoder->setScale always returns 1
+    if( resizeAfter )
     {
         resize(mat, mat, Size( size.width / scale_denom, size.height / scale_denom ), 0, 0, INTER_LINEAR_EXACT);
     }
 
+    if( !crop.empty() )
+        mat = mat(crop).clone();
+
+    if( dsize && mat.size() != *dsize && (exact || !scaledByDecoder) )
+    {
+        resize(mat, mat, *dsize, 0, 0, INTER_AREA);
+    }
+
     /// optionally rotate the data if EXIF' orientation flag says so
-    if (!mat.empty() && (flags & IMREAD_IGNORE_ORIENTATION) == 0 && flags != IMREAD_UNCHANGED)
+    if (!mat.empty() && !roi && (flags & IMREAD_IGNORE_ORIENTATION) == 0 && flags != IMREAD_UNCHANGED)
     {
         ApplyExifOrientation(decoder->getExifTag(ORIENTATION), mat);
     }
@@ -966,6 +1178,78 @@ Mat imdecode( InputArray _buf, int flags, Mat* dst )
         return cv::Mat();
 }
 
+int imdecodeBatch( InputArrayOfArrays _bufs, int flags, std::vector<Mat>& dst, std::vector<String>& errors )
+{
+    CV_TRACE_FUNCTION();
+
+    const int n = (int)_bufs.total();
+    dst.resize(n);
+    errors.assign(n, String());
+    if (n == 0)
+        return 0;
+
+    // signature of the previous buffer decoded by the thread is checked first, see findDecoder()
+    TLSData<ImageDecoder> lastDecoders;
+    std::atomic<int> decoded(0);
+    parallel_for_(Range(0, n), [&](const Range& range)
+    {
+        ImageDecoder& lastDecoder = lastDecoders.getRef();
+        for (int i = range.start; i < range.end; i++)
+        {
+            Mat buf = _bufs.getMat(i);
+            bool ok = false;
+            if (buf.empty())
+                errors[i] = "empty buffer";
+            else
+            {
+                try
+                {
+                    ok = imdecode_(buf, flags, dst[i], NULL, NULL, true, &lastDecoder, &errors[i]);
+                }
+                catch (const cv::Exception& e)
+                {
+                    errors[i] = e.what();
+                }
+            }
+            if (ok)
+                decoded++;
+            else
+                dst[i].release();
+        }
+    });
+    return decoded;
+}
+
+int imdecodeBatch( InputArrayOfArrays bufs, int flags, std::vector<Mat>& dst )
+{
+    std::vector<String> errors;
+    return imdecodeBatch(bufs, flags, dst, errors);
+}
+
+Mat imdecodeScaled( InputArray _buf, Size dsize, int flags, bool exact )
+{
+    CV_TRACE_FUNCTION();
+    CV_CheckGT(dsize.width, 0, ""); CV_CheckGT(dsize.height, 0, "");
+
+    Mat buf = _buf.getMat(), img;
+    if (!imdecode_(buf, flags, img, NULL, &dsize, exact))
+        img.release();
+
+    return img;
+}
+
+Mat imdecodeROI( InputArray _buf, const Rect& roi, int flags )
+{
+    CV_TRACE_FUNCTION();
+    CV_CheckGT(roi.width, 0, ""); CV_CheckGT(roi.height, 0, "");
+
+    Mat buf = _buf.getMat(), img;
+    if (!imdecode_(buf, flags, img, &roi))
+        img.release();
+
+    return img;
+}
+
 static bool
 imdecodemulti_(const Mat& buf, int flags, std::vector<Mat>& mats, int start, int count)
 {
@@ -1121,6 +1405,248 @@ bool imdecodemulti(InputArray _buf, int flags, CV_OUT std::vector<Mat>& mats, co
     }
 }
 
+// sets the buffer as the decoder source; if the decoder can read files only,
+// the buffer is written to a temporary file, its name is returned in filename
+static bool setBufferSource( const ImageDecoder& decoder, const Mat& buf_row, String& filename )
+{
+    if( decoder->setSource(buf_row) )
+        return true;
+
+    filename = tempfile();
+    FILE* f = fopen( filename.c_str(), "wb" );
+    if( !f )
+    {
+        filename.clear();
+        return false;
+    }
+    size_t bufSize = buf_row.total()*buf_row.elemSize();
+    bool written = fwrite(buf_row.ptr(), 1, bufSize, f) == bufSize;
+    written = fclose(f) == 0 && written;
+    if( !written )
+    {
+        remove(filename.c_str());
+        CV_Error( Error::StsError, "failed to write image data to temporary file" );
+    }
+    return decoder->setSource(filename);
+}
+
+static bool imdecodeHeader_( const Mat& buf, ImageHeader& header )
+{
+    CV_Assert(buf.isContinuous());
+    CV_Assert(buf.checkVector(1, CV_8U) > 0);
+    Mat buf_row = buf.reshape(1, 1);  // decoders expects single row, avoid issues with vector columns
+
+    ImageDecoder decoder = findDecoder(buf_row);
+    if( !decoder )
+        return false;
+
+    String filename;
+    if( !setBufferSource(decoder, buf_row, filename) )
+        return false;
+
+    bool success = false;
+    try
+    {
+        success = decoder->readHeader() && getImageHeader( decoder, header );
+    }
+    catch (const cv::Exception& e)
+    {
+        CV_LOG_ERROR(NULL, "imdecodeHeader_('" << filename << "'): can't read header: " << e.what());
+    }
+    catch (...)
+    {
+        CV_LOG_ERROR(NULL, "imdecodeHeader_('" << filename << "'): can't read header: unknown exception");
+    }
+
+    decoder.release();
+    if( !filename.empty() && 0 != remove(filename.c_str()) )
+        CV_LOG_WARNING(NULL, "unable to remove temporary file:" << filename);
+    return success;
+}
+
+bool imdecodeHeader( InputArray _buf, ImageHeader& header )
+{
+    CV_TRACE_FUNCTION();
+
+    header = ImageHeader();
+    Mat buf = _buf.getMat();
+    if( buf.empty() )
+        return false;
+    return imdecodeHeader_( buf, header );
+}
+
+// the number of bytes decoded at once when the image is converted to the destination layout or depth
+static const size_t IMDECODE_TO_BAND_SIZE = 1 << 18;
+
+// writes the decoded rows [y, y + src.rows) to the destination:
+// an interleaved image of dst_depth or the planes of dst_depth starting at planes[k]
+static void storeDecodedRows( const Mat& src, int y, Mat& dst, const std::vector<Mat>& planes, int dst_depth )
+{
+    if( planes.empty() )
+    {
+        Mat rows = dst.rowRange(y, y + src.rows);
+        src.convertTo(rows, dst_depth);
+        return;
+    }
+    Mat tmp = src;
+    if( src.depth() != dst_depth )
+        src.convertTo(tmp, dst_depth);
+    std::vector<Mat> rows(planes.size());
+    for( size_t k = 0; k < planes.size(); k++ )
+        rows[k] = planes[k].rowRange(y, y + src.rows);
+    split(tmp, &rows[0]);
+}
+
+// checks the destination layout, the planes are returned for a C x H x W or 1 x C x H x W destination;
+// returns false if the destination size doesn't match the image
+static bool getDestinationPlanes( const Mat& dst, Size size, int type, std::vector<Mat>& planes )
+{
+    const int cn = CV_MAT_CN(type);
+    Size dst_size;
+    if( dst.dims > 2 )
+    {
+        const int d = dst.dims - 3;
+        CV_Check(dst.dims, d == 0 || (d == 1 && dst.size[0] == 1), "imdecodeTo: planar destination must be C x H x W or 1 x C x H x W");
+        CV_CheckEQ(dst.channels(), 1, "imdecodeTo: planar destination must be single-channel");
+        CV_CheckEQ(dst.size[d], cn, "imdecodeTo: the number of planes must match the channels of the decoded image");
+        dst_size = Size(dst.size[d + 2], dst.size[d + 1]);
+        for( int k = 0; k < cn; k++ )
+            planes.push_back(Mat(dst_size, dst.depth(), dst.data + k*dst.step[d], dst.step[d + 1]));
+    }
+    else
+    {
+        CV_CheckEQ(dst.channels(), cn, "imdecodeTo: the channels of the destination must match the decoded image");
+        dst_size = dst.size();
+    }
+    if( dst_size != size )
+    {
+        CV_LOG_WARNING(NULL, "imdecodeTo: the image size " << size << " doesn't match the destination size " << dst_size);
+        return false;
+    }
+    return true;
+}
+
+static bool imdecodeTo_( const Mat& buf, int flags, InputOutputArray _dst )
+{
+    CV_Check(flags, flags == IMREAD_UNCHANGED ||
+             (flags & (IMREAD_LOAD_GDAL | IMREAD_REDUCED_GRAYSCALE_2 | IMREAD_REDUCED_GRAYSCALE_4 | IMREAD_REDUCED_GRAYSCALE_8)) == 0,
+             "imdecodeTo: IMREAD_LOAD_GDAL and IMREAD_REDUCED_* modes are not supported");
+    CV_Assert(buf.isContinuous());
+    CV_Assert(buf.checkVector(1, CV_8U) > 0);
+    Mat buf_row = buf.reshape(1, 1);  // decoders expects single row, avoid issues with vector columns
+
+    ImageDecoder decoder = findDecoder(buf_row);
+    if( !decoder )
+        return false;
+
+    if( flags & IMREAD_COLOR_RGB && flags != IMREAD_UNCHANGED )
+        decoder->setRGB(true);
+
+    String filename;
+    if( !setBufferSource(decoder, buf_row, filename) )
+        return false;
+
+    bool success = false;
+    try
+    {
+        success = decoder->readHeader();
+    }
+    catch (const cv::Exception& e)
+    {
+        CV_LOG_ERROR(NULL, "imdecodeTo_('" << filename << "'): can't read header: " << e.what());
+    }
+    catch (...)
+    {
+        CV_LOG_ERROR(NULL, "imdecodeTo_('" << filename << "'): can't read header: unknown exception");
+    }
+
+    Size size;
+    int type = -1;
+    Mat dst;
+    std::vector<Mat> planes;  // the planes of a C x H x W or 1 x C x H x W destination
+    if( success )
+    {
+        try
+        {
+            size = validateInputImageSize(Size(decoder->width(), decoder->height()));
+            type = calcType(decoder->type(), flags);
+            if( _dst.empty() )
+                _dst.create(size, type);
+            dst = _dst.getMat();
+            success = getDestinationPlanes(dst, size, type, planes);
+        }
+        catch (...)
+        {
+            // invalid destination
+            if( !filename.empty() )
+                remove(filename.c_str());
+            throw;
+        }
+    }
+
+    if( success )
+    {
+        success = false;
+        try
+        {
+            if( planes.empty() && dst.type() == type )
+            {
+                // the decoder writes into the destination, which may be a part of a larger array
+                Mat img = dst;
+                success = decoder->readData(img);
+                if( success && img.data != dst.data )
+                    img.copyTo(dst);
+            }
+            else if( decoder->startReadRows(type) )
+            {
+                // only a band of rows is kept in the decoded layout
+                const int band_rows = std::max(1, (int)(IMDECODE_TO_BAND_SIZE / ((size_t)size.width*CV_ELEM_SIZE(type))));
+                Mat band;
+                success = true;
+                for( int y = 0; success && y < size.height; y += band.rows )
+                {
+                    band.create(std::min(band_rows, size.height - y), size.width, type);
+                    success = decoder->readRows(band);
+                    if( success )
+                        storeDecodedRows(band, y, dst, planes, dst.depth());
+                }
+            }
+            else
+            {
+                Mat img(size, type);
+                success = decoder->readData(img);
+                if( success )
+                    storeDecodedRows(img, 0, dst, planes, dst.depth());
+            }
+        }
+        catch (const cv::Exception& e)
+        {
+            CV_LOG_ERROR(NULL, "imdecodeTo_('" << filename << "'): can't read data: " << e.what());
+            success = false;
+        }
+        catch (...)
+        {
+            CV_LOG_ERROR(NULL, "imdecodeTo_('" << filename << "'): can't read data: unknown exception");
+            success = false;
+        }
+    }
+
+    decoder.release();
+    if( !filename.empty() && 0 != remove(filename.c_str()) )
+        CV_LOG_WARNING(NULL, "unable to remove temporary file:" << filename);
+    return success;
+}
+
+bool imdecodeTo( InputArray _buf, int flags, InputOutputArray dst )
+{
+    CV_TRACE_FUNCTION();
+
+    Mat buf = _buf.getMat();
+    if( buf.empty() )
+        return false;
+    return imdecodeTo_(buf, flags, dst);
+}
+
 bool imencode( const String& ext, InputArray _image,
                std::vector<uchar>& buf, const std::vector<int>& params_ )
 {
@@ -1421,6 +1947,336 @@ ImageCollection::iterator ImageCollection::iterator::operator++(int) {
     return tmp;
 }
 
+
+class ImageStreamReader::Impl
+{
+public:
+    Impl() : m_flags(0), m_type(-1), m_row(0), m_byRows(false) {}
+    bool open(const String& filename, int flags);
+    int read(OutputArray band, int maxRows);
+    void release();
+
+    String m_filename;
+    ImageDecoder m_decoder;
+    int m_flags;
+    Size m_size;
+    int m_type;
+    int m_row;      // index of the next row
+    bool m_byRows;  // the decoder reads the image by rows
+    Mat m_image;    // the whole image if the decoder can't read it by rows
+};
+
+bool ImageStreamReader::Impl::open(const String& filename, int flags)
+{
+    release();
+    CV_Check(flags, flags == IMREAD_UNCHANGED ||
+             (flags & (IMREAD_LOAD_GDAL | IMREAD_REDUCED_GRAYSCALE_2 | IMREAD_REDUCED_GRAYSCALE_4 | IMREAD_REDUCED_GRAYSCALE_8)) == 0,
+             "ImageStreamReader: IMREAD_LOAD_GDAL and IMREAD_REDUCED_* modes are not supported");
+
+    ImageDecoder decoder = findDecoder(filename);
+    if (!decoder)
+        return false;
+
+    if (flags & IMREAD_COLOR_RGB && flags != IMREAD_UNCHANGED)
+        decoder->setRGB(true);
+
+    try
+    {
+        if (!decoder->setSource(filename) || !decoder->readHeader())
+            return false;
+
+        // only a band of rows is allocated, so the image may have more than OPENCV_IO_MAX_IMAGE_PIXELS
+        m_size = Size(decoder->width(), decoder->height());
+        CV_Assert(m_size.width > 0 && static_cast<size_t>(m_size.width) <= CV_IO_MAX_IMAGE_WIDTH);
+        CV_Assert(m_size.height > 0 && static_cast<size_t>(m_size.height) <= CV_IO_MAX_IMAGE_HEIGHT);
+        m_type = calcType(decoder->type(), flags);
+        m_byRows = decoder->startReadRows(m_type);
+    }
+    catch (const cv::Exception& e)
+    {
+        CV_LOG_ERROR(NULL, "ImageStreamReader('" << filename << "'): can't read header: " << e.what());
+        return false;
+    }
+    catch (...)
+    {
+        CV_LOG_ERROR(NULL, "ImageStreamReader('" << filename << "'): can't read header: unknown exception");
+        return false;
+    }
+    if (!m_byRows)
+        CV_LOG_INFO(NULL, "ImageStreamReader('" << filename << "'): the decoder can't read the image by rows, it is decoded completely");
+
+    m_filename = filename;
+    m_flags = flags;
+    m_decoder = decoder;
+    m_row = 0;
+    return true;
+}
+
+int ImageStreamReader::Impl::read(OutputArray band, int maxRows)
+{
+    CV_CheckGT(maxRows, 0, "");
+    const int rows = m_decoder ? std::min(maxRows, m_size.height - m_row) : 0;
+    if (rows <= 0)
+    {
+        band.release();
+        return 0;
+    }
+
+    bool success = false;
+    try
+    {
+        if (m_byRows)
+        {
+            band.create(rows, m_size.width, m_type);
+            Mat dst = band.getMat();
+            if (dst.isContinuous() || rows == 1)
+                success = m_decoder->readRows(dst);
+            else
+            {
+                Mat tmp(rows, m_size.width, m_type);
+                success = m_decoder->readRows(tmp);
+                tmp.copyTo(dst);
+            }
+        }
+        else
+        {
+            if (m_image.empty())
+            {
+                m_image.create(validateInputImageSize(m_size), m_type);
+                success = m_decoder->readData(m_image);
+            }
+            else
+                success = true;
+            if (success)
+                m_image.rowRange(m_row, m_row + rows).copyTo(band);
+        }
+    }
+    catch (const cv::Exception& e)
+    {
+        CV_LOG_ERROR(NULL, "ImageStreamReader('" << m_filename << "'): can't read data: " << e.what());
+    }
+    catch (...)
+    {
+        CV_LOG_ERROR(NULL, "ImageStreamReader('" << m_filename << "'): can't read data: unknown exception");
+    }
+    if (!success)
+    {
+        release();
+        band.release();
+        return 0;
+    }
+
+    m_row += rows;
+    if (m_row == m_size.height)
+    {
+        m_decoder.release();
+        m_image.release();
+    }
+    return rows;
+}
+
+void ImageStreamReader::Impl::release()
+{
+    m_decoder.release();
+    m_image.release();
+    m_filename = String();
+    m_size = Size();
+    m_type = -1;
+    m_row = 0;
+    m_byRows = false;
+}
+
+ImageStreamReader::ImageStreamReader() : pImpl(new Impl()) {}
+
+ImageStreamReader::ImageStreamReader(const String& filename, int flags) : pImpl(new Impl())
+{
+    pImpl->open(filename, flags);
+}
+
+ImageStreamReader::~ImageStreamReader() {}
+
+bool ImageStreamReader::open(const String& filename, int flags) { return pImpl->open(filename, flags); }
+
+bool ImageStreamReader::isOpened() const { return !pImpl->m_decoder.empty(); }
+
+void ImageStreamReader::release() { pImpl->release(); }
+
+Size ImageStreamReader::size() const { return pImpl->m_size; }
+
+int ImageStreamReader::type() const { return pImpl->m_type; }
+
+int ImageStreamReader::position() const { return pImpl->m_row; }
+
+int ImageStreamReader::read(OutputArray band, int maxRows) { return pImpl->read(band, maxRows); }
+
+
+class ImageStreamWriter::Impl
+{
+public:
+    Impl() : m_type(-1), m_wtype(-1), m_row(0), m_byRows(false) {}
+    ~Impl() { release(); }
+    bool open(const String& filename, Size size, int type, const std::vector<int>& params);
+    bool write(InputArray band);
+    void release();
+
+    String m_filename;
+    ImageEncoder m_encoder;
+    std::vector<int> m_params;
+    Size m_size;
+    int m_type;
+    int m_wtype;    // type of the encoded rows
+    int m_row;      // index of the next row
+    bool m_byRows;  // the encoder writes the image by rows
+    Mat m_image;    // the whole image if the encoder can't write it by rows
+};
+
+bool ImageStreamWriter::Impl::open(const String& filename, Size size, int type, const std::vector<int>& params)
+{
+    release();
+    CV_Assert(size.width > 0 && static_cast<size_t>(size.width) <= CV_IO_MAX_IMAGE_WIDTH);
+    CV_Assert(size.height > 0 && static_cast<size_t>(size.height) <= CV_IO_MAX_IMAGE_HEIGHT);
+    const int cn = CV_MAT_CN(type);
+    CV_Check(cn, cn == 1 || cn == 3 || cn == 4, "");
+    CV_Check(params.size(), (params.size() & 1) == 0, "Encoding 'params' must be key-value pairs");
+    CV_CheckLE(params.size(), (size_t)(CV_IO_MAX_IMAGE_PARAMS*2), "");
+
+    ImageEncoder encoder = findEncoder(filename);
+    if (!encoder)
+        CV_Error(Error::StsError, "could not find a writer for the specified extension");
+
+    int wtype = type;
+    if (!encoder->isFormatSupported(CV_MAT_DEPTH(type)))
+    {
+        CV_Assert(encoder->isFormatSupported(CV_8U));
+        wtype = CV_MAKETYPE(CV_8U, cn);
+    }
+
+    encoder->setDestination(filename);
+    bool byRows = false;
+    try
+    {
+        byRows = encoder->startWriteRows(size, wtype, params);
+    }
+    catch (const cv::Exception& e)
+    {
+        CV_LOG_ERROR(NULL, "ImageStreamWriter('" << filename << "'): can't write header: " << e.what());
+        return false;
+    }
+    catch (...)
+    {
+        CV_LOG_ERROR(NULL, "ImageStreamWriter('" << filename << "'): can't write header: unknown exception");
+        return false;
+    }
+    if (!byRows)
+    {
+        CV_LOG_INFO(NULL, "ImageStreamWriter('" << filename << "'): the encoder can't write the image by rows, it is kept in memory");
+        m_image.create(validateInputImageSize(size), wtype);
+    }
+
+    m_filename = filename;
+    m_encoder = encoder;
+    m_params = params;
+    m_size = size;
+    m_type = type;
+    m_wtype = wtype;
+    m_row = 0;
+    m_byRows = byRows;
+    return true;
+}
+
+bool ImageStreamWriter::Impl::write(InputArray _band)
+{
+    CV_Assert(m_encoder);
+    Mat band = _band.getMat();
+    CV_CheckEQ(band.cols, m_size.width, "");
+    CV_CheckEQ(band.type(), m_type, "");
+    CV_CheckLE(band.rows, m_size.height - m_row, "ImageStreamWriter: too many rows");
+
+    bool success = false;
+    try
+    {
+        if (m_wtype != m_type)
+        {
+            Mat temp;
+            band.convertTo(temp, m_wtype);
+            band = temp;
+        }
+        if (m_byRows)
+            success = m_encoder->writeRows(band);
+        else
+        {
+            band.copyTo(m_image.rowRange(m_row, m_row + band.rows));
+            success = true;
+        }
+
+        if (success && m_row + band.rows == m_size.height)
+            success = m_byRows ? m_encoder->finishWriteRows() : m_encoder->write(m_image, m_params);
+    }
+    catch (const cv::Exception& e)
+    {
+        CV_LOG_ERROR(NULL, "ImageStreamWriter('" << m_filename << "'): can't write data: " << e.what());
+    }
+    catch (...)
+    {
+        CV_LOG_ERROR(NULL, "ImageStreamWriter('" << m_filename << "'): can't write data: unknown exception");
+    }
+    if (!success)
+    {
+        release();
+        return false;
+    }
+
+    m_row += band.rows;
+    if (m_row == m_size.height)
+    {
+        m_encoder.release();
+        m_image.release();
+    }
+    return true;
+}
+
+void ImageStreamWriter::Impl::release()
+{
+    if (m_encoder)
+    {
+        // an incomplete file is not a valid image
+        CV_LOG_WARNING(NULL, "ImageStreamWriter('" << m_filename << "'): " << m_row << " of " << m_size.height
+                       << " rows are written, the file is removed");
+        m_encoder.release();
+        remove(m_filename.c_str());
+    }
+    m_image.release();
+    m_filename = String();
+    m_params.clear();
+    m_size = Size();
+    m_type = m_wtype = -1;
+    m_row = 0;
+    m_byRows = false;
+}
+
+ImageStreamWriter::ImageStreamWriter() : pImpl(new Impl()) {}
+
+ImageStreamWriter::ImageStreamWriter(const String& filename, Size size, int type, const std::vector<int>& params)
+    : pImpl(new Impl())
+{
+    pImpl->open(filename, size, type, params);
+}
+
+ImageStreamWriter::~ImageStreamWriter() {}
+
+bool ImageStreamWriter::open(const String& filename, Size size, int type, const std::vector<int>& params)
+{
+    return pImpl->open(filename, size, type, params);
+}
+
+bool ImageStreamWriter::isOpened() const { return !pImpl->m_encoder.empty(); }
+
+void ImageStreamWriter::release() { pImpl->release(); }
+
+int ImageStreamWriter::position() const { return pImpl->m_row; }
+
+bool ImageStreamWriter::write(InputArray band) { return pImpl->write(band); }
+
 }
 
 /* End of file. */
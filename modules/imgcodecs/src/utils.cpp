@@ -625,4 +625,74 @@ uchar* FillGrayRow1( uchar* data, uchar* indices, int len, uchar* palette )
     return data;
 }
 
+RowAreaResizer::RowAreaResizer( Size ssize, Mat& dst )
+    : m_ssize(ssize), m_dst(dst), m_cn(dst.channels()), m_y(0), m_dy(0)
+{
+    CV_Assert( dst.depth() == CV_8U && !dst.empty() );
+    CV_Assert( ssize.width >= dst.cols && ssize.height >= dst.rows );
+    const double scale_x = (double)ssize.width / dst.cols;
+    m_scale_y = (double)ssize.height / dst.rows;
+    m_norm = (float)(1. / (scale_x * m_scale_y));
+
+    // contributions of the source columns to the destination columns, see computeResizeAreaTab()
+    for( int dx = 0; dx < dst.cols; dx++ )
+    {
+        double fsx1 = dx * scale_x, fsx2 = std::min(fsx1 + scale_x, (double)ssize.width);
+        int sx1 = cvCeil(fsx1), sx2 = cvFloor(fsx2);
+        if( sx1 - fsx1 > 1e-3 )
+        {
+            Tab t = { sx1 - 1, dx, (float)(sx1 - fsx1) };
+            m_xtab.push_back(t);
+        }
+        for( int sx = sx1; sx < sx2; sx++ )
+        {
+            Tab t = { sx, dx, 1.f };
+            m_xtab.push_back(t);
+        }
+        if( fsx2 - sx2 > 1e-3 && sx2 < ssize.width )
+        {
+            Tab t = { sx2, dx, (float)(fsx2 - sx2) };
+            m_xtab.push_back(t);
+        }
+    }
+    m_row.resize((size_t)dst.cols * m_cn);
+    m_sum.assign((size_t)dst.cols * m_cn, 0.f);
+}
+
+void RowAreaResizer::addRow( const uchar* src )
+{
+    CV_Assert( m_y < m_ssize.height );
+    const int cn = m_cn;
+    std::fill(m_row.begin(), m_row.end(), 0.f);
+    for( size_t k = 0; k < m_xtab.size(); k++ )
+    {
+        const uchar* s = src + m_xtab[k].si * cn;
+        float* d = &m_row[m_xtab[k].di * cn];
+        const float w = m_xtab[k].w;
+        for( int c = 0; c < cn; c++ )
+            d[c] += s[c] * w;
+    }
+
+    // the source row [y, y+1) may contribute to several destination rows
+    const double y0 = m_y, y1 = m_y + 1;
+    while( m_dy < m_dst.rows )
+    {
+        const double dy0 = m_dy * m_scale_y, dy1 = std::min(dy0 + m_scale_y, (double)m_ssize.height);
+        const float w = (float)(std::min(y1, dy1) - std::max(y0, dy0));
+        if( w > 0 )
+        {
+            for( size_t i = 0; i < m_sum.size(); i++ )
+                m_sum[i] += m_row[i] * w;
+        }
+        if( y1 < dy1 - 1e-3 )
+            break;
+        uchar* d = m_dst.ptr(m_dy);
+        for( size_t i = 0; i < m_sum.size(); i++ )
+            d[i] = saturate_cast<uchar>(m_sum[i] * m_norm);
+        std::fill(m_sum.begin(), m_sum.end(), 0.f);
+        m_dy++;
+    }
+    m_y++;
+}
+
 }  // namespace
@@ -46,6 +46,9 @@ namespace cv {
 
 int validateToInt(size_t step);
 
+//! checks the image size against the OPENCV_IO_MAX_IMAGE_* limits, see loadsave.cpp
+Size validateInputImageSize(const Size& size);
+
 template <typename _Tp> static inline
 size_t safeCastToSizeT(const _Tp v_origin, const char* msg)
 {
@@ -135,6 +138,28 @@ uchar* FillGrayRow4( uchar* data, uchar* indices, int len, uchar* palette );
 uchar* FillColorRow1( uchar* data, uchar* indices, int len, PaletteEntry* palette );
 uchar* FillGrayRow1( uchar* data, uchar* indices, int len, uchar* palette );
 
+/** Downscales an 8-bit image with area interpolation (like INTER_AREA) while it is decoded.
+    The source rows are passed to addRow() top to bottom, each completed row of dst is written immediately,
+    so the whole source image is never kept in memory. */
+class RowAreaResizer
+{
+public:
+    RowAreaResizer( Size ssize, Mat& dst );
+    void addRow( const uchar* src );
+
+private:
+    struct Tab { int si, di; float w; };
+    Size m_ssize;
+    Mat& m_dst;
+    int m_cn;
+    int m_y;        // index of the next source row
+    int m_dy;       // index of the destination row being accumulated
+    double m_scale_y;
+    float m_norm;
+    std::vector<Tab> m_xtab;
+    std::vector<float> m_row, m_sum;
+};
+
 CV_INLINE bool  isBigEndian( void )
 {
     return (((const int*)"\0\x1\x2\x3\x4\x5\x6\x7")[0] & 255) != 0;
@@ -314,4 +314,52 @@ TEST(Imgcodecs_EXR, read_RGBA_unchanged)
     EXPECT_EQ(0, remove(filenameOutput.c_str()));
 }
 
+TEST(Imgcodecs_EXR, write_read_mipmap)
+{
+    const string filename = cv::tempfile(".exr");
+    const int types[] = { CV_32FC1, CV_32FC3, CV_32FC4 };
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+    {
+        SCOPED_TRACE(typeToString(types[i]));
+        Mat img(130, 200, types[i]);
+        randu(img, 0.f, 100.f);
+        ASSERT_TRUE(imwrite(filename, img, { IMWRITE_EXR_MIPMAP, 1 }));
+
+        // 200x130 -> 100x65 -> ... -> 1x1
+        ImageHeader header;
+        ASSERT_TRUE(imreadHeader(filename, header));
+        EXPECT_EQ(9, header.levelCount);
+        EXPECT_EQ(0, cvtest::norm(img, imread(filename, IMREAD_UNCHANGED), NORM_INF));
+
+        Mat level = img;
+        for (int l = 0; l < header.levelCount; l++)
+        {
+            SCOPED_TRACE(cv::format("level=%d", l));
+            if (l > 0)
+                pyrDown(level, level);
+            Mat decoded = imreadLevel(filename, l, IMREAD_UNCHANGED);
+            ASSERT_EQ(img.type(), decoded.type());
+            ASSERT_EQ(level.size(), decoded.size());
+            EXPECT_EQ(0, cvtest::norm(level, decoded, NORM_INF));
+
+            const Rect roi(level.cols / 3, level.rows / 3, 70, 20);
+            Mat part = imreadLevel(filename, l, IMREAD_UNCHANGED, roi);
+            const Rect r = roi & Rect(0, 0, level.cols, level.rows);
+            ASSERT_EQ(r.size(), part.size());
+            EXPECT_EQ(0, cvtest::norm(decoded(r), part, NORM_INF));
+
+            Mat color = imreadLevel(filename, l, IMREAD_COLOR | IMREAD_ANYDEPTH);
+            ASSERT_EQ(CV_32FC3, color.type());
+            Mat expected = level;
+            if (level.channels() == 1)
+                cvtColor(level, expected, COLOR_GRAY2BGR);
+            else if (level.channels() == 4)
+                cvtColor(level, expected, COLOR_BGRA2BGR);
+            EXPECT_EQ(0, cvtest::norm(expected, color, NORM_INF));
+        }
+        EXPECT_TRUE(imreadLevel(filename, header.levelCount, IMREAD_UNCHANGED).empty());
+    }
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
 }} // namespace
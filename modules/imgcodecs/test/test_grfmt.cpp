@@ -238,6 +238,9 @@ const string all_exts[] =
 #ifdef HAVE_IMGCODEC_PFM
     ".pfm",
 #endif
+#ifdef HAVE_IMGCODEC_CVFL
+    ".cvfl",
+#endif
 };
 
 vector<Size> all_sizes()
@@ -479,6 +482,137 @@ TEST(Imgcodecs_Pfm, read_write)
 }
 #endif
 
+#ifdef HAVE_IMGCODEC_CVFL
+typedef testing::TestWithParam<tuple<perf::MatType, int> > Imgcodecs_Cvfl;
+
+TEST_P(Imgcodecs_Cvfl, encode_decode)
+{
+    const int type = get<0>(GetParam());
+    const int predictor = get<1>(GetParam());
+    RNG& rng = theRNG();
+
+    // odd sizes exercise the tails of the vector loops and of the last block
+    const Size sizes[] = { Size(1, 1), Size(7, 3), Size(333, 257) };
+    for (size_t k = 0; k < sizeof(sizes)/sizeof(sizes[0]); k++)
+    {
+        SCOPED_TRACE(cv::format("size %dx%d", sizes[k].width, sizes[k].height));
+        Mat img(sizes[k], type);
+        if (CV_MAT_DEPTH(type) == CV_32F)
+        {
+            rng.fill(img, RNG::UNIFORM, -1e6, 1e6);
+            // smooth and noisy parts, so that both small and large residuals are coded
+            if (img.rows > 1)
+                GaussianBlur(img.rowRange(0, img.rows/2), img.rowRange(0, img.rows/2), Size(5, 5), 0);
+        }
+        else
+        {
+            rng.fill(img, RNG::UNIFORM, Scalar::all(-1e9), Scalar::all(1e9));
+            img.rowRange(0, img.rows/2).setTo(Scalar::all(100));
+        }
+
+        std::vector<int> params;
+        params.push_back(IMWRITE_CVFL_PREDICTOR);
+        params.push_back(predictor);
+        std::vector<uchar> buf;
+        ASSERT_TRUE(imencode(".cvfl", img, buf, params));
+        Mat dec = imdecode(buf, IMREAD_UNCHANGED);
+        ASSERT_EQ(img.type(), dec.type());
+        ASSERT_EQ(img.size(), dec.size());
+        EXPECT_EQ(0, cvtest::norm(img, dec, NORM_INF));
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Imgcodecs_Cvfl,
+                        testing::Combine(
+                            testing::Values(CV_8UC1, CV_8UC3, CV_8UC4, CV_16UC1, CV_16UC3, CV_16SC3, CV_32SC1, CV_32FC1, CV_32FC3),
+                            testing::Values((int)IMWRITE_CVFL_PREDICTOR_NONE, (int)IMWRITE_CVFL_PREDICTOR_LEFT,
+                                            (int)IMWRITE_CVFL_PREDICTOR_UP, (int)IMWRITE_CVFL_PREDICTOR_GRADIENT)));
+
+TEST(Imgcodecs_Cvfl_Float, special_values)
+{
+    const float vals[] = { 0.f, -0.f, 1.f, -1.f, std::numeric_limits<float>::infinity(),
+                           -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::denorm_min(),
+                           -std::numeric_limits<float>::max(), std::numeric_limits<float>::quiet_NaN() };
+    Mat img(1, (int)(sizeof(vals)/sizeof(vals[0])), CV_32FC1, (void*)vals);
+
+    std::vector<uchar> buf;
+    ASSERT_TRUE(imencode(".cvfl", img, buf));
+    Mat dec = imdecode(buf, IMREAD_UNCHANGED);
+    ASSERT_EQ(CV_32FC1, dec.type());
+    // compare the bit patterns, so that NaN and the sign of zero are checked too
+    EXPECT_EQ(0, memcmp(img.data, dec.data, img.total()*img.elemSize()));
+}
+
+TEST(Imgcodecs_Cvfl_File, read_write_convert)
+{
+    Mat img(120, 160, CV_16UC3);
+    randu(img, Scalar::all(0), Scalar::all(65536));
+
+    string filename = cv::tempfile(".cvfl");
+    ASSERT_TRUE(imwrite(filename, img));
+
+    Mat dec = imread(filename, IMREAD_UNCHANGED);
+    EXPECT_EQ(0, cvtest::norm(img, dec, NORM_INF));
+
+    Mat gray = imread(filename, IMREAD_GRAYSCALE);
+    ASSERT_EQ(CV_8UC1, gray.type());
+    Mat expected;
+    img.convertTo(expected, CV_8U, 1./256);
+    cvtColor(expected, expected, COLOR_BGR2GRAY);
+    EXPECT_LE(cvtest::norm(gray, expected, NORM_INF), 1);
+
+    Mat rgb = imread(filename, IMREAD_ANYDEPTH | IMREAD_COLOR_RGB);
+    ASSERT_EQ(CV_16UC3, rgb.type());
+    cvtColor(img, expected, COLOR_BGR2RGB);
+    EXPECT_EQ(0, cvtest::norm(rgb, expected, NORM_INF));
+
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
+TEST(Imgcodecs_Cvfl_Corrupted, block_table)
+{
+    Mat img(512, 256, CV_8UC1);
+    randu(img, Scalar::all(0), Scalar::all(256));
+    std::vector<uchar> buf;
+    ASSERT_TRUE(imencode(".cvfl", img, buf));
+    const int block_rows = buf[16] | (buf[17] << 8) | (buf[18] << 16) | (buf[19] << 24);
+    ASSERT_LT(block_rows, img.rows);  // several blocks
+
+    // the sum of the block sizes wraps around, the second one is 2^64 - (size of the first one)
+    std::vector<uchar> wrapped = buf;
+    uint64 size0 = 0;
+    for (int i = 0; i < 8; i++)
+        size0 |= (uint64)buf[20 + i] << (i*8);
+    for (int i = 0; i < 8; i++)
+        wrapped[28 + i] = (uchar)((0 - size0) >> (i*8));
+    // a huge block
+    std::vector<uchar> huge = buf;
+    huge[27] = 0x7f;
+    // the header only, with a block per row of 2^30 rows
+    std::vector<uchar> header(buf.begin(), buf.begin() + 20);
+    header[12] = header[13] = header[14] = 0; header[15] = 0x40;
+    header[16] = 1; header[17] = header[18] = header[19] = 0;
+
+    const std::vector<uchar>* corrupted[] = { &wrapped, &huge, &header };
+    string filename = cv::tempfile(".cvfl");
+    for (size_t k = 0; k < sizeof(corrupted)/sizeof(corrupted[0]); k++)
+    {
+        SCOPED_TRACE(cv::format("case %d", (int)k));
+        Mat dec;
+        EXPECT_NO_THROW(dec = imdecode(*corrupted[k], IMREAD_UNCHANGED));
+        EXPECT_TRUE(dec.empty());
+
+        FILE* f = fopen(filename.c_str(), "wb");
+        ASSERT_TRUE(f != NULL);
+        ASSERT_EQ(corrupted[k]->size(), fwrite(corrupted[k]->data(), 1, corrupted[k]->size(), f));
+        fclose(f);
+        EXPECT_NO_THROW(dec = imread(filename, IMREAD_UNCHANGED));
+        EXPECT_TRUE(dec.empty());
+    }
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+#endif
+
 TEST(Imgcodecs, write_parameter_type)
 {
     cv::Mat m(10, 10, CV_8UC1, cv::Scalar::all(0));
@@ -35,6 +35,61 @@ TEST(Imgcodecs_Png, encode)
     EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), img, img_gt);
 }
 
+TEST(Imgcodecs_Png, write_parallel)
+{
+    const int types[] = { CV_8UC1, CV_8UC3, CV_8UC4, CV_16UC1, CV_16UC3, CV_16UC4 };
+    // the largest size is split into several chunks for every type
+    const Size sizes[] = { Size(1, 1), Size(5, 3), Size(257, 1100) };
+    const int levels[] = { -1, 3 };
+    RNG& rng = theRNG();
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+    {
+        for (size_t j = 0; j < sizeof(sizes) / sizeof(sizes[0]); j++)
+        {
+            // smooth content with some noise, compressible but not trivial
+            Mat img(sizes[j], types[i]);
+            rng.fill(img, RNG::UNIFORM, 0, 4);
+            Mat ramp(sizes[j], img.type());
+            for (int y = 0; y < img.rows; y++)
+                ramp.row(y).setTo(Scalar::all(y % 200));
+            img += ramp;
+
+            for (size_t k = 0; k < sizeof(levels) / sizeof(levels[0]); k++)
+            {
+                int level = levels[k];
+                SCOPED_TRACE(cv::format("type=%s size=%dx%d level=%d", typeToString(types[i]).c_str(),
+                                        img.cols, img.rows, level));
+                vector<int> params;
+                params.push_back(IMWRITE_PNG_PARALLEL);
+                params.push_back(1);
+                if (level >= 0)
+                {
+                    params.push_back(IMWRITE_PNG_COMPRESSION);
+                    params.push_back(level);
+                }
+                vector<uchar> buf;
+                ASSERT_TRUE(imencode(".png", img, buf, params));
+                Mat decoded = imdecode(buf, IMREAD_UNCHANGED);
+                ASSERT_FALSE(decoded.empty());
+                ASSERT_EQ(img.type(), decoded.type());
+                EXPECT_EQ(0, cvtest::norm(img, decoded, NORM_INF));
+            }
+        }
+    }
+
+    // bilevel images are written by the regular encoder
+    Mat bilevel(64, 64, CV_8UC1, Scalar::all(0));
+    bilevel(Rect(10, 10, 20, 30)).setTo(255);
+    vector<int> params;
+    params.push_back(IMWRITE_PNG_PARALLEL);
+    params.push_back(1);
+    params.push_back(IMWRITE_PNG_BILEVEL);
+    params.push_back(1);
+    vector<uchar> buf;
+    ASSERT_TRUE(imencode(".png", bilevel, buf, params));
+    EXPECT_EQ(0, cvtest::norm(bilevel, imdecode(buf, IMREAD_GRAYSCALE), NORM_INF));
+}
+
 TEST(Imgcodecs_Png, regression_ImreadVSCvtColor)
 {
     const string root = cvtest::TS::ptr()->get_data_path();
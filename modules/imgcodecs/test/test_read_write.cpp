@@ -4,6 +4,10 @@
 #include "test_precomp.hpp"
 #include "test_common.hpp"
 
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
 namespace opencv_test { namespace {
 
 /* < <file_name, image_size>, <imread mode, scale> > */
@@ -542,4 +546,760 @@ TEST(Imgcodecs_Params, imencode_regression_22752)
     EXPECT_ANY_THROW(cv::imencode("test.jpg", img, buf, params));  // parameters size or missing JPEG codec
 }
 
+//==================================================================================================
+
+/* <extension, imread mode> */
+typedef tuple<string, int> Imgcodecs_ROI_t;
+typedef testing::TestWithParam<Imgcodecs_ROI_t> Imgcodecs_ROI;
+
+const Imgcodecs_ROI_t roi_exts_and_modes[] =
+{
+#ifdef HAVE_JPEG
+    make_tuple<string, int>(".jpg", IMREAD_COLOR),
+    make_tuple<string, int>(".jpg", IMREAD_GRAYSCALE),
+    make_tuple<string, int>(".jpg", IMREAD_REDUCED_COLOR_2),
+#endif
+#if defined(HAVE_PNG) || defined(HAVE_SPNG)
+    make_tuple<string, int>(".png", IMREAD_COLOR),
+    make_tuple<string, int>(".png", IMREAD_UNCHANGED),
+    make_tuple<string, int>(".png", IMREAD_REDUCED_GRAYSCALE_4),
+#endif
+#ifdef HAVE_TIFF
+    make_tuple<string, int>(".tiff", IMREAD_COLOR),
+    make_tuple<string, int>(".tiff", IMREAD_UNCHANGED),
+#endif
+#if defined(HAVE_OPENEXR) && defined(OPENCV_IMGCODECS_ENABLE_OPENEXR_TESTS)
+    make_tuple<string, int>(".exr", IMREAD_COLOR),
+    make_tuple<string, int>(".exr", IMREAD_UNCHANGED),
+#endif
+    make_tuple<string, int>(".bmp", IMREAD_COLOR),
+};
+
+TEST_P(Imgcodecs_ROI, decode_region)
+{
+    const string ext = get<0>(GetParam());
+    const int flags = get<1>(GetParam());
+
+    Mat image(301, 415, CV_8UC3);
+    RNG rng(12345);
+    rng.fill(image, RNG::UNIFORM, 0, 256);
+    if (ext == ".exr")
+        image.convertTo(image, CV_32F, 1.0 / 255);
+    else if (flags == IMREAD_UNCHANGED)
+        image.convertTo(image, CV_16U, 257);
+
+    std::vector<uchar> buf;
+    ASSERT_TRUE(imencode(ext, image, buf));
+    const Mat full = imdecode(buf, flags);
+    ASSERT_FALSE(full.empty());
+
+    const Rect rois[] = {
+        Rect(0, 0, 16, 16),
+        Rect(37, 21, 64, 49),
+        Rect(full.cols / 2, full.rows / 2, 1, 1),
+        Rect(5, full.rows - 1, full.cols - 10, 1),
+        Rect(full.cols - 30, full.rows - 17, 100, 100),  // clipped
+        Rect(0, 0, full.cols, full.rows)
+    };
+    for (const Rect& roi : rois)
+    {
+        SCOPED_TRACE(cv::format("roi=(%d, %d, %d, %d)", roi.x, roi.y, roi.width, roi.height));
+        const Rect r = roi & Rect(0, 0, full.cols, full.rows);
+        Mat part = imdecodeROI(buf, roi, flags);
+        ASSERT_EQ(r.size(), part.size());
+        ASSERT_EQ(full.type(), part.type());
+        EXPECT_EQ(0, cvtest::norm(full(r), part, NORM_INF));
+    }
+    EXPECT_TRUE(imdecodeROI(buf, Rect(full.cols, 0, 10, 10), flags).empty());
+    EXPECT_ANY_THROW(imdecodeROI(buf, Rect(0, 0, 0, 10), flags));
+
+    const string fname = cv::tempfile(ext.c_str());
+    ASSERT_TRUE(imwrite(fname, image));
+    const Rect roi = Rect(100, 50, 150, 200) & Rect(0, 0, full.cols, full.rows);
+    Mat part = imreadROI(fname, roi, flags);
+    ASSERT_EQ(roi.size(), part.size());
+    EXPECT_EQ(0, cvtest::norm(full(roi), part, NORM_INF));
+    EXPECT_EQ(0, remove(fname.c_str()));
+}
+
+INSTANTIATE_TEST_CASE_P(/*nothing*/, Imgcodecs_ROI, testing::ValuesIn(roi_exts_and_modes));
+
+TEST(Imgcodecs_Image, decode_batch)
+{
+    std::vector<std::string> batch_exts;
+#ifdef HAVE_JPEG
+    batch_exts.push_back(".jpg");
+#endif
+#if defined(HAVE_PNG) || defined(HAVE_SPNG)
+    batch_exts.push_back(".png");
+#endif
+    batch_exts.push_back(".bmp");
+
+    RNG rng(123);
+    std::vector<std::vector<uchar> > bufs;
+    for (int i = 0; i < 30; i++)
+    {
+        Mat img(rng.uniform(16, 100), rng.uniform(16, 100), CV_8UC3);
+        rng.fill(img, RNG::UNIFORM, 0, 256);
+        std::vector<uchar> buf;
+        ASSERT_TRUE(imencode(batch_exts[i % batch_exts.size()], img, buf));
+        bufs.push_back(buf);
+    }
+    bufs[7].assign(100, 'x');  // unknown format
+    bufs[11].resize(bufs[11].size() / 3);  // truncated
+    bufs[13].clear();
+
+    std::vector<Mat> dst;
+    std::vector<String> errors;
+    int decoded = imdecodeBatch(bufs, IMREAD_COLOR, dst, errors);
+    ASSERT_EQ(bufs.size(), dst.size());
+    ASSERT_EQ(bufs.size(), errors.size());
+    int expected = 0;
+    for (size_t i = 0; i < bufs.size(); i++)
+    {
+        SCOPED_TRACE(cv::format("i=%d", (int)i));
+        Mat ref = bufs[i].empty() ? Mat() : imdecode(bufs[i], IMREAD_COLOR);
+        EXPECT_EQ(ref.empty(), dst[i].empty());
+        EXPECT_EQ(ref.empty(), !errors[i].empty());
+        if (!ref.empty())
+        {
+            expected++;
+            EXPECT_EQ(0, cvtest::norm(ref, dst[i], NORM_INF));
+        }
+    }
+    EXPECT_EQ(expected, decoded);
+    EXPECT_TRUE(dst[7].empty());
+    EXPECT_TRUE(dst[13].empty());
+
+    // destinations of the same size and type are reused
+    std::vector<const uchar*> ptrs;
+    for (size_t i = 0; i < dst.size(); i++)
+        ptrs.push_back(dst[i].data);
+    EXPECT_EQ(decoded, imdecodeBatch(bufs, IMREAD_COLOR, dst));
+    for (size_t i = 0; i < dst.size(); i++)
+        EXPECT_EQ(ptrs[i], dst[i].data);
+}
+
+TEST(Imgcodecs_Image, decode_batch_same_format)
+{
+    std::vector<std::string> batch_exts;
+#ifdef HAVE_JPEG
+    batch_exts.push_back(".jpg");
+#endif
+#ifdef HAVE_PNG
+    batch_exts.push_back(".png");
+#endif
+    const int modes[] = { IMREAD_UNCHANGED, IMREAD_COLOR, IMREAD_REDUCED_GRAYSCALE_2 };
+    for (size_t e = 0; e < batch_exts.size(); e++)
+    {
+        // the decoder of the previous buffer is reused, also after a failure
+        RNG rng(5);
+        std::vector<std::vector<uchar> > bufs;
+        for (int i = 0; i < 12; i++)
+        {
+            Mat img(rng.uniform(8, 90), rng.uniform(8, 90), i % 3 == 0 ? CV_8UC1 : CV_8UC3);
+            rng.fill(img, RNG::UNIFORM, 0, 256);
+            std::vector<uchar> buf;
+            ASSERT_TRUE(imencode(batch_exts[e], img, buf));
+            bufs.push_back(buf);
+        }
+        bufs[4].resize(bufs[4].size() / 2);
+        bufs[5].resize(8);
+
+        for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+        {
+            SCOPED_TRACE(cv::format("ext=%s mode=%d", batch_exts[e].c_str(), modes[m]));
+            std::vector<Mat> dst;
+            std::vector<String> errors;
+            imdecodeBatch(bufs, modes[m], dst, errors);
+            ASSERT_EQ(bufs.size(), dst.size());
+            for (size_t i = 0; i < bufs.size(); i++)
+            {
+                SCOPED_TRACE(cv::format("i=%d", (int)i));
+                Mat ref = imdecode(bufs[i], modes[m]);
+                ASSERT_EQ(ref.empty(), dst[i].empty());
+                if (!ref.empty())
+                {
+                    ASSERT_EQ(ref.type(), dst[i].type());
+                    EXPECT_EQ(0, cvtest::norm(ref, dst[i], NORM_INF));
+                }
+            }
+        }
+    }
+}
+
+static Mat makeSmoothImage(Size size, int type)
+{
+    Mat img(size, type);
+    RNG rng(4321);
+    rng.fill(img, RNG::UNIFORM, 0, 256);
+    GaussianBlur(img, img, Size(7, 7), 0);
+    return img;
+}
+
+#ifdef HAVE_JPEG
+TEST(Imgcodecs_Jpeg, decode_scaled)
+{
+    const Mat image = makeSmoothImage(Size(640, 480), CV_8UC3);
+    std::vector<uchar> buf;
+    ASSERT_TRUE(imencode(".jpg", image, buf));
+    const Mat full = imdecode(buf, IMREAD_COLOR);
+    ASSERT_FALSE(full.empty());
+
+    const Size sizes[] = { Size(100, 75), Size(80, 200), Size(639, 479), Size(320, 240), Size(1000, 700) };
+    for (const Size& dsize : sizes)
+    {
+        SCOPED_TRACE(cv::format("dsize=%dx%d", dsize.width, dsize.height));
+        Mat ref;
+        resize(full, ref, dsize, 0, 0, INTER_AREA);
+        Mat dst = imdecodeScaled(buf, dsize, IMREAD_COLOR);
+        ASSERT_EQ(dsize, dst.size());
+        ASSERT_EQ(CV_8UC3, dst.type());
+        EXPECT_GT(cvtest::PSNR(ref, dst), 30);
+
+        // the smallest M/8 DCT scale covering dsize
+        int m = 1;
+        while (m < 16 && ((full.cols * m + 7) / 8 < dsize.width || (full.rows * m + 7) / 8 < dsize.height))
+            m++;
+        Mat native = imdecodeScaled(buf, dsize, IMREAD_GRAYSCALE, false);
+        EXPECT_EQ(Size((full.cols * m + 7) / 8, (full.rows * m + 7) / 8), native.size());
+        EXPECT_EQ(CV_8UC1, native.type());
+    }
+
+    // no DCT scaling, only the fused area resize
+    Mat ref;
+    resize(full, ref, Size(600, 450), 0, 0, INTER_AREA);
+    EXPECT_LE(cvtest::norm(ref, imdecodeScaled(buf, Size(600, 450)), NORM_INF), 1);
+
+    const string fname = cv::tempfile(".jpg");
+    ASSERT_TRUE(imwrite(fname, image));
+    Mat dst = imreadScaled(fname, Size(160, 120), IMREAD_REDUCED_COLOR_2);
+    EXPECT_EQ(Size(160, 120), dst.size());
+    EXPECT_EQ(0, remove(fname.c_str()));
+
+    EXPECT_ANY_THROW(imdecodeScaled(buf, Size(0, 10)));
+    EXPECT_ANY_THROW(imdecodeScaled(buf, Size(10, -1)));
+}
+#endif
+
+#if defined(HAVE_PNG) || defined(HAVE_SPNG)
+TEST(Imgcodecs_Png, decode_scaled)
+{
+    const Mat image = makeSmoothImage(Size(211, 157), CV_8UC4);
+    std::vector<uchar> buf;
+    ASSERT_TRUE(imencode(".png", image, buf));
+
+    Mat ref;
+    resize(image, ref, Size(50, 40), 0, 0, INTER_AREA);
+    Mat dst = imdecodeScaled(buf, Size(50, 40), IMREAD_UNCHANGED, false);
+    ASSERT_EQ(ref.size(), dst.size());
+    EXPECT_EQ(0, cvtest::norm(ref, dst, NORM_INF));
+}
+#endif
+
+typedef tuple<string, perf::MatType> Imgcodecs_Stream_t;
+typedef testing::TestWithParam<Imgcodecs_Stream_t> Imgcodecs_Stream;
+
+const Imgcodecs_Stream_t stream_exts_and_types[] =
+{
+#ifdef HAVE_JPEG
+    make_tuple<string, perf::MatType>(".jpg", CV_8UC3),
+    make_tuple<string, perf::MatType>(".jpg", CV_8UC1),
+#endif
+#ifdef HAVE_PNG
+    make_tuple<string, perf::MatType>(".png", CV_8UC3),
+    make_tuple<string, perf::MatType>(".png", CV_16UC4),
+#endif
+#ifdef HAVE_TIFF
+    make_tuple<string, perf::MatType>(".tiff", CV_8UC3),
+    make_tuple<string, perf::MatType>(".tiff", CV_16UC1),
+    make_tuple<string, perf::MatType>(".tiff", CV_32FC1),
+    make_tuple<string, perf::MatType>(".tiff", CV_32FC3),  // SGILOG
+#endif
+#ifdef HAVE_IMGCODEC_PXM
+    make_tuple<string, perf::MatType>(".ppm", CV_8UC3),
+    make_tuple<string, perf::MatType>(".pgm", CV_16UC1),
+#endif
+    make_tuple<string, perf::MatType>(".bmp", CV_8UC3),  // no row support, whole image in memory
+};
+
+TEST_P(Imgcodecs_Stream, write_and_read_bands)
+{
+    const string ext = get<0>(GetParam());
+    const int type = get<1>(GetParam());
+
+    Mat image(203, 157, type);
+    RNG rng(5678);
+    if (CV_MAT_DEPTH(type) == CV_32F)
+        rng.fill(image, RNG::UNIFORM, 0, 1);
+    else
+        rng.fill(image, RNG::UNIFORM, 0, CV_MAT_DEPTH(type) == CV_16U ? 65536 : 256);
+    GaussianBlur(image, image, Size(5, 5), 0);
+
+    const string ref_name = cv::tempfile(ext.c_str());
+    const string fname = cv::tempfile(ext.c_str());
+    ASSERT_TRUE(imwrite(ref_name, image));
+
+    {
+        ImageStreamWriter writer(fname, image.size(), type);
+        ASSERT_TRUE(writer.isOpened());
+        for (int y = 0; y < image.rows; y += 7)
+        {
+            EXPECT_EQ(y, writer.position());
+            ASSERT_TRUE(writer.write(image.rowRange(y, std::min(y + 7, image.rows))));
+        }
+        EXPECT_EQ(image.rows, writer.position());
+        EXPECT_FALSE(writer.isOpened());
+    }
+    const Mat ref = imread(ref_name, IMREAD_UNCHANGED);
+    ASSERT_FALSE(ref.empty());
+    EXPECT_EQ(0, cvtest::norm(ref, imread(fname, IMREAD_UNCHANGED), NORM_INF));
+
+    const int flags[] = { IMREAD_UNCHANGED, IMREAD_COLOR, IMREAD_GRAYSCALE };
+    for (int flag : flags)
+    {
+        if (CV_MAT_DEPTH(type) == CV_32F && flag != IMREAD_UNCHANGED)
+            continue;
+        SCOPED_TRACE(cv::format("flags=%d", flag));
+        const Mat full = imread(fname, flag);
+        ASSERT_FALSE(full.empty());
+
+        ImageStreamReader reader(fname, flag);
+        ASSERT_TRUE(reader.isOpened());
+        EXPECT_EQ(full.size(), reader.size());
+        EXPECT_EQ(full.type(), reader.type());
+        std::vector<Mat> bands;
+        Mat band;
+        int rows = 0;
+        while ((rows = reader.read(band, 10)) > 0)
+        {
+            EXPECT_EQ(rows, band.rows);
+            bands.push_back(band.clone());
+        }
+        EXPECT_EQ(full.rows, reader.position());
+        EXPECT_FALSE(reader.isOpened());
+        Mat result;
+        vconcat(bands, result);
+        EXPECT_EQ(0, cvtest::norm(full, result, NORM_INF));
+    }
+
+    EXPECT_EQ(0, remove(ref_name.c_str()));
+    EXPECT_EQ(0, remove(fname.c_str()));
+}
+
+INSTANTIATE_TEST_CASE_P(/*nothing*/, Imgcodecs_Stream, testing::ValuesIn(stream_exts_and_types));
+
+TEST(Imgcodecs_StreamWriter, incomplete_and_invalid)
+{
+    const string fname = cv::tempfile(".png");
+    Mat rows(4, 32, CV_8UC3, Scalar::all(7));
+    {
+        ImageStreamWriter writer(fname, Size(32, 16), CV_8UC3);
+        ASSERT_TRUE(writer.isOpened());
+        EXPECT_TRUE(writer.write(rows));
+        EXPECT_ANY_THROW(writer.write(Mat(4, 32, CV_8UC1)));
+        EXPECT_ANY_THROW(writer.write(Mat(4, 31, CV_8UC3)));
+        EXPECT_ANY_THROW(writer.write(Mat(13, 32, CV_8UC3)));
+    }
+    // the incomplete file is removed
+    EXPECT_EQ(NULL, fopen(fname.c_str(), "rb"));
+    EXPECT_FALSE(ImageStreamReader(fname).isOpened());
+
+    ASSERT_TRUE(imwrite(fname, Mat(16, 32, CV_8UC3, Scalar::all(7))));
+    EXPECT_ANY_THROW(ImageStreamReader(fname, IMREAD_REDUCED_COLOR_2));
+    ImageStreamReader reader(fname);
+    Mat band;
+    EXPECT_ANY_THROW(reader.read(band, 0));
+    EXPECT_TRUE(reader.isOpened());
+    EXPECT_EQ(16, reader.read(band, 100));
+    EXPECT_FALSE(reader.isOpened());
+    EXPECT_EQ(Size(32, 16), reader.size());
+    EXPECT_EQ(0, reader.read(band, 100));
+    EXPECT_TRUE(band.empty());
+    EXPECT_EQ(0, remove(fname.c_str()));
+}
+
+#ifdef HAVE_TIFF
+TEST(Imgcodecs_StreamReader, tiff_strips_and_tiles)
+{
+    const int types[] = { CV_8UC3, CV_16UC1, CV_32FC1 };
+    const std::vector<int> layouts[] = {
+        { IMWRITE_TIFF_ROWSPERSTRIP, 150 },  // single strip
+        { IMWRITE_TIFF_ROWSPERSTRIP, 16 },
+        { IMWRITE_TIFF_TILE_SIZE, 32 },
+    };
+    const string fname = cv::tempfile(".tiff");
+    for (int type : types)
+    {
+        Mat image(150, 100, type);
+        RNG rng(1234);
+        rng.fill(image, RNG::UNIFORM, 0, CV_MAT_DEPTH(type) == CV_16U ? 65536 : 256);
+        for (size_t i = 0; i < sizeof(layouts) / sizeof(layouts[0]); i++)
+        {
+            SCOPED_TRACE(cv::format("type=%s layout=%d", typeToString(type).c_str(), (int)i));
+            ASSERT_TRUE(imwrite(fname, image, layouts[i]));
+            const Mat full = imread(fname, IMREAD_UNCHANGED);
+            ASSERT_FALSE(full.empty());
+
+            // the bands are shorter than the strips or tiles
+            ImageStreamReader reader(fname, IMREAD_UNCHANGED);
+            ASSERT_TRUE(reader.isOpened());
+            std::vector<Mat> bands;
+            Mat band;
+            while (reader.read(band, 7) > 0)
+                bands.push_back(band.clone());
+            EXPECT_FALSE(reader.isOpened());
+            Mat result;
+            vconcat(bands, result);
+            EXPECT_EQ(0, cvtest::norm(full, result, NORM_INF));
+        }
+    }
+    EXPECT_EQ(0, remove(fname.c_str()));
+}
+#endif
+
+static const string header_exts[] = {
+    ".bmp",
+#if defined(HAVE_PNG) || defined(HAVE_SPNG)
+    ".png",
+#endif
+#ifdef HAVE_JPEG
+    ".jpg",
+#endif
+#ifdef HAVE_TIFF
+    ".tiff",
+#endif
+#ifdef HAVE_IMGCODEC_PXM
+    ".pnm",
+#endif
+#ifdef HAVE_IMGCODEC_CVFL
+    ".cvfl",
+#endif
+};
+
+TEST(Imgcodecs_Image, read_header)
+{
+    const int types[] = { CV_8UC1, CV_8UC3, CV_16UC3 };
+    for (size_t i = 0; i < sizeof(header_exts)/sizeof(header_exts[0]); i++)
+    {
+        for (size_t j = 0; j < sizeof(types)/sizeof(types[0]); j++)
+        {
+            const string& ext = header_exts[i];
+            Mat img(37, 53, types[j], Scalar::all(1));
+            std::vector<uchar> buf;
+            if (!imencode(ext, img, buf))
+                continue;
+            SCOPED_TRACE(ext + " " + typeToString(types[j]));
+
+            Mat expected = imdecode(buf, IMREAD_UNCHANGED);
+            ASSERT_FALSE(expected.empty());
+            ImageHeader header;
+            ASSERT_TRUE(imdecodeHeader(buf, header));
+            EXPECT_EQ(expected.cols, header.width);
+            EXPECT_EQ(expected.rows, header.height);
+            EXPECT_EQ(expected.channels(), header.channels);
+            EXPECT_EQ(expected.depth(), header.depth);
+            EXPECT_EQ(1, header.pageCount);
+            EXPECT_EQ(1, header.orientation);
+            EXPECT_FALSE(header.codec.empty());
+
+            const string fname = cv::tempfile(ext.c_str());
+            ASSERT_TRUE(imwrite(fname, img));
+            ImageHeader fheader;
+            ASSERT_TRUE(imreadHeader(fname, fheader));
+            EXPECT_EQ(header.width, fheader.width);
+            EXPECT_EQ(header.height, fheader.height);
+            EXPECT_EQ(header.channels, fheader.channels);
+            EXPECT_EQ(header.depth, fheader.depth);
+            EXPECT_EQ(header.codec, fheader.codec);
+            EXPECT_EQ(0, remove(fname.c_str()));
+        }
+    }
+
+    ImageHeader header;
+    EXPECT_FALSE(imreadHeader(cv::tempfile(".png"), header));
+    EXPECT_EQ(0, header.width);
+    std::vector<uchar> garbage(100, 0x55);
+    EXPECT_FALSE(imdecodeHeader(garbage, header));
+}
+
+#ifdef HAVE_TIFF
+TEST(Imgcodecs_Image, read_header_multipage)
+{
+    std::vector<Mat> pages(3, Mat(10, 20, CV_8UC1, Scalar::all(0)));
+    const string fname = cv::tempfile(".tiff");
+    ASSERT_TRUE(imwrite(fname, pages));
+    ImageHeader header;
+    ASSERT_TRUE(imreadHeader(fname, header));
+    EXPECT_EQ(3, header.pageCount);
+    EXPECT_EQ("tiff", header.codec);
+    EXPECT_EQ(0, remove(fname.c_str()));
+}
+#endif
+
+static const string decode_to_exts[] = {
+    ".bmp",
+#if defined(HAVE_PNG) || defined(HAVE_SPNG)
+    ".png",
+#endif
+#ifdef HAVE_JPEG
+    ".jpg",
+#endif
+#ifdef HAVE_WEBP
+    ".webp",
+#endif
+#ifdef HAVE_TIFF
+    ".tiff",
+#endif
+};
+
+typedef testing::TestWithParam<string> Imgcodecs_DecodeTo;
+
+TEST_P(Imgcodecs_DecodeTo, layouts)
+{
+    const string ext = GetParam();
+    Mat img(61, 83, CV_8UC3);
+    randu(img, Scalar::all(0), Scalar::all(256));
+    GaussianBlur(img, img, Size(7, 7), 0);
+    std::vector<uchar> buf;
+    ASSERT_TRUE(imencode(ext, img, buf));
+
+    const int modes[] = { IMREAD_COLOR, IMREAD_COLOR_RGB, IMREAD_GRAYSCALE };
+    for (size_t m = 0; m < sizeof(modes)/sizeof(modes[0]); m++)
+    {
+        SCOPED_TRACE(cv::format("flags %d", modes[m]));
+        Mat expected = imdecode(buf, modes[m]);
+        ASSERT_FALSE(expected.empty());
+        const int cn = expected.channels();
+
+        // a region of a larger image is filled in place
+        Mat canvas(expected.rows + 10, expected.cols + 20, expected.type(), Scalar::all(7));
+        Mat roi = canvas(Rect(Point(15, 4), expected.size()));
+        const uchar* data = roi.data;
+        ASSERT_TRUE(imdecodeTo(buf, modes[m], roi));
+        EXPECT_EQ(data, roi.data);
+        EXPECT_EQ(0, cvtest::norm(roi, expected, NORM_INF));
+        roi.setTo(Scalar::all(7));
+        EXPECT_EQ(0, cvtest::norm(canvas, Mat(canvas.size(), canvas.type(), Scalar::all(7)), NORM_INF));
+
+        // interleaved with another depth
+        Mat fimg(expected.size(), CV_MAKETYPE(CV_32F, cn)), fexpected;
+        ASSERT_TRUE(imdecodeTo(buf, modes[m], fimg));
+        expected.convertTo(fexpected, CV_32F);
+        EXPECT_EQ(0, cvtest::norm(fimg, fexpected, NORM_INF));
+
+        // an image of a planar N x C x H x W blob
+        int sz[] = { 3, cn, expected.rows, expected.cols };
+        Mat blob(4, sz, CV_32F, Scalar::all(-1));
+        Range ranges[] = { Range(1, 2), Range::all(), Range::all(), Range::all() };
+        Mat item = blob(ranges);
+        ASSERT_TRUE(imdecodeTo(buf, modes[m], item));
+        std::vector<Mat> planes;
+        split(fexpected, planes);
+        for (int k = 0; k < cn; k++)
+        {
+            Mat plane(expected.size(), CV_32F, blob.ptr<float>(1, k));
+            EXPECT_EQ(0, cvtest::norm(plane, planes[k], NORM_INF)) << "plane " << k;
+        }
+        Mat first(expected.rows*cn, expected.cols, CV_32F, blob.ptr<float>(0));
+        EXPECT_EQ(0, cvtest::norm(first, Mat(first.size(), CV_32F, Scalar::all(-1)), NORM_INF));
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(/*nothing*/, Imgcodecs_DecodeTo, testing::ValuesIn(decode_to_exts));
+
+TEST(Imgcodecs_Image, decode_to_invalid)
+{
+    std::vector<uchar> buf;
+    ASSERT_TRUE(imencode(".bmp", Mat(10, 20, CV_8UC3, Scalar::all(3)), buf));
+
+    Mat dst;
+    ASSERT_TRUE(imdecodeTo(buf, IMREAD_COLOR, dst));
+    EXPECT_EQ(Size(20, 10), dst.size());
+    EXPECT_EQ(CV_8UC3, dst.type());
+
+    Mat small(10, 19, CV_8UC3, Scalar::all(0));
+    EXPECT_FALSE(imdecodeTo(buf, IMREAD_COLOR, small));
+    EXPECT_EQ(0, cvtest::norm(small, NORM_INF));
+
+    Mat gray(10, 20, CV_8UC1);
+    EXPECT_ANY_THROW(imdecodeTo(buf, IMREAD_COLOR, gray));
+    int sz[] = { 1, 1, 10, 20 };
+    Mat planar(4, sz, CV_8U);
+    EXPECT_ANY_THROW(imdecodeTo(buf, IMREAD_COLOR, planar));
+    EXPECT_ANY_THROW(imdecodeTo(buf, IMREAD_REDUCED_COLOR_2, dst));
+
+    std::vector<uchar> garbage(100, 0x55);
+    EXPECT_FALSE(imdecodeTo(garbage, IMREAD_COLOR, dst));
+}
+
+TEST(Imgcodecs_AsyncWriter, write_in_order)
+{
+    const int N = 12;
+    std::vector<string> fnames;
+    std::vector<Mat> imgs;
+    for (int i = 0; i < N; i++)
+    {
+        fnames.push_back(cv::tempfile(i % 2 ? ".png" : ".bmp"));
+        imgs.push_back(Mat(20 + i, 30, CV_8UC3, Scalar(i, 2*i, 3*i)));
+    }
+
+    std::mutex mtx;
+    std::vector<string> done;
+    int failed = 0;
+    AsyncImageWriter::Callback onDone = [&](const String& fname, bool success)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        failed += success ? 0 : 1;
+        done.push_back(fname);
+    };
+    {
+        AsyncImageWriter writer(2, 3);
+        for (int i = 0; i < N; i++)
+        {
+            ASSERT_TRUE(writer.write(fnames[i], imgs[i], std::vector<int>(), onDone));
+            EXPECT_LE(writer.queueSize(), 3);
+        }
+        EXPECT_FALSE(writer.write(cv::tempfile(".unknown_ext"), imgs[0]));
+        writer.flush();
+        EXPECT_EQ(0, writer.queueSize());
+
+        AsyncImageWriter::Stats stats = writer.getStats();
+        EXPECT_EQ((size_t)N, stats.queued);
+        EXPECT_EQ((size_t)N, stats.written);
+        EXPECT_EQ(0u, stats.failed);
+        EXPECT_EQ(0u, stats.dropped);
+        EXPECT_GT(stats.bytes, 0u);
+    }
+    EXPECT_EQ(0, failed);
+    EXPECT_EQ(fnames, done);
+    for (int i = 0; i < N; i++)
+    {
+        Mat img = imread(fnames[i]);
+        EXPECT_EQ(0, cvtest::norm(img, imgs[i], NORM_INF)) << fnames[i];
+        EXPECT_EQ(0, remove(fnames[i].c_str()));
+    }
+}
+
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+// the worker is held in the callback of the first image (which is not in the queue anymore), so the queue fills up
+static void checkAsyncWriterPolicy(int policy)
+{
+    std::mutex mtx;
+    std::condition_variable cond;
+    bool entered = false, release = false;
+    std::vector<std::pair<int, bool> > done;
+    auto onDone = [&](int i) -> AsyncImageWriter::Callback
+    {
+        return [&, i](const String&, bool success)
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            done.push_back(std::make_pair(i, success));
+            if (i == 0)
+            {
+                entered = true;
+                cond.notify_all();
+                cond.wait(lock, [&] { return release; });
+            }
+        };
+    };
+
+    Mat img(8, 8, CV_8UC1, Scalar::all(5));
+    std::vector<string> fnames;
+    for (int i = 0; i < 4; i++)
+        fnames.push_back(cv::tempfile(".bmp"));
+
+    AsyncImageWriter writer(1, 2, policy);
+    ASSERT_TRUE(writer.write(fnames[0], img, std::vector<int>(), onDone(0)));
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        cond.wait(lock, [&] { return entered; });
+    }
+    EXPECT_EQ(0, writer.queueSize());
+    ASSERT_TRUE(writer.write(fnames[1], img, std::vector<int>(), onDone(1)));
+    ASSERT_TRUE(writer.write(fnames[2], img, std::vector<int>(), onDone(2)));
+    EXPECT_EQ(2, writer.queueSize());
+    EXPECT_EQ(policy == AsyncImageWriter::DROP_OLDEST, writer.write(fnames[3], img, std::vector<int>(), onDone(3)));
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        release = true;
+    }
+    cond.notify_all();
+    writer.flush();
+
+    const int droppedIdx = policy == AsyncImageWriter::DROP_OLDEST ? 1 : 3;
+    const int writtenIdx[] = { policy == AsyncImageWriter::DROP_OLDEST ? 2 : 1, policy == AsyncImageWriter::DROP_OLDEST ? 3 : 2 };
+    ASSERT_EQ(4u, done.size());
+    EXPECT_EQ(std::make_pair(0, true), done[0]);
+    EXPECT_EQ(std::make_pair(droppedIdx, false), done[1]);
+    EXPECT_EQ(std::make_pair(writtenIdx[0], true), done[2]);
+    EXPECT_EQ(std::make_pair(writtenIdx[1], true), done[3]);
+    EXPECT_EQ(1u, writer.getStats().dropped);
+    EXPECT_EQ(3u, writer.getStats().written);
+
+    EXPECT_EQ(0, remove(fnames[0].c_str()));
+    EXPECT_EQ(0, remove(fnames[writtenIdx[0]].c_str()));
+    EXPECT_EQ(0, remove(fnames[writtenIdx[1]].c_str()));
+    EXPECT_NE(0, remove(fnames[droppedIdx].c_str()));
+}
+
+TEST(Imgcodecs_AsyncWriter, drop_newest) { checkAsyncWriterPolicy(AsyncImageWriter::DROP_NEWEST); }
+TEST(Imgcodecs_AsyncWriter, drop_oldest) { checkAsyncWriterPolicy(AsyncImageWriter::DROP_OLDEST); }
+
+TEST(Imgcodecs_AsyncWriter, write_from_callback)
+{
+    // the single worker calls the callbacks, the queue is full when the next image is written from them
+    const int N = 3;
+    Mat img(8, 8, CV_8UC1, Scalar::all(5));
+    std::vector<string> fnames;
+    for (int i = 0; i < N; i++)
+        fnames.push_back(cv::tempfile(".bmp"));
+
+    AsyncImageWriter writer(1, 1, AsyncImageWriter::BLOCK);
+    std::atomic<int> written(0);
+    std::function<AsyncImageWriter::Callback(int)> onDone = [&](int i) -> AsyncImageWriter::Callback
+    {
+        return [&, i](const String&, bool success)
+        {
+            written += success ? 1 : 0;
+            if (i + 1 < N)
+                writer.write(fnames[i + 1], img, std::vector<int>(), onDone(i + 1));
+        };
+    };
+    ASSERT_TRUE(writer.write(fnames[0], img, std::vector<int>(), onDone(0)));
+    writer.flush();
+    EXPECT_EQ(N, written.load());
+    EXPECT_EQ((size_t)N, writer.getStats().written);
+    for (int i = 0; i < N; i++)
+        EXPECT_EQ(0, remove(fnames[i].c_str()));
+}
+#endif
+
+#ifdef HAVE_JPEG
+TEST(Imgcodecs_Jpeg, read_header_orientation)
+{
+    std::vector<uchar> buf;
+    ASSERT_TRUE(imencode(".jpg", Mat(16, 24, CV_8UC3, Scalar::all(128)), buf));
+
+    // APP1 segment with a little-endian TIFF directory holding only the orientation tag (6: rotated by 90 degrees)
+    static const uchar app1[] = {
+        0xFF, 0xE1, 0x00, 0x22, 'E', 'x', 'i', 'f', 0, 0,
+        'I', 'I', 0x2A, 0x00, 0x08, 0x00, 0x00, 0x00,
+        0x01, 0x00,
+        0x12, 0x01, 0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00
+    };
+    buf.insert(buf.begin() + 2, app1, app1 + sizeof(app1));
+
+    ImageHeader header;
+    ASSERT_TRUE(imdecodeHeader(buf, header));
+    EXPECT_EQ(6, header.orientation);
+    EXPECT_EQ(24, header.width);
+    EXPECT_EQ(16, header.height);
+    EXPECT_EQ("jpeg", header.codec);
+    // the header reports the stored size, imdecode applies the orientation
+    EXPECT_EQ(Size(16, 24), imdecode(buf, IMREAD_COLOR).size());
+}
+#endif
+
 }} // namespace
@@ -1276,6 +1276,103 @@ TEST(Imgcodecs_Tiff, read_multipage_indexed)
     }
 }
 
+TEST(Imgcodecs_Tiff, write_parallel_deflate)
+{
+    const int types[] = { CV_8UC1, CV_8UC3, CV_8SC4, CV_16UC3, CV_16SC1, CV_32SC3 };
+    RNG& rng = theRNG();
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+    {
+        Mat img(211, 317, types[i]);
+        rng.fill(img, RNG::UNIFORM, -50, 50);
+        for (int predictor = IMWRITE_TIFF_PREDICTOR_NONE; predictor <= IMWRITE_TIFF_PREDICTOR_HORIZONTAL; predictor++)
+        {
+            for (int rowsPerStrip = 0; rowsPerStrip <= 100; rowsPerStrip += 100)
+            {
+                SCOPED_TRACE(cv::format("type=%s predictor=%d rowsPerStrip=%d",
+                                        typeToString(types[i]).c_str(), predictor, rowsPerStrip));
+                vector<int> params;
+                params.push_back(IMWRITE_TIFF_COMPRESSION);
+                params.push_back(IMWRITE_TIFF_COMPRESSION_ADOBE_DEFLATE);
+                params.push_back(IMWRITE_TIFF_PREDICTOR);
+                params.push_back(predictor);
+                if (rowsPerStrip > 0)
+                {
+                    params.push_back(IMWRITE_TIFF_ROWSPERSTRIP);
+                    params.push_back(rowsPerStrip);
+                }
+                vector<uchar> parallel;
+                params.push_back(IMWRITE_TIFF_PARALLEL);
+                params.push_back(1);
+                ASSERT_TRUE(imencode(".tiff", img, parallel, params));
+
+                Mat decoded = imdecode(parallel, IMREAD_UNCHANGED);
+                ASSERT_FALSE(decoded.empty());
+                ASSERT_EQ(img.type(), decoded.type());
+                EXPECT_EQ(0, cvtest::norm(img, decoded, NORM_INF));
+            }
+        }
+    }
+}
+
+TEST(Imgcodecs_Tiff, write_read_pyramid)
+{
+    const int types[] = { CV_8UC3, CV_8SC1, CV_16UC1, CV_16SC4, CV_32SC1, CV_32FC1 };
+    const string filename = cv::tempfile(".tiff");
+    RNG& rng = theRNG();
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+    {
+        SCOPED_TRACE(typeToString(types[i]));
+        Mat img(450, 600, types[i]);
+        rng.fill(img, RNG::UNIFORM, 0, 100);
+        vector<Mat> pages(2, img);
+        pages[1] = img(Rect(0, 0, 100, 90)).clone();
+        vector<int> params;
+        params.push_back(IMWRITE_TIFF_PYRAMID_LEVELS);
+        params.push_back(-1);
+        params.push_back(IMWRITE_TIFF_TILE_SIZE);
+        params.push_back(128);
+        ASSERT_TRUE(imwrite(filename, pages, params));
+
+        // 600x450 -> 300x225 -> 150x113 -> 75x57 fits a tile
+        ImageHeader header;
+        ASSERT_TRUE(imreadHeader(filename, header));
+        EXPECT_EQ(600, header.width);
+        EXPECT_EQ(2, header.pageCount);
+        EXPECT_EQ(4, header.levelCount);
+        EXPECT_EQ(2, (int)imcount(filename));
+
+        Mat level = img;
+        for (int l = 0; l < header.levelCount; l++)
+        {
+            SCOPED_TRACE(cv::format("level=%d", l));
+            if (l > 0 && (img.depth() == CV_8S || img.depth() == CV_32S))
+            {
+                // pyrDown() doesn't support these depths
+                Mat tmp;
+                level.convertTo(tmp, CV_64F);
+                pyrDown(tmp, tmp);
+                tmp.convertTo(level, img.depth());
+            }
+            else if (l > 0)
+            {
+                pyrDown(level, level);
+            }
+            Mat decoded = imreadLevel(filename, l, IMREAD_UNCHANGED);
+            ASSERT_EQ(img.type(), decoded.type());
+            ASSERT_EQ(level.size(), decoded.size());
+            EXPECT_EQ(0, cvtest::norm(level, decoded, NORM_INF));
+
+            const Rect roi(level.cols / 3, level.rows / 4, 70, 40);
+            Mat part = imreadLevel(filename, l, IMREAD_UNCHANGED, roi);
+            const Rect r = roi & Rect(0, 0, level.cols, level.rows);
+            ASSERT_EQ(r.size(), part.size());
+            EXPECT_EQ(0, cvtest::norm(decoded(r), part, NORM_INF));
+        }
+        EXPECT_TRUE(imreadLevel(filename, header.levelCount, IMREAD_UNCHANGED).empty());
+    }
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
 TEST(Imgcodecs_Tiff, read_bigtiff_images)
 {
     const string root = cvtest::TS::ptr()->get_data_path();
@@ -115,6 +115,28 @@ TEST(Imgcodecs_WebP, encode_decode_with_alpha_webp)
     EXPECT_EQ(512, img_webp_bgr.rows);
 }
 
+TEST(Imgcodecs_WebP, decode_alpha_to_bgr_and_gray)
+{
+    Mat img(37, 45, CV_8UC4);
+    // the lossless encoder may change the colors of fully transparent pixels
+    randu(img, Scalar(0, 0, 0, 1), Scalar::all(256));
+    std::vector<uchar> buf;
+    ASSERT_TRUE(imencode(".webp", img, buf)); // lossless
+
+    Mat bgra = imdecode(buf, IMREAD_UNCHANGED);
+    ASSERT_EQ(CV_8UC4, bgra.type());
+    EXPECT_EQ(0, cvtest::norm(img, bgra, NORM_INF));
+
+    // the alpha is dropped by the decoder, the colors must be the same
+    Mat expected;
+    cvtColor(bgra, expected, COLOR_BGRA2BGR);
+    EXPECT_EQ(0, cvtest::norm(imdecode(buf, IMREAD_COLOR), expected, NORM_INF));
+    cvtColor(bgra, expected, COLOR_BGRA2RGB);
+    EXPECT_EQ(0, cvtest::norm(imdecode(buf, IMREAD_COLOR_RGB), expected, NORM_INF));
+    cvtColor(bgra, expected, COLOR_BGRA2GRAY);
+    EXPECT_EQ(0, cvtest::norm(imdecode(buf, IMREAD_GRAYSCALE), expected, NORM_INF));
+}
+
 #endif // HAVE_WEBP
 
 }} // namespace
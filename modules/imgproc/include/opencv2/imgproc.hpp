@@ -1511,8 +1511,9 @@ In-place operation is supported.
 
 @note The median filter uses #BORDER_REPLICATE internally to cope with border pixels, see #BorderTypes
 
-@param src input 1-, 3-, or 4-channel image; when ksize is 3 or 5, the image depth should be
-CV_8U, CV_16U, or CV_32F, for larger aperture sizes, it can only be CV_8U.
+@param src input 1-, 3-, or 4-channel image; the image depth should be CV_8U, CV_16U, CV_16S or
+CV_32F. Apertures larger than 5 use a histogram method for CV_8U images and a sliding sorted
+window, which is noticeably slower, for the other depths.
 @param dst destination array of the same size and type as src.
 @param ksize aperture linear size; it must be odd and greater than 1, for example: 3, 5, 7 ...
 @sa  bilateralFilter, blur, boxFilter, GaussianBlur
@@ -3913,6 +3914,43 @@ is \f$W \times H\f$ and templ is \f$w \times h\f$ , then result is \f$(W-w+1) \t
 CV_EXPORTS_W void matchTemplate( InputArray image, InputArray templ,
                                  OutputArray result, int method, InputArray mask = noArray() );
 
+/** @brief Compares several templates against the same image.
+
+The function computes the same maps of comparison results as #matchTemplate called for each template.
+The templates of the same size share the Fourier transforms of the image tiles, so matching a batch of
+templates against one image costs much less than the separate calls.
+
+@param image Image where the search is running. It must be 8-bit or 32-bit floating-point.
+@param templs Searched templates. They must be not greater than the source image and have the same
+data type.
+@param results Maps of comparison results, one for each template, see #matchTemplate.
+@param method Parameter specifying the comparison method, see #TemplateMatchModes
+ */
+CV_EXPORTS_W void matchTemplates( InputArray image, InputArrayOfArrays templs,
+                                  OutputArrayOfArrays results, int method );
+
+/** @brief Finds the best matches of a template with a coarse-to-fine search.
+
+The image and the template are reduced by #pyrDown. The whole map of comparison results is computed on
+the coarsest level only, and the best candidates found there are refined on the finer levels in small
+neighbourhoods of their positions. This is much faster than #matchTemplate followed by a search of the
+extrema, but a match which is not among the candidates on the coarsest level is missed.
+
+@param image Image where the search is running. It must be 8-bit or 32-bit floating-point.
+@param templ Searched template. It must be not greater than the source image and have the same data type.
+@param locations Output top-left corners of the matches, the best match first. The matches are at least
+half the template size apart.
+@param scores Output comparison results at the locations, see #TemplateMatchModes.
+@param method Parameter specifying the comparison method, see #TemplateMatchModes
+@param maxCount Maximum number of the matches.
+@param maxLevel The coarsest level of the pyramids. 0 means the search over the whole map at the full
+resolution. If negative, the template is reduced while its smaller side is at least 16 pixels, but not
+more than 4 times.
+ */
+CV_EXPORTS_W void matchTemplatePeaks( InputArray image, InputArray templ,
+                                      CV_OUT std::vector<Point>& locations, CV_OUT std::vector<float>& scores,
+                                      int method, int maxCount = 1, int maxLevel = -1 );
+
 //! @}
 
 //! @addtogroup imgproc_shape
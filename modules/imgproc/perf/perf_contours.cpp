@@ -47,6 +47,37 @@ PERF_TEST_P(TestFindContours, findContours,
     SANITY_CHECK_NOTHING();
 }
 
+typedef TestBaseWithParam< tuple<Size, RetrMode, int> > TestFindContoursMask;
+
+// segmentation-like masks with many components, some of them nested
+PERF_TEST_P(TestFindContoursMask, findContours,
+            Combine(
+               Values( sz1080p, Size(3840, 2160) ), // image size
+               RetrMode::all(), // retrieval mode
+               Values( 1, 4, 8 ) // threads
+            )
+           )
+{
+    Size img_size = get<0>(GetParam());
+    int retr_mode = get<1>(GetParam());
+    int threads = get<2>(GetParam());
+
+    RNG rng;
+    Mat noise(img_size, CV_8UC1), img;
+    rng.fill(noise, RNG::UNIFORM, 0, 256);
+    cv::blur(noise, img, Size(15, 15));
+    cv::threshold(img, img, 130, 255, THRESH_BINARY);
+    vector< vector<Point> > contours;
+    vector<Vec4i> hierarchy;
+
+    int prev_threads = getNumThreads();
+    setNumThreads(threads);
+    TEST_CYCLE() findContours( img, contours, hierarchy, retr_mode, CHAIN_APPROX_SIMPLE );
+    setNumThreads(prev_threads);
+
+    SANITY_CHECK_NOTHING();
+}
+
 typedef TestBaseWithParam< tuple<Size, ApproxMode, int> > TestFindContoursFF;
 
 PERF_TEST_P(TestFindContoursFF, findContours,
@@ -81,4 +81,60 @@ PERF_TEST_P(ImgSize_TmplSize_Method, matchTemplateBig,
     SANITY_CHECK(result, eps);
 }
 
+typedef tuple<Size, int, MethodType> ImgSize_TmplCount_Method_t;
+typedef perf::TestBaseWithParam<ImgSize_TmplCount_Method_t> ImgSize_TmplCount_Method;
+
+PERF_TEST_P(ImgSize_TmplCount_Method, matchTemplates,
+            testing::Combine(
+                testing::Values(cv::Size(640, 480), cv::Size(1280, 1024)),
+                testing::Values(1, 8, 32),
+                testing::Values(TM_CCORR, TM_CCOEFF_NORMED)
+                )
+    )
+{
+    Size imgSz = get<0>(GetParam());
+    int count = get<1>(GetParam());
+    int method = get<2>(GetParam());
+
+    Mat img(imgSz, CV_8UC1);
+    std::vector<Mat> templs(count);
+    for (int i = 0; i < count; i++)
+    {
+        templs[i].create(32, 32, CV_8UC1);
+        declare.in(templs[i], WARMUP_RNG);
+    }
+    std::vector<Mat> results;
+
+    declare.in(img, WARMUP_RNG).time(30);
+
+    TEST_CYCLE() matchTemplates(img, templs, results, method);
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef tuple<Size, Size> ImgSize_TmplSize_t;
+typedef perf::TestBaseWithParam<ImgSize_TmplSize_t> ImgSize_TmplSize;
+
+PERF_TEST_P(ImgSize_TmplSize, matchTemplatePeaks,
+            testing::Combine(
+                testing::Values(cv::Size(1280, 1024), cv::Size(1920, 1080)),
+                testing::Values(cv::Size(32, 32), cv::Size(100, 60))
+                )
+    )
+{
+    Size imgSz = get<0>(GetParam());
+    Size tmplSz = get<1>(GetParam());
+
+    Mat img(imgSz, CV_8UC1);
+    Mat tmpl(tmplSz, CV_8UC1);
+    std::vector<Point> locations;
+    std::vector<float> scores;
+
+    declare.in(img, WARMUP_RNG).in(tmpl, WARMUP_RNG).time(30);
+
+    TEST_CYCLE() matchTemplatePeaks(img, tmpl, locations, scores, TM_CCOEFF_NORMED, 5);
+
+    SANITY_CHECK_NOTHING();
+}
+
 } // namespace
@@ -39,4 +39,28 @@ PERF_TEST_P(Size_MatType, dilate, TYPICAL_MATS_MORPH)
     SANITY_CHECK(dst);
 }
 
+CV_ENUM(MorphExOp, MORPH_OPEN, MORPH_CLOSE, MORPH_GRADIENT, MORPH_TOPHAT, MORPH_BLACKHAT)
+
+typedef TestBaseWithParam< tuple<Size, MatType, MorphExOp> > Size_MatType_MorphExOp;
+
+PERF_TEST_P(Size_MatType_MorphExOp, morphologyEx,
+            testing::Combine(testing::Values(sz1080p, Size(3840, 2160)),
+                             testing::Values(TYPICAL_MAT_TYPES_MORPH),
+                             MorphExOp::all()))
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    int op = get<2>(GetParam());
+
+    Mat src(sz, type);
+    Mat dst(sz, type);
+    Mat kernel = getStructuringElement(MORPH_ELLIPSE, Size(5, 5));
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE() morphologyEx(src, dst, op, kernel);
+
+    SANITY_CHECK_NOTHING();
+}
+
 } // namespace
@@ -43,6 +43,7 @@
 #include "precomp.hpp"
 #include "opencl_kernels_imgproc.hpp"
 #include "opencv2/core/hal/intrin.hpp"
+#include "opencv2/core/utils/buffer_pool.private.hpp"
 #include <deque>
 
 #include "opencv2/core/openvx/ovx_defs.hpp"
@@ -360,9 +361,12 @@ public:
         CV_DbgAssert(cn > 0);
 
         Mat dx, dy;
-        AutoBuffer<short> dxMax(0), dyMax(0);
+        dx.allocator = dy.allocator = utils::getTemporaryMatAllocator();
+        utils::PooledAutoBuffer<short> dxMax(0), dyMax(0);
         std::deque<uchar*> stack, borderPeaksLocal;
         const int rowStart = max(0, boundaries.start - 1), rowEnd = min(src.rows, boundaries.end + 1);
+        // the rows of src in dx and dy, the gradients are computed by bands as the loop below reaches them
+        int gradStart = rowStart, gradEnd = rowStart;
         int *_mag_p, *_mag_a, *_mag_n;
         short *_dx, *_dy, *_dx_a = NULL, *_dy_a = NULL, *_dx_n = NULL, *_dy_n = NULL;
         uchar *_pmap;
@@ -375,14 +379,15 @@ public:
             {
                 scale = 1 / 16.0;
             }
-            Sobel(src.rowRange(rowStart, rowEnd), dx, CV_16S, 1, 0, aperture_size, scale, 0, BORDER_REPLICATE);
-            Sobel(src.rowRange(rowStart, rowEnd), dy, CV_16S, 0, 1, aperture_size, scale, 0, BORDER_REPLICATE);
         }
         else
         {
             dx = src.rowRange(rowStart, rowEnd);
             dy = src2.rowRange(rowStart, rowEnd);
+            gradEnd = rowEnd;
         }
+        // the bands of dx and dy stay in the cache until the magnitude is computed
+        const int gradRows = std::max(32, (int)((1 << 18) / ((size_t)src.cols * cn * sizeof(short) * 2)));
 
         CV_TRACE_REGION_NEXT("magnitude");
         if(cn > 1)
@@ -397,12 +402,12 @@ public:
 
         // _mag_p: previous row, _mag_a: actual row, _mag_n: next row
 #if (CV_SIMD || CV_SIMD_SCALABLE)
-        AutoBuffer<int> buffer(3 * (mapstep * cn + CV_SIMD_WIDTH));
+        utils::PooledAutoBuffer<int> buffer(3 * (mapstep * cn + CV_SIMD_WIDTH));
         _mag_p = alignPtr(buffer.data() + 1, CV_SIMD_WIDTH);
         _mag_a = alignPtr(_mag_p + mapstep * cn, CV_SIMD_WIDTH);
         _mag_n = alignPtr(_mag_a + mapstep * cn, CV_SIMD_WIDTH);
 #else
-        AutoBuffer<int> buffer(3 * (mapstep * cn));
+        utils::PooledAutoBuffer<int> buffer(3 * (mapstep * cn));
         _mag_p = buffer.data() + 1;
         _mag_a = _mag_p + mapstep * cn;
         _mag_n = _mag_a + mapstep * cn;
@@ -429,9 +434,19 @@ public:
 
             if(i < rowEnd)
             {
+                if (i >= gradEnd)
+                {
+                    // the previous row is kept for the non-maxima suppression. Sobel() reads the aperture
+                    // rows around the band of src, so the seams are the same as without bands
+                    gradStart = max(i - 1, rowStart);
+                    gradEnd = min(gradStart + gradRows, rowEnd);
+                    Sobel(src.rowRange(gradStart, gradEnd), dx, CV_16S, 1, 0, aperture_size, scale, 0, BORDER_REPLICATE);
+                    Sobel(src.rowRange(gradStart, gradEnd), dy, CV_16S, 0, 1, aperture_size, scale, 0, BORDER_REPLICATE);
+                }
+
                 // Next row calculation
-                _dx = dx.ptr<short>(i - rowStart);
-                _dy = dy.ptr<short>(i - rowStart);
+                _dx = dx.ptr<short>(i - gradStart);
+                _dy = dy.ptr<short>(i - gradStart);
 
                 if (L2gradient)
                 {
@@ -526,8 +541,8 @@ public:
 
             if(cn == 1)
             {
-                _dx = dx.ptr<short>(i - rowStart - 1);
-                _dy = dy.ptr<short>(i - rowStart - 1);
+                _dx = dx.ptr<short>(i - gradStart - 1);
+                _dy = dy.ptr<short>(i - gradStart - 1);
             }
             else
             {
@@ -903,6 +918,7 @@ void Canny( InputArray _src, OutputArray _dst,
         numOfThreads = std::max(1, src.rows / minGrainSize);
 
     Mat map;
+    map.allocator = utils::getTemporaryMatAllocator();
     std::deque<uchar*> stack;
 
     parallel_for_(Range(0, src.rows), parallelCanny(src, map, stack, low, high, aperture_size, L2gradient), numOfThreads);
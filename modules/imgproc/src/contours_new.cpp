@@ -291,9 +291,14 @@ struct ContourScanner_
     int mode;
     CTree tree;
     array<int, 128> ctable;
+    // parallel scan: component labels of the scanned rows, band of every component and
+    // the band this scanner handles; contours of other bands are skipped
+    Mat scanLabels;
+    const int* labelBand;
+    int scanBand;
 
 public:
-    ContourScanner_() {}
+    ContourScanner_() : labelBand(nullptr), scanBand(-1) {}
     ~ContourScanner_() {}
     inline bool isInt() const
     {
@@ -309,6 +314,7 @@ public:
     int findFirstBoundingContour(const Point& last_pos, const int y, const int lval, int par);
     int findNextX(int x, int y, int& prev, int& p);
     bool findNext();
+    bool findAllParallel();
 
     static shared_ptr<ContourScanner_> create(Mat img, int mode, int method, Point offset);
 };  // class ContourScanner_
@@ -447,6 +453,11 @@ bool ContourScanner_::contourScan(const int prev, int& p, Point& last_pos, const
         }
     }
 
+    if (!scanLabels.empty() && labelBand[scanLabels.at<int>(y, x - (is_hole ? 1 : 0))] != scanBand)
+    {
+        return false;
+    }
+
     if (mode == RETR_EXTERNAL && (is_hole || this->image.at<schar>(last_pos) > 0))
     {
         return false;
@@ -623,6 +634,134 @@ bool ContourScanner_::findNext()
     return false;
 }
 
+// Images smaller than this (or fewer than 4 threads) are always scanned by a single scanner
+static const int PARALLEL_SCAN_MIN_AREA = 1 << 20;
+
+// Contours of different 8-connected components never interact, except that a component lying
+// in a hole of another one gets nested into it (RETR_TREE) or skipped (RETR_EXTERNAL). So the
+// components are grouped by their outermost enclosing component, the groups are distributed
+// over row bands by their top row and every band is traced by its own scanner on a copy of the
+// rows it spans, ignoring the components of other bands. Per-band trees are merged in the
+// raster order of contour starting points, i.e. in the order the sequential scan creates them,
+// so the resulting tree is identical to the one findNext() builds.
+bool ContourScanner_::findAllParallel()
+{
+    const int nthreads = getNumThreads();
+    if (nthreads < 4 || isInt() || (double)image.total() < PARALLEL_SCAN_MIN_AREA)
+        return false;
+
+    Mat labels, stats, centroids;
+    const int ncomp = connectedComponentsWithStats(image, labels, stats, centroids, 8, CV_32S);
+    if (ncomp < 3)
+        return false;
+
+    // first pixel of a component in raster order, it lies in the top row of its bounding box
+    const auto firstPixel = [](const Mat& lbl, const Mat& st, int i) {
+        const int y = st.at<int>(i, CC_STAT_TOP);
+        const int* row = lbl.ptr<int>(y);
+        int x = st.at<int>(i, CC_STAT_LEFT);
+        while (row[x] != i)
+            x++;
+        return Point(x, y);
+    };
+
+    vector<int> root(ncomp);
+    for (int i = 0; i < ncomp; i++)
+        root[i] = i;
+    if (mode == RETR_EXTERNAL || mode == RETR_TREE)
+    {
+        // holes are bounded 4-connected background components; the pixel above the first
+        // pixel of a hole belongs to the component surrounding it, and the pixel on the left
+        // of the first pixel of a component belongs to the hole (or the outer background)
+        // surrounding that component
+        Mat bgLabels, bgStats;
+        const int nbg =
+            connectedComponentsWithStats(image == 0, bgLabels, bgStats, centroids, 4, CV_32S);
+        const int outer = bgLabels.at<int>(0, 0);
+        vector<int> owner(nbg, 0);
+        for (int h = 1; h < nbg; h++)
+        {
+            if (h != outer)
+                owner[h] = labels.at<int>(firstPixel(bgLabels, bgStats, h) - Point(0, 1));
+        }
+        vector<int> parent(ncomp, 0);
+        for (int i = 1; i < ncomp; i++)
+            parent[i] = owner[bgLabels.at<int>(firstPixel(labels, stats, i) - Point(1, 0))];
+        for (int i = 1; i < ncomp; i++)
+        {
+            int r = i;
+            while (parent[r] != 0)
+                r = parent[r];
+            for (int j = i; j != r;)
+            {
+                const int next = parent[j];
+                parent[j] = r;
+                j = next;
+            }
+            root[i] = r;
+        }
+    }
+
+    const int nbands = std::min(ncomp - 1, nthreads * 2);
+    vector<int> band(ncomp, -1);
+    vector<Range> bandRows(nbands, Range(image.rows, 0));
+    for (int i = 1; i < ncomp; i++)
+    {
+        const int top = stats.at<int>(i, CC_STAT_TOP);
+        const int b = (int)((int64)stats.at<int>(root[i], CC_STAT_TOP) * nbands / image.rows);
+        band[i] = b;
+        bandRows[b].start = std::min(bandRows[b].start, top - 1);
+        bandRows[b].end = std::max(bandRows[b].end, top + stats.at<int>(i, CC_STAT_HEIGHT) + 1);
+    }
+
+    vector<CTree> trees(nbands);
+    parallel_for_(Range(0, nbands), [&](const Range& range) {
+        for (int b = range.start; b < range.end; b++)
+        {
+            if (bandRows[b].size() <= 0)
+                continue;
+            const Range rows = bandRows[b];
+            ContourScanner scanner =
+                create(image.rowRange(rows).clone(), mode, approx_method2, offset + Point(0, rows.start));
+            scanner->scanLabels = labels.rowRange(rows);
+            scanner->labelBand = &band[0];
+            scanner->scanBand = b;
+            while (scanner->findNext())
+            {
+            }
+            trees[b] = std::move(scanner->tree);
+        }
+    });
+
+    // contours are keyed by the position where the scan meets them: the starting point of an
+    // outer border and the pixel right of the starting point of a hole border
+    vector<Vec4i> order;
+    vector<vector<int>> remap(nbands);
+    for (int b = 0; b < nbands; b++)
+    {
+        const int count = (int)trees[b].size();
+        remap[b].assign(std::max(count, 1), 0);
+        for (int i = 1; i < count; i++)
+        {
+            Contour& c = trees[b].elem(i).body;
+            c.origin.y += bandRows[b].start;
+            order.push_back(Vec4i(c.origin.y, c.origin.x + (c.isHole ? 1 : 0), b, i));
+        }
+    }
+    std::sort(order.begin(), order.end(), [](const Vec4i& a, const Vec4i& b) {
+        return a[0] < b[0] || (a[0] == b[0] && a[1] < b[1]);
+    });
+    for (const Vec4i& o : order)
+    {
+        CNode& src = trees[o[2]].elem(o[3]);
+        const int idx = tree.newElem().self();
+        tree.elem(idx).body = std::move(src.body);
+        remap[o[2]][o[3]] = idx;
+        tree.addChild(remap[o[2]][src.parent], idx);
+    }
+    return true;
+}
+
 //==============================================================================
 
 void cv::findContours(InputArray _image,
@@ -679,8 +818,11 @@ void cv::findContours(InputArray _image,
 
     // find contours
     ContourScanner scanner = ContourScanner_::create(image, mode, method, offset + Point(-1, -1));
-    while (scanner->findNext())
+    if (!scanner->findAllParallel())
     {
+        while (scanner->findNext())
+        {
+        }
     }
 
     contourTreeToResults(scanner->tree, res_type, _contours, _hierarchy);
@@ -218,6 +218,195 @@ void FilterEngine::apply(const Mat& src, Mat& dst, const Size& wsz, const Point&
         CV_CPU_DISPATCH_MODES_ALL);
 }
 
+void applyFilterParallel(const std::function<Ptr<FilterEngine>()>& createFilter,
+                         const Mat& src, Mat& dst, const Size& wsz, const Point& ofs)
+{
+    CV_INSTRUMENT_REGION();
+
+    Ptr<FilterEngine> f = createFilter();
+    // a band pays for the setup of its engine and for the aperture rows filtered again at its seams
+    const int minBandRows = std::max(f->ksize.height * 4, 16);
+    int nbands = std::min(getNumThreads(), std::min(src.rows / minBandRows, (int)(src.total() >> 16)));
+    Mat input = src;
+    if (nbands > 1 && src.data == dst.data)
+    {
+        // the bands must not read the rows already filtered by their neighbours
+        if (wsz == src.size())
+            input = src.clone();
+        else
+            nbands = 1;
+    }
+    if (nbands <= 1)
+    {
+        f->apply(src, dst, wsz, ofs);
+        return;
+    }
+
+    parallel_for_(Range(0, nbands), [&](const Range& range)
+    {
+        // only one range starts with the first band, it reuses the engine created above
+        Ptr<FilterEngine> bandFilter = range.start == 0 ? f : createFilter();
+        for (int i = range.start; i < range.end; i++)
+        {
+            const int y0 = src.rows * i / nbands, y1 = src.rows * (i + 1) / nbands;
+            Mat dstBand = dst.rowRange(y0, y1);
+            bandFilter->apply(input.rowRange(y0, y1), dstBand, wsz, ofs + Point(0, y0));
+        }
+    }, nbands);
+}
+
+int FilterPipeline::addFilter(int input, const FilterFactory& createFilter)
+{
+    CV_Assert(0 <= input && input < (int)stages.size());
+
+    Stage stage;
+    stage.input[0] = input;
+    stage.createFilter = createFilter;
+    stage.filter = createFilter();
+    CV_Assert(stage.filter);
+    if (input > 0)
+        CV_CheckTypeEQ(stage.filter->srcType, stages[input].type, "");
+    stage.type = stage.filter->dstType;
+    stages.push_back(stage);
+    return (int)stages.size() - 1;
+}
+
+int FilterPipeline::addPointwise(int input1, int input2, int dstType, const PointwiseOp& op)
+{
+    CV_Assert(0 <= input1 && input1 < (int)stages.size());
+    CV_Assert(-1 <= input2 && input2 < (int)stages.size());
+    CV_Assert(op);
+
+    Stage stage;
+    stage.input[0] = input1;
+    stage.input[1] = input2;
+    stage.type = dstType;
+    stage.op = op;
+    stages.push_back(stage);
+    return (int)stages.size() - 1;
+}
+
+void FilterPipeline::apply(const Mat& src, Mat& dst, const Size& wsz, const Point& ofs)
+{
+    CV_INSTRUMENT_REGION();
+
+    const int nstages = (int)stages.size();
+    CV_Assert(nstages > 1 && !src.empty());
+    CV_Assert(dst.size() == src.size());
+    CV_CheckTypeEQ(dst.type(), stages.back().type, "");
+
+    // the rows of a stage needed above and below a band of the result, through all the filters reading it
+    std::vector<int> top(nstages, 0), bottom(nstages, 0);
+    size_t rowBytes = 0;
+    for (int s = nstages - 1; s > 0; s--)
+    {
+        const Stage& stage = stages[s];
+        const int dy0 = stage.filter ? stage.filter->anchor.y : 0;
+        const int dy1 = stage.filter ? stage.filter->ksize.height - 1 - dy0 : 0;
+        for (int k = 0; k < 2; k++)
+        {
+            const int in = stage.input[k];
+            if (in < 0)
+                continue;
+            if (in == 0 && stage.filter)
+                CV_CheckTypeEQ(src.type(), stage.filter->srcType, "");
+            top[in] = std::max(top[in], top[s] + dy0);
+            bottom[in] = std::max(bottom[in], bottom[s] + dy1);
+        }
+        if (s < nstages - 1)
+            rowBytes += src.cols * CV_ELEM_SIZE(stage.type);
+    }
+    int margin = 0;
+    for (int s = 0; s < nstages; s++)
+        margin = std::max(margin, top[s] + bottom[s]);
+
+    // a band pays for the setup of its engines and for the rows computed again at its seams,
+    // and its intermediate rows should fit in the L2 cache
+    const int minBandRows = std::max(margin * 4, 16);
+    const int bandRows = std::max(minBandRows, (int)((1 << 18) / std::max(rowBytes, (size_t)1)));
+    int nbands = std::max(src.rows / bandRows, 1);
+    nbands = std::max(nbands, std::min(getNumThreads(), std::min(src.rows / minBandRows, (int)(src.total() >> 16))));
+
+    Mat input = src;
+    if (nbands > 1 && src.data == dst.data)
+    {
+        // the bands must not read the rows already written by the previous ones
+        Mat region = src;
+        region.adjustROI(ofs.y, wsz.height - ofs.y - src.rows, ofs.x, wsz.width - ofs.x - src.cols);
+        input = region.clone()(Rect(ofs, src.size()));
+    }
+
+    parallel_for_(Range(0, nbands), [&](const Range& range)
+    {
+        std::vector<Ptr<FilterEngine> > filters(nstages);
+        std::vector<Mat> bufs(nstages);
+        std::vector<Range> rows(nstages);
+        // only one range starts with the first band, it reuses the engines created by addFilter()
+        for (int s = 1; s < nstages; s++)
+            if (stages[s].filter)
+                filters[s] = range.start == 0 ? stages[s].filter : stages[s].createFilter();
+
+        auto inputRows = [&](int k, const Range& r) -> Mat
+        {
+            return k == 0 ? input.rowRange(r) : bufs[k].rowRange(r.start - rows[k].start, r.end - rows[k].start);
+        };
+
+        for (int i = range.start; i < range.end; i++)
+        {
+            // the rows of each stage needed for the band, from the result back to the source
+            std::fill(rows.begin(), rows.end(), Range(0, 0));
+            rows[nstages - 1] = Range(src.rows * i / nbands, src.rows * (i + 1) / nbands);
+            for (int s = nstages - 1; s > 0; s--)
+            {
+                if (rows[s].empty())
+                    continue;
+                const int dy0 = filters[s] ? filters[s]->anchor.y : 0;
+                const int dy1 = filters[s] ? filters[s]->ksize.height - 1 - dy0 : 0;
+                const Range r(std::max(rows[s].start - dy0, 0), std::min(rows[s].end + dy1, src.rows));
+                for (int k = 0; k < 2; k++)
+                {
+                    const int in = stages[s].input[k];
+                    if (in > 0)
+                        rows[in] = rows[in].empty() ? r : Range(std::min(rows[in].start, r.start),
+                                                                std::max(rows[in].end, r.end));
+                }
+            }
+
+            for (int s = 1; s < nstages; s++)
+            {
+                const Stage& stage = stages[s];
+                const Range& r = rows[s];
+                if (r.empty())
+                    continue;
+                Mat out;
+                if (s == nstages - 1)
+                    out = dst.rowRange(r);
+                else
+                {
+                    if (bufs[s].rows < r.size())
+                        bufs[s].create(std::max(r.size(), src.rows / nbands + margin), src.cols, stage.type);
+                    out = bufs[s].rowRange(0, r.size());
+                }
+
+                if (filters[s])
+                {
+                    // the intermediate images are filtered as the whole images
+                    if (stage.input[0] == 0)
+                        filters[s]->apply(input.rowRange(r), out, wsz, ofs + Point(0, r.start));
+                    else
+                        filters[s]->apply(inputRows(stage.input[0], r), out, src.size(), Point(0, r.start));
+                }
+                else
+                {
+                    const uchar* data = out.data;
+                    stage.op(inputRows(stage.input[0], r), stage.input[1] >= 0 ? inputRows(stage.input[1], r) : Mat(), out);
+                    CV_Assert(out.data == data && out.rows == r.size());
+                }
+            }
+        }
+    }, std::min(nbands, getNumThreads()));
+}
+
 /****************************************************************************************\
 *                                 Separable linear filter                                *
 \****************************************************************************************/
@@ -1353,11 +1542,11 @@ static void ocvFilter2D(int stype, int dtype, int kernel_type,
 {
     int borderTypeValue = borderType & ~BORDER_ISOLATED;
     Mat kernel = Mat(Size(kernel_width, kernel_height), kernel_type, kernel_data, kernel_step);
-    Ptr<FilterEngine> f = createLinearFilter(stype, dtype, kernel, Point(anchor_x, anchor_y), delta,
-                                             borderTypeValue);
     Mat src(Size(width, height), stype, src_data, src_step);
     Mat dst(Size(width, height), dtype, dst_data, dst_step);
-    f->apply(src, dst, Size(full_width, full_height), Point(offset_x, offset_y));
+    applyFilterParallel([&]() { return createLinearFilter(stype, dtype, kernel, Point(anchor_x, anchor_y), delta,
+                                                          borderTypeValue); },
+                        src, dst, Size(full_width, full_height), Point(offset_x, offset_y));
 }
 
 static bool replacementSepFilter(int stype, int dtype, int ktype,
@@ -1393,12 +1582,12 @@ static void ocvSepFilter(int stype, int dtype, int ktype,
 {
     Mat kernelX(Size(kernelx_len, 1), ktype, kernelx_data);
     Mat kernelY(Size(kernely_len, 1), ktype, kernely_data);
-    Ptr<FilterEngine> f = createSeparableLinearFilter(stype, dtype, kernelX, kernelY,
-                                                      Point(anchor_x, anchor_y),
-                                                      delta, borderType & ~BORDER_ISOLATED);
     Mat src(Size(width, height), stype, src_data, src_step);
     Mat dst(Size(width, height), dtype, dst_data, dst_step);
-    f->apply(src, dst, Size(full_width, full_height), Point(offset_x, offset_y));
+    applyFilterParallel([&]() { return createSeparableLinearFilter(stype, dtype, kernelX, kernelY,
+                                                                   Point(anchor_x, anchor_y),
+                                                                   delta, borderType & ~BORDER_ISOLATED); },
+                        src, dst, Size(full_width, full_height), Point(offset_x, offset_y));
 }
 
 //===================================================================
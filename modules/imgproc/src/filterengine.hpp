@@ -42,6 +42,7 @@ the use of this software, even if advised of the possibility of such damage.
 #define __OPENCV_IMGPROC_FILTERENGINE_HPP__
 
 #include "opencv2/imgproc.hpp"
+#include "opencv2/core/utils/buffer_pool.private.hpp"
 
 namespace cv
 {
@@ -265,10 +266,12 @@ public:
     int columnBorderType;
     std::vector<int> borderTab;
     int borderElemSize;
-    std::vector<uchar> ringBuf;
-    std::vector<uchar> srcRow;
-    std::vector<uchar> constBorderValue;
-    std::vector<uchar> constBorderRow;
+    // row buffers are taken from the CPU buffer pool: engines are usually re-created on each call
+    typedef std::vector<uchar, utils::PooledStdAllocator<uchar> > RowBuffer;
+    RowBuffer ringBuf;
+    RowBuffer srcRow;
+    RowBuffer constBorderValue;
+    RowBuffer constBorderRow;
     int bufStep;
     int startY;
     int startY0;
@@ -358,6 +361,63 @@ CV_EXPORTS Ptr<FilterEngine> createMorphologyFilter(int op, int type, InputArray
                                                     int columnBorderType = -1,
                                                     const Scalar& borderValue = morphologyDefaultBorderValue());
 
+//! applies the filter like FilterEngine::apply(), but to the bands of rows in parallel. Each band is filtered
+//! by its own engine returned by createFilter, and the aperture rows around it are read from the image, so the
+//! result doesn't depend on the number of bands. In-place filtering of a submatrix is done on one thread.
+void applyFilterParallel(const std::function<Ptr<FilterEngine>()>& createFilter,
+                         const Mat& src, Mat& dst, const Size& wsz, const Point& ofs);
+
+/*!
+ The Chain of Filters and Pointwise Operations Processed by Bands of Rows
+
+ The stage 0 is the source image, each added stage reads the source or the previous stages,
+ and the last stage is the result. For a band of the result every stage computes only the rows
+ which are needed by the following stages, so the intermediate images are never stored in full,
+ their bands stay in the cache. The bands are processed in parallel.
+
+ The result is the same as when the stages are applied to the whole images one by one:
+ the filters of the source read the aperture rows around the ROI like FilterEngine::apply(),
+ and the intermediate images are filtered as the whole images of the size of the ROI.
+ Here is how morphologyEx(MORPH_GRADIENT) is computed:
+
+ \code
+     FilterPipeline pipeline;
+     int dilated = pipeline.addFilter(0, [&]() { return createMorphologyFilter(MORPH_DILATE, type, kernel); });
+     int eroded = pipeline.addFilter(0, [&]() { return createMorphologyFilter(MORPH_ERODE, type, kernel); });
+     pipeline.addPointwise(dilated, eroded, type, [](const Mat& a, const Mat& b, Mat& d) { subtract(a, b, d); });
+     pipeline.apply(src, dst, wsz, ofs);
+ \endcode
+*/
+class FilterPipeline
+{
+public:
+    typedef std::function<Ptr<FilterEngine>()> FilterFactory;
+    //! computes the rows of a stage from the same rows of its inputs, src2 is empty for the operations of one input
+    typedef std::function<void(const Mat& src1, const Mat& src2, Mat& dst)> PointwiseOp;
+
+    //! creates the pipeline of the source stage only
+    FilterPipeline() : stages(1) {}
+    //! adds the stage filtering the stage input by the engines from createFilter. Returns the index of the stage.
+    int addFilter(int input, const FilterFactory& createFilter);
+    //! adds the stage computed by op from the stages input1 and input2 (-1 for one input). Returns the index of the stage.
+    int addPointwise(int input1, int input2, int dstType, const PointwiseOp& op);
+    //! applies the stages to the ROI src at ofs of the image of size wsz and stores the last stage in dst
+    void apply(const Mat& src, Mat& dst, const Size& wsz, const Point& ofs);
+
+protected:
+    struct Stage
+    {
+        Stage() : type(-1) { input[0] = input[1] = -1; }
+
+        int input[2];
+        int type;
+        FilterFactory createFilter;
+        Ptr<FilterEngine> filter;  // created by addFilter(), the first band reuses it
+        PointwiseOp op;
+    };
+    std::vector<Stage> stages;
+};
+
 static inline Point normalizeAnchor( Point anchor, Size ksize )
 {
    if( anchor.x == -1 )
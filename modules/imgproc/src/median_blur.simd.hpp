@@ -81,7 +81,7 @@ void medianBlur(const Mat& src0, /*const*/ Mat& dst, int ksize);
 #ifndef CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
 
 static void
-medianBlur_8u_O1( const Mat& _src, Mat& _dst, int ksize )
+medianBlur_8u_O1( const Mat& _src, Mat& _dst, int ksize, const Range& rows )
 {
     CV_INSTRUMENT_REGION();
 
@@ -141,21 +141,18 @@ medianBlur_8u_O1( const Mat& _src, Mat& _dst, int ksize )
         memset( h_coarse, 0, 16*n*cn*sizeof(h_coarse[0]) );
         memset( h_fine, 0, 16*16*n*cn*sizeof(h_fine[0]) );
 
-        // First row initialization
+        // Column histograms of the row preceding the band
         for( c = 0; c < cn; c++ )
         {
-            for( j = 0; j < n; j++ )
-                COP( c, j, src[cn*j+c], += (HT)(r+2) );
-
-            for( i = 1; i < r; i++ )
+            for( i = rows.start - r - 1; i < rows.start + r; i++ )
             {
-                const uchar* p = src + sstep*std::min(i, m-1);
+                const uchar* p = src + sstep*std::min(std::max(i, 0), m-1);
                 for ( j = 0; j < n; j++ )
                     COP( c, j, p[cn*j+c], ++ );
             }
         }
 
-        for( i = 0; i < m; i++ )
+        for( i = rows.start; i < rows.end; i++ )
         {
             const uchar* p0 = src + sstep * std::max( 0, i-r-1 );
             const uchar* p1 = src + sstep * std::min( m-1, i+r );
@@ -345,7 +342,7 @@ medianBlur_8u_O1( const Mat& _src, Mat& _dst, int ksize )
 }
 
 static void
-medianBlur_8u_Om( const Mat& _src, Mat& _dst, int m )
+medianBlur_8u_Om( const Mat& _src, Mat& _dst, int m, const Range& cols )
 {
     CV_INSTRUMENT_REGION();
 
@@ -361,6 +358,8 @@ medianBlur_8u_Om( const Mat& _src, Mat& _dst, int m )
     int     cn = _src.channels();
     const uchar*  src_max = src + size.height*src_step;
     CV_Assert(cn > 0 && cn <= 4);
+    src += cols.start*cn;
+    dst += cols.start*cn;
 
     #define UPDATE_ACC01( pix, cn, op ) \
     {                                   \
@@ -370,7 +369,7 @@ medianBlur_8u_Om( const Mat& _src, Mat& _dst, int m )
     }
 
     //CV_Assert( size.height >= nx && size.width >= nx );
-    for( x = 0; x < size.width; x++, src += cn, dst += cn )
+    for( x = cols.start; x < cols.end; x++, src += cn, dst += cn )
     {
         uchar* dst_cur = dst;
         const uchar* src_top = src;
@@ -620,7 +619,7 @@ typedef MinMax32f MinMaxVec32f;
 
 template<class Op, class VecOp>
 static void
-medianBlur_SortNet( const Mat& _src, Mat& _dst, int m )
+medianBlur_SortNet( const Mat& _src, Mat& _dst, int m, const Range& rows )
 {
     CV_INSTRUMENT_REGION();
 
@@ -660,7 +659,8 @@ medianBlur_SortNet( const Mat& _src, Mat& _dst, int m )
         }
 
         size.width *= cn;
-        for( i = 0; i < size.height; i++, dst += dstep )
+        dst = _dst.ptr<T>(rows.start);
+        for( i = rows.start; i < rows.end; i++, dst += dstep )
         {
             const T* row0 = src + std::max(i - 1, 0)*sstep;
             const T* row1 = src + i*sstep;
@@ -737,7 +737,8 @@ medianBlur_SortNet( const Mat& _src, Mat& _dst, int m )
         }
 
         size.width *= cn;
-        for( i = 0; i < size.height; i++, dst += dstep )
+        dst = _dst.ptr<T>(rows.start);
+        for( i = rows.start; i < rows.end; i++, dst += dstep )
         {
             const T* row[5];
             row[0] = src + std::max(i - 2, 0)*sstep;
@@ -838,6 +839,130 @@ medianBlur_SortNet( const Mat& _src, Mat& _dst, int m )
     }
 }
 
+// Order-preserving integer keys, so that the sorted window can use exact comparisons
+// (for floats that also gives NaNs a fixed place in the order)
+struct MedianKey16u
+{
+    typedef ushort value_type;
+    static int toKey(ushort v) { return v; }
+    static ushort fromKey(int k) { return (ushort)k; }
+};
+
+struct MedianKey16s
+{
+    typedef short value_type;
+    static int toKey(short v) { return v; }
+    static short fromKey(int k) { return (short)k; }
+};
+
+struct MedianKey32f
+{
+    typedef float value_type;
+    static int toKey(float v)
+    {
+        Cv32suf u;
+        u.f = v;
+        return u.i ^ ((u.i >> 31) & 0x7fffffff);
+    }
+    static float fromKey(int k)
+    {
+        Cv32suf u;
+        u.i = k ^ ((k >> 31) & 0x7fffffff);
+        return u.f;
+    }
+};
+
+/**
+ * Median of any aperture for depths without a histogram method. Every column of the aperture
+ * is kept sorted while moving down (one removal and one insertion per row), and every row keeps
+ * a sorted window of m*m keys per channel; moving one pixel right drops the outgoing column
+ * from the window and merges the incoming one, both in O(m*m).
+ */
+template<class Key>
+static void
+medianBlur_SortedWindow( const Mat& _src, Mat& _dst, int m, const Range& rows )
+{
+    CV_INSTRUMENT_REGION();
+
+    typedef typename Key::value_type T;
+
+    Size size = _dst.size();
+    int i, j, k, cn = _src.channels(), r = m/2, n = m*m, width = size.width*cn;
+    AutoBuffer<int> _buf(n + width*m);
+    int* win = _buf.data();
+    int* cols = win + n;
+
+    // sorted columns of the row preceding the band
+    for( k = 0; k < m; k++ )
+    {
+        const T* srow = _src.ptr<T>(std::min(std::max(rows.start - 1 - r + k, 0), size.height - 1));
+        for( j = 0; j < width; j++ )
+            cols[j*m + k] = Key::toKey(srow[j]);
+    }
+    for( j = 0; j < width; j++ )
+        std::sort(cols + j*m, cols + (j + 1)*m);
+
+    for( i = rows.start; i < rows.end; i++ )
+    {
+        const T* srow0 = _src.ptr<T>(std::max(i - r - 1, 0));
+        const T* srow1 = _src.ptr<T>(std::min(i + r, size.height - 1));
+        for( j = 0; j < width; j++ )
+        {
+            int* col = cols + j*m;
+            int vo = Key::toKey(srow0[j]), vi = Key::toKey(srow1[j]);
+            int p = 0;
+            while( col[p] != vo )
+                p++;
+            if( vi > vo )
+                for( ; p < m - 1 && col[p + 1] < vi; p++ )
+                    col[p] = col[p + 1];
+            else
+                for( ; p > 0 && col[p - 1] > vi; p-- )
+                    col[p] = col[p - 1];
+            col[p] = vi;
+        }
+
+        T* dst = _dst.ptr<T>(i);
+        for( int c = 0; c < cn; c++ )
+        {
+            int len = 0;
+            for( j = -r; j <= r; j++ )
+            {
+                const int* col = cols + (std::min(std::max(j, 0), size.width - 1)*cn + c)*m;
+                for( k = 0; k < m; k++ )
+                    win[len++] = col[k];
+            }
+            std::sort(win, win + n);
+            dst[c] = Key::fromKey(win[n/2]);
+
+            for( j = 1; j < size.width; j++ )
+            {
+                const int* outc = cols + (std::max(j - r - 1, 0)*cn + c)*m;
+                const int* inc = cols + (std::min(j + r, size.width - 1)*cn + c)*m;
+                int a, b, d;
+
+                // drop the outgoing column in place, then merge the incoming one from the back
+                for( a = 0, b = 0, len = 0; a < n; a++ )
+                {
+                    int v = win[a];
+                    if( b < m && v == outc[b] )
+                    {
+                        b++;
+                        continue;
+                    }
+                    win[len++] = v;
+                }
+                CV_DbgAssert( len == n - m && b == m );
+
+                for( a = n - m - 1, d = m - 1, len = n - 1; d >= 0; len-- )
+                    win[len] = a >= 0 && win[a] > inc[d] ? win[a--] : inc[d--];
+
+                dst[j*cn + c] = Key::fromKey(win[n/2]);
+            }
+        }
+    }
+}
+
 } // namespace anon
 
 void medianBlur(const Mat& src0, /*const*/ Mat& dst, int ksize)
@@ -850,6 +975,10 @@ void medianBlur(const Mat& src0, /*const*/ Mat& dst, int ksize)
 #endif
         );
 
+    // rows (columns for the per-column histogram) are split into bands of at least
+    // 4 apertures, so re-initializing the running state of each band stays cheap
+    int nstripes = std::max(1, std::min(getNumThreads(), dst.rows / (ksize*4)));
+
     Mat src;
     if( useSortNet )
     {
@@ -858,19 +987,50 @@ void medianBlur(const Mat& src0, /*const*/ Mat& dst, int ksize)
         else
             src0.copyTo(src);
 
-        if( src.depth() == CV_8U )
-            medianBlur_SortNet<MinMax8u, MinMaxVec8u>( src, dst, ksize );
-        else if( src.depth() == CV_16U )
-            medianBlur_SortNet<MinMax16u, MinMaxVec16u>( src, dst, ksize );
-        else if( src.depth() == CV_16S )
-            medianBlur_SortNet<MinMax16s, MinMaxVec16s>( src, dst, ksize );
-        else if( src.depth() == CV_32F )
-            medianBlur_SortNet<MinMax32f, MinMaxVec32f>( src, dst, ksize );
-        else
+        if( src.cols == 1 || src.rows == 1 )
+            nstripes = 1;
+
+        int depth = src.depth();
+        if( depth != CV_8U && depth != CV_16U && depth != CV_16S && depth != CV_32F )
             CV_Error(cv::Error::StsUnsupportedFormat, "");
 
+        parallel_for_(Range(0, nstripes), [&](const Range& range)
+        {
+            Range rows(range.start*dst.rows/nstripes, range.end*dst.rows/nstripes);
+            if( depth == CV_8U )
+                medianBlur_SortNet<MinMax8u, MinMaxVec8u>( src, dst, ksize, rows );
+            else if( depth == CV_16U )
+                medianBlur_SortNet<MinMax16u, MinMaxVec16u>( src, dst, ksize, rows );
+            else if( depth == CV_16S )
+                medianBlur_SortNet<MinMax16s, MinMaxVec16s>( src, dst, ksize, rows );
+            else
+                medianBlur_SortNet<MinMax32f, MinMaxVec32f>( src, dst, ksize, rows );
+        }, nstripes);
+
         return;
     }
+    else if( src0.depth() != CV_8U )
+    {
+        if( dst.data != src0.data )
+            src = src0;
+        else
+            src0.copyTo(src);
+
+        int depth = src.depth();
+        if( depth != CV_16U && depth != CV_16S && depth != CV_32F )
+            CV_Error(cv::Error::StsUnsupportedFormat, "");
+
+        parallel_for_(Range(0, nstripes), [&](const Range& range)
+        {
+            Range rows(range.start*dst.rows/nstripes, range.end*dst.rows/nstripes);
+            if( depth == CV_16U )
+                medianBlur_SortedWindow<MedianKey16u>( src, dst, ksize, rows );
+            else if( depth == CV_16S )
+                medianBlur_SortedWindow<MedianKey16s>( src, dst, ksize, rows );
+            else
+                medianBlur_SortedWindow<MedianKey32f>( src, dst, ksize, rows );
+        }, nstripes);
+    }
     else
     {
         // TODO AVX guard (external call)
@@ -882,9 +1042,21 @@ void medianBlur(const Mat& src0, /*const*/ Mat& dst, int ksize)
         double img_size_mp = (double)(src0.total())/(1 << 20);
         if( ksize <= 3 + (img_size_mp < 1 ? 12 : img_size_mp < 4 ? 6 : 2)*
             ((CV_SIMD || CV_SIMD_SCALABLE) ? 1 : 3))
-            medianBlur_8u_Om( src, dst, ksize );
+        {
+            // every column is filtered on its own
+            parallel_for_(Range(0, dst.cols), [&](const Range& cols)
+            {
+                medianBlur_8u_Om( src, dst, ksize, cols );
+            }, std::min(dst.cols, getNumThreads()*4));
+        }
         else
-            medianBlur_8u_O1( src, dst, ksize );
+        {
+            parallel_for_(Range(0, nstripes), [&](const Range& range)
+            {
+                Range rows(range.start*dst.rows/nstripes, range.end*dst.rows/nstripes);
+                medianBlur_8u_O1( src, dst, ksize, rows );
+            }, nstripes);
+        }
     }
 }
 
@@ -444,19 +444,31 @@ static void ocvMorph(int op, int src_type, int dst_type,
     Mat kernel(Size(kernel_width, kernel_height), kernel_type, kernel_data, kernel_step);
     Point anchor(anchor_x, anchor_y);
     Vec<double, 4> borderVal(borderValue);
-    Ptr<FilterEngine> f = createMorphologyFilter(op, src_type, kernel, anchor, borderType, borderType, borderVal);
+    std::function<Ptr<FilterEngine>()> createFilter = [&]()
+    {
+        return createMorphologyFilter(op, src_type, kernel, anchor, borderType, borderType, borderVal);
+    };
     Mat src(Size(width, height), src_type, src_data, src_step);
     Mat dst(Size(width, height), dst_type, dst_data, dst_step);
+    if( iterations > 1 && roi_width2 == width && roi_height2 == height )
+    {
+        // the iterations on a whole dst image are chained by bands of rows instead of passes over the image
+        FilterPipeline pipeline;
+        for( int i = 0, stage = 0; i < iterations; i++ )
+            stage = pipeline.addFilter(stage, createFilter);
+        pipeline.apply(src, dst, Size(roi_width, roi_height), Point(roi_x, roi_y));
+        return;
+    }
     {
         Point ofs(roi_x, roi_y);
         Size wsz(roi_width, roi_height);
-        f->apply( src, dst, wsz, ofs );
+        applyFilterParallel( createFilter, src, dst, wsz, ofs );
     }
     {
         Point ofs(roi_x2, roi_y2);
         Size wsz(roi_width2, roi_height2);
         for( int i = 1; i < iterations; i++ )
-            f->apply( dst, dst, wsz, ofs );
+            applyFilterParallel( createFilter, dst, dst, wsz, ofs );
     }
 }
 
@@ -932,6 +944,27 @@ static bool ocl_morphOp(InputArray _src, OutputArray _dst, InputArray _kernel,
 
 #endif
 
+// the iterations of a rectangular kernel are equivalent to one pass of a larger rectangle
+static void collapseMorphIterations(Mat& kernel, Point& anchor, int& iterations)
+{
+    Size ksize = kernel.size();
+    if (kernel.empty())
+    {
+        kernel = getStructuringElement(MORPH_RECT, Size(1+iterations*2,1+iterations*2));
+        anchor = Point(iterations, iterations);
+        iterations = 1;
+    }
+    else if( iterations > 1 && countNonZero(kernel) == kernel.rows*kernel.cols )
+    {
+        anchor = Point(anchor.x*iterations, anchor.y*iterations);
+        kernel = getStructuringElement(MORPH_RECT,
+                                       Size(ksize.width + (iterations-1)*(ksize.width-1),
+                                            ksize.height + (iterations-1)*(ksize.height-1)),
+                                       anchor);
+        iterations = 1;
+    }
+}
+
 static void morphOp( int op, InputArray _src, OutputArray _dst,
                      InputArray _kernel,
                      Point anchor, int iterations,
@@ -957,21 +990,7 @@ static void morphOp( int op, InputArray _src, OutputArray _dst,
         return;
     }
 
-    if (kernel.empty())
-    {
-        kernel = getStructuringElement(MORPH_RECT, Size(1+iterations*2,1+iterations*2));
-        anchor = Point(iterations, iterations);
-        iterations = 1;
-    }
-    else if( iterations > 1 && countNonZero(kernel) == kernel.rows*kernel.cols )
-    {
-        anchor = Point(anchor.x*iterations, anchor.y*iterations);
-        kernel = getStructuringElement(MORPH_RECT,
-                                       Size(ksize.width + (iterations-1)*(ksize.width-1),
-                                            ksize.height + (iterations-1)*(ksize.height-1)),
-                                       anchor);
-        iterations = 1;
-    }
+    collapseMorphIterations(kernel, anchor, iterations);
 
     Mat src = _src.getMat();
     _dst.create( src.size(), src.type() );
@@ -1154,6 +1173,88 @@ static bool ipp_morphologyEx(int op, InputArray _src, OutputArray _dst,
 #endif
 #endif
 
+static bool halMorphImplemented(int op, const Mat& src, const Mat& kernel, Point anchor,
+                                int borderType, const Scalar& borderValue, int iterations, bool isSubmatrix)
+{
+    cvhalFilter2D * ctx;
+    int res = cv_hal_morphInit(&ctx, op, src.type(), src.type(), src.cols, src.rows,
+                               kernel.type(), kernel.data, kernel.step, kernel.cols, kernel.rows,
+                               anchor.x, anchor.y, borderType, borderValue.val,
+                               iterations, isSubmatrix, false);
+    if (res != CV_HAL_ERROR_OK)
+        return false;
+    cv_hal_morphFree(ctx);
+    return true;
+}
+
+// the chains of erosions and dilations run by bands of rows, so the intermediate images stay in the cache.
+// The result is the same as of the sequence of erode() and dilate() calls in morphologyEx().
+static bool ocvMorphologyExFused(int op, const Mat& src, Mat& dst, Mat kernel, Point anchor, int iterations,
+                                 int borderType, const Scalar& borderValue)
+{
+    if (op != MORPH_OPEN && op != MORPH_CLOSE && op != MORPH_GRADIENT && op != MORPH_TOPHAT && op != MORPH_BLACKHAT)
+        return false;
+
+    anchor = normalizeAnchor(anchor, kernel.size());
+    if (iterations == 0 || kernel.rows*kernel.cols == 1)
+        return false;
+    collapseMorphIterations(kernel, anchor, iterations);
+
+    bool isolated = (borderType&BORDER_ISOLATED)?true:false;
+    borderType = (borderType&~BORDER_ISOLATED);
+    // the second operation of the sequence reads the rows around dst
+    if (!isolated && dst.isSubmatrix())
+        return false;
+
+    bool isSubmatrix = src.isSubmatrix() && !isolated;
+    if (halMorphImplemented(MORPH_ERODE, src, kernel, anchor, borderType, borderValue, iterations, isSubmatrix) ||
+        halMorphImplemented(MORPH_DILATE, src, kernel, anchor, borderType, borderValue, iterations, isSubmatrix))
+        return false;
+
+    Point ofs;
+    Size wsz(src.cols, src.rows);
+    if (!isolated)
+        src.locateROI(wsz, ofs);
+
+    const int type = src.type();
+    const Vec<double, 4> borderVal(borderValue.val);
+    FilterPipeline pipeline;
+    auto addMorph = [&](int input, int morphOp)
+    {
+        for (int i = 0; i < iterations; i++)
+            input = pipeline.addFilter(input, [=]()
+            {
+                return createMorphologyFilter(morphOp, type, kernel, anchor, borderType, borderType, borderVal);
+            });
+        return input;
+    };
+    const FilterPipeline::PointwiseOp sub = [](const Mat& a, const Mat& b, Mat& d) { subtract(a, b, d); };
+
+    switch( op )
+    {
+    case MORPH_OPEN:
+        addMorph(addMorph(0, MORPH_ERODE), MORPH_DILATE);
+        break;
+    case MORPH_CLOSE:
+        addMorph(addMorph(0, MORPH_DILATE), MORPH_ERODE);
+        break;
+    case MORPH_GRADIENT:
+    {
+        int eroded = addMorph(0, MORPH_ERODE);
+        pipeline.addPointwise(addMorph(0, MORPH_DILATE), eroded, type, sub);
+        break;
+    }
+    case MORPH_TOPHAT:
+        pipeline.addPointwise(0, addMorph(addMorph(0, MORPH_ERODE), MORPH_DILATE), type, sub);
+        break;
+    case MORPH_BLACKHAT:
+        pipeline.addPointwise(addMorph(addMorph(0, MORPH_DILATE), MORPH_ERODE), 0, type, sub);
+        break;
+    }
+    pipeline.apply(src, dst, wsz, ofs);
+    return true;
+}
+
 void morphologyEx( InputArray _src, OutputArray _dst, int op,
                        InputArray _kernel, Point anchor, int iterations,
                        int borderType, const Scalar& borderValue )
@@ -1185,6 +1286,9 @@ void morphologyEx( InputArray _src, OutputArray _dst, int op,
     //CV_IPP_RUN_FAST(ipp_morphologyEx(op, src, dst, kernel, anchor, iterations, borderType, borderValue));
 #endif
 
+    if (ocvMorphologyExFused(op, src, dst, kernel, anchor, iterations, borderType, borderValue))
+        return;
+
     switch( op )
     {
     case MORPH_ERODE:
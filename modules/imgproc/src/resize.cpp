@@ -52,6 +52,7 @@
 #include "hal_replacement.hpp"
 #include "opencv2/core/hal/intrin.hpp"
 #include "opencv2/core/utils/buffer_area.private.hpp"
+#include "opencv2/core/utils/buffer_pool.private.hpp"
 
 #include "opencv2/core/openvx/ovx_defs.hpp"
 #include "resize.hpp"
@@ -924,7 +925,7 @@ void resize_bitExact(const uchar* src, size_t src_step, int src_width, int src_h
     interpolation interp_x(inv_scale_x, src_width, dst_width);
     interpolation interp_y(inv_scale_y, src_height, dst_height);
 
-    AutoBuffer<uchar> buf( dst_width * sizeof(int) +
+    utils::PooledAutoBuffer<uchar> buf( dst_width * sizeof(int) +
                            dst_height * sizeof(int) +
                            dst_width * interp_x.len*sizeof(fixedpoint) +
                            dst_height * interp_y.len * sizeof(fixedpoint) );
@@ -1122,7 +1123,7 @@ static void
 resizeNN( const Mat& src, Mat& dst, double fx, double fy )
 {
     Size ssize = src.size(), dsize = dst.size();
-    AutoBuffer<int> _x_ofs(dsize.width);
+    utils::PooledAutoBuffer<int> _x_ofs(dsize.width);
     int* x_ofs = _x_ofs.data();
     int pix_size = (int)src.elemSize();
     double ifx = 1./fx, ify = 1./fy;
@@ -2189,7 +2190,7 @@ public:
         VResize vresize;
 
         int bufstep = (int)alignSize(dsize.width, 16);
-        AutoBuffer<WT> _buffer(bufstep*ksize);
+        utils::PooledAutoBuffer<WT> _buffer(bufstep*ksize);
         const T* srows[MAX_ESIZE]={0};
         WT* rows[MAX_ESIZE]={0};
         int prev_sy[MAX_ESIZE];
@@ -3203,7 +3204,7 @@ public:
         Size dsize = dst->size();
         int cn = dst->channels();
         dsize.width *= cn;
-        AutoBuffer<WT> _buffer(dsize.width*2);
+        utils::PooledAutoBuffer<WT> _buffer(dsize.width*2);
         const DecimateAlpha* xtab = xtab0;
         int xtab_size = xtab_size0;
         WT *buf = _buffer.data(), *sum = buf + dsize.width;
@@ -4019,7 +4020,7 @@ void resize(int src_type,
             {
                 int area = iscale_x*iscale_y;
                 size_t srcstep = src_step / src.elemSize1();
-                AutoBuffer<int> _ofs(area + dsize.width*cn);
+                utils::PooledAutoBuffer<int> _ofs(area + dsize.width*cn);
                 int* ofs = _ofs.data();
                 int* xofs = ofs + area;
                 ResizeAreaFastFunc func = areafast_tab[depth];
@@ -4044,13 +4045,13 @@ void resize(int src_type,
             ResizeAreaFunc func = area_tab[depth];
             CV_Assert( func != 0 && cn <= 4 );
 
-            AutoBuffer<DecimateAlpha> _xytab((src_width + src_height)*2);
+            utils::PooledAutoBuffer<DecimateAlpha> _xytab((src_width + src_height)*2);
             DecimateAlpha* xtab = _xytab.data(), *ytab = xtab + src_width*2;
 
             int xtab_size = computeResizeAreaTab(src_width, dsize.width, cn, scale_x, xtab);
             int ytab_size = computeResizeAreaTab(src_height, dsize.height, 1, scale_y, ytab);
 
-            AutoBuffer<int> _tabofs(dsize.height + 1);
+            utils::PooledAutoBuffer<int> _tabofs(dsize.height + 1);
             int* tabofs = _tabofs.data();
             for( k = 0, dy = 0; k < ytab_size; k++ )
             {
@@ -4085,7 +4086,7 @@ void resize(int src_type,
 
     CV_Assert( func != 0 );
 
-    AutoBuffer<uchar> _buffer((width + dsize.height)*(sizeof(int) + sizeof(float)*ksize));
+    utils::PooledAutoBuffer<uchar> _buffer((width + dsize.height)*(sizeof(int) + sizeof(float)*ksize));
     int* xofs = (int*)_buffer.data();
     int* yofs = xofs + width;
     float* alpha = (float*)(yofs + dsize.height);
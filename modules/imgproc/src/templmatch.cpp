@@ -563,95 +563,101 @@ static bool ocl_matchTemplate( InputArray _img, InputArray _templ, OutputArray _
 
 #include "opencv2/core/hal/hal.hpp"
 
-void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
-                Point anchor, double delta, int borderType )
+// computes the correlation of the image with several templates of the same size and type,
+// the spectrum of each image tile is computed once for all of them
+static void crossCorrMulti( const Mat& img, const std::vector<Mat>& _templs, std::vector<Mat>& corrs,
+                            Point anchor, double delta, int borderType )
 {
     const double blockScale = 4.5;
     const int minBlockSize = 256;
     std::vector<uchar> buf;
 
-    Mat templ = _templ;
+    CV_Assert( !_templs.empty() && _templs.size() == corrs.size() );
+    const int ntempl = (int)_templs.size();
+    std::vector<Mat> templs(_templs);
+    const Mat& corr = corrs[0];
     int depth = img.depth(), cn = img.channels();
-    int tdepth = templ.depth(), tcn = templ.channels();
+    int tdepth = templs[0].depth(), tcn = templs[0].channels();
     int cdepth = corr.depth(), ccn = corr.channels();
+    Size templSize = templs[0].size();
 
-    CV_Assert( img.dims <= 2 && templ.dims <= 2 && corr.dims <= 2 );
+    CV_Assert( img.dims <= 2 && templs[0].dims <= 2 && corr.dims <= 2 );
 
-    if( depth != tdepth && tdepth != std::max(CV_32F, depth) )
+    for( int t = 0; t < ntempl; t++ )
     {
-        _templ.convertTo(templ, std::max(CV_32F, depth));
-        tdepth = templ.depth();
+        CV_Assert( templs[t].size() == templSize && templs[t].type() == templs[0].type() );
+        CV_Assert( corrs[t].size() == corr.size() && corrs[t].type() == corr.type() );
+        if( depth != tdepth && tdepth != std::max(CV_32F, depth) )
+            _templs[t].convertTo(templs[t], std::max(CV_32F, depth));
     }
+    tdepth = templs[0].depth();
 
     CV_Assert( depth == tdepth || tdepth == CV_32F);
-    CV_Assert( corr.rows <= img.rows + templ.rows - 1 &&
-               corr.cols <= img.cols + templ.cols - 1 );
+    CV_Assert( corr.rows <= img.rows + templSize.height - 1 &&
+               corr.cols <= img.cols + templSize.width - 1 );
 
     CV_Assert( ccn == 1 || delta == 0 );
 
     int maxDepth = depth > CV_8S ? CV_64F : std::max(std::max(CV_32F, tdepth), cdepth);
     Size blocksize, dftsize;
 
-    blocksize.width = cvRound(templ.cols*blockScale);
-    blocksize.width = std::max( blocksize.width, minBlockSize - templ.cols + 1 );
+    blocksize.width = cvRound(templSize.width*blockScale);
+    blocksize.width = std::max( blocksize.width, minBlockSize - templSize.width + 1 );
     blocksize.width = std::min( blocksize.width, corr.cols );
-    blocksize.height = cvRound(templ.rows*blockScale);
-    blocksize.height = std::max( blocksize.height, minBlockSize - templ.rows + 1 );
+    blocksize.height = cvRound(templSize.height*blockScale);
+    blocksize.height = std::max( blocksize.height, minBlockSize - templSize.height + 1 );
     blocksize.height = std::min( blocksize.height, corr.rows );
 
-    dftsize.width = std::max(getOptimalDFTSize(blocksize.width + templ.cols - 1), 2);
-    dftsize.height = getOptimalDFTSize(blocksize.height + templ.rows - 1);
+    dftsize.width = std::max(getOptimalDFTSize(blocksize.width + templSize.width - 1), 2);
+    dftsize.height = getOptimalDFTSize(blocksize.height + templSize.height - 1);
     if( dftsize.width <= 0 || dftsize.height <= 0 )
         CV_Error( cv::Error::StsOutOfRange, "the input arrays are too big" );
 
     // recompute block size
-    blocksize.width = dftsize.width - templ.cols + 1;
+    blocksize.width = dftsize.width - templSize.width + 1;
     blocksize.width = MIN( blocksize.width, corr.cols );
-    blocksize.height = dftsize.height - templ.rows + 1;
+    blocksize.height = dftsize.height - templSize.height + 1;
     blocksize.height = MIN( blocksize.height, corr.rows );
 
-    Mat dftTempl( dftsize.height*tcn, dftsize.width, maxDepth );
-    Mat dftImg( dftsize, maxDepth );
+    // the planes of the templates one after another
+    Mat dftTempl( dftsize.height*tcn*ntempl, dftsize.width, maxDepth );
 
-    int i, k, bufSize = 0;
+    int bufSize = 0;
     if( tcn > 1 && tdepth != maxDepth )
-        bufSize = templ.cols*templ.rows*CV_ELEM_SIZE(tdepth);
-
-    if( cn > 1 && depth != maxDepth )
-        bufSize = std::max( bufSize, (blocksize.width + templ.cols - 1)*
-            (blocksize.height + templ.rows - 1)*CV_ELEM_SIZE(depth));
-
-    if( (ccn > 1 || cn > 1) && cdepth != maxDepth )
-        bufSize = std::max( bufSize, blocksize.width*blocksize.height*CV_ELEM_SIZE(cdepth));
+        bufSize = templSize.width*templSize.height*CV_ELEM_SIZE(tdepth);
 
     buf.resize(bufSize);
 
-    Ptr<hal::DFT2D> c = hal::DFT2D::create(dftsize.width, dftsize.height, dftTempl.depth(), 1, 1, CV_HAL_DFT_IS_INPLACE, templ.rows);
+    Ptr<hal::DFT2D> c = hal::DFT2D::create(dftsize.width, dftsize.height, dftTempl.depth(), 1, 1, CV_HAL_DFT_IS_INPLACE, templSize.height);
 
     // compute DFT of each template plane
-    for( k = 0; k < tcn; k++ )
+    for( int t = 0; t < ntempl; t++ )
     {
-        int yofs = k*dftsize.height;
-        Mat src = templ;
-        Mat dst(dftTempl, Rect(0, yofs, dftsize.width, dftsize.height));
-        Mat dst1(dftTempl, Rect(0, yofs, templ.cols, templ.rows));
-
-        if( tcn > 1 )
+        const Mat& templ = templs[t];
+        for( int k = 0; k < tcn; k++ )
         {
-            src = tdepth == maxDepth ? dst1 : Mat(templ.size(), tdepth, &buf[0]);
-            int pairs[] = {k, 0};
-            mixChannels(&templ, 1, &src, 1, pairs, 1);
-        }
+            int yofs = (t*tcn + k)*dftsize.height;
+            Mat src = templ;
+            Mat dst(dftTempl, Rect(0, yofs, dftsize.width, dftsize.height));
+            Mat dst1(dftTempl, Rect(0, yofs, templ.cols, templ.rows));
+
+            if( tcn > 1 )
+            {
+                src = tdepth == maxDepth ? dst1 : Mat(templ.size(), tdepth, &buf[0]);
+                int pairs[] = {k, 0};
+                mixChannels(&templ, 1, &src, 1, pairs, 1);
+            }
 
-        if( dst1.data != src.data )
-            src.convertTo(dst1, dst1.depth());
+            if( dst1.data != src.data )
+                src.convertTo(dst1, dst1.depth());
 
-        if( dst.cols > templ.cols )
-        {
-            Mat part(dst, Range(0, templ.rows), Range(templ.cols, dst.cols));
-            part = Scalar::all(0);
+            if( dst.cols > templ.cols )
+            {
+                Mat part(dst, Range(0, templ.rows), Range(templ.cols, dst.cols));
+                part = Scalar::all(0);
+            }
+            c->apply(dst.data, (int)dst.step, dst.data, (int)dst.step);
         }
-        c->apply(dst.data, (int)dst.step, dst.data, (int)dst.step);
     }
 
     int tileCountX = (corr.cols + blocksize.width - 1)/blocksize.width;
@@ -670,93 +676,135 @@ void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
     }
     borderType |= BORDER_ISOLATED;
 
-    Ptr<hal::DFT2D> cF, cR;
-    int f = CV_HAL_DFT_IS_INPLACE;
-    int f_inv = f | CV_HAL_DFT_INVERSE | CV_HAL_DFT_SCALE;
-    cF = hal::DFT2D::create(dftsize.width, dftsize.height, maxDepth, 1, 1, f, blocksize.height + templ.rows - 1);
-    cR = hal::DFT2D::create(dftsize.width, dftsize.height, maxDepth, 1, 1, f_inv, blocksize.height);
+    bufSize = 0;
+    if( cn > 1 && depth != maxDepth )
+        bufSize = (blocksize.width + templSize.width - 1)*(blocksize.height + templSize.height - 1)*CV_ELEM_SIZE(depth);
+
+    if( (ccn > 1 || cn > 1) && cdepth != maxDepth )
+        bufSize = std::max( bufSize, blocksize.width*blocksize.height*CV_ELEM_SIZE(cdepth));
 
-    // calculate correlation by blocks
-    for( i = 0; i < tileCount; i++ )
+    // calculate correlation by blocks, the tiles are independent
+    parallel_for_(Range(0, tileCount), [&](const Range& range)
     {
-        int x = (i%tileCountX)*blocksize.width;
-        int y = (i/tileCountX)*blocksize.height;
-
-        Size bsz(std::min(blocksize.width, corr.cols - x),
-                 std::min(blocksize.height, corr.rows - y));
-        Size dsz(bsz.width + templ.cols - 1, bsz.height + templ.rows - 1);
-        int x0 = x - anchor.x + roiofs.x, y0 = y - anchor.y + roiofs.y;
-        int x1 = std::max(0, x0), y1 = std::max(0, y0);
-        int x2 = std::min(img0.cols, x0 + dsz.width);
-        int y2 = std::min(img0.rows, y0 + dsz.height);
-        Mat src0(img0, Range(y1, y2), Range(x1, x2));
-        Mat dst(dftImg, Rect(0, 0, dsz.width, dsz.height));
-        Mat dst1(dftImg, Rect(x1-x0, y1-y0, x2-x1, y2-y1));
-        Mat cdst(corr, Rect(x, y, bsz.width, bsz.height));
-
-        for( k = 0; k < cn; k++ )
+        std::vector<uchar> tileBuf(bufSize);
+        Mat dftImg( dftsize, maxDepth );
+        // the product of the spectra goes to a separate buffer when the image spectrum is reused
+        Mat dftProd = ntempl > 1 ? Mat( dftsize, maxDepth ) : dftImg;
+
+        Ptr<hal::DFT2D> cF, cR;
+        int f = CV_HAL_DFT_IS_INPLACE;
+        int f_inv = f | CV_HAL_DFT_INVERSE | CV_HAL_DFT_SCALE;
+        cF = hal::DFT2D::create(dftsize.width, dftsize.height, maxDepth, 1, 1, f, blocksize.height + templSize.height - 1);
+        cR = hal::DFT2D::create(dftsize.width, dftsize.height, maxDepth, 1, 1, f_inv, blocksize.height);
+
+        for( int i = range.start; i < range.end; i++ )
         {
-            Mat src = src0;
-            dftImg = Scalar::all(0);
-
-            if( cn > 1 )
+            int x = (i%tileCountX)*blocksize.width;
+            int y = (i/tileCountX)*blocksize.height;
+
+            Size bsz(std::min(blocksize.width, corr.cols - x),
+                     std::min(blocksize.height, corr.rows - y));
+            Size dsz(bsz.width + templSize.width - 1, bsz.height + templSize.height - 1);
+            int x0 = x - anchor.x + roiofs.x, y0 = y - anchor.y + roiofs.y;
+            int x1 = std::max(0, x0), y1 = std::max(0, y0);
+            int x2 = std::min(img0.cols, x0 + dsz.width);
+            int y2 = std::min(img0.rows, y0 + dsz.height);
+            Mat src0(img0, Range(y1, y2), Range(x1, x2));
+            Mat dst(dftImg, Rect(0, 0, dsz.width, dsz.height));
+            Mat dst1(dftImg, Rect(x1-x0, y1-y0, x2-x1, y2-y1));
+
+            for( int k = 0; k < cn; k++ )
             {
-                src = depth == maxDepth ? dst1 : Mat(y2-y1, x2-x1, depth, &buf[0]);
-                int pairs[] = {k, 0};
-                mixChannels(&src0, 1, &src, 1, pairs, 1);
-            }
+                Mat src = src0;
+                dftImg = Scalar::all(0);
 
-            if( dst1.data != src.data )
-                src.convertTo(dst1, dst1.depth());
+                if( cn > 1 )
+                {
+                    src = depth == maxDepth ? dst1 : Mat(y2-y1, x2-x1, depth, &tileBuf[0]);
+                    int pairs[] = {k, 0};
+                    mixChannels(&src0, 1, &src, 1, pairs, 1);
+                }
 
-            if( x2 - x1 < dsz.width || y2 - y1 < dsz.height )
-                copyMakeBorder(dst1, dst, y1-y0, dst.rows-dst1.rows-(y1-y0),
-                               x1-x0, dst.cols-dst1.cols-(x1-x0), borderType);
+                if( dst1.data != src.data )
+                    src.convertTo(dst1, dst1.depth());
 
-            if (bsz.height == blocksize.height)
-                cF->apply(dftImg.data, (int)dftImg.step, dftImg.data, (int)dftImg.step);
-            else
-                dft( dftImg, dftImg, 0, dsz.height );
+                if( x2 - x1 < dsz.width || y2 - y1 < dsz.height )
+                    copyMakeBorder(dst1, dst, y1-y0, dst.rows-dst1.rows-(y1-y0),
+                                   x1-x0, dst.cols-dst1.cols-(x1-x0), borderType);
 
-            Mat dftTempl1(dftTempl, Rect(0, tcn > 1 ? k*dftsize.height : 0,
-                                         dftsize.width, dftsize.height));
-            mulSpectrums(dftImg, dftTempl1, dftImg, 0, true);
+                if (bsz.height == blocksize.height)
+                    cF->apply(dftImg.data, (int)dftImg.step, dftImg.data, (int)dftImg.step);
+                else
+                    dft( dftImg, dftImg, 0, dsz.height );
 
-            if (bsz.height == blocksize.height)
-                cR->apply(dftImg.data, (int)dftImg.step, dftImg.data, (int)dftImg.step);
-            else
-                dft( dftImg, dftImg, DFT_INVERSE + DFT_SCALE, bsz.height );
+                for( int t = 0; t < ntempl; t++ )
+                {
+                    Mat cdst(corrs[t], Rect(x, y, bsz.width, bsz.height));
+                    Mat dftTempl1(dftTempl, Rect(0, (t*tcn + (tcn > 1 ? k : 0))*dftsize.height,
+                                                 dftsize.width, dftsize.height));
+                    mulSpectrums(dftImg, dftTempl1, dftProd, 0, true);
 
-            src = dftImg(Rect(0, 0, bsz.width, bsz.height));
+                    if (bsz.height == blocksize.height)
+                        cR->apply(dftProd.data, (int)dftProd.step, dftProd.data, (int)dftProd.step);
+                    else
+                        dft( dftProd, dftProd, DFT_INVERSE + DFT_SCALE, bsz.height );
 
-            if( ccn > 1 )
-            {
-                if( cdepth != maxDepth )
-                {
-                    Mat plane(bsz, cdepth, &buf[0]);
-                    src.convertTo(plane, cdepth, 1, delta);
-                    src = plane;
-                }
-                int pairs[] = {0, k};
-                mixChannels(&src, 1, &cdst, 1, pairs, 1);
-            }
-            else
-            {
-                if( k == 0 )
-                    src.convertTo(cdst, cdepth, 1, delta);
-                else
-                {
-                    if( maxDepth != cdepth )
+                    src = dftProd(Rect(0, 0, bsz.width, bsz.height));
+
+                    if( ccn > 1 )
                     {
-                        Mat plane(bsz, cdepth, &buf[0]);
-                        src.convertTo(plane, cdepth);
-                        src = plane;
+                        if( cdepth != maxDepth )
+                        {
+                            Mat plane(bsz, cdepth, &tileBuf[0]);
+                            src.convertTo(plane, cdepth, 1, delta);
+                            src = plane;
+                        }
+                        int pairs[] = {0, k};
+                        mixChannels(&src, 1, &cdst, 1, pairs, 1);
+                    }
+                    else
+                    {
+                        if( k == 0 )
+                            src.convertTo(cdst, cdepth, 1, delta);
+                        else
+                        {
+                            if( maxDepth != cdepth )
+                            {
+                                Mat plane(bsz, cdepth, &tileBuf[0]);
+                                src.convertTo(plane, cdepth);
+                                src = plane;
+                            }
+                            add(src, cdst, cdst);
+                        }
                     }
-                    add(src, cdst, cdst);
                 }
             }
         }
-    }
+    }, std::min(tileCount, getNumThreads()));
+}
+
+void crossCorr( const Mat& img, const Mat& templ, Mat& corr,
+                Point anchor, double delta, int borderType )
+{
+    std::vector<Mat> templs(1, templ), corrs(1, corr);
+    crossCorrMulti(img, templs, corrs, anchor, delta, borderType);
+}
+
+// the limits of the template area for the direct correlation are the same as in filter2D()
+static bool useDirectCorr( Size templSize, int depth, int cn )
+{
+    int dftSize = depth == CV_32F && checkHardwareSupport(CV_CPU_SSE3) ? 130 : 50;
+    return cn == 1 && templSize.area() < dftSize;
+}
+
+// the correlation with a small single-channel template by the vectorized linear filter, without the DFT.
+// The filter reads the pixels to the right and below the positions inside the image only, so no border is used
+static void directCrossCorr( const Mat& img, const Mat& templ, Mat& corr )
+{
+    Mat kernel;
+    templ.convertTo(kernel, CV_32F);
+    applyFilterParallel([&]() { return createLinearFilter(img.type(), corr.type(), kernel, Point(0, 0), 0, BORDER_CONSTANT); },
+                        img(Rect(Point(), corr.size())), corr, img.size(), Point());
 }
 
 static void matchTemplateMask( InputArray _img, InputArray _templ, OutputArray _result, int method, InputArray _mask )
@@ -967,65 +1015,67 @@ static void common_matchTemplate( Mat& img, Mat& templ, Mat& result, int method,
     int sumstep = sum.data ? (int)(sum.step / sizeof(double)) : 0;
     int sqstep = sqsum.data ? (int)(sqsum.step / sizeof(double)) : 0;
 
-    int i, j, k;
-
-    for( i = 0; i < result.rows; i++ )
+    parallel_for_(Range(0, result.rows), [&](const Range& range)
     {
-        float* rrow = result.ptr<float>(i);
-        int idx = i * sumstep;
-        int idx2 = i * sqstep;
-
-        for( j = 0; j < result.cols; j++, idx += cn, idx2 += cn )
+        for( int i = range.start; i < range.end; i++ )
         {
-            double num = rrow[j], t;
-            double wndMean2 = 0, wndSum2 = 0;
+            float* rrow = result.ptr<float>(i);
+            int idx = i * sumstep;
+            int idx2 = i * sqstep;
 
-            if( numType == 1 )
+            for( int j = 0; j < result.cols; j++, idx += cn, idx2 += cn )
             {
-                for( k = 0; k < cn; k++ )
+                int k;
+                double num = rrow[j], t;
+                double wndMean2 = 0, wndSum2 = 0;
+
+                if( numType == 1 )
                 {
-                    t = p0[idx+k] - p1[idx+k] - p2[idx+k] + p3[idx+k];
-                    wndMean2 += t*t;
-                    num -= t*templMean[k];
-                }
+                    for( k = 0; k < cn; k++ )
+                    {
+                        t = p0[idx+k] - p1[idx+k] - p2[idx+k] + p3[idx+k];
+                        wndMean2 += t*t;
+                        num -= t*templMean[k];
+                    }
 
-                wndMean2 *= invArea;
-            }
+                    wndMean2 *= invArea;
+                }
 
-            if( isNormed || numType == 2 )
-            {
-                for( k = 0; k < cn; k++ )
+                if( isNormed || numType == 2 )
                 {
-                    t = q0[idx2+k] - q1[idx2+k] - q2[idx2+k] + q3[idx2+k];
-                    wndSum2 += t;
+                    for( k = 0; k < cn; k++ )
+                    {
+                        t = q0[idx2+k] - q1[idx2+k] - q2[idx2+k] + q3[idx2+k];
+                        wndSum2 += t;
+                    }
+
+                    if( numType == 2 )
+                    {
+                        num = wndSum2 - 2*num + templSum2;
+                        num = MAX(num, 0.);
+                    }
                 }
 
-                if( numType == 2 )
+                if( isNormed )
                 {
-                    num = wndSum2 - 2*num + templSum2;
-                    num = MAX(num, 0.);
+                    double diff2 = MAX(wndSum2 - wndMean2, 0);
+                    if (diff2 <= std::min(0.5, 10 * FLT_EPSILON * wndSum2))
+                        t = 0; // avoid rounding errors
+                    else
+                        t = std::sqrt(diff2)*templNorm;
+
+                    if( fabs(num) < t )
+                        num /= t;
+                    else if( fabs(num) < t*1.125 )
+                        num = num > 0 ? 1 : -1;
+                    else
+                        num = method != cv::TM_SQDIFF_NORMED ? 0 : 1;
                 }
-            }
 
-            if( isNormed )
-            {
-                double diff2 = MAX(wndSum2 - wndMean2, 0);
-                if (diff2 <= std::min(0.5, 10 * FLT_EPSILON * wndSum2))
-                    t = 0; // avoid rounding errors
-                else
-                    t = std::sqrt(diff2)*templNorm;
-
-                if( fabs(num) < t )
-                    num /= t;
-                else if( fabs(num) < t*1.125 )
-                    num = num > 0 ? 1 : -1;
-                else
-                    num = method != cv::TM_SQDIFF_NORMED ? 0 : 1;
+                rrow[j] = (float)num;
             }
-
-            rrow[j] = (float)num;
         }
-    }
+    }, result.total()/(double)(1<<16));
 }
 }
 
@@ -1188,11 +1238,194 @@ void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result,
 
     CV_IPP_RUN_FAST(ipp_matchTemplate(img, templ, result, method))
 
-    crossCorr( img, templ, result, Point(0,0), 0, 0);
+    if( useDirectCorr(templ.size(), depth, cn) )
+        directCrossCorr( img, templ, result );
+    else
+        crossCorr( img, templ, result, Point(0,0), 0, 0);
 
     common_matchTemplate(img, templ, result, method, cn);
 }
 
+void cv::matchTemplates( InputArray _img, InputArrayOfArrays _templs, OutputArrayOfArrays _results, int method )
+{
+    CV_INSTRUMENT_REGION();
+
+    Mat img = _img.getMat();
+    int type = img.type(), depth = CV_MAT_DEPTH(type), cn = CV_MAT_CN(type);
+    CV_Assert( cv::TM_SQDIFF <= method && method <= cv::TM_CCOEFF_NORMED );
+    CV_Assert( (depth == CV_8U || depth == CV_32F) && img.dims <= 2 );
+
+    std::vector<Mat> templs;
+    _templs.getMatVector(templs);
+    const int ntempl = (int)templs.size();
+    _results.create(ntempl, 1, CV_32F);
+    for( int i = 0; i < ntempl; i++ )
+    {
+        const Mat& templ = templs[i];
+        CV_CheckTypeEQ( templ.type(), type, "" );
+        CV_Assert( !templ.empty() && templ.rows <= img.rows && templ.cols <= img.cols );
+        _results.create(img.rows - templ.rows + 1, img.cols - templ.cols + 1, CV_32F, i, true);
+    }
+
+    // the templates of the same size share the spectra of the image tiles
+    std::vector<bool> done(ntempl, false);
+    for( int i = 0; i < ntempl; i++ )
+    {
+        if( done[i] )
+            continue;
+        std::vector<Mat> group, results;
+        for( int j = i; j < ntempl; j++ )
+        {
+            if( done[j] || templs[j].size() != templs[i].size() )
+                continue;
+            done[j] = true;
+            group.push_back(templs[j]);
+            results.push_back(_results.getMat(j));
+        }
+
+        if( useDirectCorr(group[0].size(), depth, cn) )
+        {
+            for( size_t j = 0; j < group.size(); j++ )
+                directCrossCorr( img, group[j], results[j] );
+        }
+        else
+            crossCorrMulti( img, group, results, Point(0,0), 0, 0 );
+
+        for( size_t j = 0; j < group.size(); j++ )
+            common_matchTemplate( img, group[j], results[j], method, cn );
+    }
+}
+
+namespace cv
+{
+
+struct TemplatePeak
+{
+    Point pt;
+    float score;
+};
+
+// keeps the best peaks which are at least minDist apart
+static void selectTemplatePeaks( std::vector<TemplatePeak>& peaks, bool minimize, Size minDist, int maxCount )
+{
+    std::sort(peaks.begin(), peaks.end(), [minimize](const TemplatePeak& a, const TemplatePeak& b)
+    {
+        if( a.score != b.score )
+            return minimize ? a.score < b.score : a.score > b.score;
+        return a.pt.y != b.pt.y ? a.pt.y < b.pt.y : a.pt.x < b.pt.x;
+    });
+
+    std::vector<TemplatePeak> selected;
+    for( size_t i = 0; i < peaks.size() && (int)selected.size() < maxCount; i++ )
+    {
+        bool isolated = true;
+        for( size_t j = 0; j < selected.size() && isolated; j++ )
+            isolated = std::abs(peaks[i].pt.x - selected[j].pt.x) >= minDist.width ||
+                       std::abs(peaks[i].pt.y - selected[j].pt.y) >= minDist.height;
+        if( isolated )
+            selected.push_back(peaks[i]);
+    }
+    peaks.swap(selected);
+}
+
+// the local extrema of the map of the comparison results
+static void findTemplatePeaks( const Mat& result, bool minimize, Size minDist, int maxCount,
+                               std::vector<TemplatePeak>& peaks )
+{
+    peaks.clear();
+    for( int y = 0; y < result.rows; y++ )
+    {
+        const float* rows[3] = { result.ptr<float>(std::max(y - 1, 0)), result.ptr<float>(y),
+                                 result.ptr<float>(std::min(y + 1, result.rows - 1)) };
+        for( int x = 0; x < result.cols; x++ )
+        {
+            const float v = rows[1][x];
+            const int xl = std::max(x - 1, 0), xr = std::min(x + 1, result.cols - 1);
+            bool extremum = true;
+            for( int k = 0; k < 3 && extremum; k++ )
+                extremum = minimize ? v <= std::min(std::min(rows[k][xl], rows[k][x]), rows[k][xr])
+                                    : v >= std::max(std::max(rows[k][xl], rows[k][x]), rows[k][xr]);
+            if( extremum )
+            {
+                TemplatePeak peak = { Point(x, y), v };
+                peaks.push_back(peak);
+            }
+        }
+    }
+    selectTemplatePeaks(peaks, minimize, minDist, maxCount);
+}
+
+}
+
+void cv::matchTemplatePeaks( InputArray _img, InputArray _templ, std::vector<Point>& locations,
+                             std::vector<float>& scores, int method, int maxCount, int maxLevel )
+{
+    CV_INSTRUMENT_REGION();
+
+    Mat img = _img.getMat(), templ = _templ.getMat();
+    int type = img.type(), depth = CV_MAT_DEPTH(type);
+    CV_Assert( cv::TM_SQDIFF <= method && method <= cv::TM_CCOEFF_NORMED );
+    CV_Assert( (depth == CV_8U || depth == CV_32F) && type == templ.type() && img.dims <= 2 );
+    CV_Assert( !templ.empty() && templ.rows <= img.rows && templ.cols <= img.cols );
+    CV_CheckGT( maxCount, 0, "" );
+
+    const bool minimize = method == cv::TM_SQDIFF || method == cv::TM_SQDIFF_NORMED;
+    if( maxLevel < 0 )
+    {
+        // the template is reduced while it keeps enough details to be matched
+        maxLevel = 0;
+        for( Size sz = templ.size(); maxLevel < 4 && std::min(sz.width, sz.height) >= 16; maxLevel++ )
+            sz = Size((sz.width + 1)/2, (sz.height + 1)/2);
+    }
+
+    std::vector<Mat> imgPyr, templPyr;
+    buildPyramid(img, imgPyr, maxLevel);
+    buildPyramid(templ, templPyr, maxLevel);
+    auto minDist = [&](int level)
+    {
+        return Size(std::max(templPyr[level].cols/2, 1), std::max(templPyr[level].rows/2, 1));
+    };
+
+    // the whole map is computed on the coarsest level only. More candidates than requested are kept
+    // there, since the order of the matches may change when they are refined
+    const int candidates = maxLevel > 0 ? maxCount*4 + 4 : maxCount;
+    std::vector<TemplatePeak> peaks;
+    Mat result;
+    matchTemplate(imgPyr[maxLevel], templPyr[maxLevel], result, method);
+    findTemplatePeaks(result, minimize, minDist(maxLevel), candidates, peaks);
+
+    for( int level = maxLevel - 1; level >= 0; level-- )
+    {
+        const Mat& image = imgPyr[level];
+        const Mat& t = templPyr[level];
+        const Rect valid(0, 0, image.cols - t.cols + 1, image.rows - t.rows + 1);
+        for( size_t i = 0; i < peaks.size(); i++ )
+        {
+            // the position is known up to the rounding of pyrDown
+            const int radius = 2;
+            Rect window = Rect(peaks[i].pt.x*2 - radius, peaks[i].pt.y*2 - radius, radius*2 + 1, radius*2 + 1) & valid;
+            CV_Assert( !window.empty() );
+            matchTemplate(image(Rect(window.tl(), window.size() + t.size() - Size(1, 1))), t, result, method);
+
+            double minVal = 0, maxVal = 0;
+            Point minLoc, maxLoc;
+            minMaxLoc(result, &minVal, &maxVal, &minLoc, &maxLoc);
+            peaks[i].pt = window.tl() + (minimize ? minLoc : maxLoc);
+            peaks[i].score = (float)(minimize ? minVal : maxVal);
+        }
+        // the candidates which have converged to the same match are merged
+        selectTemplatePeaks(peaks, minimize, minDist(level), level > 0 ? candidates : maxCount);
+    }
+
+    locations.resize(peaks.size());
+    scores.resize(peaks.size());
+    for( size_t i = 0; i < peaks.size(); i++ )
+    {
+        locations[i] = peaks[i].pt;
+        scores[i] = peaks[i].score;
+    }
+}
+
 CV_IMPL void
 cvMatchTemplate( const CvArr* _img, const CvArr* _templ, CvArr* _result, int method )
 {
@@ -155,6 +155,29 @@ static void Canny_reference( const Mat& src, Mat& dst,
 
 //==============================================================================
 
+// the gradients of a large image are computed by bands of rows
+TEST(Imgproc_Canny, gradient_bands)
+{
+    Mat img(600, 2048, CV_8UC1);
+    randu(img, 0, 256);
+    GaussianBlur(img, img, Size(5, 5), 0);
+    for (int aperture = 3; aperture <= 5; aperture += 2)
+    {
+        for (int L2 = 0; L2 <= 1; L2++)
+        {
+            SCOPED_TRACE(cv::format("aperture=%d L2=%d", aperture, L2));
+            Mat dx, dy, ref, dst;
+            Sobel(img, dx, CV_16S, 1, 0, aperture, 1, 0, BORDER_REPLICATE);
+            Sobel(img, dy, CV_16S, 0, 1, aperture, 1, 0, BORDER_REPLICATE);
+            cv::Canny(dx, dy, ref, 50, 150, L2 != 0);
+            cv::Canny(img, dst, 50, 150, aperture, L2 != 0);
+            EXPECT_EQ(0, cvtest::norm(ref, dst, NORM_INF));
+        }
+    }
+}
+
+//==============================================================================
+
 // aperture, true gradient
 typedef testing::TestWithParam<testing::tuple<int, bool>> Canny_Modes;
 
@@ -561,6 +561,55 @@ INSTANTIATE_TEST_CASE_P(
                                      CHAIN_APPROX_TC89_L1,
                                      CHAIN_APPROX_TC89_KCOS)));
 
+// Large images are scanned by independent bands of components on several threads,
+// results must be identical to the sequential scan
+TEST(Imgproc_FindContours, parallel_bands)
+{
+    const Size sz {1200, 1000};
+    RNG& rng = TS::ptr()->get_rng();
+    Mat noise(sz, CV_8UC1), fimg;
+    cvtest::randUni(rng, noise, 0, 255);
+    cv::boxFilter(noise, fimg, CV_8U, Size(5, 5));
+
+    vector<Mat> imgs;
+    for (int level : {110, 135})
+    {
+        Mat img;
+        cv::threshold(fimg, img, level, 255, THRESH_BINARY);
+        // nested rings crossing many bands
+        for (int r = 450; r > 0; r -= 30)
+            circle(img, Point(600, 500), r, Scalar::all(r % 60 ? 255 : 0), 8);
+        imgs.push_back(img);
+    }
+
+    const int prevThreads = getNumThreads();
+    for (size_t k = 0; k < imgs.size(); ++k)
+    {
+        for (int mode : {RETR_EXTERNAL, RETR_LIST, RETR_CCOMP, RETR_TREE})
+        {
+            for (int method : {0, (int)CHAIN_APPROX_NONE, (int)CHAIN_APPROX_SIMPLE, (int)CHAIN_APPROX_TC89_L1})
+            {
+                SCOPED_TRACE(format("img = %zu, mode = %d, method = %d", k, mode, method));
+                vector<Mat> contours_ref, contours;
+                vector<Vec4i> hierarchy_ref, hierarchy;
+                setNumThreads(1);
+                findContours(imgs[k], contours_ref, hierarchy_ref, mode, method, Point(3, -2));
+                setNumThreads(4);
+                findContours(imgs[k], contours, hierarchy, mode, method, Point(3, -2));
+                setNumThreads(prevThreads);
+
+                ASSERT_EQ(contours_ref.size(), contours.size());
+                for (size_t i = 0; i < contours.size(); ++i)
+                {
+                    ASSERT_EQ(contours_ref[i].type(), contours[i].type());
+                    ASSERT_EQ(0., cvtest::norm(contours_ref[i], contours[i], NORM_INF)) << "contour = " << i;
+                }
+                ASSERT_EQ(hierarchy_ref, hierarchy);
+            }
+        }
+    }
+}
+
 TEST(Imgproc_FindContours, link_runs)
 {
     const Size sz {500, 500};
@@ -2291,6 +2291,78 @@ TEST(Imgproc_MedianBlur, hires_regression_13409)
     ASSERT_EQ(0.0, cvtest::norm(dst_hires(Rect(516, 516, 1016, 1016)), dst_ref(Rect(4, 4, 1016, 1016)), NORM_INF));
 }
 
+static void medianBlurReference(const Mat& src, Mat& dst, int ksize)
+{
+    const int r = ksize / 2, cn = src.channels();
+    Mat src64, border;
+    src.convertTo(src64, CV_64F);
+    cv::copyMakeBorder(src64, border, r, r, r, r, BORDER_REPLICATE);
+    Mat dst64(src.size(), CV_64FC(cn));
+    std::vector<double> win(ksize * ksize);
+    for (int y = 0; y < src.rows; y++)
+        for (int x = 0; x < src.cols; x++)
+            for (int c = 0; c < cn; c++)
+            {
+                for (int dy = 0; dy < ksize; dy++)
+                    for (int dx = 0; dx < ksize; dx++)
+                        win[dy * ksize + dx] = border.ptr<double>(y + dy)[(x + dx) * cn + c];
+                std::nth_element(win.begin(), win.begin() + win.size() / 2, win.end());
+                dst64.ptr<double>(y)[x * cn + c] = win[win.size() / 2];
+            }
+    dst64.convertTo(dst, src.type());
+}
+
+TEST(Imgproc_MedianBlur, large_aperture_all_depths)
+{
+    RNG& rng = TS::ptr()->get_rng();
+    for (int type : {CV_16UC1, CV_16SC3, CV_32FC1, CV_32FC4})
+    {
+        for (int ksize : {7, 11})
+        {
+            SCOPED_TRACE(cv::format("type=%s ksize=%d", typeToString(type).c_str(), ksize));
+            Mat src(47, 61, type), dst, ref;
+            if (CV_MAT_DEPTH(type) == CV_16U)
+                rng.fill(src, RNG::UNIFORM, 0, 65536);
+            else if (CV_MAT_DEPTH(type) == CV_16S)
+                rng.fill(src, RNG::UNIFORM, -32768, 32768);
+            else
+                rng.fill(src, RNG::UNIFORM, -1000, 1000);
+
+            medianBlur(src, dst, ksize);
+            medianBlurReference(src, ref, ksize);
+            EXPECT_EQ(0, cvtest::norm(dst, ref, NORM_INF));
+
+            Mat inplace = src.clone();
+            medianBlur(inplace, inplace, ksize);
+            EXPECT_EQ(0, cvtest::norm(dst, inplace, NORM_INF));
+        }
+    }
+}
+
+TEST(Imgproc_MedianBlur, parallel_bands)
+{
+    RNG& rng = TS::ptr()->get_rng();
+    const int prevThreads = getNumThreads();
+    for (int type : {CV_8UC1, CV_8UC3, CV_16UC1, CV_32FC1})
+    {
+        Mat src(480, 640, type);
+        rng.fill(src, RNG::UNIFORM, 0, 256);
+        for (int ksize : {3, 5, 7, 21})
+        {
+            if (CV_MAT_DEPTH(type) != CV_8U && ksize > 7)
+                continue;
+            SCOPED_TRACE(cv::format("type=%s ksize=%d", typeToString(type).c_str(), ksize));
+            Mat ref, dst;
+            setNumThreads(1);
+            medianBlur(src, ref, ksize);
+            setNumThreads(4);
+            medianBlur(src, dst, ksize);
+            setNumThreads(prevThreads);
+            EXPECT_EQ(0, cvtest::norm(ref, dst, NORM_INF));
+        }
+    }
+}
+
 TEST(Imgproc_Sobel, s16_regression_13506)
 {
     Mat src = (Mat_<short>(8, 16) << 127, 138, 130, 102, 118,  97,  76,  84, 124,  90, 146,  63, 130,  87, 212,  85,
@@ -2551,4 +2623,141 @@ INSTANTIATE_TEST_CASE_P(/**/, Imgproc_sepFilter2D_types,
     testing::Values(CV_16S, CV_32F, CV_64F),
 );
 
+// the filters built on FilterEngine process the bands of rows in parallel,
+// the result must not depend on the number of threads
+TEST(Imgproc_FilterEngine, parallel_bands)
+{
+    const int nthreads = getNumThreads();
+    const int types[] = { CV_8UC1, CV_8UC3, CV_16SC1, CV_32FC1, CV_32FC4 };
+    const int borders[] = { BORDER_REFLECT_101, BORDER_CONSTANT, BORDER_REPLICATE };
+    Mat kernel(5, 5, CV_32F), kx(1, 7, CV_32F), ky(1, 3, CV_32F);
+    randu(kernel, -1, 1);
+    randu(kx, -1, 1);
+    randu(ky, -1, 1);
+    const Mat cross = getStructuringElement(MORPH_CROSS, Size(5, 5));
+
+    for (size_t t = 0; t < sizeof(types) / sizeof(types[0]); t++)
+    {
+        for (size_t b = 0; b < sizeof(borders) / sizeof(borders[0]); b++)
+        {
+            const int border = borders[b];
+            Mat big(700, 530, types[t]);
+            randu(big, 0, 255);
+            // a submatrix, the aperture at the borders of the bands reads the rows around it
+            const Mat src = big(Rect(7, 9, 500, 650));
+
+            std::vector<std::function<void(const Mat&, Mat&)> > ops = {
+                [&](const Mat& in, Mat& out) { cv::filter2D(in, out, -1, kernel, Point(-1, -1), 1, border); },
+                [&](const Mat& in, Mat& out) { cv::sepFilter2D(in, out, CV_32F, kx, ky, Point(-1, -1), 0, border); },
+                [&](const Mat& in, Mat& out) { cv::Sobel(in, out, CV_32F, 1, 1, 3, 1, 0, border); },
+                [&](const Mat& in, Mat& out) { cv::boxFilter(in, out, -1, Size(7, 3), Point(-1, -1), true, border); },
+                [&](const Mat& in, Mat& out) { cv::sqrBoxFilter(in, out, -1, Size(3, 5), Point(-1, -1), true, border); },
+                [&](const Mat& in, Mat& out) { cv::erode(in, out, cross, Point(-1, -1), 2, border); },
+                [&](const Mat& in, Mat& out) { cv::dilate(in, out, Mat(), Point(-1, -1), 1, border); }
+            };
+            for (size_t op = 0; op < ops.size(); op++)
+            {
+                SCOPED_TRACE(cv::format("type=%s border=%d op=%d", typeToString(types[t]).c_str(), border, (int)op));
+                Mat ref, dst;
+                setNumThreads(1);
+                ops[op](src, ref);
+                setNumThreads(4);
+                ops[op](src, dst);
+                ASSERT_EQ(ref.type(), dst.type());
+                if (ref.depth() >= CV_32F)
+                    EXPECT_LE(cvtest::norm(ref, dst, NORM_INF | NORM_RELATIVE), 1e-5);
+                else
+                    EXPECT_EQ(0, cvtest::norm(ref, dst, NORM_INF));
+            }
+
+            // in-place, the bands must read the source rows
+            Mat ref, inplace = src.clone();
+            setNumThreads(1);
+            cv::filter2D(inplace, ref, -1, kernel, Point(-1, -1), 0, border);
+            setNumThreads(4);
+            cv::filter2D(inplace, inplace, -1, kernel, Point(-1, -1), 0, border);
+            EXPECT_LE(cvtest::norm(ref, inplace, NORM_INF), ref.depth() >= CV_32F ? 1e-3 : 0);
+        }
+    }
+    setNumThreads(nthreads);
+}
+
+// morphologyEx runs the chains of erosions and dilations by bands of rows,
+// the result must be the same as of the separate passes over the whole images
+TEST(Imgproc_MorphologyEx, fused_chains)
+{
+    const int types[] = { CV_8UC1, CV_16UC3, CV_32FC1 };
+    const int borders[] = { BORDER_CONSTANT, BORDER_REPLICATE, BORDER_REFLECT_101 | BORDER_ISOLATED };
+    const int ops[] = { MORPH_OPEN, MORPH_CLOSE, MORPH_GRADIENT, MORPH_TOPHAT, MORPH_BLACKHAT };
+    const Mat kernels[] = { getStructuringElement(MORPH_CROSS, Size(5, 3)),
+                            getStructuringElement(MORPH_CROSS, Size(3, 5)),
+                            getStructuringElement(MORPH_RECT, Size(3, 3)) };
+    const int iterations[] = { 1, 3, 1 };
+
+    for (size_t t = 0; t < sizeof(types) / sizeof(types[0]); t++)
+    {
+        Mat big(700, 530, types[t]);
+        randu(big, 0, 255);
+        const Mat src = big(Rect(5, 11, 512, 640));
+        for (size_t b = 0; b < sizeof(borders) / sizeof(borders[0]); b++)
+        {
+            const int border = borders[b];
+            for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++)
+            {
+                const Mat& kernel = kernels[k];
+                const int iters = iterations[k];
+                // one pass per iteration, the next passes filter the whole image
+                auto morph = [&](int op, const Mat& in, Mat& out)
+                {
+                    cv::morphologyEx(in, out, op, kernel, Point(-1, -1), 1, border);
+                    for (int i = 1; i < iters; i++)
+                        cv::morphologyEx(out, out, op, kernel, Point(-1, -1), 1, border);
+                };
+                for (size_t o = 0; o < sizeof(ops) / sizeof(ops[0]); o++)
+                {
+                    const int op = ops[o];
+                    SCOPED_TRACE(cv::format("type=%s border=%d kernel=%d op=%d",
+                                            typeToString(types[t]).c_str(), border, (int)k, op));
+                    Mat dst, ref, t1, t2;
+                    cv::morphologyEx(src, dst, op, kernel, Point(-1, -1), iters, border);
+                    switch (op)
+                    {
+                    case MORPH_OPEN:
+                        morph(MORPH_ERODE, src, t1);
+                        morph(MORPH_DILATE, t1, ref);
+                        break;
+                    case MORPH_CLOSE:
+                        morph(MORPH_DILATE, src, t1);
+                        morph(MORPH_ERODE, t1, ref);
+                        break;
+                    case MORPH_GRADIENT:
+                        morph(MORPH_DILATE, src, t1);
+                        morph(MORPH_ERODE, src, t2);
+                        ref = t1 - t2;
+                        break;
+                    case MORPH_TOPHAT:
+                        morph(MORPH_ERODE, src, t1);
+                        morph(MORPH_DILATE, t1, t2);
+                        ref = src - t2;
+                        break;
+                    case MORPH_BLACKHAT:
+                        morph(MORPH_DILATE, src, t1);
+                        morph(MORPH_ERODE, t1, t2);
+                        ref = t2 - src;
+                        break;
+                    }
+                    EXPECT_EQ(0, cvtest::norm(ref, dst, NORM_INF));
+
+                    if (border & BORDER_ISOLATED)
+                    {
+                        Mat inplace = src.clone();
+                        cv::morphologyEx(inplace, inplace, op, kernel, Point(-1, -1), iters, border);
+                        EXPECT_EQ(0, cvtest::norm(ref, inplace, NORM_INF));
+                    }
+                }
+            }
+        }
+    }
+}
+
 }} // namespace
@@ -342,4 +342,76 @@ INSTANTIATE_TEST_CASE_P(/**/,
             testing::Values(TM_SQDIFF, TM_SQDIFF_NORMED, TM_CCORR, TM_CCORR_NORMED, TM_CCOEFF, TM_CCOEFF_NORMED)));
 
 
+TEST(Imgproc_MatchTemplate, batch)
+{
+    RNG& rng = TS::ptr()->get_rng();
+    const int types[] = { CV_8UC1, CV_8UC3, CV_32FC1 };
+    const int nthreads = getNumThreads();
+    for (size_t t = 0; t < sizeof(types) / sizeof(types[0]); t++)
+    {
+        Mat img(600, 800, types[t]);
+        cvtest::randUni(rng, img, Scalar::all(0), Scalar::all(255));
+        // two groups of the same size, the small ones are matched directly
+        std::vector<Mat> templs;
+        const Size sizes[] = { Size(40, 30), Size(5, 7), Size(40, 30), Size(40, 30), Size(5, 7) };
+        for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+            templs.push_back(img(Rect(Point(rng.uniform(0, 700), rng.uniform(0, 500)), sizes[i])).clone());
+
+        for (int method = TM_SQDIFF; method <= TM_CCOEFF_NORMED; method++)
+        {
+            SCOPED_TRACE(cv::format("type=%s method=%d", typeToString(types[t]).c_str(), method));
+            std::vector<Mat> results;
+            setNumThreads(4);
+            cv::matchTemplates(img, templs, results, method);
+            setNumThreads(1);
+            ASSERT_EQ(templs.size(), results.size());
+            for (size_t i = 0; i < templs.size(); i++)
+            {
+                Mat ref;
+                cv::matchTemplate(img, templs[i], ref, method);
+                EXPECT_MAT_NEAR_RELATIVE(ref, results[i], 1e-5);
+            }
+        }
+    }
+    setNumThreads(nthreads);
+}
+
+TEST(Imgproc_MatchTemplate, peaks)
+{
+    RNG& rng = TS::ptr()->get_rng();
+    Mat img(480, 640, CV_8UC1);
+    cvtest::randUni(rng, img, Scalar::all(0), Scalar::all(255));
+    GaussianBlur(img, img, Size(7, 7), 0);
+    Mat templ(48, 48, CV_8UC1);
+    cvtest::randUni(rng, templ, Scalar::all(0), Scalar::all(255));
+    GaussianBlur(templ, templ, Size(7, 7), 0);
+    const Point pts[] = { Point(37, 301), Point(420, 55), Point(250, 250) };
+    for (int i = 0; i < 3; i++)
+        templ.copyTo(img(Rect(pts[i], templ.size())));
+
+    const int methods[] = { TM_SQDIFF, TM_SQDIFF_NORMED, TM_CCORR_NORMED, TM_CCOEFF, TM_CCOEFF_NORMED };
+    for (size_t m = 0; m < sizeof(methods) / sizeof(methods[0]); m++)
+    {
+        for (int level = -1; level <= 0; level++)
+        {
+            SCOPED_TRACE(cv::format("method=%d level=%d", methods[m], level));
+            std::vector<Point> locations;
+            std::vector<float> scores;
+            cv::matchTemplatePeaks(img, templ, locations, scores, methods[m], 3, level);
+            ASSERT_EQ(3u, locations.size());
+            ASSERT_EQ(3u, scores.size());
+            for (int i = 0; i < 3; i++)
+                EXPECT_NE(std::find(locations.begin(), locations.end(), pts[i]), locations.end()) << pts[i];
+            if (methods[m] == TM_SQDIFF_NORMED)
+            {
+                EXPECT_LE(scores[2], 1e-4);
+            }
+            else if (methods[m] == TM_CCORR_NORMED || methods[m] == TM_CCOEFF_NORMED)
+            {
+                EXPECT_GE(scores[2], 1 - 1e-4);
+            }
+        }
+    }
+}
+
 }} // namespace